@@ -4,10 +4,14 @@
 
 #include "app/cli_handler.h"
 
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "build/project_config.h"
+#include "core/base/file_util.h"
 #include "core/base/logger.h"
 #include "core/cli/ansi/progress_bar.h"
 #include "core/cli/ansi/style_builder.h"
@@ -17,11 +21,23 @@
 #include "core/location.h"
 #include "core/redy/build_type.h"
 #include "core/redy/runtime_options.h"
+#include "frontend/base/data/arena_profile.h"
+#include "frontend/base/string/string_interner.h"
+#include "frontend/diagnostic/data/diagnostic_entry.h"
+#include "frontend/diagnostic/engine/diagnostic_engine.h"
+#include "frontend/diagnostic/engine/sink.h"
+#include "frontend/pipeline/pipeline.h"
+#include "i18n/base/translator.h"
+#include "unicode/utf8/file_manager.h"
 
 namespace app {
 
 namespace {
 
+// per-project build state (the arena profile) is kept here when no cache
+// directory is given, relative to the directory redy is run from
+constexpr const char* kDefaultBuildStateDir = ".redy";
+
 void setup_options(core::ArgParser& parser, core::RuntimeOptions* options) {
   // runtime overridable options
   parser.add_option(&options->config_file, "config",
@@ -36,10 +52,113 @@ void setup_options(core::ArgParser& parser, core::RuntimeOptions* options) {
 
   parser.add_alias("mr", "min_size_rel");
 
+  parser.add_option(&options->jobs, "jobs",
+                    "number of frontend worker threads (0 = all cores)", false,
+                    {options->jobs});
+  parser.add_alias("j", "jobs");
+
+  parser.add_flag(&options->arena_profile, "arena_profile",
+                  "pre-size frontend arenas from the recorded profile and "
+                  "update it",
+                  false, {options->arena_profile});
+
+  parser.add_option(&options->cache_dir, "cache_dir",
+                    "directory for cached asts of unchanged input files", false,
+                    {options->cache_dir});
+
+  parser.add_option(&options->diagnostic_format, "diagnostic_format",
+                    "how diagnostics are printed: classic, json (one object "
+                    "per line) or binary",
+                    false, {options->diagnostic_format});
+
+  parser.add_list(&options->input_files, "input",
+                  "source file to compile, can be given multiple times");
+  parser.add_alias("i", "input");
+
   parser.add_positional(&options->sub_command, "sub_command",
                         "specify what to do", false);
 }
 
+// lexes, parses and resolves every input file and prints the diagnostics.
+// returns the number of diagnostics reported.
+std::size_t compile_inputs(const core::RuntimeOptions& options) {
+  unicode::Utf8FileManager manager;
+  std::vector<unicode::Utf8FileId> files;
+  files.reserve(options.input_files.size());
+  for (const std::string& path : options.input_files) {
+    files.push_back(manager.register_file(
+        std::u8string_view(reinterpret_cast<const char8_t*>(path.data()),
+                           path.size())));
+  }
+
+  // the profile describes the project being compiled, so it lives in the
+  // project's cache directory rather than next to the shared binary
+  base::ArenaProfile arena_profile;
+  const std::string profile_dir =
+      options.cache_dir.empty() ? kDefaultBuildStateDir : options.cache_dir;
+  const std::string profile_path =
+      core::join_path(profile_dir, base::ArenaProfile::kFileName);
+  if (options.arena_profile) {
+    arena_profile.load(profile_path);
+  }
+
+  const i18n::Translator translator;
+  base::StringInterner interner;
+  pipeline::Pipeline pipeline(
+      &manager, &translator,
+      {.jobs = options.jobs,
+       .arena_profile = options.arena_profile ? &arena_profile : nullptr,
+       .cache_dir = options.cache_dir});
+  std::vector<diagnostic::DiagnosticEntry> errors =
+      pipeline.run(files, &interner, pipeline::Pipeline::Scope::kProject);
+
+  if (options.arena_profile) {
+    if (!core::dir_exists(profile_dir.c_str())) {
+      core::create_directories(profile_dir.c_str());
+    }
+    if (!arena_profile.save(profile_path)) {
+      core::glog.warn_ref<"failed to save the arena profile to {}\n">(
+          profile_path);
+    }
+  }
+
+  const std::size_t error_count = errors.size();
+  if (error_count != 0) {
+    diagnostic::DiagnosticOptions diagnostic_options;
+    diagnostic_options.jobs = options.jobs;
+    if (options.diagnostic_format == "json") {
+      diagnostic_options.output_format =
+          diagnostic::DiagnosticOutputFormat::kJson;
+    } else if (options.diagnostic_format == "binary") {
+      diagnostic_options.output_format =
+          diagnostic::DiagnosticOutputFormat::kBinary;
+    }
+    diagnostic::DiagnosticEngine engine(&manager, &translator,
+                                        diagnostic_options);
+    for (auto& e : errors) {
+      engine.push(std::move(e));
+    }
+    if (diagnostic_options.output_format ==
+        diagnostic::DiagnosticOutputFormat::kClassic) {
+      diagnostic::LoggerSink sink;
+      engine.emit_batch_and_clear(&sink);
+      sink.write("\n", 1);
+      const std::size_t suppressed = engine.suppressed().total();
+      if (suppressed != 0) {
+        core::glog.raw<"{} repeated, follow-up or excess diagnostics were "
+                       "not shown\n">(suppressed);
+      }
+      sink.flush();
+    } else {
+      // machine readable output goes to stdout as is
+      core::glog.flush();
+      diagnostic::FdSink sink(1);
+      engine.emit_batch_and_clear(&sink);
+    }
+  }
+  return error_count;
+}
+
 }  // namespace
 
 int handle_arguments(int argc, char** argv) {
@@ -98,6 +217,10 @@ int handle_arguments(int argc, char** argv) {
     core::glog.flush();
   }
 
+  if (!options->input_files.empty()) {
+    return compile_inputs(*options) == 0 ? 0 : 1;
+  }
+
   core::StyleBuilder ing;
   ing.style(core::Style::kBoldUnderline).color(core::Color::kBrightBlue);
   core::ProgressBar bar(30, ing.build("Compiling...") + " : demo.ry");
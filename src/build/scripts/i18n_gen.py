@@ -181,6 +181,46 @@ def build_string_table(
     return string_to_index, string_table
 
 
+def escape_cpp_string(string: str) -> str:
+    return string.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n")
+
+
+def split_format_string(string: str) -> list[tuple[str, int]]:
+    """split a message at its placeholders into (literal, arg index) pairs.
+    the last pair has no argument, its index is -1."""
+    segments = []
+    literal = ""
+    next_arg = 0
+    i = 0
+    while i < len(string):
+        c = string[i]
+        if string.startswith("{{", i) or string.startswith("}}", i):
+            literal += c
+            i += 2
+        elif c == "{":
+            end = string.find("}", i)
+            if end < 0:
+                raise ValueError(f"unterminated placeholder in '{string}'")
+            field = string[i + 1 : end]
+            if field == "":
+                arg = next_arg
+                next_arg += 1
+            elif field.isdigit():
+                arg = int(field)
+            else:
+                raise ValueError(f"unsupported placeholder '{{{field}}}' in '{string}'")
+            segments.append((literal, arg))
+            literal = ""
+            i = end + 1
+        elif c == "}":
+            raise ValueError(f"unmatched '}}' in '{string}'")
+        else:
+            literal += c
+            i += 1
+    segments.append((literal, -1))
+    return segments
+
+
 def generate_all(data: Dict[str, Dict[str, str]]):
     validate_and_warn_missing_keys(data, default_lang_name)
 
@@ -297,10 +337,21 @@ def generate_translation_impl_header(
     # generate string table
     string_table_str = ""
     for string in string_table:
-        escaped_string = (
-            string.replace('"', '\\"').replace("\\", "\\\\").replace("\n", "\\n")
-        )
-        string_table_str += f'    "{escaped_string}",\n'
+        string_table_str += f'    "{escape_cpp_string(string)}",\n'
+
+    # generate format segment tables, every string split at its placeholders
+    segments_str = ""
+    segment_offsets_str = ""
+    segment_count = 0
+    max_arg_count = 0
+    for string in string_table:
+        segment_offsets_str += f"    {segment_count},\n"
+        for literal, arg in split_format_string(string):
+            arg_str = "kNoFormatArg" if arg < 0 else str(arg)
+            segments_str += f'    FormatSegment{{"{escape_cpp_string(literal)}", {arg_str}}},\n'
+            segment_count += 1
+            max_arg_count = max(max_arg_count, arg + 1)
+    segment_offsets_str += f"    {segment_count},\n"
 
     # generate translation tables (indices into string table)
     lang_tables_str = ""
@@ -356,6 +407,8 @@ def generate_translation_impl_header(
 #define I18N_BASE_DATA_TRANSLATION_IMPL_H_
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 #include "i18n/base/data/language_id.h"
 #include "i18n/base/data/translation_key.h"
@@ -366,6 +419,18 @@ namespace i18n {{
 constexpr std::array<const char*, {len(string_table)}> kStringTable = {{
 {string_table_str}}};
 
+// kStringTable split at placeholders. the segments of kStringTable[i] are
+// kFormatSegments[kFormatSegmentOffsets[i]] up to
+// kFormatSegments[kFormatSegmentOffsets[i + 1]]
+constexpr std::array<FormatSegment, {segment_count}> kFormatSegments = {{
+{segments_str}}};
+
+constexpr std::array<uint16_t, {len(string_table) + 1}> kFormatSegmentOffsets = {{
+{segment_offsets_str}}};
+
+// highest placeholder index in kStringTable plus one
+constexpr std::size_t kFormatArgSlotCount = {max_arg_count};
+
 // translation index tables (indices into kStringTable)
 {lang_tables_str}
 
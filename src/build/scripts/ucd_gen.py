@@ -56,7 +56,7 @@ def should_skip_generation(raw_files):
         with open(checksum_path, "r", encoding="utf-8") as f:
             saved_checksum = f.read().strip()
         current_cc_checksum = get_file_checksum(source_path)
-        current_raw_checksum = calculate_checksum(raw_files)
+        current_raw_checksum = calculate_checksum(raw_files + [__file__])
 
         return saved_checksum == f"{current_cc_checksum}\n{current_raw_checksum}"
     except (IOError, FileNotFoundError):
@@ -134,6 +134,58 @@ def compress_ranges(ranges):
     return compressed
 
 
+# must match kUnicodeBitmapBlockBits in unicode_data.h
+kBitmapBlockBits = 8
+kBitmapBlockSize = 1 << kBitmapBlockBits
+kMaxCodepoint = 0x10FFFF
+kBitmapIndexSize = (kMaxCodepoint + 1) >> kBitmapBlockBits
+
+
+def build_two_stage_bitmap(ranges):
+    """Split the codepoint space into 256-codepoint blocks, deduplicate the
+    block bitmaps and return (index, blocks)"""
+    bits = bytearray((kMaxCodepoint + 1) // 8)
+    for start, end in ranges:
+        for cp in range(start, end + 1):
+            bits[cp >> 3] |= 1 << (cp & 7)
+
+    block_bytes = kBitmapBlockSize // 8
+    index = []
+    blocks = []
+    block_ids = {}
+    for i in range(kBitmapIndexSize):
+        block = bytes(bits[i * block_bytes : (i + 1) * block_bytes])
+        if block not in block_ids:
+            block_ids[block] = len(blocks)
+            blocks.append(block)
+        index.append(block_ids[block])
+
+    if len(blocks) > 256:
+        raise RuntimeError(
+            f"{len(blocks)} unique bitmap blocks do not fit in an uint8_t index"
+        )
+    return index, blocks
+
+
+def emit_bitmap_tables(varname, ranges):
+    index, blocks = build_two_stage_bitmap(ranges)
+    lines = [f"constexpr uint8_t {varname}Index[kUnicodeBitmapIndexSize] = {{"]
+    for i in range(0, len(index), 16):
+        lines.append("  " + ", ".join(str(v) for v in index[i : i + 16]) + ",")
+    lines.append("};")
+    lines.append(f"constexpr UnicodeBitmapBlock {varname}Blocks[] = {{")
+    for block in blocks:
+        words = [
+            int.from_bytes(block[w * 8 : (w + 1) * 8], "little")
+            for w in range(len(block) // 8)
+        ]
+        lines.append(
+            "  {{ " + ", ".join(f"0x{word:016X}ull" for word in words) + " }},"
+        )
+    lines.append("};")
+    return "\n".join(lines)
+
+
 def emit_range_array(varname, ranges):
     lines = [f"constexpr UnicodeRange {varname}[] = {{"]
     for start, end in ranges:
@@ -170,6 +222,13 @@ namespace unicode {{
 // whitespace property
 {emit_range_array("kWhiteSpace", all_data["White_Space"])}
 
+// two-stage bitmaps for the properties checked per character while lexing
+{emit_bitmap_tables("kXIDStart", all_data["XID_Start"])}
+
+{emit_bitmap_tables("kXIDContinue", all_data["XID_Continue"])}
+
+{emit_bitmap_tables("kWhiteSpace", all_data["White_Space"])}
+
 // general categories
 {emit_range_array("kDecimalNumber", all_data["Nd"])}
 
@@ -231,7 +290,7 @@ def main():
     # save checksums after successful generation
     with open(checksum_path, "w", encoding="utf-8") as f:
         cc_checksum = get_file_checksum(source_path)
-        raw_checksum = calculate_checksum(raw_files)
+        raw_checksum = calculate_checksum(raw_files + [__file__])
         f.write(f"{cc_checksum}\n{raw_checksum}")
 
     print(
@@ -22,6 +22,7 @@
 #else
 #include <dirent.h>
 #include <errno.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
@@ -434,21 +435,11 @@ int rename_file(const char* old_path, const char* new_path) {
 #endif
 }
 
-int write_file(const char* path, const std::string& content) {
-#if IS_WINDOWS
-  int fd = _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
-                 _S_IREAD | _S_IWRITE);
-#else
-  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-#endif
-
-  if (fd < 0) {
-    glog.error_ref<"failed to open file for writing {} ({})\n">(
-        path, std::strerror(errno));
-    glog.flush();
-    return -1;
-  }
+namespace {
 
+// writes all of `content` to `fd` and closes it. fails if either the write or
+// the close fails, so a successful return means the file is complete.
+int write_and_close(int fd, const char* path, const std::string& content) {
   std::size_t total_written = 0;
   const char* data = content.data();
   std::size_t size = content.size();
@@ -460,6 +451,9 @@ int write_file(const char* path, const std::string& content) {
 #else
     ssize_t bytes = write(fd, data + total_written, size - total_written);
 #endif
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
     if (bytes <= 0) {
       glog.error_ref<"failed to write to the file {} ({})\n">(
           path, std::strerror(errno));
@@ -475,10 +469,57 @@ int write_file(const char* path, const std::string& content) {
   }
 
 #if IS_WINDOWS
-  _close(fd);
+  const int result = _close(fd);
 #else
-  close(fd);
+  const int result = close(fd);
 #endif
+  if (result != 0) {
+    glog.error_ref<"failed to close the file {} ({})\n">(path,
+                                                         std::strerror(errno));
+    glog.flush();
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+int write_file(const char* path, const std::string& content) {
+#if IS_WINDOWS
+  int fd = _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+#else
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+
+  if (fd < 0) {
+    glog.error_ref<"failed to open file for writing {} ({})\n">(
+        path, std::strerror(errno));
+    glog.flush();
+    return -1;
+  }
+  return write_and_close(fd, path, content);
+}
+
+int write_new_file(const char* path, const std::string& content) {
+#if IS_WINDOWS
+  int fd = _open(path, _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+#else
+  int fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+#endif
+
+  if (fd < 0) {
+    glog.error_ref<"failed to create the file {} ({})\n">(
+        path, std::strerror(errno));
+    glog.flush();
+    return -1;
+  }
+  if (write_and_close(fd, path, content) != 0) {
+    // the file was created by this call, so nobody else can be using it
+    remove_file(path);
+    return -1;
+  }
   return 0;
 }
 
@@ -783,6 +824,95 @@ TempDir::~TempDir() {
   }
 }
 
+MappedFile::MappedFile(const char* path) {
+#if IS_WINDOWS
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+
+  LARGE_INTEGER file_size;
+  if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size) ||
+      file_size.QuadPart <= 0) {
+    CloseHandle(file);
+    return;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    return;
+  }
+
+  // the view keeps the mapping object alive
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == nullptr) {
+    return;
+  }
+
+  data_ = static_cast<const char*>(view);
+  size_ = static_cast<std::size_t>(file_size.QuadPart);
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+    close(fd);
+    return;
+  }
+
+  const std::size_t size = static_cast<std::size_t>(st.st_size);
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return;
+  }
+
+  // sources are scanned front to back once, let the kernel read ahead
+  madvise(addr, size, MADV_SEQUENTIAL);
+
+  data_ = static_cast<const char*>(addr);
+  size_ = size;
+#endif
+}
+
+MappedFile::~MappedFile() {
+  unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+void MappedFile::unmap() {
+  if (data_ == nullptr) {
+    return;
+  }
+#if IS_WINDOWS
+  UnmapViewOfFile(data_);
+#else
+  munmap(const_cast<char*>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
 File::File(std::string&& file_name, std::string&& source)
     : file_name_(std::move(file_name)),
       source_(std::move(source)),
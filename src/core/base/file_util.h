@@ -50,6 +50,9 @@ CORE_EXPORT int remove_file(const char* path);
 CORE_EXPORT int remove_directory(const char* path);
 CORE_EXPORT int rename_file(const char* old_path, const char* new_path);
 CORE_EXPORT int write_file(const char* path, const std::string& content);
+// like write_file, but fails instead of truncating a file that already exists.
+// a partially written file is removed again.
+CORE_EXPORT int write_new_file(const char* path, const std::string& content);
 CORE_EXPORT int write_binary_to_file(const void* binary_data,
                                      std::size_t binary_size,
                                      const std::string& output_path);
@@ -169,6 +172,34 @@ class CORE_EXPORT TempDir {
   bool valid_ : 1 = true;
 };
 
+// read-only private mapping of a regular file. the content is served from the
+// page cache without a copy and shared with other processes mapping the same
+// file. valid() is false if the file can not be mapped (missing, empty, a pipe
+// or another non-regular file), callers fall back to read_file() then.
+class CORE_EXPORT MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(const char* path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  inline const char* data() const { return data_; }
+  inline std::size_t size() const { return size_; }
+  inline bool valid() const { return data_ != nullptr; }
+
+ private:
+  void unmap();
+
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
 class CORE_EXPORT File {
  public:
   File(std::string&& file_name, std::string&& source);
@@ -6,7 +6,9 @@
 
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "build/build_flag.h"
@@ -23,6 +25,33 @@ TEST(FileUtilTest, TempFileLifecycle) {
   EXPECT_EQ(content, "content");
 }
 
+TEST(FileUtilTest, MappedFileMatchesRead) {
+  TempFile file("test_mapped_", "line 1\nline 2\n");
+  ASSERT_TRUE(file.valid());
+
+  MappedFile mapped(file.path().c_str());
+  ASSERT_TRUE(mapped.valid());
+  EXPECT_EQ(std::string_view(mapped.data(), mapped.size()),
+            read_file(file.path().c_str()));
+
+  MappedFile moved = std::move(mapped);
+  EXPECT_FALSE(mapped.valid());
+  ASSERT_TRUE(moved.valid());
+  EXPECT_EQ(std::string_view(moved.data(), moved.size()), "line 1\nline 2\n");
+}
+
+TEST(FileUtilTest, MappedFileInvalidForEmptyOrMissing) {
+  TempFile empty("test_mapped_empty_");
+  ASSERT_TRUE(empty.valid());
+  EXPECT_FALSE(MappedFile(empty.path().c_str()).valid());
+
+  TempDir dir("test_mapped_dir_");
+  ASSERT_TRUE(dir.valid());
+  EXPECT_FALSE(MappedFile(dir.path().c_str()).valid());
+
+  EXPECT_FALSE(MappedFile("this/path/does/not/exist.ry").valid());
+}
+
 TEST(FileUtilTest, TempDirLifecycle) {
   TempDir dir("test_tmpdir_");
   ASSERT_TRUE(dir.valid());
@@ -38,6 +67,14 @@ TEST(FileUtilTest, WriteAndReadFile) {
   EXPECT_EQ(remove_file(temp.c_str()), 0);
 }
 
+TEST(FileUtilTest, WriteNewFileKeepsExistingFile) {
+  std::string temp = temp_path("fileutil_test_");
+  ASSERT_EQ(write_new_file(temp.c_str(), "first"), 0);
+  EXPECT_NE(write_new_file(temp.c_str(), "second"), 0);
+  EXPECT_EQ(read_file(temp.c_str()), "first");
+  EXPECT_EQ(remove_file(temp.c_str()), 0);
+}
+
 TEST(FileUtilTest, WriteBinaryToFile) {
   std::string temp = temp_path("bin_test_");
   std::vector<uint8_t> data = {1, 2, 3, 4, 5};
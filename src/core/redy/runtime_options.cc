@@ -29,6 +29,28 @@ std::string RuntimeOptions::to_string(std::size_t padding_size) {
 
   result.append("sub command: ").append(sub_command).push_back('\n');
 
+  result.append("jobs: ").append(std::to_string(jobs)).push_back('\n');
+
+  result.append("arena profile: ")
+      .append(arena_profile ? "true" : "false")
+      .push_back('\n');
+
+  if (!cache_dir.empty()) {
+    result.append("cache dir: ").append(cache_dir).push_back('\n');
+  }
+
+  result.append("diagnostic format: ")
+      .append(diagnostic_format)
+      .push_back('\n');
+
+  if (!input_files.empty()) {
+    result.append("input files:");
+    for (const std::string& file : input_files) {
+      result.append(pad).append("  ").append(file);
+    }
+    result.push_back('\n');
+  }
+
   return result;
 }
 
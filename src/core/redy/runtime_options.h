@@ -5,8 +5,10 @@
 #ifndef CORE_REDY_RUNTIME_OPTIONS_H_
 #define CORE_REDY_RUNTIME_OPTIONS_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/base/core_export.h"
 #include "core/base/logger.h"
@@ -39,6 +41,16 @@ struct CORE_EXPORT RuntimeOptions {
   std::string sub_command = "compile";
   bool verbose = false;
   BuildType build_type = BuildType::kDebug;
+  // frontend worker threads, 0 uses every hardware thread
+  uint32_t jobs = 0;
+  std::vector<std::string> input_files;
+  // pre-size frontend arenas from, and record into, the arena profile in the
+  // cache directory (".redy" when cache_dir is empty)
+  bool arena_profile = false;
+  // directory of the ast cache, empty disables it
+  std::string cache_dir;
+  // "classic" for people, "json" or "binary" for tools
+  std::string diagnostic_format = "classic";
 
  private:
   RuntimeOptions() = default;
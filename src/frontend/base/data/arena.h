@@ -5,44 +5,245 @@
 #ifndef FRONTEND_BASE_DATA_ARENA_H_
 #define FRONTEND_BASE_DATA_ARENA_H_
 
+#include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
 #include <utility>
-#include <vector>
 
+#include "core/check.h"
 #include "frontend/base/base_export.h"
+#include "frontend/base/data/region.h"
 
 namespace base {
 
+namespace detail {
+
+// blocks of about a page, at least 16 elements each
+template <typename T>
+inline constexpr std::size_t arena_block_bits() {
+  constexpr std::size_t kTargetBlockBytes = 4096;
+  constexpr std::size_t kElements =
+      sizeof(T) >= kTargetBlockBytes / 16 ? 16 : kTargetBlockBytes / sizeof(T);
+  return std::bit_width(kElements) - 1;
+}
+
+}  // namespace detail
+
 // arena allocation utility class for data oriented design
-// this is currently just a wrapper of std::vector, but it has some useful
-// helper methods
-template <typename T, typename Id = std::size_t>
+// elements live in fixed-size blocks, so appending never moves existing
+// elements and references to them stay valid until reset() or destruction.
+// an id maps to its element with a shift and a mask.
+//
+// blocks come from the heap, or from a Region when one is attached with
+// use_region(). region memory is released by the region, not the arena.
+template <typename T,
+          typename Id = std::size_t,
+          std::size_t kBlockBits = detail::arena_block_bits<T>()>
 class BASE_EXPORT Arena {
  public:
+  static constexpr std::size_t kBlockSize = std::size_t{1} << kBlockBits;
+  static constexpr std::size_t kBlockMask = kBlockSize - 1;
+
   Arena() = default;
-  ~Arena() = default;
+  explicit Arena(Region* region) : region_(region) {}
+  ~Arena() {
+    clear_elements();
+    release_blocks();
+  }
 
   Arena(const Arena&) = delete;
   Arena& operator=(const Arena&) = delete;
 
-  Arena(Arena&&) noexcept = default;
-  Arena& operator=(Arena&&) noexcept = default;
+  Arena(Arena&& other) noexcept { take(&other); }
+
+  Arena& operator=(Arena&& other) noexcept {
+    if (this != &other) {
+      clear_elements();
+      release_blocks();
+      take(&other);
+    }
+    return *this;
+  }
+
+  // allocates every later block and block table from `region`, which must
+  // outlive the arena. only valid before the first block is allocated.
+  inline void use_region(Region* region) {
+    DCHECK_EQ(block_count_, 0u);
+    region_ = region;
+  }
 
   Id alloc(T&& value) {
-    buffer_.emplace_back(std::move(value));
-    return static_cast<Id>(buffer_.size() - 1);
+    if (cursor_ == limit_) [[unlikely]] {
+      next_block();
+    }
+    std::construct_at(cursor_++, std::move(value));
+    return static_cast<Id>(size_++);
+  }
+
+  // copies `values` to the end of the arena, a block at a time
+  void append(std::span<const T> values)
+    requires std::is_trivially_copyable_v<T>
+  {
+    while (!values.empty()) {
+      if (cursor_ == limit_) {
+        next_block();
+      }
+      const std::size_t n = std::min<std::size_t>(
+          values.size(), static_cast<std::size_t>(limit_ - cursor_));
+      std::memcpy(cursor_, values.data(), n * sizeof(T));
+      cursor_ += n;
+      size_ += n;
+      values = values.subspan(n);
+    }
+  }
+
+  // calls f(std::span<const T>) for the used part of every block, in id order
+  template <typename F>
+  void for_each_block(F&& f) const {
+    for (std::size_t begin = 0; begin < size_; begin += kBlockSize) {
+      f(std::span<const T>(blocks_[begin >> kBlockBits],
+                           std::min(kBlockSize, size_ - begin)));
+    }
+  }
+
+  // destroys every element but keeps the blocks for reuse
+  inline void reset() { clear_elements(); }
+
+  inline void reserve(std::size_t n) {
+    while (capacity() < n) {
+      add_block();
+    }
   }
 
-  inline constexpr const std::vector<T>& buffer() const { return buffer_; }
-  inline constexpr void reserve(std::size_t n) { buffer_.reserve(n); }
-  inline constexpr void resize(std::size_t n) { buffer_.resize(n); }
-  inline constexpr std::size_t size() const { return buffer_.size(); }
+  inline void resize(std::size_t n) {
+    reserve(n);
+    while (size_ < n) {
+      std::construct_at(slot(size_));
+      ++size_;
+    }
+    while (size_ > n) {
+      std::destroy_at(slot(--size_));
+    }
+    sync_cursor();
+  }
 
-  inline constexpr T& operator[](Id id) { return buffer_[id]; }
-  inline constexpr const T& operator[](Id id) const { return buffer_[id]; }
+  inline constexpr std::size_t size() const { return size_; }
+  inline constexpr bool empty() const { return size_ == 0; }
+  inline constexpr std::size_t capacity() const {
+    return block_count_ * kBlockSize;
+  }
+
+  inline T& operator[](Id id) { return *slot(static_cast<std::size_t>(id)); }
+  inline const T& operator[](Id id) const {
+    return *slot(static_cast<std::size_t>(id));
+  }
 
  private:
-  std::vector<T> buffer_;
+  inline T* slot(std::size_t index) const {
+    return blocks_[index >> kBlockBits] + (index & kBlockMask);
+  }
+
+  // moves the bump cursor to the block holding index size_, reusing a block
+  // kept by reset() or reserve() before allocating a new one
+  void next_block() {
+    if ((size_ >> kBlockBits) == block_count_) {
+      add_block();
+    }
+    sync_cursor();
+  }
+
+  void sync_cursor() {
+    const std::size_t block = size_ >> kBlockBits;
+    if (block == block_count_) {
+      cursor_ = limit_ = nullptr;
+      return;
+    }
+    cursor_ = blocks_[block] + (size_ & kBlockMask);
+    limit_ = blocks_[block] + kBlockSize;
+  }
+
+  void add_block() {
+    if (block_count_ == table_capacity_) {
+      grow_table();
+    }
+    blocks_[block_count_++] =
+        static_cast<T*>(allocate(kBlockSize * sizeof(T), alignof(T)));
+  }
+
+  // the block table is a plain array so a region-backed arena makes no heap
+  // allocation at all
+  void grow_table() {
+    const std::size_t capacity = std::max<std::size_t>(table_capacity_ * 2, 4);
+    T** table = static_cast<T**>(allocate(capacity * sizeof(T*), alignof(T*)));
+    if (block_count_ != 0) {
+      std::memcpy(table, blocks_, block_count_ * sizeof(T*));
+    }
+    if (!region_) {
+      deallocate(blocks_, alignof(T*));
+    }
+    blocks_ = table;
+    table_capacity_ = capacity;
+  }
+
+  void* allocate(std::size_t bytes, std::size_t alignment) {
+    if (region_) {
+      return region_->allocate(bytes, alignment);
+    }
+    return ::operator new(bytes, std::align_val_t{alignment});
+  }
+
+  static void deallocate(void* p, std::size_t alignment) {
+    if (p) {
+      ::operator delete(p, std::align_val_t{alignment});
+    }
+  }
+
+  void clear_elements() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (std::size_t i = 0; i < size_; ++i) {
+        std::destroy_at(slot(i));
+      }
+    }
+    size_ = 0;
+    sync_cursor();
+  }
+
+  void release_blocks() {
+    if (!region_) {
+      for (std::size_t i = 0; i < block_count_; ++i) {
+        deallocate(blocks_[i], alignof(T));
+      }
+      deallocate(blocks_, alignof(T*));
+    }
+    blocks_ = nullptr;
+    block_count_ = 0;
+    table_capacity_ = 0;
+    cursor_ = limit_ = nullptr;
+  }
+
+  void take(Arena* other) {
+    region_ = other->region_;
+    blocks_ = std::exchange(other->blocks_, nullptr);
+    block_count_ = std::exchange(other->block_count_, 0);
+    table_capacity_ = std::exchange(other->table_capacity_, 0);
+    size_ = std::exchange(other->size_, 0);
+    cursor_ = std::exchange(other->cursor_, nullptr);
+    limit_ = std::exchange(other->limit_, nullptr);
+  }
+
+  Region* region_ = nullptr;
+  T** blocks_ = nullptr;
+  std::size_t block_count_ = 0;
+  std::size_t table_capacity_ = 0;
+  std::size_t size_ = 0;
+  // bump range inside the block that receives the next element
+  T* cursor_ = nullptr;
+  T* limit_ = nullptr;
 };
 
 }  // namespace base
@@ -0,0 +1,162 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "frontend/base/data/arena.h"
+#include "frontend/base/data/region.h"
+
+namespace base {
+
+namespace {
+
+// the previous vector-backed arena, kept here as the baseline
+template <typename T>
+class VectorArena {
+ public:
+  std::size_t alloc(T&& value) {
+    data_.emplace_back(std::move(value));
+    return data_.size() - 1;
+  }
+  inline void reserve(std::size_t n) { data_.reserve(n); }
+  inline void reset() { data_.clear(); }
+  inline T& operator[](std::size_t id) { return data_[id]; }
+
+ private:
+  std::vector<T> data_;
+};
+
+// shaped like ast::Node and a typical expression payload
+struct Node {
+  uint32_t payload_id;
+  uint8_t kind;
+};
+
+struct Payload {
+  uint32_t lhs;
+  uint32_t rhs;
+  uint32_t op;
+  uint32_t begin;
+  uint32_t end;
+};
+
+// parser-like allocation pattern: every node gets a payload and links back
+// to an earlier node
+template <typename NodeArena, typename PayloadArena>
+void build_ast(NodeArena* nodes, PayloadArena* payloads, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const uint32_t id = static_cast<uint32_t>(i);
+    const std::size_t p = payloads->alloc(Payload{
+        .lhs = id / 2, .rhs = id / 3, .op = id & 7, .begin = id, .end = id});
+    nodes->alloc(Node{.payload_id = static_cast<uint32_t>(p),
+                      .kind = static_cast<uint8_t>(id)});
+    if (i > 0) {
+      benchmark::DoNotOptimize((*payloads)[(*nodes)[i / 2].payload_id].lhs);
+    }
+  }
+}
+
+void arena_vector_build(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    VectorArena<Node> nodes;
+    VectorArena<Payload> payloads;
+    nodes.reserve(512);
+    payloads.reserve(256);
+    build_ast(&nodes, &payloads, count);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(count * state.iterations());
+}
+BENCHMARK(arena_vector_build)->RangeMultiplier(8)->Range(512, 1 << 18);
+
+void arena_chunked_build(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    Arena<Node> nodes;
+    Arena<Payload> payloads;
+    nodes.reserve(512);
+    payloads.reserve(256);
+    build_ast(&nodes, &payloads, count);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(count * state.iterations());
+}
+BENCHMARK(arena_chunked_build)->RangeMultiplier(8)->Range(512, 1 << 18);
+
+// one arena reused across compilations, as a long-running driver would
+void arena_vector_rebuild(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  VectorArena<Node> nodes;
+  VectorArena<Payload> payloads;
+  for (auto _ : state) {
+    nodes.reset();
+    payloads.reset();
+    build_ast(&nodes, &payloads, count);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(count * state.iterations());
+}
+BENCHMARK(arena_vector_rebuild)->RangeMultiplier(8)->Range(512, 1 << 18);
+
+void arena_chunked_rebuild(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  Arena<Node> nodes;
+  Arena<Payload> payloads;
+  for (auto _ : state) {
+    nodes.reset();
+    payloads.reset();
+    build_ast(&nodes, &payloads, count);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(count * state.iterations());
+}
+BENCHMARK(arena_chunked_rebuild)->RangeMultiplier(8)->Range(512, 1 << 18);
+
+// a context per small file: many arenas with a few elements each, created
+// and torn down together
+constexpr std::size_t kContextArenas = 48;
+constexpr std::size_t kSmallFileElements = 8;
+
+template <typename Arenas>
+void fill_small_file(Arenas* arenas) {
+  for (auto& arena : *arenas) {
+    for (uint32_t i = 0; i < kSmallFileElements; ++i) {
+      arena.alloc(Payload{.lhs = i, .rhs = i, .op = i, .begin = i, .end = i});
+    }
+  }
+}
+
+void arena_heap_small_contexts(benchmark::State& state) {
+  for (auto _ : state) {
+    std::array<Arena<Payload>, kContextArenas> arenas;
+    fill_small_file(&arenas);
+    benchmark::DoNotOptimize(arenas.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(arena_heap_small_contexts);
+
+void arena_region_small_contexts(benchmark::State& state) {
+  for (auto _ : state) {
+    Region region;
+    std::array<Arena<Payload>, kContextArenas> arenas;
+    for (auto& arena : arenas) {
+      arena.use_region(&region);
+    }
+    fill_small_file(&arenas);
+    benchmark::DoNotOptimize(arenas.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(arena_region_small_contexts);
+
+}  // namespace
+
+}  // namespace base
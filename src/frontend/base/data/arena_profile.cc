@@ -0,0 +1,117 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/base/data/arena_profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "core/base/file_util.h"
+
+namespace base {
+
+namespace {
+
+constexpr std::string_view kHeader = "# redy arena profile v2";
+
+}  // namespace
+
+void ArenaProfile::record(std::string_view name,
+                          std::size_t elements,
+                          std::size_t units) {
+  auto it = usages_.find(name);
+  if (it == usages_.end()) {
+    it = usages_.emplace(std::string(name), Usage{}).first;
+  }
+  Usage& usage = it->second;
+  if (usage.units > kHistoryUnits) {
+    const double scale = kHistoryUnits / usage.units;
+    usage.elements *= scale;
+    usage.units = kHistoryUnits;
+  }
+  usage.elements += static_cast<double>(elements);
+  // an empty input counts as a single unit
+  usage.units += static_cast<double>(std::max<std::size_t>(units, 1));
+}
+
+std::size_t ArenaProfile::estimate(std::string_view name,
+                                   std::size_t units) const {
+  auto it = usages_.find(name);
+  if (it == usages_.end() || it->second.units <= 0.0) {
+    return 0;
+  }
+  const double ratio = it->second.elements / it->second.units;
+  return static_cast<std::size_t>(
+      std::ceil(ratio * static_cast<double>(units)));
+}
+
+bool ArenaProfile::load(const std::string& path) {
+  if (!core::file_exists(path.c_str())) {
+    return false;
+  }
+  const std::string content = core::read_file(path.c_str());
+  std::string_view rest = content;
+
+  std::map<std::string, Usage, std::less<>> usages;
+  bool header = true;
+  while (!rest.empty()) {
+    const std::size_t eol = rest.find('\n');
+    std::string_view line = rest.substr(0, eol);
+    rest = eol == std::string_view::npos ? "" : rest.substr(eol + 1);
+
+    if (header) {
+      if (line != kHeader) {
+        return false;
+      }
+      header = false;
+      continue;
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    const std::size_t space = line.find(' ');
+    if (space == std::string_view::npos || space == 0) {
+      return false;
+    }
+    const std::string values(line.substr(space + 1));
+    char* end = nullptr;
+    Usage usage;
+    usage.elements = std::strtod(values.c_str(), &end);
+    if (end == values.c_str() || *end != ' ') {
+      return false;
+    }
+    const char* units_begin = end + 1;
+    usage.units = std::strtod(units_begin, &end);
+    if (end == units_begin || end != values.c_str() + values.size() ||
+        !(usage.elements >= 0.0) || !(usage.units >= 0.0)) {
+      return false;
+    }
+    usages.emplace(std::string(line.substr(0, space)), usage);
+  }
+  if (header) {
+    return false;
+  }
+
+  usages_ = std::move(usages);
+  return true;
+}
+
+bool ArenaProfile::save(const std::string& path) const {
+  std::string content(kHeader);
+  content += '\n';
+  for (const auto& [name, usage] : usages_) {
+    content += std::format("{} {:.3f} {:.3f}\n", name, usage.elements,
+                           usage.units);
+  }
+  return core::write_file(path.c_str(), content) == 0;
+}
+
+}  // namespace base
@@ -0,0 +1,68 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_BASE_DATA_ARENA_PROFILE_H_
+#define FRONTEND_BASE_DATA_ARENA_PROFILE_H_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "frontend/base/base_export.h"
+
+namespace base {
+
+// per-arena usage from earlier compilations, used to pre-size the arenas of the
+// next one.
+//
+// counts are normalized by a size unit of the input (source lines for the ast,
+// ast nodes for the hir), so one profile fits both tiny files and large
+// modules. an arena's estimate is the total of its recorded elements over the
+// total of its units, so one unusually dense file does not inflate every later
+// reservation. once the units of an arena pass kHistoryUnits both totals are
+// scaled down, letting old compilations fade out.
+class BASE_EXPORT ArenaProfile {
+ public:
+  static constexpr const char* kFileName = "arena_profile.txt";
+  static constexpr double kHistoryUnits = 1 << 20;
+
+  ArenaProfile() = default;
+  ~ArenaProfile() = default;
+
+  ArenaProfile(const ArenaProfile&) = default;
+  ArenaProfile& operator=(const ArenaProfile&) = default;
+
+  ArenaProfile(ArenaProfile&&) noexcept = default;
+  ArenaProfile& operator=(ArenaProfile&&) noexcept = default;
+
+  // records that arena `name` held `elements` for an input of `units`
+  void record(std::string_view name, std::size_t elements, std::size_t units);
+
+  // elements to reserve for arena `name` on an input of `units`, 0 if the
+  // arena was never recorded
+  std::size_t estimate(std::string_view name, std::size_t units) const;
+
+  // text format, one "<name> <elements> <units>" line per arena. load()
+  // returns false if the file is missing or malformed, leaving the profile
+  // unchanged.
+  bool load(const std::string& path);
+  bool save(const std::string& path) const;
+
+  inline bool empty() const { return usages_.empty(); }
+  inline std::size_t size() const { return usages_.size(); }
+
+ private:
+  struct Usage {
+    double elements = 0.0;
+    double units = 0.0;
+  };
+
+  std::map<std::string, Usage, std::less<>> usages_;
+};
+
+}  // namespace base
+
+#endif  // FRONTEND_BASE_DATA_ARENA_PROFILE_H_
@@ -0,0 +1,93 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/base/data/arena_profile.h"
+
+#include <string>
+
+#include "core/base/file_util.h"
+#include "gtest/gtest.h"
+
+namespace base {
+
+TEST(ArenaProfileTest, EstimatesScaleWithUnits) {
+  ArenaProfile profile;
+  profile.record("ast.nodes", 400, 100);
+
+  EXPECT_EQ(profile.estimate("ast.nodes", 100), 400u);
+  EXPECT_EQ(profile.estimate("ast.nodes", 10), 40u);
+  EXPECT_EQ(profile.estimate("ast.nodes", 3), 12u);
+  EXPECT_EQ(profile.estimate("ast.unknown", 100), 0u);
+}
+
+TEST(ArenaProfileTest, AveragesOverRecordedUnits) {
+  ArenaProfile profile;
+  profile.record("ast.nodes", 400, 100);
+  profile.record("ast.nodes", 100, 100);
+  EXPECT_EQ(profile.estimate("ast.nodes", 100), 250u);
+
+  // a small dense input barely moves the estimate
+  profile.record("ast.nodes", 50, 10);
+  EXPECT_EQ(profile.estimate("ast.nodes", 210), 550u);
+
+  // an empty input counts as a single unit
+  profile.record("hir.nodes", 7, 0);
+  EXPECT_EQ(profile.estimate("hir.nodes", 1), 7u);
+}
+
+TEST(ArenaProfileTest, OldHistoryFadesOut) {
+  constexpr auto kUnits = static_cast<std::size_t>(ArenaProfile::kHistoryUnits);
+  ArenaProfile profile;
+  profile.record("ast.nodes", 8 * kUnits, kUnits);
+  EXPECT_EQ(profile.estimate("ast.nodes", 1), 8u);
+
+  for (int i = 0; i < 64; ++i) {
+    profile.record("ast.nodes", 2 * kUnits, kUnits);
+  }
+  EXPECT_EQ(profile.estimate("ast.nodes", 1), 2u);
+}
+
+TEST(ArenaProfileTest, RoundTripsThroughFile) {
+  core::TempDir dir("arena_profile_");
+  ASSERT_TRUE(dir.valid());
+  const std::string path =
+      core::join_path(dir.path(), ArenaProfile::kFileName);
+
+  ArenaProfile profile;
+  profile.record("ast.nodes", 1234, 100);
+  profile.record("hir.call_expression_payloads", 1, 3);
+  ASSERT_TRUE(profile.save(path));
+
+  ArenaProfile loaded;
+  ASSERT_TRUE(loaded.load(path));
+  EXPECT_EQ(loaded.size(), 2u);
+  EXPECT_EQ(loaded.estimate("ast.nodes", 100), 1234u);
+  EXPECT_EQ(loaded.estimate("hir.call_expression_payloads", 3000), 1000u);
+}
+
+TEST(ArenaProfileTest, RejectsMissingAndMalformedFiles) {
+  ArenaProfile profile;
+  profile.record("ast.nodes", 4, 1);
+
+  EXPECT_FALSE(profile.load("/nonexistent/arena_profile.txt"));
+
+  core::TempFile no_header("arena_profile_", "ast.nodes 2.0\n");
+  EXPECT_FALSE(profile.load(no_header.path()));
+
+  core::TempFile old_version("arena_profile_",
+                             "# redy arena profile v1\nast.nodes 2.0\n");
+  EXPECT_FALSE(profile.load(old_version.path()));
+
+  core::TempFile bad_value("arena_profile_",
+                           "# redy arena profile v2\nast.nodes many 1\n");
+  EXPECT_FALSE(profile.load(bad_value.path()));
+
+  core::TempFile no_units("arena_profile_",
+                          "# redy arena profile v2\nast.nodes 2.0\n");
+  EXPECT_FALSE(profile.load(no_units.path()));
+
+  EXPECT_EQ(profile.estimate("ast.nodes", 1), 4u);
+}
+
+}  // namespace base
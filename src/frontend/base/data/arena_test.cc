@@ -0,0 +1,136 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/base/data/arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "frontend/base/data/region.h"
+#include "gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+struct Item {
+  uint32_t value = 0;
+  uint32_t extra = 0;
+};
+
+using SmallArena = Arena<Item, uint32_t, 2>;
+
+}  // namespace
+
+TEST(ArenaTest, AllocReturnsSequentialIds) {
+  SmallArena arena;
+  for (uint32_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(arena.alloc(Item{.value = i}), i);
+  }
+  EXPECT_EQ(arena.size(), 10u);
+  for (uint32_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(arena[i].value, i);
+  }
+}
+
+TEST(ArenaTest, AddressesStayStableAcrossGrowth) {
+  SmallArena arena;
+  std::vector<const Item*> addresses;
+  for (uint32_t i = 0; i < 100; ++i) {
+    addresses.push_back(&arena[arena.alloc(Item{.value = i})]);
+  }
+  for (uint32_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(&arena[i], addresses[i]);
+    EXPECT_EQ(addresses[i]->value, i);
+  }
+}
+
+TEST(ArenaTest, ResetKeepsBlocks) {
+  SmallArena arena;
+  for (uint32_t i = 0; i < 20; ++i) {
+    arena.alloc(Item{.value = i});
+  }
+  const std::size_t capacity = arena.capacity();
+  const Item* first = &arena[0];
+
+  arena.reset();
+  EXPECT_TRUE(arena.empty());
+  EXPECT_EQ(arena.capacity(), capacity);
+
+  EXPECT_EQ(arena.alloc(Item{.value = 42}), 0u);
+  EXPECT_EQ(&arena[0], first);
+  EXPECT_EQ(arena[0].value, 42u);
+}
+
+TEST(ArenaTest, ReserveAndResize) {
+  SmallArena arena;
+  arena.reserve(9);
+  EXPECT_GE(arena.capacity(), 9u);
+  EXPECT_EQ(arena.size(), 0u);
+
+  arena.resize(6);
+  EXPECT_EQ(arena.size(), 6u);
+  EXPECT_EQ(arena[5].value, 0u);
+
+  arena.resize(2);
+  EXPECT_EQ(arena.size(), 2u);
+  EXPECT_EQ(arena.alloc(Item{.value = 7}), 2u);
+}
+
+TEST(ArenaTest, DestroysNonTrivialElements) {
+  auto counter = std::make_shared<int>(0);
+  {
+    Arena<std::shared_ptr<int>, uint32_t, 2> arena;
+    for (int i = 0; i < 10; ++i) {
+      arena.alloc(std::shared_ptr<int>(counter));
+    }
+    EXPECT_EQ(counter.use_count(), 11);
+
+    arena.reset();
+    EXPECT_EQ(counter.use_count(), 1);
+
+    arena.alloc(std::shared_ptr<int>(counter));
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(ArenaTest, MoveTransfersElements) {
+  Arena<std::string, uint32_t, 2> arena;
+  arena.alloc("first");
+  arena.alloc("second");
+  const std::string* second = &arena[1];
+
+  Arena<std::string, uint32_t, 2> moved = std::move(arena);
+  EXPECT_EQ(moved.size(), 2u);
+  EXPECT_EQ(&moved[1], second);
+  EXPECT_EQ(moved[0], "first");
+  EXPECT_EQ(arena.size(), 0u);  // NOLINT
+}
+
+TEST(ArenaTest, RegionBackedArenasShareChunks) {
+  Region region;
+  SmallArena first(&region);
+  Arena<std::string, uint32_t, 2> second;
+  second.use_region(&region);
+
+  for (uint32_t i = 0; i < 100; ++i) {
+    first.alloc(Item{.value = i});
+    second.alloc(std::to_string(i));
+  }
+  for (uint32_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(first[i].value, i);
+    EXPECT_EQ(second[i], std::to_string(i));
+  }
+  EXPECT_EQ(region.chunk_count(), 1u);
+
+  second.reset();
+  EXPECT_EQ(second.alloc("reused"), 0u);
+  EXPECT_EQ(region.chunk_count(), 1u);
+}
+
+}  // namespace base
@@ -0,0 +1,86 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/base/data/region.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "core/check.h"
+
+namespace base {
+
+namespace {
+
+// chunk headers are padded so the payload keeps the maximum alignment
+constexpr std::size_t kHeaderSize = alignof(std::max_align_t) * 2;
+
+inline char* align_up(char* p, std::size_t alignment) {
+  const auto addr = reinterpret_cast<std::uintptr_t>(p);
+  return reinterpret_cast<char*>((addr + alignment - 1) & ~(alignment - 1));
+}
+
+}  // namespace
+
+Region::Region(std::size_t chunk_size) : chunk_size_(chunk_size) {
+  DCHECK_GT(chunk_size_, kHeaderSize);
+}
+
+Region::~Region() {
+  Chunk* chunk = head_;
+  while (chunk) {
+    Chunk* next = chunk->next;
+    ::operator delete(chunk);
+    chunk = next;
+  }
+}
+
+void* Region::allocate(std::size_t size, std::size_t alignment) {
+  DCHECK(std::has_single_bit(alignment));
+  DCHECK_LE(alignment, alignof(std::max_align_t));
+
+  if (cursor_ != nullptr) [[likely]] {
+    char* p = align_up(cursor_, alignment);
+    if (p <= limit_ && size <= static_cast<std::size_t>(limit_ - p)) {
+      cursor_ = p + size;
+      return p;
+    }
+  }
+
+  // large requests get a chunk of their own, linked behind the current one so
+  // the space left in it is not lost
+  const std::size_t payload_size = chunk_size_ - kHeaderSize;
+  if (size > payload_size / 4) {
+    Chunk* chunk = new_chunk(size);
+    if (head_) {
+      chunk->next = head_->next;
+      head_->next = chunk;
+    } else {
+      chunk->next = nullptr;
+      head_ = chunk;
+    }
+    return reinterpret_cast<char*>(chunk) + kHeaderSize;
+  }
+
+  Chunk* chunk = new_chunk(payload_size);
+  chunk->next = head_;
+  head_ = chunk;
+  char* p = reinterpret_cast<char*>(chunk) + kHeaderSize;
+  cursor_ = p + size;
+  limit_ = p + payload_size;
+  return p;
+}
+
+Region::Chunk* Region::new_chunk(std::size_t payload_size) {
+  const std::size_t total = kHeaderSize + payload_size;
+  Chunk* chunk = static_cast<Chunk*>(::operator new(total));
+  chunk->size = total;
+  bytes_reserved_ += total;
+  ++chunk_count_;
+  return chunk;
+}
+
+}  // namespace base
@@ -0,0 +1,61 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_BASE_DATA_REGION_H_
+#define FRONTEND_BASE_DATA_REGION_H_
+
+#include <cstddef>
+
+#include "frontend/base/base_export.h"
+
+namespace base {
+
+// bump allocator over a list of chunks, all released at once when the region
+// is destroyed. used as the backing store of the arenas in a context, so a
+// small file costs a single chunk allocation instead of one per arena.
+//
+// regions are neither copyable nor movable since arenas keep a pointer to
+// the region they allocate from.
+class BASE_EXPORT Region {
+ public:
+  static constexpr std::size_t kDefaultChunkSize = 64 * 1024;
+
+  explicit Region(std::size_t chunk_size = kDefaultChunkSize);
+  ~Region();
+
+  Region(const Region&) = delete;
+  Region& operator=(const Region&) = delete;
+
+  Region(Region&&) = delete;
+  Region& operator=(Region&&) = delete;
+
+  // returns `size` bytes aligned to `alignment`, which must be a power of two
+  // no larger than alignof(std::max_align_t). the memory lives until the
+  // region is destroyed.
+  void* allocate(std::size_t size, std::size_t alignment);
+
+  // total bytes obtained from the system, including chunk headers
+  inline std::size_t bytes_reserved() const { return bytes_reserved_; }
+  inline std::size_t chunk_count() const { return chunk_count_; }
+
+ private:
+  struct Chunk {
+    Chunk* next;
+    std::size_t size;
+  };
+
+  Chunk* new_chunk(std::size_t payload_size);
+
+  std::size_t chunk_size_;
+  // the chunk being bumped is always the head of the list
+  Chunk* head_ = nullptr;
+  char* cursor_ = nullptr;
+  char* limit_ = nullptr;
+  std::size_t bytes_reserved_ = 0;
+  std::size_t chunk_count_ = 0;
+};
+
+}  // namespace base
+
+#endif  // FRONTEND_BASE_DATA_REGION_H_
@@ -0,0 +1,52 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/base/data/region.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <set>
+
+#include "gtest/gtest.h"
+
+namespace base {
+
+TEST(RegionTest, AllocationsAreAlignedAndDisjoint) {
+  Region region(1024);
+  std::set<std::uintptr_t> seen;
+  for (std::size_t i = 0; i < 200; ++i) {
+    const std::size_t alignment = std::size_t{1} << (i % 4);
+    void* p = region.allocate(24, alignment);
+    const auto addr = reinterpret_cast<std::uintptr_t>(p);
+    EXPECT_EQ(addr % alignment, 0u);
+    EXPECT_TRUE(seen.insert(addr).second);
+    std::memset(p, static_cast<int>(i), 24);
+  }
+  EXPECT_GT(region.chunk_count(), 1u);
+}
+
+TEST(RegionTest, SmallAllocationsShareAChunk) {
+  Region region;
+  for (int i = 0; i < 64; ++i) {
+    region.allocate(64, alignof(std::max_align_t));
+  }
+  EXPECT_EQ(region.chunk_count(), 1u);
+}
+
+TEST(RegionTest, LargeAllocationsKeepTheCurrentChunk) {
+  Region region(1024);
+  char* first = static_cast<char*>(region.allocate(16, 1));
+  void* large = region.allocate(4096, 8);
+  ASSERT_NE(large, nullptr);
+  std::memset(large, 0, 4096);
+  EXPECT_EQ(region.chunk_count(), 2u);
+
+  // the next small allocation still bumps the first chunk
+  char* second = static_cast<char*>(region.allocate(16, 1));
+  EXPECT_EQ(second, first + 16);
+  EXPECT_EQ(region.chunk_count(), 2u);
+}
+
+}  // namespace base
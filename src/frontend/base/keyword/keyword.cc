@@ -5,150 +5,180 @@
 #include "frontend/base/keyword/keyword.h"
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <string>
 #include <string_view>
 
-#include "frontend/base/token/token.h"
 #include "frontend/base/token/token_kind.h"
 
 namespace base {
 
-TokenKind lookup_id_or_keyword(std::u8string_view word) {
-  switch (word.length()) {
-    case 2:
-      if (word == u8"i8") {
-        return TokenKind::kI8;
-      } else if (word == u8"u8") {
-        return TokenKind::kU8;
-      } else if (word == u8"if") {
-        return TokenKind::kIf;
-      } else if (word == u8"fn") {
-        return TokenKind::kFunction;
-      } else if (word == u8"as") {
-        return TokenKind::kAs;
-      } else {
+namespace {
+
+struct Keyword {
+  std::u8string_view word;
+  TokenKind kind;
+};
+
+constexpr const std::array kKeywords = {
+    Keyword{u8"i8", TokenKind::kI8},
+    Keyword{u8"u8", TokenKind::kU8},
+    Keyword{u8"if", TokenKind::kIf},
+    Keyword{u8"fn", TokenKind::kFunction},
+    Keyword{u8"as", TokenKind::kAs},
+    Keyword{u8"i16", TokenKind::kI16},
+    Keyword{u8"i32", TokenKind::kI32},
+    Keyword{u8"i64", TokenKind::kI64},
+    Keyword{u8"u16", TokenKind::kU16},
+    Keyword{u8"u32", TokenKind::kU32},
+    Keyword{u8"u64", TokenKind::kU64},
+    Keyword{u8"f32", TokenKind::kF32},
+    Keyword{u8"f64", TokenKind::kF64},
+    Keyword{u8"str", TokenKind::kStr},
+    Keyword{u8"for", TokenKind::kFor},
+    Keyword{u8"ret", TokenKind::kReturn},
+    Keyword{u8"mut", TokenKind::kMutable},
+    Keyword{u8"pub", TokenKind::kPublic},
+    Keyword{u8"use", TokenKind::kUse},
+    Keyword{u8"i128", TokenKind::kI128},
+    Keyword{u8"u128", TokenKind::kU128},
+    Keyword{u8"void", TokenKind::kVoid},
+    Keyword{u8"byte", TokenKind::kByte},
+    Keyword{u8"bool", TokenKind::kBool},
+    Keyword{u8"char", TokenKind::kChar},
+    Keyword{u8"else", TokenKind::kElse},
+    Keyword{u8"loop", TokenKind::kLoop},
+    Keyword{u8"enum", TokenKind::kEnumeration},
+    Keyword{u8"impl", TokenKind::kImplementation},
+    Keyword{u8"fast", TokenKind::kFast},
+    Keyword{u8"this", TokenKind::kThis},
+    Keyword{u8"true", TokenKind::kTrue},
+    Keyword{u8"isize", TokenKind::kIsize},
+    Keyword{u8"usize", TokenKind::kUsize},
+    Keyword{u8"while", TokenKind::kWhile},
+    Keyword{u8"break", TokenKind::kBreak},
+    Keyword{u8"match", TokenKind::kMatch},
+    Keyword{u8"trait", TokenKind::kTrait},
+    Keyword{u8"union", TokenKind::kUnion},
+    Keyword{u8"const", TokenKind::kConstant},
+    Keyword{u8"async", TokenKind::kAsync},
+    Keyword{u8"await", TokenKind::kAwait},
+    Keyword{u8"false", TokenKind::kFalse},
+    Keyword{u8"struct", TokenKind::kStruct},
+    Keyword{u8"module", TokenKind::kModule},
+    Keyword{u8"unsafe", TokenKind::kUnsafe},
+    Keyword{u8"extern", TokenKind::kExtern},
+    Keyword{u8"static", TokenKind::kStatic},
+    Keyword{u8"continue", TokenKind::kContinue},
+    Keyword{u8"redirect", TokenKind::kRedirect},
+    Keyword{u8"thread_local", TokenKind::kThreadLocal},
+};
+
+constexpr std::size_t min_keyword_length() {
+  std::size_t result = kKeywords[0].word.size();
+  for (const Keyword& keyword : kKeywords) {
+    result = keyword.word.size() < result ? keyword.word.size() : result;
+  }
+  return result;
+}
+
+constexpr std::size_t max_keyword_length() {
+  std::size_t result = 0;
+  for (const Keyword& keyword : kKeywords) {
+    result = keyword.word.size() > result ? keyword.word.size() : result;
+  }
+  return result;
+}
+
+constexpr const std::size_t kMinKeywordLength = min_keyword_length();
+constexpr const std::size_t kMaxKeywordLength = max_keyword_length();
+
+// pack() reads the first two and the last two bytes
+static_assert(kMinKeywordLength >= 2);
+
+constexpr const uint32_t kSlotBits = 8;
+constexpr const std::size_t kSlotCount = std::size_t{1} << kSlotBits;
+
+static_assert(kKeywords.size() < kSlotCount);
+
+// the first two bytes, the last two bytes and the length identify every
+// keyword uniquely
+constexpr uint64_t pack(std::u8string_view word) {
+  const std::size_t n = word.size();
+  return static_cast<uint64_t>(word[0]) |
+         static_cast<uint64_t>(word[1]) << 8 |
+         static_cast<uint64_t>(word[n - 2]) << 16 |
+         static_cast<uint64_t>(word[n - 1]) << 24 |
+         static_cast<uint64_t>(n) << 32;
+}
+
+constexpr uint32_t slot_of(std::u8string_view word, uint64_t multiplier) {
+  return static_cast<uint32_t>((pack(word) * multiplier) >> (64 - kSlotBits));
+}
+
+// splitmix64, forced odd
+constexpr uint64_t candidate_multiplier(uint64_t attempt) {
+  uint64_t z = attempt * 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return (z ^ (z >> 31)) | 1;
+}
+
+// searches a multiplier that maps every keyword to its own slot. slots are
+// stamped with the attempt number so the table never has to be cleared.
+constexpr uint64_t find_perfect_multiplier() {
+  std::array<uint32_t, kSlotCount> stamps{};
+  for (uint32_t attempt = 1;; ++attempt) {
+    const uint64_t multiplier = candidate_multiplier(attempt);
+    bool perfect = true;
+    for (const Keyword& keyword : kKeywords) {
+      uint32_t& stamp = stamps[slot_of(keyword.word, multiplier)];
+      if (stamp == attempt) {
+        perfect = false;
         break;
       }
+      stamp = attempt;
+    }
+    if (perfect) {
+      return multiplier;
+    }
+  }
+}
 
-    case 3:
-      if (word == u8"i16") {
-        return TokenKind::kI16;
-      } else if (word == u8"i32") {
-        return TokenKind::kI32;
-      } else if (word == u8"i64") {
-        return TokenKind::kI64;
-      } else if (word == u8"u16") {
-        return TokenKind::kU16;
-      } else if (word == u8"u32") {
-        return TokenKind::kU32;
-      } else if (word == u8"u64") {
-        return TokenKind::kU64;
-      } else if (word == u8"f32") {
-        return TokenKind::kF32;
-      } else if (word == u8"f64") {
-        return TokenKind::kF64;
-      } else if (word == u8"str") {
-        return TokenKind::kStr;
-      } else if (word == u8"for") {
-        return TokenKind::kFor;
-      } else if (word == u8"ret") {
-        return TokenKind::kReturn;
-      } else if (word == u8"mut") {
-        return TokenKind::kMutable;
-      } else if (word == u8"pub") {
-        return TokenKind::kPublic;
-      } else if (word == u8"use") {
-        return TokenKind::kUse;
-      }
-      break;
-
-    case 4:
-      if (word == u8"i128") {
-        return TokenKind::kI128;
-      } else if (word == u8"u128") {
-        return TokenKind::kU128;
-      } else if (word == u8"void") {
-        return TokenKind::kVoid;
-      } else if (word == u8"byte") {
-        return TokenKind::kByte;
-      } else if (word == u8"bool") {
-        return TokenKind::kBool;
-      } else if (word == u8"char") {
-        return TokenKind::kChar;
-      } else if (word == u8"else") {
-        return TokenKind::kElse;
-      } else if (word == u8"loop") {
-        return TokenKind::kLoop;
-      } else if (word == u8"enum") {
-        return TokenKind::kEnumeration;
-      } else if (word == u8"impl") {
-        return TokenKind::kImplementation;
-      } else if (word == u8"fast") {
-        return TokenKind::kFast;
-      } else if (word == u8"this") {
-        return TokenKind::kThis;
-      } else if (word == u8"true") {
-        return TokenKind::kTrue;
-      }
-      break;
-
-    case 5:
-      if (word == u8"isize") {
-        return TokenKind::kIsize;
-      } else if (word == u8"usize") {
-        return TokenKind::kUsize;
-      } else if (word == u8"while") {
-        return TokenKind::kWhile;
-      } else if (word == u8"break") {
-        return TokenKind::kBreak;
-      } else if (word == u8"match") {
-        return TokenKind::kMatch;
-      } else if (word == u8"trait") {
-        return TokenKind::kTrait;
-      } else if (word == u8"union") {
-        return TokenKind::kUnion;
-      } else if (word == u8"const") {
-        return TokenKind::kConstant;
-      } else if (word == u8"async") {
-        return TokenKind::kAsync;
-      } else if (word == u8"await") {
-        return TokenKind::kAwait;
-      } else if (word == u8"false") {
-        return TokenKind::kFalse;
-      }
+constexpr const uint64_t kMultiplier = find_perfect_multiplier();
 
-      break;
-
-    case 6:
-      if (word == u8"struct") {
-        return TokenKind::kStruct;
-      } else if (word == u8"module") {
-        return TokenKind::kModule;
-      } else if (word == u8"unsafe") {
-        return TokenKind::kUnsafe;
-      } else if (word == u8"extern") {
-        return TokenKind::kExtern;
-      } else if (word == u8"static") {
-        return TokenKind::kStatic;
-      }
-      break;
+// index + 1 into kKeywords, 0 for an empty slot
+constexpr std::array<uint8_t, kSlotCount> build_slots() {
+  std::array<uint8_t, kSlotCount> slots{};
+  for (std::size_t i = 0; i < kKeywords.size(); ++i) {
+    slots[slot_of(kKeywords[i].word, kMultiplier)] =
+        static_cast<uint8_t>(i + 1);
+  }
+  return slots;
+}
 
-    case 8:
-      if (word == u8"continue") {
-        return TokenKind::kContinue;
-      } else if (word == u8"redirect") {
-        return TokenKind::kRedirect;
-      }
-      break;
+constexpr const std::array<uint8_t, kSlotCount> kSlots = build_slots();
 
-    case 12:
-      if (word == u8"thread_local") {
-        return TokenKind::kThreadLocal;
-      }
-      break;
+}  // namespace
+
+TokenKind lookup_id_or_keyword(std::u8string_view word) {
+  const std::size_t length = word.size();
+  if (length < kMinKeywordLength || length > kMaxKeywordLength) {
+    return TokenKind::kIdentifier;
+  }
+
+  // one hash, one probe and one memcmp
+  const uint8_t entry = kSlots[slot_of(word, kMultiplier)];
+  if (entry == 0) {
+    return TokenKind::kIdentifier;
   }
 
+  const Keyword& keyword = kKeywords[entry - 1];
+  if (keyword.word.size() == length &&
+      std::memcmp(keyword.word.data(), word.data(), length) == 0) {
+    return keyword.kind;
+  }
   return TokenKind::kIdentifier;
 }
 
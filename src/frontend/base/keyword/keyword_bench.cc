@@ -2,7 +2,10 @@
 // This source code is licensed under the Apache License, Version 2.0
 // which can be found in the LICENSE file.
 
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "frontend/base/keyword/keyword.h"
@@ -11,6 +14,49 @@ namespace base {
 
 namespace {
 
+constexpr const std::u8string_view kKeywordWords[] = {
+    u8"fn",     u8"ret",   u8"if",     u8"else",     u8"for",
+    u8"while",  u8"mut",   u8"i32",    u8"struct",   u8"enum",
+    u8"match",  u8"true",  u8"false",  u8"continue", u8"usize",
+    u8"static", u8"const", u8"pub",    u8"use",      u8"thread_local",
+};
+
+// typical identifiers, including some that share a length and the leading or
+// trailing bytes with a keyword
+constexpr const std::u8string_view kIdentifierWords[] = {
+    u8"x",       u8"i",        u8"foo",   u8"count", u8"result",
+    u8"buffer",  u8"node_id",  u8"iff",   u8"fns",   u8"make_vector",
+    u8"structs", u8"returned", u8"len",   u8"value", u8"index",
+    u8"token",   u8"ctx",      u8"lhs",   u8"rhs",   u8"file_manager",
+};
+
+// word stream of a realistic function body, identifier dominated
+constexpr const std::u8string_view kMixedWords[] = {
+    u8"fn",    u8"compute", u8"x",     u8"i32",   u8"y",     u8"i32",
+    u8"i32",   u8"total",   u8"mut",   u8"i32",   u8"for",   u8"i",
+    u8"total", u8"total",   u8"x",     u8"i",     u8"y",     u8"if",
+    u8"total", u8"limit",   u8"break", u8"name",  u8"str",   u8"world",
+    u8"ret",   u8"total",   u8"node",  u8"ctx",   u8"alloc", u8"node_id",
+};
+
+template <std::size_t N>
+void lookup_words(benchmark::State& state,
+                  const std::u8string_view (&words)[N]) {
+  std::size_t bytes = 0;
+  for (const std::u8string_view word : words) {
+    bytes += word.size();
+  }
+
+  for (auto _ : state) {
+    for (const std::u8string_view word : words) {
+      benchmark::DoNotOptimize(lookup_id_or_keyword(word));
+    }
+  }
+
+  state.SetBytesProcessed(bytes * state.iterations());
+  state.SetItemsProcessed(N * state.iterations());
+}
+
 void keyword_lookup_keyword(benchmark::State& state) {
   const std::u8string id = u8"if";
   for (auto _ : state) {
@@ -21,6 +67,21 @@ void keyword_lookup_keyword(benchmark::State& state) {
 }
 BENCHMARK(keyword_lookup_keyword);
 
+void keyword_lookup_hits(benchmark::State& state) {
+  lookup_words(state, kKeywordWords);
+}
+BENCHMARK(keyword_lookup_hits);
+
+void keyword_lookup_misses(benchmark::State& state) {
+  lookup_words(state, kIdentifierWords);
+}
+BENCHMARK(keyword_lookup_misses);
+
+void keyword_lookup_mixed(benchmark::State& state) {
+  lookup_words(state, kMixedWords);
+}
+BENCHMARK(keyword_lookup_mixed);
+
 }  // namespace
 
 }  // namespace base
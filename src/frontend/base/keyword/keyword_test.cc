@@ -79,4 +79,19 @@ TEST(KeywordTest, LookupKeyword) {
   verify_keyword(u8"infer", TokenKind::kIdentifier);
 }
 
+TEST(KeywordTest, LookupNearMisses) {
+  // same length or same leading / trailing bytes as a keyword
+  verify_keyword(u8"", TokenKind::kIdentifier);
+  verify_keyword(u8"x", TokenKind::kIdentifier);
+  verify_keyword(u8"i9", TokenKind::kIdentifier);
+  verify_keyword(u8"Fn", TokenKind::kIdentifier);
+  verify_keyword(u8"iff", TokenKind::kIdentifier);
+  verify_keyword(u8"i256", TokenKind::kIdentifier);
+  verify_keyword(u8"structs", TokenKind::kIdentifier);
+  verify_keyword(u8"contiue", TokenKind::kIdentifier);
+  verify_keyword(u8"thread_locale", TokenKind::kIdentifier);
+  verify_keyword(u8"thread_lokal", TokenKind::kIdentifier);
+  verify_keyword(u8"あい", TokenKind::kIdentifier);
+}
+
 }  // namespace base
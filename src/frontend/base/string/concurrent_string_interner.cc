@@ -0,0 +1,244 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/base/string/concurrent_string_interner.h"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+#include "core/check.h"
+#include "frontend/base/string/string_hash.h"
+#include "frontend/base/string/string_id.h"
+
+namespace base {
+
+namespace {
+
+constexpr std::size_t kInitialTableCapacity = 64;
+
+// the largest local index whose id is still below kInvalidStringId
+constexpr uint32_t kMaxLocalIndex =
+    (kInvalidStringId >> ConcurrentStringInterner::kShardBits) - 1;
+
+}  // namespace
+
+ConcurrentStringInterner::Table::Table(std::size_t capacity)
+    : mask(capacity - 1),
+      slots(std::make_unique<std::atomic<uint64_t>[]>(capacity)) {
+  DCHECK(std::has_single_bit(capacity));
+}
+
+ConcurrentStringInterner::ConcurrentStringInterner() {
+  for (Shard& shard : shards_) {
+    auto table = std::make_unique<Table>(kInitialTableCapacity);
+    shard.table.store(table.get(), std::memory_order_relaxed);
+    shard.tables.emplace_back(std::move(table));
+  }
+}
+
+ConcurrentStringInterner::~ConcurrentStringInterner() = default;
+
+StringId ConcurrentStringInterner::intern(std::string_view s) {
+  if (s.empty()) {
+    return kEmptyStringId;
+  }
+
+  const uint64_t hash = hash_string(s);
+  Shard& shard = shards_[shard_index(hash)];
+
+  // lock-free fast path. a stale table can only miss strings inserted after
+  // it was replaced, which the locked path below finds.
+  const Table* table = shard.table.load(std::memory_order_acquire);
+  const StringId found = find(shard, *table, hash, s);
+  if (found != kInvalidStringId) {
+    return found;
+  }
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return insert(&shard, hash, s);
+}
+
+std::string_view ConcurrentStringInterner::lookup(StringId id) const {
+  const uint32_t local_index = id >> kShardBits;
+  if (id == kEmptyStringId || id == kInvalidStringId || local_index == 0) {
+    return "";
+  }
+
+  const Shard& shard = shards_[id & (kShardCount - 1)];
+  if (local_index > shard.count.load(std::memory_order_acquire)) {
+    return "";
+  }
+  const Entry* e = entry(shard, local_index);
+  return std::string_view(e->data, e->length);
+}
+
+StringId ConcurrentStringInterner::lookup(std::string_view s) const {
+  if (s.empty()) {
+    return kEmptyStringId;
+  }
+
+  const uint64_t hash = hash_string(s);
+  const Shard& shard = shards_[shard_index(hash)];
+  return find(shard, *shard.table.load(std::memory_order_acquire), hash, s);
+}
+
+std::size_t ConcurrentStringInterner::size() const {
+  std::size_t total = 0;
+  for (const Shard& shard : shards_) {
+    total += shard.count.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+StringId ConcurrentStringInterner::find(const Shard& shard,
+                                        const Table& table,
+                                        uint64_t hash,
+                                        std::string_view s) {
+  const uint64_t tag = make_slot(hash, 0);
+  std::size_t idx = static_cast<std::size_t>(hash) & table.mask;
+
+  for (std::size_t i = 0; i <= table.mask; ++i) {
+    const uint64_t slot = table.slots[idx].load(std::memory_order_acquire);
+    if (slot == 0) {
+      return kInvalidStringId;
+    }
+    if ((slot & 0xFFFFFFFF00000000ULL) == tag) {
+      const StringId id = static_cast<StringId>(slot);
+      const Entry* e = entry(shard, id >> kShardBits);
+      if (std::string_view(e->data, e->length) == s) {
+        return id;
+      }
+    }
+    // linear probing
+    idx = (idx + 1) & table.mask;
+  }
+  return kInvalidStringId;
+}
+
+ConcurrentStringInterner::SegmentPos ConcurrentStringInterner::segment_pos(
+    uint32_t local_index) {
+  // segment k holds 2^(kFirstSegmentBits + k) entries
+  const std::size_t pos =
+      static_cast<std::size_t>(local_index) - 1 + (1u << kFirstSegmentBits);
+  const std::size_t width = std::bit_width(pos);
+  const std::size_t size = std::size_t{1} << (width - 1);
+  return {width - 1 - kFirstSegmentBits, pos - size, size};
+}
+
+const ConcurrentStringInterner::Entry* ConcurrentStringInterner::entry(
+    const Shard& shard,
+    uint32_t local_index) {
+  const SegmentPos p = segment_pos(local_index);
+  const Entry* entries =
+      shard.segments[p.segment].load(std::memory_order_acquire);
+  DCHECK(entries);
+  return &entries[p.offset];
+}
+
+ConcurrentStringInterner::Entry* ConcurrentStringInterner::entry_slot(
+    Shard* shard,
+    uint32_t local_index) {
+  const SegmentPos p = segment_pos(local_index);
+  Entry* entries = shard->segments[p.segment].load(std::memory_order_relaxed);
+  if (entries == nullptr) {
+    auto storage = std::make_unique<Entry[]>(p.size);
+    entries = storage.get();
+    shard->segment_storage.emplace_back(std::move(storage));
+    shard->segments[p.segment].store(entries, std::memory_order_release);
+  }
+  return &entries[p.offset];
+}
+
+StringId ConcurrentStringInterner::insert(Shard* shard,
+                                          uint64_t hash,
+                                          std::string_view s) {
+  // another thread may have inserted it since the lock-free probe
+  const StringId existing =
+      find(*shard, *shard->table.load(std::memory_order_relaxed), hash, s);
+  if (existing != kInvalidStringId) {
+    return existing;
+  }
+
+  Table* table = shard->table.load(std::memory_order_relaxed);
+  if ((shard->used_slots + 1) * 2 > table->mask + 1) {
+    grow(shard);
+    table = shard->table.load(std::memory_order_relaxed);
+  }
+
+  const uint32_t local_index =
+      shard->count.load(std::memory_order_relaxed) + 1;
+  CHECK_LE(local_index, kMaxLocalIndex);
+  const StringId id =
+      make_id(static_cast<std::size_t>(shard - shards_.data()), local_index);
+
+  // the entry is visible before the slot that hands out its id
+  Entry* e = entry_slot(shard, local_index);
+  e->data = store_bytes(shard, s);
+  e->length = s.size();
+  shard->count.store(local_index, std::memory_order_release);
+
+  std::size_t idx = static_cast<std::size_t>(hash) & table->mask;
+  while (table->slots[idx].load(std::memory_order_relaxed) != 0) {
+    idx = (idx + 1) & table->mask;
+  }
+  table->slots[idx].store(make_slot(hash, id), std::memory_order_release);
+  ++shard->used_slots;
+  return id;
+}
+
+const char* ConcurrentStringInterner::store_bytes(Shard* shard,
+                                                  std::string_view s) {
+  // strings are copied into fixed blocks that are never reallocated, so
+  // readers can hold on to the bytes without a lock
+  if (s.size() > kStringBlockSize / 4) {
+    auto block = std::make_unique<char[]>(s.size());
+    std::memcpy(block.get(), s.data(), s.size());
+    const char* data = block.get();
+    shard->large_strings.emplace_back(std::move(block));
+    return data;
+  }
+
+  if (shard->block_used + s.size() > kStringBlockSize) {
+    shard->blocks.emplace_back(std::make_unique<char[]>(kStringBlockSize));
+    shard->block_used = 0;
+  }
+  char* data = shard->blocks.back().get() + shard->block_used;
+  std::memcpy(data, s.data(), s.size());
+  shard->block_used += s.size();
+  return data;
+}
+
+void ConcurrentStringInterner::grow(Shard* shard) {
+  const Table* old = shard->table.load(std::memory_order_relaxed);
+  auto table = std::make_unique<Table>((old->mask + 1) * 2);
+
+  for (std::size_t i = 0; i <= old->mask; ++i) {
+    const uint64_t slot = old->slots[i].load(std::memory_order_relaxed);
+    if (slot == 0) {
+      continue;
+    }
+    const StringId id = static_cast<StringId>(slot);
+    const Entry* e = entry(*shard, id >> kShardBits);
+    std::size_t idx = static_cast<std::size_t>(
+                          hash_string(std::string_view(e->data, e->length))) &
+                      table->mask;
+    while (table->slots[idx].load(std::memory_order_relaxed) != 0) {
+      idx = (idx + 1) & table->mask;
+    }
+    table->slots[idx].store(slot, std::memory_order_relaxed);
+  }
+
+  // readers may still be probing the old table, so it is retired rather
+  // than freed
+  shard->table.store(table.get(), std::memory_order_release);
+  shard->tables.emplace_back(std::move(table));
+}
+
+}  // namespace base
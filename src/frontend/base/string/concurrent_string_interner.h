@@ -0,0 +1,134 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_BASE_STRING_CONCURRENT_STRING_INTERNER_H_
+#define FRONTEND_BASE_STRING_CONCURRENT_STRING_INTERNER_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "frontend/base/base_export.h"
+#include "frontend/base/string/string_id.h"
+#include "frontend/base/string/string_interner.h"
+
+namespace base {
+
+// thread-safe counterpart of StringInterner with the same intern / lookup api.
+//
+// strings are split over kShardCount shards by hash, each with its own insert
+// mutex, so threads interning different strings rarely contend. looking up a
+// string that is already interned (the common case while parsing) never takes
+// a lock: slots, string entries and string bytes are only ever published with
+// release stores and never move or get freed before the interner is
+// destroyed.
+//
+// ids are globally stable across threads but, unlike StringInterner, not
+// dense and not in insertion order. the low kShardBits bits select the shard.
+class BASE_EXPORT ConcurrentStringInterner {
+ public:
+  static constexpr std::size_t kShardBits = 6;
+  static constexpr std::size_t kShardCount = std::size_t{1} << kShardBits;
+
+  ConcurrentStringInterner();
+  ~ConcurrentStringInterner();
+
+  ConcurrentStringInterner(const ConcurrentStringInterner&) = delete;
+  ConcurrentStringInterner& operator=(const ConcurrentStringInterner&) = delete;
+
+  ConcurrentStringInterner(ConcurrentStringInterner&&) = delete;
+  ConcurrentStringInterner& operator=(ConcurrentStringInterner&&) = delete;
+
+  // interns a string and returns a stable id
+  // if already present, returns existing id without locking
+  StringId intern(std::string_view s);
+  std::string_view lookup(StringId id) const;
+  StringId lookup(std::string_view s) const;
+
+  // number of interned strings. exact only when no insert is in flight.
+  std::size_t size() const;
+
+ private:
+  // per-shard string entries live in segments of doubling size, so an entry
+  // never moves once written and the segment table itself is fixed size.
+  static constexpr std::size_t kFirstSegmentBits = 8;
+  static constexpr std::size_t kSegmentCount = 32 - kShardBits;
+
+  struct SegmentPos {
+    std::size_t segment;
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  static constexpr std::size_t kStringBlockSize = 64 * 1024;
+
+  struct Entry {
+    const char* data = nullptr;
+    std::size_t length = 0;
+  };
+
+  // open-addressing table. a slot packs 32 bits of the hash with the string
+  // id, 0 marks an empty slot (ids are never 0).
+  struct Table {
+    explicit Table(std::size_t capacity);
+
+    std::size_t mask;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+  };
+
+  struct alignas(64) Shard {
+    std::atomic<Table*> table{nullptr};
+    std::array<std::atomic<Entry*>, kSegmentCount> segments{};
+    std::atomic<uint32_t> count{0};
+
+    // everything below is only touched with `mutex` held
+    std::mutex mutex;
+    std::size_t used_slots = 0;
+    std::vector<std::unique_ptr<Table>> tables;
+    std::vector<std::unique_ptr<Entry[]>> segment_storage;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::size_t block_used = kStringBlockSize;
+    std::vector<std::unique_ptr<char[]>> large_strings;
+  };
+
+  // the shard comes from the top bits, the table index from the low bits
+  static inline std::size_t shard_index(uint64_t hash) {
+    return static_cast<std::size_t>(hash >> (64 - kShardBits));
+  }
+
+  // the top kShardBits bits are the same for every hash in a shard, so the
+  // tag takes the 32 bits below them
+  static inline uint64_t make_slot(uint64_t hash, StringId id) {
+    return ((hash << kShardBits) & 0xFFFFFFFF00000000ULL) | id;
+  }
+
+  static inline StringId make_id(std::size_t shard, uint32_t local_index) {
+    // local indices start at 1 so no id is kEmptyStringId
+    return static_cast<StringId>((local_index << kShardBits) | shard);
+  }
+
+  static StringId find(const Shard& shard,
+                       const Table& table,
+                       uint64_t hash,
+                       std::string_view s);
+
+  static SegmentPos segment_pos(uint32_t local_index);
+  static const Entry* entry(const Shard& shard, uint32_t local_index);
+
+  StringId insert(Shard* shard, uint64_t hash, std::string_view s);
+  const char* store_bytes(Shard* shard, std::string_view s);
+  Entry* entry_slot(Shard* shard, uint32_t local_index);
+  void grow(Shard* shard);
+
+  std::array<Shard, kShardCount> shards_;
+};
+
+}  // namespace base
+
+#endif  // FRONTEND_BASE_STRING_CONCURRENT_STRING_INTERNER_H_
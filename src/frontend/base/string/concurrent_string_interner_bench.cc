@@ -0,0 +1,89 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "frontend/base/string/concurrent_string_interner.h"
+#include "frontend/base/string/string_interner.h"
+
+namespace base {
+
+namespace {
+
+constexpr std::size_t kWordCount = 4096;
+
+// identifier-like words, a mix that repeats heavily as in real sources
+const std::vector<std::string>& words() {
+  static const std::vector<std::string> kWords = [] {
+    std::vector<std::string> result;
+    result.reserve(kWordCount);
+    for (std::size_t i = 0; i < kWordCount; ++i) {
+      result.emplace_back("identifier_" + std::to_string(i));
+    }
+    return result;
+  }();
+  return kWords;
+}
+
+// baseline: the single-threaded interner behind one global mutex
+struct LockedStringInterner {
+  StringId intern(std::string_view s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return interner.intern(s);
+  }
+
+  std::mutex mutex;
+  StringInterner interner;
+};
+
+LockedStringInterner* locked_interner = nullptr;
+ConcurrentStringInterner* concurrent_interner = nullptr;
+
+// every thread interns the shared word list from its own starting point, so
+// the first pass contends on inserts and the rest are lookups of hits
+// the shared interner is created by thread 0 and only read once the loop has
+// started, which happens after all threads finished their setup
+template <typename Interner>
+void intern_words(benchmark::State& state, Interner* const* interner) {
+  const std::vector<std::string>& w = words();
+  std::size_t i = static_cast<std::size_t>(state.thread_index()) * 997;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize((*interner)->intern(w[i % kWordCount]));
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void string_interner_locked(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    locked_interner = new LockedStringInterner();
+  }
+  intern_words(state, &locked_interner);
+  if (state.thread_index() == 0) {
+    delete locked_interner;
+    locked_interner = nullptr;
+  }
+}
+BENCHMARK(string_interner_locked)->ThreadRange(1, 16)->UseRealTime();
+
+void string_interner_concurrent(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    concurrent_interner = new ConcurrentStringInterner();
+  }
+  intern_words(state, &concurrent_interner);
+  if (state.thread_index() == 0) {
+    delete concurrent_interner;
+    concurrent_interner = nullptr;
+  }
+}
+BENCHMARK(string_interner_concurrent)->ThreadRange(1, 16)->UseRealTime();
+
+}  // namespace
+
+}  // namespace base
@@ -0,0 +1,109 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/base/string/concurrent_string_interner.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace base {
+
+class ConcurrentStringInternerTest : public testing::Test {
+ protected:
+  ConcurrentStringInterner interner;
+};
+
+TEST_F(ConcurrentStringInternerTest, InternsUniqueStrings) {
+  StringId id1 = interner.intern("hello");
+  StringId id2 = interner.intern("world");
+
+  EXPECT_NE(id1, kInvalidStringId);
+  EXPECT_NE(id2, kInvalidStringId);
+  EXPECT_NE(id1, kEmptyStringId);
+  EXPECT_NE(id1, id2);
+  EXPECT_EQ(interner.size(), 2u);
+}
+
+TEST_F(ConcurrentStringInternerTest, ReturnsSameIdForExistingString) {
+  StringId id1 = interner.intern("test_string");
+  StringId id2 = interner.intern("test_string");
+
+  EXPECT_EQ(id1, id2);
+  EXPECT_EQ(interner.size(), 1u);
+}
+
+TEST_F(ConcurrentStringInternerTest, LookupRoundTrips) {
+  StringId id = interner.intern("lookup_test");
+
+  EXPECT_EQ(interner.lookup(id), "lookup_test");
+  EXPECT_EQ(interner.lookup(std::string_view("lookup_test")), id);
+  EXPECT_EQ(interner.lookup(std::string_view("missing")), kInvalidStringId);
+}
+
+TEST_F(ConcurrentStringInternerTest, EmptyString) {
+  EXPECT_EQ(interner.intern(""), kEmptyStringId);
+  EXPECT_EQ(interner.lookup(kEmptyStringId), "");
+  EXPECT_EQ(interner.lookup(kInvalidStringId), "");
+}
+
+TEST_F(ConcurrentStringInternerTest, GrowsAndKeepsIds) {
+  constexpr std::size_t kCount = 100000;
+  std::vector<StringId> ids;
+  ids.reserve(kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    ids.push_back(interner.intern("str_" + std::to_string(i)));
+  }
+
+  EXPECT_EQ(interner.size(), kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    const std::string s = "str_" + std::to_string(i);
+    EXPECT_EQ(interner.lookup(ids[i]), s);
+    EXPECT_EQ(interner.intern(s), ids[i]);
+  }
+}
+
+TEST_F(ConcurrentStringInternerTest, LongStrings) {
+  const std::string long_str(1 << 20, 'x');
+  StringId id = interner.intern(long_str);
+
+  EXPECT_EQ(interner.lookup(id), long_str);
+  EXPECT_EQ(interner.intern(long_str), id);
+}
+
+TEST_F(ConcurrentStringInternerTest, ConcurrentInternAgreesOnIds) {
+  constexpr std::size_t kThreads = 8;
+  constexpr std::size_t kWords = 20000;
+
+  // every thread interns the same words in a different order
+  std::vector<std::vector<StringId>> ids(kThreads,
+                                         std::vector<StringId>(kWords));
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (std::size_t n = 0; n < kWords; ++n) {
+        const std::size_t i =
+            ((t % 2 == 0 ? n : kWords - 1 - n) + t * 7919) % kWords;
+        ids[t][i] = interner.intern("word_" + std::to_string(i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(interner.size(), kWords);
+  for (std::size_t i = 0; i < kWords; ++i) {
+    for (std::size_t t = 1; t < kThreads; ++t) {
+      ASSERT_EQ(ids[t][i], ids[0][i]);
+    }
+    EXPECT_EQ(interner.lookup(ids[0][i]), "word_" + std::to_string(i));
+  }
+}
+
+}  // namespace base
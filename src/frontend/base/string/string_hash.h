@@ -0,0 +1,123 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_BASE_STRING_STRING_HASH_H_
+#define FRONTEND_BASE_STRING_STRING_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "build/build_flag.h"
+
+#if COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+namespace base {
+
+// wyhash (final version 4) for interner keys. it reads 8 / 4 bytes at a time
+// instead of one, which matters for identifiers since most are short and
+// hashed on every path expression.
+
+namespace detail {
+
+constexpr uint64_t kWyP0 = 0xa0761d6478bd642fULL;
+constexpr uint64_t kWyP1 = 0xe7037ed1a0b428dbULL;
+constexpr uint64_t kWyP2 = 0x8ebc6af09c88c6e3ULL;
+constexpr uint64_t kWyP3 = 0x589965cc75374cc3ULL;
+
+inline uint64_t wymix(uint64_t a, uint64_t b) {
+#if COMPILER_MSVC && defined(_M_X64)
+  uint64_t hi = 0;
+  const uint64_t lo = _umul128(a, b, &hi);
+  return lo ^ hi;
+#else
+  const __uint128_t r = static_cast<__uint128_t>(a) * b;
+  return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#endif
+}
+
+inline uint64_t read64(const char* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t read32(const char* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// 1 to 3 bytes, spread over a 24-bit value
+inline uint64_t read_small(const char* p, std::size_t k) {
+  return (static_cast<uint64_t>(static_cast<uint8_t>(p[0])) << 16) |
+         (static_cast<uint64_t>(static_cast<uint8_t>(p[k >> 1])) << 8) |
+         static_cast<uint8_t>(p[k - 1]);
+}
+
+}  // namespace detail
+
+inline uint64_t hash_string(std::string_view s, uint64_t seed = 0) {
+  using detail::kWyP0;
+  using detail::kWyP1;
+  using detail::read32;
+  using detail::read64;
+  using detail::wymix;
+
+  const char* p = s.data();
+  std::size_t len = s.size();
+  seed ^= wymix(seed ^ kWyP0, kWyP1);
+
+  uint64_t a = 0;
+  uint64_t b = 0;
+  if (len <= 16) [[likely]] {
+    if (len >= 4) {
+      a = (read32(p) << 32) | read32(p + ((len >> 3) << 2));
+      b = (read32(p + len - 4) << 32) | read32(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = detail::read_small(p, len);
+    }
+  } else {
+    std::size_t i = len;
+    if (i > 48) [[unlikely]] {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+      do {
+        seed = wymix(read64(p) ^ kWyP1, read64(p + 8) ^ seed);
+        see1 = wymix(read64(p + 16) ^ detail::kWyP2, read64(p + 24) ^ see1);
+        see2 = wymix(read64(p + 32) ^ detail::kWyP3, read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = wymix(read64(p) ^ kWyP1, read64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = read64(p + i - 16);
+    b = read64(p + i - 8);
+  }
+
+  a ^= kWyP1;
+  b ^= seed;
+#if COMPILER_MSVC && defined(_M_X64)
+  uint64_t hi = 0;
+  a = _umul128(a, b, &hi);
+  b = hi;
+#else
+  const __uint128_t r = static_cast<__uint128_t>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+#endif
+  return wymix(a ^ kWyP0 ^ len, b ^ kWyP1);
+}
+
+}  // namespace base
+
+#endif  // FRONTEND_BASE_STRING_STRING_HASH_H_
@@ -4,6 +4,8 @@
 
 #include "frontend/base/string/string_interner.h"
 
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <string_view>
@@ -11,15 +13,55 @@
 #include <vector>
 
 #include "core/check.h"
+#include "frontend/base/string/string_hash.h"
 #include "frontend/base/string/string_id.h"
 
+#if ENABLE_AVX2
+#include <immintrin.h>
+#endif
+
 namespace base {
 
+namespace {
+
+// bit i is set when control byte i of the group equals `control`
+inline uint32_t match_control(const int8_t* group, int8_t control) {
+#if ENABLE_AVX2
+  const __m128i ctrl =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(control))));
+#else
+  uint32_t mask = 0;
+  for (std::size_t i = 0; i < StringInterner::kGroupWidth; ++i) {
+    mask |= static_cast<uint32_t>(group[i] == control) << i;
+  }
+  return mask;
+#endif
+}
+
+// empty is the only control byte with the sign bit set
+inline uint32_t match_empty(const int8_t* group) {
+#if ENABLE_AVX2
+  const __m128i ctrl =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+#else
+  uint32_t mask = 0;
+  for (std::size_t i = 0; i < StringInterner::kGroupWidth; ++i) {
+    mask |= static_cast<uint32_t>(group[i] < 0) << i;
+  }
+  return mask;
+#endif
+}
+
+}  // namespace
+
 StringInterner::StringInterner(double max_load_factor)
     : max_load_factor_(max_load_factor) {
   // allocate 1 KiB string arena
   arena_.reserve(1024);
-  // allocate 64 bytes small bucket table
+  // allocate small 64 slot table
   init_buckets(64);
 }
 
@@ -31,25 +73,21 @@ StringId StringInterner::intern(std::string_view s) {
   }
   ensure_load_factor();
 
-  const uint64_t hash = hash_sv(s);
-  const uint32_t mask = static_cast<uint32_t>(buckets_.size() - 1);
-  uint32_t idx = static_cast<uint32_t>(hash) & mask;
-
-  while (true) {
-    Bucket& b = buckets_[idx];
-    if (b.empty()) {
-      // insert new
-      const StringId id = arena_.alloc(s);
-      b = Bucket{hash, id};
-      ++used_buckets_;
-      return id;
-    } else if (b.hash == hash && arena_[b.id] == s) {
-      // already interned
-      return b.id;
-    }
-    // linear probing
-    idx = (idx + 1) & mask;
+  const uint64_t hash = hash_string(s);
+  const uint64_t prefix = load_prefix(s);
+  bool found = false;
+  const std::size_t idx = find_slot(s, hash, prefix, &found);
+  if (found) {
+    // already interned
+    return slots_[idx].id;
   }
+
+  // insert new
+  const StringId id = static_cast<StringId>(arena_.alloc(s));
+  ctrl_[idx] = control_of(hash);
+  slots_[idx] = Slot{prefix, static_cast<uint32_t>(s.size()), id};
+  ++used_buckets_;
+  return id;
 }
 
 std::string_view StringInterner::lookup(StringId id) const {
@@ -60,24 +98,59 @@ StringId StringInterner::lookup(std::string_view s) const {
   if (s.empty()) {
     return kEmptyStringId;
   }
-  const uint64_t hash = hash_sv(s);
-  const uint32_t mask = static_cast<uint32_t>(buckets_.size() - 1);
-  uint32_t idx = static_cast<uint32_t>(hash) & mask;
-
-  for (std::size_t i = 0; i < buckets_.size(); ++i) {
-    const Bucket& b = buckets_[idx];
-    if (b.empty()) {
-      return kInvalidStringId;
-    } else if (b.hash == hash && arena_[b.id] == s) {
-      return b.id;
-    } else {
-      idx = (idx + 1) & mask;
+  bool found = false;
+  const std::size_t idx =
+      find_slot(s, hash_string(s), load_prefix(s), &found);
+  return found ? slots_[idx].id : kInvalidStringId;
+}
+
+std::size_t StringInterner::find_slot(std::string_view s,
+                                      uint64_t hash,
+                                      uint64_t prefix,
+                                      bool* found) const {
+  const int8_t control = control_of(hash);
+  const std::size_t group_mask = slots_.size() / kGroupWidth - 1;
+  std::size_t group = static_cast<std::size_t>(hash >> 7) & group_mask;
+
+  // triangular probing over groups visits every group once
+  for (std::size_t step = 1;; ++step) {
+    const std::size_t base = group * kGroupWidth;
+    for (uint32_t match = match_control(&ctrl_[base], control); match != 0;
+         match &= match - 1) {
+      const std::size_t idx = base + std::countr_zero(match);
+      const Slot& slot = slots_[idx];
+      if (slot.length == s.size() && slot.prefix == prefix &&
+          (s.size() <= 8 || arena_[slot.id] == s)) {
+        *found = true;
+        return idx;
+      }
     }
+
+    // nothing is ever erased, so an empty slot ends the probe sequence
+    const uint32_t empty = match_empty(&ctrl_[base]);
+    if (empty != 0) {
+      *found = false;
+      return base + std::countr_zero(empty);
+    }
+    group = (group + step) & group_mask;
+  }
+}
+
+std::size_t StringInterner::find_empty_slot(uint64_t hash) const {
+  const std::size_t group_mask = slots_.size() / kGroupWidth - 1;
+  std::size_t group = static_cast<std::size_t>(hash >> 7) & group_mask;
+  for (std::size_t step = 1;; ++step) {
+    const std::size_t base = group * kGroupWidth;
+    const uint32_t empty = match_empty(&ctrl_[base]);
+    if (empty != 0) {
+      return base + std::countr_zero(empty);
+    }
+    group = (group + step) & group_mask;
   }
-  return kInvalidStringId;
 }
 
 void StringInterner::init_buckets(std::size_t n) {
+  n = std::max(n, kGroupWidth);
   // round up to next power of 2
   if ((n & (n - 1)) != 0) {
     --n;
@@ -90,33 +163,35 @@ void StringInterner::init_buckets(std::size_t n) {
     ++n;
   }
 
-  buckets_.clear();
-  buckets_.resize(n);
+  ctrl_.assign(n, kEmptyControl);
+  slots_.clear();
+  slots_.resize(n);
   used_buckets_ = 0;
 }
 
 void StringInterner::ensure_load_factor() {
   if (load_factor() > max_load_factor_) {
-    rehash(buckets_.size() * 2);
+    rehash(slots_.size() * 2);
   }
 }
 
 void StringInterner::rehash(std::size_t new_size) {
   // save old
-  std::vector<Bucket> old = std::move(buckets_);
+  std::vector<int8_t> old_ctrl = std::move(ctrl_);
+  std::vector<Slot> old_slots = std::move(slots_);
   init_buckets(new_size);
 
-  // reinsert existing entries
-  for (const auto& b : old) {
-    if (b.id == kInvalidStringId) {
+  // reinsert existing entries. only the 7-bit control survives in the table,
+  // so the full hash is recomputed from the arena.
+  for (std::size_t i = 0; i < old_slots.size(); ++i) {
+    if (old_ctrl[i] == kEmptyControl) {
       continue;
     }
-    const uint32_t mask = static_cast<uint32_t>(buckets_.size() - 1);
-    uint32_t idx = static_cast<uint32_t>(b.hash) & mask;
-    while (buckets_[idx].id != kInvalidStringId) {
-      idx = (idx + 1) & mask;
-    }
-    buckets_[idx] = b;
+    const Slot& slot = old_slots[i];
+    const uint64_t hash = hash_string(arena_[slot.id]);
+    const std::size_t idx = find_empty_slot(hash);
+    ctrl_[idx] = control_of(hash);
+    slots_[idx] = slot;
     ++used_buckets_;
   }
 }
@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string_view>
 #include <vector>
 
@@ -40,42 +41,56 @@ class BASE_EXPORT StringInterner {
   inline std::size_t size() const { return arena_.size(); }
 
   inline std::size_t string_count() const { return arena_.size(); }
-  inline std::size_t bucket_count() const { return buckets_.size(); }
+  inline std::size_t bucket_count() const { return slots_.size(); }
   inline std::size_t used_buckets() const { return used_buckets_; }
   inline double load_factor() const {
-    return buckets_.empty() ? 0.0
-                            : static_cast<double>(used_buckets_) /
-                                  static_cast<double>(buckets_.size());
+    return slots_.empty() ? 0.0
+                          : static_cast<double>(used_buckets_) /
+                                static_cast<double>(slots_.size());
   }
 
+  // number of control bytes probed at once
+  static constexpr std::size_t kGroupWidth = 16;
+
  private:
+  // swiss-table layout: one control byte per slot, either kEmptyControl or
+  // the low 7 bits of the hash. a whole group of control bytes is matched at
+  // once, and only slots whose byte matches are compared.
+  static constexpr int8_t kEmptyControl = static_cast<int8_t>(0x80);
+
+  // a slot carries the length and the first 8 bytes of its string, so most
+  // mismatches never touch the arena and strings up to 8 bytes never do.
+  struct Slot {
+    uint64_t prefix = 0;
+    uint32_t length = 0;
+    StringId id = kInvalidStringId;
+  };
+
   void init_buckets(std::size_t n);
   void ensure_load_factor();
   void rehash(std::size_t new_size);
 
-  // TODO: replace this with xxh3
-  static inline uint64_t hash_sv(std::string_view s) {
-    // FNV-1a hash (better than std::hash for short strings)
-    // FNV offset basis
-    uint64_t hash = 14695981039346656037ULL;
-    for (char c : s) {
-      hash ^= static_cast<uint64_t>(c);
-      // FNV prime
-      hash *= 1099511628211ULL;
-    }
-    return hash;
+  // returns the slot index holding `s`, or the index of the empty slot where
+  // it would be inserted with `*found` set to false
+  std::size_t find_slot(std::string_view s,
+                        uint64_t hash,
+                        uint64_t prefix,
+                        bool* found) const;
+  std::size_t find_empty_slot(uint64_t hash) const;
+
+  static inline uint64_t load_prefix(std::string_view s) {
+    uint64_t prefix = 0;
+    std::memcpy(&prefix, s.data(), s.size() < 8 ? s.size() : 8);
+    return prefix;
   }
 
-  // bucket for open-addressing hash table
-  struct Bucket {
-    uint64_t hash = 0;
-    StringId id = kInvalidStringId;
-
-    bool empty() const { return id == kInvalidStringId; }
-  };
+  static inline int8_t control_of(uint64_t hash) {
+    return static_cast<int8_t>(hash & 0x7F);
+  }
 
   StringArena arena_;
-  std::vector<Bucket> buckets_;
+  std::vector<int8_t> ctrl_;
+  std::vector<Slot> slots_;
   std::size_t used_buckets_ = 0;
   double max_load_factor_;
 };
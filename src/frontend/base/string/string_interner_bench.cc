@@ -0,0 +1,101 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "frontend/base/string/string_hash.h"
+#include "frontend/base/string/string_interner.h"
+
+namespace base {
+
+namespace {
+
+constexpr std::size_t kWordCount = 4096;
+
+// short identifiers dominate real sources, with a tail of longer names
+std::vector<std::string> make_words(const char* prefix) {
+  std::vector<std::string> words;
+  words.reserve(kWordCount);
+  for (std::size_t i = 0; i < kWordCount; ++i) {
+    std::string word = prefix + std::to_string(i);
+    if (i % 8 == 0) {
+      word += "_with_a_longer_descriptive_suffix";
+    }
+    words.emplace_back(std::move(word));
+  }
+  return words;
+}
+
+void string_hash(benchmark::State& state) {
+  const std::vector<std::string> words = make_words("id");
+  std::size_t bytes = 0;
+  for (const auto& w : words) {
+    bytes += w.size();
+  }
+
+  for (auto _ : state) {
+    for (const auto& w : words) {
+      benchmark::DoNotOptimize(hash_string(w));
+    }
+  }
+  state.SetBytesProcessed(bytes * state.iterations());
+  state.SetItemsProcessed(kWordCount * state.iterations());
+}
+BENCHMARK(string_hash);
+
+// every word is already interned, the common case while parsing
+void string_interner_intern_hits(benchmark::State& state) {
+  const std::vector<std::string> words = make_words("id");
+  StringInterner interner;
+  for (const auto& w : words) {
+    interner.intern(w);
+  }
+
+  for (auto _ : state) {
+    for (const auto& w : words) {
+      benchmark::DoNotOptimize(interner.intern(w));
+    }
+  }
+  state.SetItemsProcessed(kWordCount * state.iterations());
+}
+BENCHMARK(string_interner_intern_hits);
+
+// probes for absent words sharing lengths and prefixes with present ones
+void string_interner_lookup_misses(benchmark::State& state) {
+  const std::vector<std::string> present = make_words("id");
+  const std::vector<std::string> absent = make_words("ix");
+  StringInterner interner;
+  for (const auto& w : present) {
+    interner.intern(w);
+  }
+
+  for (auto _ : state) {
+    for (const auto& w : absent) {
+      benchmark::DoNotOptimize(interner.lookup(std::string_view(w)));
+    }
+  }
+  state.SetItemsProcessed(kWordCount * state.iterations());
+}
+BENCHMARK(string_interner_lookup_misses);
+
+void string_interner_intern_fresh(benchmark::State& state) {
+  const std::vector<std::string> words = make_words("id");
+  for (auto _ : state) {
+    StringInterner interner;
+    for (const auto& w : words) {
+      benchmark::DoNotOptimize(interner.intern(w));
+    }
+  }
+  state.SetItemsProcessed(kWordCount * state.iterations());
+}
+BENCHMARK(string_interner_intern_fresh);
+
+}  // namespace
+
+}  // namespace base
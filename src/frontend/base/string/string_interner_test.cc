@@ -71,4 +71,32 @@ TEST_F(StringInternerTest, HandlesLargeNumberOfStrings) {
   EXPECT_EQ(interner.lookup(id500), s500);
 }
 
+TEST_F(StringInternerTest, DistinguishesSharedPrefixes) {
+  // equal length and equal first 8 bytes, so only the arena compare differs
+  StringId id1 = interner.intern("abcdefgh_1");
+  StringId id2 = interner.intern("abcdefgh_2");
+  // inline-only strings
+  StringId id3 = interner.intern("abcdefgh");
+  StringId id4 = interner.intern("abcdefg");
+
+  EXPECT_NE(id1, id2);
+  EXPECT_NE(id3, id4);
+  EXPECT_NE(id1, id3);
+  EXPECT_EQ(interner.intern("abcdefgh_1"), id1);
+  EXPECT_EQ(interner.intern("abcdefgh_2"), id2);
+  EXPECT_EQ(interner.intern("abcdefgh"), id3);
+  EXPECT_EQ(interner.intern("abcdefg"), id4);
+  EXPECT_EQ(interner.lookup(id2), "abcdefgh_2");
+}
+
+TEST_F(StringInternerTest, KeepsLoadFactorBounded) {
+  for (int i = 0; i < 10000; ++i) {
+    interner.intern("s" + std::to_string(i));
+  }
+
+  EXPECT_EQ(interner.string_count(), 10000u);
+  EXPECT_LE(interner.load_factor(), 0.75);
+  EXPECT_EQ(interner.bucket_count() % StringInterner::kGroupWidth, 0u);
+}
+
 }  // namespace base
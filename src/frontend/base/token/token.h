@@ -6,6 +6,7 @@
 #define FRONTEND_BASE_TOKEN_TOKEN_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -17,26 +18,31 @@
 #include "core/base/string_util.h"
 #include "core/check.h"
 #include "frontend/base/base_export.h"
+#include "frontend/base/string/string_id.h"
 #include "frontend/base/token/token_kind.h"
 #include "unicode/utf8/file.h"
 
 namespace base {
 
+// packed to 12 bytes so that the token stream stays cache dense. line and
+// column are not stored but recovered from the file on demand.
+//
+// identifiers may carry the id their lexeme was interned as by the lexer, in
+// the bits that would otherwise be padding. ids that do not fit in 24 bits
+// are not stored, and the lexeme has to be interned again.
 class BASE_EXPORT Token {
  public:
-  constexpr Token(TokenKind kind,
-                  const core::SourceLocation& location,
-                  std::size_t length)
-      : range_(location, length), kind_(kind) {}
-
-  constexpr Token(TokenKind kind, const core::SourceRange& range)
-      : range_(range), kind_(kind) {}
-
-  constexpr Token(TokenKind kind,
-                  std::size_t line,
-                  std::size_t column,
-                  std::size_t length)
-      : Token(kind, core::SourceRange(line, column, length)) {}
+  static constexpr uint32_t kNoSymbol = (1u << 24) - 1;
+
+  constexpr Token(TokenKind kind, std::size_t offset, std::size_t length)
+      : offset_(static_cast<uint32_t>(offset)),
+        length_(static_cast<uint32_t>(length)),
+        kind_(static_cast<uint8_t>(kind)),
+        symbol_(kNoSymbol) {
+    // sources of 4 GiB or more can not be addressed by 32 bit offsets
+    DCHECK_LE(offset, UINT32_MAX);
+    DCHECK_LE(length, UINT32_MAX - offset);
+  }
 
   Token() = delete;
 
@@ -48,17 +54,51 @@ class BASE_EXPORT Token {
   Token(Token&&) noexcept = default;
   Token& operator=(Token&&) noexcept = default;
 
-  inline const core::SourceRange& range() const { return range_; }
-  inline const core::SourceLocation& start() const { return range_.start(); }
-  inline const core::SourceLocation end() const { return range_.end(); }
-  inline std::size_t length() const { return range_.length(); }
-  inline TokenKind kind() const { return kind_; }
+  // byte offset from the beginning of the file
+  inline uint32_t offset() const { return offset_; }
+  inline uint32_t end_offset() const { return offset_ + length_; }
+  // length in bytes
+  inline uint32_t length() const { return length_; }
+  inline TokenKind kind() const { return static_cast<TokenKind>(kind_); }
+
+  inline bool has_symbol() const { return symbol_ != kNoSymbol; }
+  inline StringId symbol() const {
+    DCHECK(has_symbol());
+    return symbol_;
+  }
+  // returns false if `id` does not fit
+  inline bool set_symbol(StringId id) {
+    if (id >= kNoSymbol) {
+      return false;
+    }
+    symbol_ = id;
+    return true;
+  }
+
+  // moves the token by `delta` bytes, for tokens behind an edit
+  inline void shift(std::ptrdiff_t delta) {
+    DCHECK_GE(static_cast<std::ptrdiff_t>(offset_) + delta, 0);
+    offset_ =
+        static_cast<uint32_t>(static_cast<std::ptrdiff_t>(offset_) + delta);
+  }
+
+  inline core::SourceLocation start(const unicode::Utf8File& file) const {
+    return file.location(offset_);
+  }
+
+  inline core::SourceLocation end(const unicode::Utf8File& file) const {
+    return file.location(end_offset());
+  }
+
+  // length of the returned range is in codepoints
+  inline core::SourceRange range(const unicode::Utf8File& file) const {
+    return core::SourceRange(start(file),
+                             file.codepoint_count(offset_, length_));
+  }
 
   inline const std::u8string_view lexeme_u8(
       const unicode::Utf8File& file) const {
-    return std::u8string_view(file.line_u8(range_.start().line()).data() +
-                                  range_.start().column() - 1,
-                              range_.length());
+    return file.content_u8().substr(offset_, length_);
   }
 
   inline const std::string_view lexeme(const unicode::Utf8File& file) const {
@@ -71,21 +111,22 @@ class BASE_EXPORT Token {
                    std::size_t buf_size) const {
     char* cursor = buf;
     core::write_format(cursor, buf + buf_size, "{} ({})",
-                       token_kind_to_string(kind_),
+                       token_kind_to_string(kind()),
                        std::string_view(lexeme(file)));
   }
 
   inline void dump_detailed(const unicode::Utf8File& file,
                             char* buf,
                             std::size_t buf_size) {
+    const core::SourceLocation location = start(file);
     char* cursor = buf;
     core::write_format(cursor, buf + buf_size,
                        "[token]\n"
                        "kind_str = \"{}\"\nkind_id = {}\n"
                        "lexeme = \"{}\"\nline = {}\ncolumn = {}\n",
-                       token_kind_to_string(kind_),
+                       token_kind_to_string(kind()),
                        std::to_string(static_cast<int8_t>(kind_)), lexeme(file),
-                       range_.start().line(), range_.start().column());
+                       location.line(), location.column());
   }
 
   inline std::string dump(const unicode::Utf8File& file) {
@@ -101,10 +142,15 @@ class BASE_EXPORT Token {
   }
 
  private:
-  core::SourceRange range_;
-  TokenKind kind_ = TokenKind::kUnknown;
+  uint32_t offset_ = 0;
+  uint32_t length_ = 0;
+  // both bitfields share one uint32_t so that msvc packs them as well
+  uint32_t kind_ : 8 = static_cast<uint8_t>(TokenKind::kUnknown);
+  uint32_t symbol_ : 24 = kNoSymbol;
 };
 
+static_assert(sizeof(Token) == 12);
+
 }  // namespace base
 
 #endif  // FRONTEND_BASE_TOKEN_TOKEN_H_
@@ -4,10 +4,14 @@
 
 #include "frontend/base/token/token_stream.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "core/base/source_location.h"
 #include "core/check.h"
 #include "frontend/base/token/token.h"
 #include "unicode/utf8/file.h"
@@ -28,25 +32,108 @@ TokenStream::TokenStream(std::vector<Token>&& tokens,
   DCHECK(!tokens_.empty()) << "TokenStream requires at least one token";
 }
 
+TokenStream::TokenStream(TokenSource source,
+                         unicode::Utf8FileManager* file_manager,
+                         unicode::Utf8FileId file_id,
+                         std::size_t capacity)
+    : TokenStream(std::move(source), capacity) {
+  DCHECK(file_manager);
+  DCHECK_NE(file_id, unicode::kInvalidFileId);
+  file_manager_ = file_manager;
+  file_id_ = file_id;
+}
+
+TokenStream::TokenStream(TokenSource source, std::size_t capacity)
+    : source_(std::move(source)) {
+  DCHECK(source_);
+  // keep at least as many tokens behind the current one as ahead of it
+  capacity = std::bit_ceil(std::max(capacity, 2 * (kStreamLookahead + 1)));
+  tokens_.reserve(capacity);
+  for (std::size_t i = 0; i < capacity; ++i) {
+    tokens_.emplace_back(TokenKind::kEof, 0, 0);
+  }
+  ring_mask_ = capacity - 1;
+  fill_lookahead();
+  current_token_ = &at(0);
+}
+
+void TokenStream::fill_lookahead() {
+  while (!source_exhausted_ && pulled_ <= pos_ + kStreamLookahead) {
+    Token token = source_();
+    source_exhausted_ = token.kind() == TokenKind::kEof;
+    tokens_[pulled_ & ring_mask_] = std::move(token);
+    ++pulled_;
+  }
+}
+
+void TokenStream::splice(std::size_t first,
+                         std::size_t last,
+                         std::vector<Token>&& tokens,
+                         std::ptrdiff_t byte_delta) {
+  DCHECK(!is_streaming());
+  DCHECK_LE(first, last);
+  DCHECK_LT(last, tokens_.size()) << "the eof token can not be replaced";
+
+  // the tail is moved and shifted in one pass, growing or shrinking the
+  // vector in place
+  const std::size_t old_tail = last;
+  const std::size_t new_tail = first + tokens.size();
+  const std::size_t tail_size = tokens_.size() - last;
+  if (new_tail > old_tail) {
+    const std::size_t grow = new_tail - old_tail;
+    for (std::size_t i = 0; i < grow; ++i) {
+      tokens_.emplace_back(TokenKind::kEof, 0, 0);
+    }
+    for (std::size_t i = tail_size; i-- > 0;) {
+      tokens_[new_tail + i] = std::move(tokens_[old_tail + i]);
+      tokens_[new_tail + i].shift(byte_delta);
+    }
+  } else {
+    for (std::size_t i = 0; i < tail_size; ++i) {
+      tokens_[new_tail + i] = std::move(tokens_[old_tail + i]);
+      tokens_[new_tail + i].shift(byte_delta);
+    }
+    tokens_.erase(tokens_.begin() + (new_tail + tail_size), tokens_.end());
+  }
+  std::move(tokens.begin(), tokens.end(), tokens_.begin() + first);
+
+  end_token_ = &tokens_.back();
+  rewind(0);
+}
+
 std::string TokenStream::dump() const {
   std::string result;
   result.append("\n[token_stream]\n");
-  for (const auto& token : tokens_) {
+  const std::size_t first = is_streaming() ? first_retained() : 0;
+  for (std::size_t i = first; i < size(); ++i) {
+    const Token& token = at(i);
     result.append("\n[token_stream.token]\n");
 
     result.append("kind = ");
     result.append(token_kind_to_string(token.kind()));
     result.append("\n");
 
+    if (!has_file()) {
+      // only the offsets are known
+      result.append("offset = ");
+      result.append(std::to_string(token.offset()));
+      result.append("\n");
+      result.append("length = ");
+      result.append(std::to_string(token.length()));
+      result.append("\n");
+      continue;
+    }
+
     result.append("lexeme = ");
     result.append(token.lexeme(file()));
     result.append("\n");
 
+    const core::SourceLocation location = token.start(file());
     result.append("line = ");
-    result.append(std::to_string(token.start().line()));
+    result.append(std::to_string(location.line()));
     result.append("\n");
     result.append("column = ");
-    result.append(std::to_string(token.start().column()));
+    result.append(std::to_string(location.column()));
     result.append("\n");
   }
   return result;
@@ -5,6 +5,8 @@
 #ifndef FRONTEND_BASE_TOKEN_TOKEN_STREAM_H_
 #define FRONTEND_BASE_TOKEN_TOKEN_STREAM_H_
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -19,10 +21,40 @@ namespace base {
 
 class BASE_EXPORT TokenStream {
  public:
+  // produces the next token in streaming mode. once the input is exhausted it
+  // returns a kEof token, after which it is not called again.
+  using TokenSource = std::function<Token()>;
+
+  // tokens that are always available ahead of the current one in streaming
+  // mode, i.e. the maximum offset accepted by peek()
+  static constexpr const std::size_t kStreamLookahead = 16;
+  static constexpr const std::size_t kDefaultStreamCapacity = 4096;
+
   explicit TokenStream(std::vector<Token>&& tokens,
                        unicode::Utf8FileManager* file_manager,
                        unicode::Utf8FileId file_id);
 
+  // streaming mode. tokens are pulled from `source` on demand into a ring
+  // buffer of `capacity` tokens (rounded up to a power of two), so the token
+  // storage does not grow with the input. only the last
+  // `capacity - kStreamLookahead - 1` tokens stay addressable, references to
+  // older tokens are invalidated as the buffer wraps around, and reaching
+  // behind them is a fatal error. the parser only steps back one token.
+  //
+  // this bounds the tokens only. tokens and diagnostics address the source by
+  // byte offset, so the file content and its line table stay resident and
+  // memory is still linear in the size of the input.
+  explicit TokenStream(TokenSource source,
+                       unicode::Utf8FileManager* file_manager,
+                       unicode::Utf8FileId file_id,
+                       std::size_t capacity = kDefaultStreamCapacity);
+
+  // streaming mode over a source that does not keep the file resident, e.g.
+  // a lexer reading a unicode::Utf8Window. file() is not available, tokens
+  // only carry their offsets and the symbols of interned identifiers.
+  explicit TokenStream(TokenSource source,
+                       std::size_t capacity = kDefaultStreamCapacity);
+
   ~TokenStream() = default;
 
   TokenStream() = delete;
@@ -43,14 +75,36 @@ class BASE_EXPORT TokenStream {
                               std::size_t offset) const;
   inline constexpr bool eof() const;
   inline constexpr std::size_t position() const;
+  // in streaming mode, the number of tokens pulled from the source so far
   inline constexpr std::size_t size() const;
+  inline constexpr bool is_streaming() const;
+  inline bool has_file() const;
   inline const unicode::Utf8File& file() const;
   inline unicode::Utf8FileId file_id() const;
+  // token at an absolute position. in streaming mode only retained tokens
+  // are addressable.
+  inline const Token& at(std::size_t pos) const;
+
+  // replaces tokens [first, last) with `tokens` and moves every token behind
+  // them by `byte_delta` bytes, for re-lexing after an edit. not available in
+  // streaming mode. rewinds to position 0.
+  void splice(std::size_t first,
+              std::size_t last,
+              std::vector<Token>&& tokens,
+              std::ptrdiff_t byte_delta);
 
   std::string dump() const;
 
  private:
+  inline constexpr std::size_t first_retained() const;
+  void fill_lookahead();
+
+  // all tokens, or the ring buffer in streaming mode
   std::vector<Token> tokens_;
+  TokenSource source_;
+  std::size_t ring_mask_ = 0;
+  std::size_t pulled_ = 0;
+  bool source_exhausted_ = false;
   unicode::Utf8FileManager* file_manager_ = nullptr;
   unicode::Utf8FileId file_id_ = unicode::kInvalidFileId;
   const Token* current_token_ = nullptr;
@@ -58,18 +112,36 @@ class BASE_EXPORT TokenStream {
   std::size_t pos_ = 0;
 };
 
+inline const Token& TokenStream::at(std::size_t pos) const {
+  if (is_streaming()) [[unlikely]] {
+    CHECK_GE(pos, first_retained()) << "token was evicted from the buffer";
+    CHECK_LT(pos, pulled_) << "token was not pulled from the source yet";
+    return tokens_[pos & ring_mask_];
+  }
+  DCHECK_LT(pos, tokens_.size());
+  return tokens_[pos];
+}
+
 inline const Token& TokenStream::peek(std::size_t offset) const {
-  const std::size_t target_pos = pos_ + offset;
-  DCHECK_LT(target_pos, tokens_.size());
-  return tokens_[target_pos];
+  if (is_streaming()) [[unlikely]] {
+    CHECK_LE(offset, kStreamLookahead) << "peek past the streaming lookahead";
+  }
+  return at(pos_ + offset);
 }
 
 inline const Token& TokenStream::previous() const {
   DCHECK_GT(pos_, 0) << "previous token not found";
-  return tokens_[pos_ - 1];
+  return at(pos_ - 1);
 }
 
 inline const Token& TokenStream::next() {
+  if (is_streaming()) [[unlikely]] {
+    DCHECK(!eof()) << "reached eof token unexpectedly";
+    ++pos_;
+    fill_lookahead();
+    current_token_ = &at(pos_);
+    return *current_token_;
+  }
   DCHECK_NE(current_token_, end_token_) << "reached eof token unexpectedly";
   ++pos_;
   current_token_ = &tokens_[pos_];
@@ -86,9 +158,9 @@ inline bool TokenStream::match(TokenKind expected_kind) {
 }
 
 inline constexpr void TokenStream::rewind(std::size_t pos) {
-  DCHECK_LE(pos, tokens_.size()) << "rewind range is invalid";
+  DCHECK_LE(pos, size()) << "rewind range is invalid";
   pos_ = pos;
-  current_token_ = &tokens_[pos_];
+  current_token_ = &at(pos_);
 }
 
 inline constexpr bool TokenStream::check(TokenKind expected_kind) const {
@@ -110,10 +182,24 @@ inline constexpr std::size_t TokenStream::position() const {
 }
 
 inline constexpr std::size_t TokenStream::size() const {
-  return tokens_.size();
+  return is_streaming() ? pulled_ : tokens_.size();
+}
+
+inline constexpr bool TokenStream::is_streaming() const {
+  return ring_mask_ != 0;
+}
+
+inline constexpr std::size_t TokenStream::first_retained() const {
+  const std::size_t retained = tokens_.size() - kStreamLookahead - 1;
+  return pulled_ > retained ? pulled_ - retained : 0;
+}
+
+inline bool TokenStream::has_file() const {
+  return file_manager_ != nullptr;
 }
 
 inline const unicode::Utf8File& TokenStream::file() const {
+  DCHECK(has_file()) << "the stream was created without a file";
   return file_manager_->loaded_file(file_id_);
 }
 
@@ -5,6 +5,7 @@
 #include "frontend/base/token/token_stream.h"
 
 #include <cstddef>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -20,10 +21,10 @@ TEST(TokenStreamTest, BasicNextAndPeek) {
   unicode::Utf8FileId file_id = manager.register_virtual_file(u8"x + 42");
   const unicode::Utf8File& file = manager.file(file_id);
 
-  tokens.emplace_back(TokenKind::kIdentifier, 1, 1, 1);
-  tokens.emplace_back(TokenKind::kPlus, 1, 3, 1);
-  tokens.emplace_back(TokenKind::kDecimal, 1, 5, 2);
-  tokens.emplace_back(TokenKind::kEof, 1, 7, 0);
+  tokens.emplace_back(TokenKind::kIdentifier, 0, 1);
+  tokens.emplace_back(TokenKind::kPlus, 2, 1);
+  tokens.emplace_back(TokenKind::kDecimal, 4, 2);
+  tokens.emplace_back(TokenKind::kEof, 6, 0);
 
   TokenStream stream(std::move(tokens), &manager, file_id);
 
@@ -46,9 +47,9 @@ TEST(TokenStreamTest, RewindWorks) {
   unicode::Utf8FileId file_id = manager.register_virtual_file(u8"foo 1");
   const unicode::Utf8File& file = manager.file(file_id);
 
-  tokens.emplace_back(TokenKind::kIdentifier, 1, 1, 3);
-  tokens.emplace_back(TokenKind::kDecimal, 1, 5, 1);
-  tokens.emplace_back(TokenKind::kEof, 1, 6, 0);
+  tokens.emplace_back(TokenKind::kIdentifier, 0, 3);
+  tokens.emplace_back(TokenKind::kDecimal, 4, 1);
+  tokens.emplace_back(TokenKind::kEof, 5, 0);
 
   TokenStream stream(std::move(tokens), &manager, file_id);
 
@@ -61,4 +62,109 @@ TEST(TokenStreamTest, RewindWorks) {
   EXPECT_EQ(stream.peek().lexeme(file), "1");
 }
 
+TEST(TokenStreamTest, SpliceReplacesTokensAndShiftsTheTail) {
+  // "x + 42" edited to "x - y - 42" and back
+  unicode::Utf8FileManager manager;
+  unicode::Utf8FileId file_id = manager.register_virtual_file(u8"x - y - 42");
+  const unicode::Utf8File& file = manager.file(file_id);
+
+  std::vector<Token> tokens;
+  tokens.emplace_back(TokenKind::kIdentifier, 0, 1);
+  tokens.emplace_back(TokenKind::kPlus, 2, 1);
+  tokens.emplace_back(TokenKind::kDecimal, 4, 2);
+  tokens.emplace_back(TokenKind::kEof, 6, 0);
+  TokenStream stream(std::move(tokens), &manager, file_id);
+  stream.next();
+
+  std::vector<Token> replacement;
+  replacement.emplace_back(TokenKind::kMinus, 2, 1);
+  replacement.emplace_back(TokenKind::kIdentifier, 4, 1);
+  replacement.emplace_back(TokenKind::kMinus, 6, 1);
+  stream.splice(1, 2, std::move(replacement), 4);
+
+  ASSERT_EQ(stream.size(), 6u);
+  EXPECT_EQ(stream.position(), 0u);
+  EXPECT_EQ(stream.peek(2).lexeme(file), "y");
+  EXPECT_EQ(stream.peek(4).kind(), TokenKind::kDecimal);
+  EXPECT_EQ(stream.peek(4).lexeme(file), "42");
+  EXPECT_EQ(stream.peek(5).offset(), 10u);
+
+  replacement.clear();
+  replacement.emplace_back(TokenKind::kPlus, 2, 1);
+  stream.splice(1, 4, std::move(replacement), -4);
+
+  ASSERT_EQ(stream.size(), 4u);
+  EXPECT_EQ(stream.peek(1).kind(), TokenKind::kPlus);
+  EXPECT_EQ(stream.peek(2).offset(), 4u);
+  EXPECT_EQ(stream.peek(3).kind(), TokenKind::kEof);
+  EXPECT_EQ(stream.peek(3).offset(), 6u);
+}
+
+TEST(TokenStreamTest, StreamingPullsOnDemand) {
+  unicode::Utf8FileManager manager;
+  unicode::Utf8FileId file_id = manager.register_virtual_file(u8"x + 42");
+  const unicode::Utf8File& file = manager.file(file_id);
+
+  std::size_t pulled = 0;
+  auto source = [&pulled]() {
+    ++pulled;
+    switch (pulled) {
+      case 1: return Token(TokenKind::kIdentifier, 0, 1);
+      case 2: return Token(TokenKind::kPlus, 2, 1);
+      case 3: return Token(TokenKind::kDecimal, 4, 2);
+      default: return Token(TokenKind::kEof, 6, 0);
+    }
+  };
+
+  TokenStream stream(source, &manager, file_id);
+  EXPECT_TRUE(stream.is_streaming());
+  // the source is not called again after eof
+  EXPECT_EQ(pulled, 4u);
+  EXPECT_EQ(stream.size(), 4u);
+
+  EXPECT_EQ(stream.peek().lexeme(file), "x");
+  EXPECT_EQ(stream.peek(2).lexeme(file), "42");
+  EXPECT_EQ(stream.next().kind(), TokenKind::kPlus);
+  EXPECT_EQ(stream.previous().kind(), TokenKind::kIdentifier);
+  EXPECT_EQ(stream.next().kind(), TokenKind::kDecimal);
+  EXPECT_EQ(stream.next().kind(), TokenKind::kEof);
+  EXPECT_TRUE(stream.eof());
+  EXPECT_EQ(pulled, 4u);
+}
+
+TEST(TokenStreamTest, StreamingBoundedByCapacity) {
+  std::u8string source;
+  constexpr const std::size_t kCount = 10000;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    source.append(u8"a ");
+  }
+  unicode::Utf8FileManager manager;
+  unicode::Utf8FileId file_id =
+      manager.register_virtual_file(std::move(source));
+
+  std::size_t pulled = 0;
+  auto token_source = [&pulled]() {
+    const std::size_t index = pulled++;
+    if (index == kCount) {
+      return Token(TokenKind::kEof, index * 2, 0);
+    }
+    return Token(TokenKind::kIdentifier, index * 2, 1);
+  };
+
+  TokenStream stream(token_source, &manager, file_id, 64);
+  std::size_t seen = 0;
+  while (!stream.eof()) {
+    EXPECT_EQ(stream.peek().offset(), seen * 2);
+    // never more than the lookahead is pulled ahead of the consumer
+    EXPECT_LE(pulled, seen + TokenStream::kStreamLookahead + 1);
+    stream.next();
+    ++seen;
+  }
+  EXPECT_EQ(seen, kCount);
+
+  // rewinding within the retained window still works
+  stream.rewind(kCount - 10);
+  EXPECT_EQ(stream.peek().offset(), (kCount - 10) * 2);
+}
+
 }  // namespace base
@@ -14,11 +14,11 @@ TEST(TokenTest, BasicConstruction) {
   unicode::Utf8FileManager manager;
   auto file_id = manager.register_virtual_file(u8"if");
   const unicode::Utf8File& file = manager.file(file_id);
-  Token tok(TokenKind::kIf, core::SourceLocation(1, 1), 2);
+  Token tok(TokenKind::kIf, 0, 2);
   EXPECT_EQ(tok.kind(), TokenKind::kIf);
   EXPECT_EQ(tok.lexeme(file), "if");
-  EXPECT_EQ(tok.start().line(), 1);
-  EXPECT_EQ(tok.start().column(), 1);
+  EXPECT_EQ(tok.start(file).line(), 1);
+  EXPECT_EQ(tok.start(file).column(), 1);
   EXPECT_EQ(file_id, 0);
   EXPECT_FALSE(file.file_name().empty());
 
@@ -26,4 +26,27 @@ TEST(TokenTest, BasicConstruction) {
   EXPECT_FALSE(tok.dump_detailed(file).empty());
 }
 
+TEST(TokenTest, CompactLayout) {
+  EXPECT_EQ(sizeof(Token), 12);
+}
+
+TEST(TokenTest, LazyLocation) {
+  unicode::Utf8FileManager manager;
+  auto file_id = manager.register_virtual_file(u8"x\nあい := 1");
+  const unicode::Utf8File& file = manager.file(file_id);
+
+  // `:=` starts after "x\n" (2 bytes) + "あい " (7 bytes)
+  Token tok(TokenKind::kColonEqual, 9, 2);
+  EXPECT_EQ(tok.lexeme(file), ":=");
+  EXPECT_EQ(tok.start(file).line(), 2);
+  EXPECT_EQ(tok.start(file).column(), 4);
+  EXPECT_EQ(tok.end(file).column(), 6);
+
+  // multibyte identifier, range length is in codepoints
+  Token ident(TokenKind::kIdentifier, 2, 6);
+  EXPECT_EQ(ident.lexeme(file), "あい");
+  EXPECT_EQ(ident.range(file).start().column(), 1);
+  EXPECT_EQ(ident.range(file).length(), 2);
+}
+
 }  // namespace base
@@ -5,12 +5,17 @@
 #ifndef FRONTEND_DATA_AST_CONTEXT_H_
 #define FRONTEND_DATA_AST_CONTEXT_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "frontend/base/data/arena.h"
+#include "frontend/base/data/arena_profile.h"
+#include "frontend/base/data/region.h"
 #include "frontend/data/ast/base/ast_export.h"
 #include "frontend/data/ast/base/node.h"
 #include "frontend/data/ast/base/node_id.h"
@@ -30,8 +35,10 @@ class AST_EXPORT Context {
   Context(const Context&) = delete;
   Context& operator=(const Context&) = delete;
 
+  // move assignment would free the region before the arenas that still
+  // point into it, contexts are handed around by unique_ptr instead
   Context(Context&&) noexcept = default;
-  Context& operator=(Context&&) noexcept = default;
+  Context& operator=(Context&&) = delete;
 
   template <typename T>
   inline constexpr base::Arena<T>& arena();
@@ -60,10 +67,173 @@ class AST_EXPORT Context {
     return arena<T>()[id];
   }
 
+  // a NodeRange indexes this flat child array rather than the node arena, so
+  // the children of one list are contiguous however deeply they nest
+  inline NodeRange alloc_children(std::span<const NodeId> ids) {
+    if (ids.empty()) {
+      return NodeRange{};
+    }
+    const NodeId begin = static_cast<NodeId>(children_.size());
+    children_.insert(children_.end(), ids.begin(), ids.end());
+    return NodeRange{
+        .begin = begin,
+        .size = static_cast<uint32_t>(ids.size()),
+    };
+  }
+
+  inline std::span<const NodeId> children(NodeRange range) const {
+    if (!range.valid()) {
+      return {};
+    }
+    return std::span<const NodeId>(children_).subspan(range.begin, range.size);
+  }
+
+  inline const std::vector<NodeId>& children() const { return children_; }
+
+  // top-level items of the file in source order
+  inline void add_root(NodeId id) { roots_.push_back(id); }
+  inline void set_roots(std::vector<NodeId>&& roots) {
+    roots_ = std::move(roots);
+  }
+  inline const std::vector<NodeId>& roots() const { return roots_; }
+
+  // turns the payload ids of one list into a PayloadRange. ids allocated back
+  // to back are used as is, otherwise (a nested list of the same payload type
+  // was allocated in between) the elements are copied to the arena's end.
+  // the originals are then left behind as dead payloads, so such a list costs
+  // its elements twice. only lists that nest a list of their own type pay
+  // this, e.g. if branches around an inner if or nested tuple types.
+  template <typename T>
+  inline PayloadRange<T> alloc_payload_range(std::span<const uint32_t> ids) {
+    if (ids.empty()) {
+      return PayloadRange<T>{};
+    }
+
+    bool contiguous = true;
+    for (std::size_t i = 1; i < ids.size(); ++i) {
+      if (ids[i] != ids[0] + i) {
+        contiguous = false;
+        break;
+      }
+    }
+
+    uint32_t begin = ids[0];
+    if (!contiguous) {
+      base::Arena<T>& a = arena<T>();
+      begin = static_cast<uint32_t>(a.size());
+      for (const uint32_t id : ids) {
+        T copy = a[id];
+        a.alloc(std::move(copy));
+      }
+    }
+    return PayloadRange<T>{
+        .begin = PayloadId<T>(begin),
+        .size = static_cast<uint32_t>(ids.size()),
+    };
+  }
+
+  // calls f(name, arena) for every arena, in a fixed order. names are the
+  // profile and serialization keys.
+  template <typename F>
+  inline void for_each_arena(F&& f) {
+    visit_arenas(*this, f);
+  }
+  template <typename F>
+  inline void for_each_arena(F&& f) const {
+    visit_arenas(*this, f);
+  }
+
+  // reserves every arena for an input of `units` source lines, from the
+  // average usage of earlier runs
+  inline void reserve_from(const base::ArenaProfile& profile,
+                           std::size_t units) {
+    for_each_arena([&](std::string_view name, auto& arena) {
+      arena.reserve(profile.estimate(name, units));
+    });
+  }
+
+  inline void record_usage(base::ArenaProfile* profile, std::size_t units) {
+    for_each_arena([&](std::string_view name, auto& arena) {
+      profile->record(name, arena.size(), units);
+    });
+  }
+
  private:
-  Context() = default;
+  // every arena allocates from one region, so a context costs a few chunk
+  // allocations and a single teardown however many arenas it has
+  Context() : region_(std::make_unique<base::Region>()) {
+    for_each_arena([this](std::string_view, auto& arena) {
+      if constexpr (requires { arena.use_region(region_.get()); }) {
+        arena.use_region(region_.get());
+      }
+    });
+  }
+
+  template <typename Self, typename F>
+  static void visit_arenas(Self& self, F& f) {
+    f("ast.nodes", self.nodes_);
+    f("ast.children", self.children_);
+    f("ast.roots", self.roots_);
+    f("ast.literal_expression_payloads", self.literal_expression_payloads_);
+    f("ast.path_expression_payloads", self.path_expression_payloads_);
+    f("ast.unary_expression_payloads", self.unary_expression_payloads_);
+    f("ast.binary_expression_payloads", self.binary_expression_payloads_);
+    f("ast.grouped_expression_payloads", self.grouped_expression_payloads_);
+    f("ast.array_expression_payloads", self.array_expression_payloads_);
+    f("ast.tuple_expression_payloads", self.tuple_expression_payloads_);
+    f("ast.index_expression_payloads", self.index_expression_payloads_);
+    f("ast.construct_expression_payloads", self.construct_expression_payloads_);
+    f("ast.function_call_expression_payloads",
+      self.function_call_expression_payloads_);
+    f("ast.method_call_expression_payloads",
+      self.method_call_expression_payloads_);
+    f("ast.fn_macro_call_expr_payloads", self.fn_macro_call_expr_payloads_);
+    f("ast.mt_macro_call_expr_payloads", self.mt_macro_call_expr_payloads_);
+    f("ast.field_access_expression_payloads",
+      self.field_access_expression_payloads_);
+    f("ast.await_expression_payloads", self.await_expression_payloads_);
+    f("ast.continue_expression_payloads", self.continue_expression_payloads_);
+    f("ast.break_expression_payloads", self.break_expression_payloads_);
+    f("ast.range_expression_payloads", self.range_expression_payloads_);
+    f("ast.return_expression_payloads", self.return_expression_payloads_);
+    f("ast.block_expression_payloads", self.block_expression_payloads_);
+    f("ast.if_expression_payloads", self.if_expression_payloads_);
+    f("ast.loop_expression_payloads", self.loop_expression_payloads_);
+    f("ast.while_expression_payloads", self.while_expression_payloads_);
+    f("ast.for_expression_payloads", self.for_expression_payloads_);
+    f("ast.match_expression_payloads", self.match_expression_payloads_);
+    f("ast.closure_expression_payloads", self.closure_expression_payloads_);
+    f("ast.assign_statement_payloads", self.assign_statement_payloads_);
+    f("ast.attribute_statement_payloads", self.attribute_statement_payloads_);
+    f("ast.use_statement_payloads", self.use_statement_payloads_);
+    f("ast.function_declaration_payloads", self.function_declaration_payloads_);
+    f("ast.struct_declaration_payloads", self.struct_declaration_payloads_);
+    f("ast.enumeration_declaration_payloads",
+      self.enumeration_declaration_payloads_);
+    f("ast.trait_declaration_payloads", self.trait_declaration_payloads_);
+    f("ast.impl_declaration_payloads", self.impl_declaration_payloads_);
+    f("ast.redirect_declaration_payloads", self.redirect_declaration_payloads_);
+    f("ast.union_declaration_payloads", self.union_declaration_payloads_);
+    f("ast.module_declaration_payloads", self.module_declaration_payloads_);
+    f("ast.attribute_use_payloads", self.attribute_use_payloads_);
+    f("ast.capture_payloads", self.capture_payloads_);
+    f("ast.field_payloads", self.field_payloads_);
+    f("ast.parameter_payloads", self.parameter_payloads_);
+    f("ast.enum_variant_payloads", self.enum_variant_payloads_);
+    f("ast.type_reference_payloads", self.type_reference_payloads_);
+    f("ast.array_type_payloads", self.array_type_payloads_);
+    f("ast.identifier_payloads", self.identifier_payloads_);
+    f("ast.if_branch_payloads", self.if_branch_payloads_);
+    f("ast.match_arm_payloads", self.match_arm_payloads_);
+  }
+
+
+  // declared first so it outlives the arenas
+  std::unique_ptr<base::Region> region_;
 
   base::Arena<Node> nodes_;
+  std::vector<NodeId> children_;
+  std::vector<NodeId> roots_;
 
   base::Arena<LiteralExpressionPayload> literal_expression_payloads_;
   base::Arena<PathExpressionPayload> path_expression_payloads_;
@@ -53,7 +53,6 @@ struct EnumVariantPayload {
     PayloadRange<TypeReferencePayload> types;
 
     Data() {}
-    ~Data() {}
   } data;
 
   explicit EnumVariantPayload(PayloadId<PathExpressionPayload> name)
@@ -87,7 +86,6 @@ struct TypeReferencePayload {
     PayloadId<ArrayTypePayload> array_id;
 
     Data() {}
-    ~Data() {}
   } data;
 
   explicit TypeReferencePayload(base::PrimitiveType type)
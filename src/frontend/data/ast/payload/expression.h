@@ -6,8 +6,8 @@
 #define FRONTEND_DATA_AST_PAYLOAD_EXPRESSION_H_
 
 #include <cstddef>
+#include <cstdint>
 
-#include "core/base/source_range.h"
 #include "frontend/base/keyword/type.h"
 #include "frontend/base/literal/literal.h"
 #include "frontend/base/operator/binary_operator.h"
@@ -18,9 +18,12 @@
 
 namespace ast {
 
+// the lexeme is kept as a byte range of the source file, so it is sliced out
+// of the content in O(1) and resolved to a line and column only on demand
 struct LiteralExpressionPayload {
   base::LiteralKind kind = base::LiteralKind::kUnknown;
-  core::SourceRange lexeme_range;
+  uint32_t lexeme_offset = 0;
+  uint32_t lexeme_length = 0;
 };
 
 struct PathExpressionPayload {
@@ -0,0 +1,545 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/data/ast/serialization.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "frontend/base/string/string_hash.h"
+#include "frontend/base/string/string_id.h"
+#include "frontend/base/keyword/type.h"
+#include "frontend/base/string/string_interner.h"
+#include "frontend/data/ast/base/node.h"
+#include "frontend/data/ast/payload/data.h"
+
+namespace ast {
+
+namespace {
+
+// "RAST" read as a little-endian word, a byte-swapped magic means the file
+// was written on a machine with the other endianness
+constexpr uint32_t kMagic = 0x54534152;
+constexpr std::size_t kSectionAlignment = 8;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t source_hash;
+  uint32_t section_count;
+  uint32_t string_count;
+  uint64_t strings_offset;
+};
+
+// one per arena, in Context::for_each_arena order
+struct SectionHeader {
+  uint64_t name_hash;
+  uint32_t element_size;
+  uint32_t count;
+  uint64_t offset;
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+static_assert(std::is_trivially_copyable_v<SectionHeader>);
+
+template <typename Container>
+using ElementOf = std::remove_cvref_t<decltype(std::declval<Container&>()[0])>;
+
+std::size_t section_count(const Context& context) {
+  std::size_t count = 0;
+  context.for_each_arena([&](std::string_view, const auto&) { ++count; });
+  return count;
+}
+
+inline void pad_to(std::string* out, std::size_t alignment) {
+  out->resize((out->size() + alignment - 1) & ~(alignment - 1), '\0');
+}
+
+template <typename T>
+inline void write_at(std::string* out, std::size_t offset, const T& value) {
+  std::memcpy(out->data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+inline bool read_at(std::string_view data, std::size_t offset, T* value) {
+  if (offset > data.size() || data.size() - offset < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(value, data.data() + offset, sizeof(T));
+  return true;
+}
+
+// bounds of every id a loaded context refers to. the data may come from a
+// damaged or foreign cache file, so it is checked as a whole before anything
+// indexes an arena with it.
+class IdChecker {
+ public:
+  IdChecker(Context* context, std::size_t string_count)
+      : context_(context), string_count_(string_count) {}
+
+  inline bool node(NodeId id) const {
+    return id < context_->arena<Node>().size();
+  }
+  inline bool optional_node(NodeId id) const {
+    return id == kInvalidNodeId || node(id);
+  }
+  inline bool nodes(NodeRange range) const {
+    return !range.valid() || uint64_t{range.begin} + range.size <=
+                                 context_->children().size();
+  }
+
+  template <typename T>
+  inline bool has(uint32_t id) const {
+    return id < context_->arena<T>().size();
+  }
+  template <typename T>
+  inline bool payload(PayloadId<T> id) const {
+    return !id.valid() || has<T>(id.id);
+  }
+  template <typename T>
+  inline bool payloads(PayloadRange<T> range) const {
+    return !range.valid() ||
+           uint64_t{range.begin.id} + range.size <= context_->arena<T>().size();
+  }
+
+  inline bool string(base::StringId id) const { return id < string_count_; }
+
+ private:
+  Context* context_;
+  std::size_t string_count_;
+};
+
+bool check(const IdChecker& c, const Node& node) {
+  switch (node.kind) {
+    using Kind = NodeKind;
+    case Kind::kUnknown: return true;
+    case Kind::kAssignStatement:
+      return c.has<AssignStatementPayload>(node.payload_id);
+    case Kind::kAttributeStatement:
+      return c.has<AttributeStatementPayload>(node.payload_id);
+    case Kind::kUseStatement:
+      return c.has<UseStatementPayload>(node.payload_id);
+    case Kind::kLiteralExpression:
+      return c.has<LiteralExpressionPayload>(node.payload_id);
+    case Kind::kPathExpression:
+      return c.has<PathExpressionPayload>(node.payload_id);
+    case Kind::kUnaryExpression:
+      return c.has<UnaryExpressionPayload>(node.payload_id);
+    case Kind::kBinaryExpression:
+      return c.has<BinaryExpressionPayload>(node.payload_id);
+    case Kind::kGroupedExpression:
+      return c.has<GroupedExpressionPayload>(node.payload_id);
+    case Kind::kArrayExpression:
+      return c.has<ArrayExpressionPayload>(node.payload_id);
+    case Kind::kTupleExpression:
+      return c.has<TupleExpressionPayload>(node.payload_id);
+    case Kind::kIndexExpression:
+      return c.has<IndexExpressionPayload>(node.payload_id);
+    case Kind::kConstructExpression:
+      return c.has<ConstructExpressionPayload>(node.payload_id);
+    case Kind::kFunctionCallExpression:
+      return c.has<FunctionCallExpressionPayload>(node.payload_id);
+    case Kind::kMethodCallExpression:
+      return c.has<MethodCallExpressionPayload>(node.payload_id);
+    case Kind::kFunctionMacroCallExpression:
+      return c.has<FunctionMacroCallExpressionPayload>(node.payload_id);
+    case Kind::kMethodMacroCallExpression:
+      return c.has<MethodMacroCallExpressionPayload>(node.payload_id);
+    case Kind::kFieldAccessExpression:
+      return c.has<FieldAccessExpressionPayload>(node.payload_id);
+    case Kind::kAwaitExpression:
+      return c.has<AwaitExpressionPayload>(node.payload_id);
+    case Kind::kContinueExpression:
+      return c.has<ContinueExpressionPayload>(node.payload_id);
+    case Kind::kBreakExpression:
+      return c.has<BreakExpressionPayload>(node.payload_id);
+    case Kind::kRangeExpression:
+      return c.has<RangeExpressionPayload>(node.payload_id);
+    case Kind::kReturnExpression:
+      return c.has<ReturnExpressionPayload>(node.payload_id);
+    case Kind::kBlockExpression:
+      return c.has<BlockExpressionPayload>(node.payload_id);
+    case Kind::kIfExpression:
+      return c.has<IfExpressionPayload>(node.payload_id);
+    case Kind::kLoopExpression:
+      return c.has<LoopExpressionPayload>(node.payload_id);
+    case Kind::kWhileExpression:
+      return c.has<WhileExpressionPayload>(node.payload_id);
+    case Kind::kForExpression:
+      return c.has<ForExpressionPayload>(node.payload_id);
+    case Kind::kMatchExpression:
+      return c.has<MatchExpressionPayload>(node.payload_id);
+    case Kind::kClosureExpression:
+      return c.has<ClosureExpressionPayload>(node.payload_id);
+    case Kind::kFunctionDeclaration:
+      return c.has<FunctionDeclarationPayload>(node.payload_id);
+    case Kind::kStructDeclaration:
+      return c.has<StructDeclarationPayload>(node.payload_id);
+    case Kind::kEnumDeclaration:
+      return c.has<EnumerationDeclarationPayload>(node.payload_id);
+    case Kind::kTraitDeclaration:
+      return c.has<TraitDeclarationPayload>(node.payload_id);
+    case Kind::kImplDeclaration:
+      return c.has<ImplementationDeclarationPayload>(node.payload_id);
+    case Kind::kUnionDeclaration:
+      return c.has<UnionDeclarationPayload>(node.payload_id);
+    case Kind::kModuleDeclaration:
+      return c.has<ModuleDeclarationPayload>(node.payload_id);
+    case Kind::kRedirectDeclaration:
+      return c.has<RedirectDeclarationPayload>(node.payload_id);
+  }
+  // a kind this build does not know
+  return false;
+}
+
+// entries of the children and roots arrays
+inline bool check(const IdChecker& c, NodeId id) { return c.node(id); }
+
+inline bool check(const IdChecker&, const LiteralExpressionPayload&) {
+  return true;
+}
+inline bool check(const IdChecker& c, const PathExpressionPayload& p) {
+  return c.payloads(p.path_parts_range);
+}
+inline bool check(const IdChecker& c, const UnaryExpressionPayload& p) {
+  return c.optional_node(p.operand);
+}
+inline bool check(const IdChecker& c, const BinaryExpressionPayload& p) {
+  return c.optional_node(p.lhs) && c.optional_node(p.rhs);
+}
+inline bool check(const IdChecker& c, const GroupedExpressionPayload& p) {
+  return c.optional_node(p.expression);
+}
+inline bool check(const IdChecker& c, const ArrayExpressionPayload& p) {
+  return c.nodes(p.array_elements_range);
+}
+inline bool check(const IdChecker& c, const TupleExpressionPayload& p) {
+  return c.nodes(p.tuple_elements_range);
+}
+inline bool check(const IdChecker& c, const IndexExpressionPayload& p) {
+  return c.optional_node(p.operand) && c.optional_node(p.index);
+}
+inline bool check(const IdChecker& c, const ConstructExpressionPayload& p) {
+  return c.optional_node(p.type_path) && c.nodes(p.args_range);
+}
+inline bool check(const IdChecker& c, const FunctionCallExpressionPayload& p) {
+  return c.optional_node(p.callee) && c.nodes(p.args_range);
+}
+inline bool check(const IdChecker& c, const MethodCallExpressionPayload& p) {
+  return c.optional_node(p.obj) && c.payload(p.method) &&
+         c.nodes(p.args_range);
+}
+inline bool check(const IdChecker& c,
+                  const FunctionMacroCallExpressionPayload& p) {
+  return c.optional_node(p.macro_callee) && c.nodes(p.args_range);
+}
+inline bool check(const IdChecker& c,
+                  const MethodMacroCallExpressionPayload& p) {
+  return c.optional_node(p.obj) && c.payload(p.macro_method) &&
+         c.nodes(p.args_range);
+}
+inline bool check(const IdChecker& c, const FieldAccessExpressionPayload& p) {
+  return c.optional_node(p.obj) && c.payload(p.field);
+}
+inline bool check(const IdChecker& c, const AwaitExpressionPayload& p) {
+  return c.optional_node(p.callee_expression);
+}
+inline bool check(const IdChecker& c, const ContinueExpressionPayload& p) {
+  return c.optional_node(p.expression);
+}
+inline bool check(const IdChecker& c, const BreakExpressionPayload& p) {
+  return c.optional_node(p.expression);
+}
+inline bool check(const IdChecker& c, const RangeExpressionPayload& p) {
+  return c.optional_node(p.begin) && c.optional_node(p.end);
+}
+inline bool check(const IdChecker& c, const ReturnExpressionPayload& p) {
+  return c.optional_node(p.expression);
+}
+inline bool check(const IdChecker& c, const BlockExpressionPayload& p) {
+  return c.nodes(p.body_nodes_range);
+}
+inline bool check(const IdChecker& c, const IfExpressionPayload& p) {
+  return c.payloads(p.branches_range);
+}
+inline bool check(const IdChecker& c, const LoopExpressionPayload& p) {
+  return c.payload(p.body);
+}
+inline bool check(const IdChecker& c, const WhileExpressionPayload& p) {
+  return c.optional_node(p.condition) && c.payload(p.body);
+}
+inline bool check(const IdChecker& c, const ForExpressionPayload& p) {
+  return c.payload(p.iterator) && c.optional_node(p.range) &&
+         c.payload(p.body);
+}
+inline bool check(const IdChecker& c, const MatchExpressionPayload& p) {
+  return c.optional_node(p.expression) && c.payloads(p.arms_range);
+}
+inline bool check(const IdChecker& c, const ClosureExpressionPayload& p) {
+  return c.payloads(p.captures_range) && c.payloads(p.parameters_range) &&
+         c.optional_node(p.body);
+}
+
+inline bool check(const IdChecker& c, const AssignStatementPayload& p) {
+  return c.payload(p.target_variable) && c.payload(p.target_type) &&
+         c.optional_node(p.value_expression);
+}
+inline bool check(const IdChecker& c, const AttributeStatementPayload& p) {
+  return c.payloads(p.attributes_range);
+}
+inline bool check(const IdChecker& c, const UseStatementPayload& p) {
+  return c.payloads(p.use_paths_range);
+}
+inline bool check(const IdChecker& c, const FunctionDeclarationPayload& p) {
+  return c.payload(p.name) && c.payloads(p.parameters_range) &&
+         c.payload(p.return_type) && c.payload(p.body);
+}
+inline bool check(const IdChecker& c, const StructDeclarationPayload& p) {
+  return c.payload(p.name) && c.payloads(p.fields_range);
+}
+inline bool check(const IdChecker& c,
+                  const EnumerationDeclarationPayload& p) {
+  return c.payload(p.name) && c.payloads(p.variants_range);
+}
+inline bool check(const IdChecker& c, const TraitDeclarationPayload& p) {
+  return c.payload(p.name) && c.nodes(p.function_declare_range);
+}
+inline bool check(const IdChecker& c,
+                  const ImplementationDeclarationPayload& p) {
+  return c.payload(p.target_name) && c.payload(p.trait_name) &&
+         c.nodes(p.function_definition_range);
+}
+inline bool check(const IdChecker& c, const RedirectDeclarationPayload& p) {
+  return c.payload(p.name) && c.payload(p.target);
+}
+inline bool check(const IdChecker& c, const UnionDeclarationPayload& p) {
+  return c.payload(p.name) && c.payloads(p.fields_range);
+}
+inline bool check(const IdChecker& c, const ModuleDeclarationPayload& p) {
+  return c.payload(p.name) && c.nodes(p.module_nodes_range);
+}
+
+inline bool check(const IdChecker& c, const AttributeUsePayload& p) {
+  return c.payload(p.callee) && c.nodes(p.args_range);
+}
+inline bool check(const IdChecker& c, const CapturePayload& p) {
+  return c.payload(p.capture_name) && c.payload(p.type);
+}
+inline bool check(const IdChecker& c, const FieldPayload& p) {
+  return c.payload(p.field_name) && c.payload(p.type);
+}
+inline bool check(const IdChecker& c, const ParameterPayload& p) {
+  return c.payload(p.param_name) && c.payload(p.type);
+}
+bool check(const IdChecker& c, const EnumVariantPayload& p) {
+  if (!c.payload(p.variant_name)) {
+    return false;
+  }
+  switch (p.type) {
+    using Type = EnumVariantPayload::VariantType;
+    case Type::kEmpty: return true;
+    case Type::kInteger: return c.optional_node(p.data.int_expr);
+    case Type::kStructLike: return c.payloads(p.data.fields);
+    case Type::kTupleLike: return c.payloads(p.data.types);
+  }
+  return false;
+}
+bool check(const IdChecker& c, const TypeReferencePayload& p) {
+  switch (p.category) {
+    using Category = base::TypeCategory;
+    case Category::kUnknown: return true;
+    case Category::kPrimitive: return true;
+    case Category::kUserDefined: return c.payload(p.data.user_defined_name);
+    case Category::kArray: return c.payload(p.data.array_id);
+  }
+  return false;
+}
+inline bool check(const IdChecker& c, const ArrayTypePayload& p) {
+  return c.payload(p.type) && c.optional_node(p.array_size_expr);
+}
+// still an index into the string table of the file
+inline bool check(const IdChecker& c, const IdentifierPayload& p) {
+  return c.string(p.id);
+}
+inline bool check(const IdChecker& c, const IfBranchPayload& p) {
+  return c.optional_node(p.condition) && c.payload(p.block);
+}
+inline bool check(const IdChecker& c, const MatchArmPayload& p) {
+  return c.optional_node(p.pattern) && c.optional_node(p.expression);
+}
+
+}  // namespace
+
+std::string serialize(const Context& context,
+                      const base::StringInterner& interner,
+                      uint64_t source_hash) {
+  const std::size_t sections = section_count(context);
+
+  std::string out(sizeof(FileHeader) + sections * sizeof(SectionHeader), '\0');
+
+  // identifiers point into a file-local string table
+  std::vector<std::string_view> strings;
+  std::unordered_map<base::StringId, uint32_t> string_index;
+  auto local_id = [&](base::StringId id) {
+    auto [it, inserted] =
+        string_index.try_emplace(id, static_cast<uint32_t>(strings.size()));
+    if (inserted) {
+      strings.push_back(interner.lookup(id));
+    }
+    return it->second;
+  };
+
+  std::size_t section = 0;
+  context.for_each_arena([&](std::string_view name, const auto& arena) {
+    using T = ElementOf<decltype(arena)>;
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "ast payloads must stay trivially copyable");
+    static_assert(alignof(T) <= kSectionAlignment);
+
+    pad_to(&out, kSectionAlignment);
+    const SectionHeader header = {
+        .name_hash = base::hash_string(name),
+        .element_size = static_cast<uint32_t>(sizeof(T)),
+        .count = static_cast<uint32_t>(arena.size()),
+        .offset = out.size(),
+    };
+    write_at(&out,
+             sizeof(FileHeader) + section++ * sizeof(SectionHeader),
+             header);
+
+    auto write_elements = [&](std::span<const T> elements) {
+      const std::size_t begin = out.size();
+      out.resize(begin + elements.size_bytes());
+      std::memcpy(out.data() + begin, elements.data(), elements.size_bytes());
+
+      if constexpr (std::is_same_v<T, IdentifierPayload>) {
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+          const IdentifierPayload local = {.id = local_id(elements[i].id)};
+          write_at(&out, begin + i * sizeof(T), local);
+        }
+      }
+    };
+    if constexpr (requires { arena.for_each_block(write_elements); }) {
+      arena.for_each_block(write_elements);
+    } else {
+      write_elements(std::span<const T>(arena.data(), arena.size()));
+    }
+  });
+
+  // string table: all lengths, then all bytes
+  pad_to(&out, kSectionAlignment);
+  const std::size_t strings_offset = out.size();
+  for (std::string_view s : strings) {
+    const uint32_t length = static_cast<uint32_t>(s.size());
+    out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+  }
+  for (std::string_view s : strings) {
+    out.append(s);
+  }
+
+  const FileHeader header = {
+      .magic = kMagic,
+      .version = kSerializedFormatVersion,
+      .source_hash = source_hash,
+      .section_count = static_cast<uint32_t>(sections),
+      .string_count = static_cast<uint32_t>(strings.size()),
+      .strings_offset = strings_offset,
+  };
+  write_at(&out, 0, header);
+  return out;
+}
+
+std::unique_ptr<Context> deserialize(std::string_view data,
+                                     uint64_t source_hash,
+                                     base::StringInterner* interner) {
+  FileHeader header;
+  if (!read_at(data, 0, &header) || header.magic != kMagic ||
+      header.version != kSerializedFormatVersion ||
+      header.source_hash != source_hash) {
+    return nullptr;
+  }
+
+  auto context = Context::create();
+  if (header.section_count != section_count(*context)) {
+    return nullptr;
+  }
+
+  // the string table, interned only once the whole file checked out
+  std::vector<std::string_view> strings(header.string_count);
+  std::size_t lengths_offset = header.strings_offset;
+  std::size_t bytes_offset =
+      lengths_offset + std::size_t{header.string_count} * sizeof(uint32_t);
+  if (bytes_offset > data.size()) {
+    return nullptr;
+  }
+  for (uint32_t i = 0; i < header.string_count; ++i) {
+    uint32_t length = 0;
+    if (!read_at(data, lengths_offset, &length) ||
+        data.size() - bytes_offset < length) {
+      return nullptr;
+    }
+    strings[i] = data.substr(bytes_offset, length);
+    lengths_offset += sizeof(uint32_t);
+    bytes_offset += length;
+  }
+
+  bool ok = true;
+  std::size_t section = 0;
+  context->for_each_arena([&](std::string_view name, auto& arena) {
+    using T = ElementOf<decltype(arena)>;
+    SectionHeader s;
+    if (!ok ||
+        !read_at(data,
+                 sizeof(FileHeader) + section++ * sizeof(SectionHeader),
+                 &s) ||
+        s.name_hash != base::hash_string(name) ||
+        s.element_size != sizeof(T) || s.offset > data.size() ||
+        (data.size() - s.offset) / sizeof(T) < s.count) {
+      ok = false;
+      return;
+    }
+
+    // sections are aligned within the file and the mapping is page aligned
+    const std::span<const T> elements(
+        reinterpret_cast<const T*>(data.data() + s.offset), s.count);
+    if constexpr (requires { arena.append(elements); }) {
+      arena.append(elements);
+    } else {
+      arena.assign(elements.begin(), elements.end());
+    }
+  });
+  if (!ok) {
+    return nullptr;
+  }
+
+  const IdChecker checker(context.get(), strings.size());
+  context->for_each_arena([&](std::string_view, auto& arena) {
+    for (std::size_t i = 0; ok && i < arena.size(); ++i) {
+      ok = check(checker, arena[i]);
+    }
+  });
+  if (!ok) {
+    return nullptr;
+  }
+
+  std::vector<base::StringId> ids(strings.size());
+  for (std::size_t i = 0; i < strings.size(); ++i) {
+    ids[i] = interner->intern(strings[i]);
+  }
+  auto& identifiers = context->arena<IdentifierPayload>();
+  for (std::size_t i = 0; i < identifiers.size(); ++i) {
+    identifiers[i].id = ids[identifiers[i].id];
+  }
+  return context;
+}
+
+}  // namespace ast
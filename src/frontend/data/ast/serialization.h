@@ -0,0 +1,46 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_DATA_AST_SERIALIZATION_H_
+#define FRONTEND_DATA_AST_SERIALIZATION_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "frontend/data/ast/base/ast_export.h"
+#include "frontend/data/ast/context.h"
+
+namespace base {
+class StringInterner;
+}  // namespace base
+
+namespace ast {
+
+// on-disk ast format. bump whenever a payload layout or the arena order of
+// Context changes, older files are then rejected instead of misread.
+inline constexpr uint32_t kSerializedFormatVersion = 3;
+
+// every arena of `context` as a flat array, plus the strings its identifiers
+// refer to. ids are rewritten to indices into that string table, so the file
+// does not depend on the interner it was parsed with. `source_hash` is the
+// content hash of the source file the ast belongs to.
+AST_EXPORT std::string serialize(const Context& context,
+                                 const base::StringInterner& interner,
+                                 uint64_t source_hash);
+
+// reads data written by serialize(), typically straight from a mapped file.
+// arenas are filled with one copy per block and identifiers are re-interned
+// into `interner`. returns nullptr if the data is truncated, was written by a
+// different format version, belongs to a source with another hash or refers
+// to a node, payload or string outside of its sections. nothing is interned
+// then.
+AST_EXPORT std::unique_ptr<Context> deserialize(std::string_view data,
+                                                uint64_t source_hash,
+                                                base::StringInterner* interner);
+
+}  // namespace ast
+
+#endif  // FRONTEND_DATA_AST_SERIALIZATION_H_
@@ -0,0 +1,177 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/data/ast/serialization.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frontend/base/string/string_interner.h"
+#include "frontend/data/ast/base/node.h"
+#include "frontend/data/ast/context.h"
+#include "frontend/data/ast/payload/data.h"
+#include "frontend/data/ast/payload/expression.h"
+#include "gtest/gtest.h"
+
+namespace ast {
+
+namespace {
+
+constexpr uint64_t kSourceHash = 0x0123456789abcdefULL;
+
+// `foo::bar` and `foo` as path expressions, wrapped in a tuple
+std::unique_ptr<Context> build_context(base::StringInterner* interner) {
+  auto context = Context::create();
+
+  const auto foo = context->alloc_payload(
+      IdentifierPayload{.id = interner->intern("foo")});
+  context->alloc_payload(IdentifierPayload{.id = interner->intern("bar")});
+  const auto foo_again = context->alloc_payload(
+      IdentifierPayload{.id = interner->intern("foo")});
+
+  const NodeId qualified = context->alloc_node(
+      NodeKind::kPathExpression,
+      PathExpressionPayload{.path_parts_range = {.begin = foo, .size = 2}});
+  const NodeId plain = context->alloc_node(
+      NodeKind::kPathExpression,
+      PathExpressionPayload{.path_parts_range = {.begin = foo_again,
+                                                 .size = 1}});
+
+  const NodeId elements[] = {qualified, plain};
+  context->add_root(context->alloc_node(
+      NodeKind::kTupleExpression,
+      TupleExpressionPayload{
+          .tuple_elements_range = context->alloc_children(elements)}));
+  return context;
+}
+
+std::vector<std::string> identifier_names(
+    Context* context,
+    const base::StringInterner& interner) {
+  std::vector<std::string> names;
+  auto& identifiers = context->arena<IdentifierPayload>();
+  for (std::size_t i = 0; i < identifiers.size(); ++i) {
+    names.emplace_back(interner.lookup(identifiers[i].id));
+  }
+  return names;
+}
+
+}  // namespace
+
+TEST(SerializationTest, RoundTripsIntoAnotherInterner) {
+  base::StringInterner writer;
+  auto original = build_context(&writer);
+  const std::string data = serialize(*original, writer, kSourceHash);
+
+  // a reader whose ids differ from the writer's
+  base::StringInterner reader;
+  reader.intern("unrelated");
+  reader.intern("bar");
+  auto loaded = deserialize(data, kSourceHash, &reader);
+  ASSERT_NE(loaded, nullptr);
+
+  EXPECT_EQ(identifier_names(loaded.get(), reader),
+            (std::vector<std::string>{"foo", "bar", "foo"}));
+
+  auto& nodes = loaded->arena<Node>();
+  ASSERT_EQ(nodes.size(), original->arena<Node>().size());
+  for (NodeId i = 0; i < nodes.size(); ++i) {
+    EXPECT_EQ(nodes[i].kind, original->arena<Node>()[i].kind);
+    EXPECT_EQ(nodes[i].payload_id, original->arena<Node>()[i].payload_id);
+  }
+  EXPECT_EQ(loaded->children(), original->children());
+  EXPECT_EQ(loaded->roots(), original->roots());
+
+  const auto& path = loaded->get<PathExpressionPayload>(0);
+  EXPECT_EQ(path.path_parts_range.begin.id, 0u);
+  EXPECT_EQ(path.path_parts_range.size, 2u);
+}
+
+TEST(SerializationTest, RoundTripsArenasSpanningBlocks) {
+  base::StringInterner interner;
+  auto original = Context::create();
+  constexpr std::size_t kCount = 10000;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    original->alloc_payload(IdentifierPayload{
+        .id = interner.intern("id" + std::to_string(i % 100))});
+  }
+
+  const std::string data = serialize(*original, interner, kSourceHash);
+  base::StringInterner reader;
+  auto loaded = deserialize(data, kSourceHash, &reader);
+  ASSERT_NE(loaded, nullptr);
+
+  auto& identifiers = loaded->arena<IdentifierPayload>();
+  ASSERT_EQ(identifiers.size(), kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(reader.lookup(identifiers[i].id), "id" + std::to_string(i % 100));
+  }
+  EXPECT_EQ(reader.size(), interner.size());
+}
+
+TEST(SerializationTest, RejectsMismatchedData) {
+  base::StringInterner interner;
+  auto context = build_context(&interner);
+  const std::string data = serialize(*context, interner, kSourceHash);
+
+  base::StringInterner reader;
+  EXPECT_EQ(deserialize(data, kSourceHash + 1, &reader), nullptr);
+  EXPECT_EQ(deserialize("", kSourceHash, &reader), nullptr);
+  EXPECT_EQ(deserialize(std::string_view(data).substr(0, data.size() / 2),
+                        kSourceHash, &reader),
+            nullptr);
+
+  std::string other_version = data;
+  other_version[4] = static_cast<char>(kSerializedFormatVersion + 1);
+  EXPECT_EQ(deserialize(other_version, kSourceHash, &reader), nullptr);
+
+  EXPECT_NE(deserialize(data, kSourceHash, &reader), nullptr);
+}
+
+TEST(SerializationTest, RejectsOutOfRangeIds) {
+  // each breaks one reference of an otherwise valid context
+  const std::vector<void (*)(Context*)> corruptions = {
+      [](Context* c) { c->add_root(100); },
+      [](Context* c) {
+        const NodeId missing[] = {100};
+        c->add_root(c->alloc_node(
+            NodeKind::kTupleExpression,
+            TupleExpressionPayload{.tuple_elements_range =
+                                       c->alloc_children(missing)}));
+      },
+      [](Context* c) {
+        c->add_root(c->alloc(Node{.payload_id = 100,
+                                  .kind = NodeKind::kPathExpression}));
+      },
+      [](Context* c) {
+        c->alloc_payload(TupleExpressionPayload{
+            .tuple_elements_range = {.begin = 1, .size = 100}});
+      },
+      [](Context* c) {
+        c->alloc_payload(PathExpressionPayload{
+            .path_parts_range = {.begin = PayloadId<IdentifierPayload>(2),
+                                 .size = 100}});
+      },
+      [](Context* c) {
+        c->alloc_payload(LoopExpressionPayload{
+            .body = PayloadId<BlockExpressionPayload>(0)});
+      },
+  };
+
+  for (std::size_t i = 0; i < corruptions.size(); ++i) {
+    base::StringInterner writer;
+    auto context = build_context(&writer);
+    corruptions[i](context.get());
+    const std::string data = serialize(*context, writer, kSourceHash);
+
+    base::StringInterner reader;
+    EXPECT_EQ(deserialize(data, kSourceHash, &reader), nullptr) << i;
+    EXPECT_EQ(reader.size(), 0u) << i;
+  }
+}
+
+}  // namespace ast
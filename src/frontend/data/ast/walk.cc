@@ -0,0 +1,271 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/data/ast/walk.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "frontend/data/ast/base/node.h"
+#include "frontend/data/ast/payload/data.h"
+#include "frontend/data/ast/payload/expression.h"
+#include "frontend/data/ast/payload/statement.h"
+
+namespace ast {
+
+namespace {
+
+class ChildCollector {
+ public:
+  ChildCollector(Context* context, std::vector<NodeId>* out)
+      : context_(context), out_(out) {}
+
+  void collect(NodeId id);
+
+ private:
+  template <typename T>
+  inline const T& payload(const Node& node) {
+    return context_->get<T>(node.payload_id);
+  }
+
+  inline void node(NodeId id) {
+    if (id != kInvalidNodeId) {
+      out_->push_back(id);
+    }
+  }
+
+  inline void nodes(NodeRange range) {
+    for (const NodeId id : context_->children(range)) {
+      out_->push_back(id);
+    }
+  }
+
+  inline void block(PayloadId<BlockExpressionPayload> id) {
+    if (id.valid()) {
+      nodes(context_->get<BlockExpressionPayload>(id.id).body_nodes_range);
+    }
+  }
+
+  // only array types hold a node, their size
+  void type(const TypeReferencePayload& reference) {
+    if (!reference.is_array()) {
+      return;
+    }
+    const auto& array =
+        context_->get<ArrayTypePayload>(reference.as_array().id);
+    type(array.type);
+    node(array.array_size_expr);
+  }
+
+  inline void type(PayloadId<TypeReferencePayload> id) {
+    if (id.valid()) {
+      type(context_->get<TypeReferencePayload>(id.id));
+    }
+  }
+
+  // calls f(payload) for every payload of `range`
+  template <typename T, typename F>
+  inline void each(PayloadRange<T> range, F&& f) {
+    if (!range.valid()) {
+      return;
+    }
+    for (uint32_t id = range.begin.id; id <= range.end(); ++id) {
+      f(context_->get<T>(id));
+    }
+  }
+
+  // the types of fields, parameters or captures
+  template <typename T>
+  inline void types_of(PayloadRange<T> range) {
+    each(range, [this](const T& p) { type(p.type); });
+  }
+
+  Context* context_;
+  std::vector<NodeId>* out_;
+};
+
+void ChildCollector::collect(NodeId id) {
+  const Node& n = context_->arena<Node>()[id];
+  switch (n.kind) {
+    using Kind = NodeKind;
+    case Kind::kAssignStatement: {
+      const auto& p = payload<AssignStatementPayload>(n);
+      type(p.target_type);
+      node(p.value_expression);
+      break;
+    }
+    case Kind::kAttributeStatement: {
+      each(payload<AttributeStatementPayload>(n).attributes_range,
+           [this](const AttributeUsePayload& p) { nodes(p.args_range); });
+      break;
+    }
+    case Kind::kUnaryExpression:
+      node(payload<UnaryExpressionPayload>(n).operand);
+      break;
+    case Kind::kBinaryExpression: {
+      const auto& p = payload<BinaryExpressionPayload>(n);
+      node(p.lhs);
+      node(p.rhs);
+      break;
+    }
+    case Kind::kGroupedExpression:
+      node(payload<GroupedExpressionPayload>(n).expression);
+      break;
+    case Kind::kArrayExpression:
+      nodes(payload<ArrayExpressionPayload>(n).array_elements_range);
+      break;
+    case Kind::kTupleExpression:
+      nodes(payload<TupleExpressionPayload>(n).tuple_elements_range);
+      break;
+    case Kind::kIndexExpression: {
+      const auto& p = payload<IndexExpressionPayload>(n);
+      node(p.operand);
+      node(p.index);
+      break;
+    }
+    case Kind::kConstructExpression: {
+      const auto& p = payload<ConstructExpressionPayload>(n);
+      node(p.type_path);
+      nodes(p.args_range);
+      break;
+    }
+    case Kind::kFunctionCallExpression: {
+      const auto& p = payload<FunctionCallExpressionPayload>(n);
+      node(p.callee);
+      nodes(p.args_range);
+      break;
+    }
+    case Kind::kMethodCallExpression: {
+      const auto& p = payload<MethodCallExpressionPayload>(n);
+      node(p.obj);
+      nodes(p.args_range);
+      break;
+    }
+    case Kind::kFunctionMacroCallExpression: {
+      const auto& p = payload<FunctionMacroCallExpressionPayload>(n);
+      node(p.macro_callee);
+      nodes(p.args_range);
+      break;
+    }
+    case Kind::kMethodMacroCallExpression: {
+      const auto& p = payload<MethodMacroCallExpressionPayload>(n);
+      node(p.obj);
+      nodes(p.args_range);
+      break;
+    }
+    case Kind::kFieldAccessExpression:
+      node(payload<FieldAccessExpressionPayload>(n).obj);
+      break;
+    case Kind::kAwaitExpression:
+      node(payload<AwaitExpressionPayload>(n).callee_expression);
+      break;
+    case Kind::kContinueExpression:
+      node(payload<ContinueExpressionPayload>(n).expression);
+      break;
+    case Kind::kBreakExpression:
+      node(payload<BreakExpressionPayload>(n).expression);
+      break;
+    case Kind::kRangeExpression: {
+      const auto& p = payload<RangeExpressionPayload>(n);
+      node(p.begin);
+      node(p.end);
+      break;
+    }
+    case Kind::kReturnExpression:
+      node(payload<ReturnExpressionPayload>(n).expression);
+      break;
+    case Kind::kBlockExpression:
+      nodes(payload<BlockExpressionPayload>(n).body_nodes_range);
+      break;
+    case Kind::kIfExpression: {
+      each(payload<IfExpressionPayload>(n).branches_range,
+           [this](const IfBranchPayload& p) {
+             node(p.condition);
+             block(p.block);
+           });
+      break;
+    }
+    case Kind::kLoopExpression:
+      block(payload<LoopExpressionPayload>(n).body);
+      break;
+    case Kind::kWhileExpression: {
+      const auto& p = payload<WhileExpressionPayload>(n);
+      node(p.condition);
+      block(p.body);
+      break;
+    }
+    case Kind::kForExpression: {
+      const auto& p = payload<ForExpressionPayload>(n);
+      node(p.range);
+      block(p.body);
+      break;
+    }
+    case Kind::kMatchExpression: {
+      const auto& p = payload<MatchExpressionPayload>(n);
+      node(p.expression);
+      each(p.arms_range, [this](const MatchArmPayload& arm) {
+        node(arm.pattern);
+        node(arm.expression);
+      });
+      break;
+    }
+    case Kind::kClosureExpression: {
+      const auto& p = payload<ClosureExpressionPayload>(n);
+      types_of(p.captures_range);
+      types_of(p.parameters_range);
+      node(p.body);
+      break;
+    }
+    case Kind::kFunctionDeclaration: {
+      const auto& p = payload<FunctionDeclarationPayload>(n);
+      types_of(p.parameters_range);
+      type(p.return_type);
+      block(p.body);
+      break;
+    }
+    case Kind::kStructDeclaration:
+      types_of(payload<StructDeclarationPayload>(n).fields_range);
+      break;
+    case Kind::kEnumDeclaration: {
+      each(payload<EnumerationDeclarationPayload>(n).variants_range,
+           [this](const EnumVariantPayload& p) {
+             switch (p.type) {
+               using Type = EnumVariantPayload::VariantType;
+               case Type::kInteger: node(p.data.int_expr); break;
+               case Type::kStructLike: types_of(p.data.fields); break;
+               case Type::kTupleLike:
+                 each(p.data.types,
+                      [this](const TypeReferencePayload& t) { type(t); });
+                 break;
+               default: break;
+             }
+           });
+      break;
+    }
+    case Kind::kTraitDeclaration:
+      nodes(payload<TraitDeclarationPayload>(n).function_declare_range);
+      break;
+    case Kind::kImplDeclaration:
+      nodes(payload<ImplementationDeclarationPayload>(n)
+                .function_definition_range);
+      break;
+    case Kind::kUnionDeclaration:
+      types_of(payload<UnionDeclarationPayload>(n).fields_range);
+      break;
+    case Kind::kModuleDeclaration:
+      nodes(payload<ModuleDeclarationPayload>(n).module_nodes_range);
+      break;
+
+    // no child nodes
+    default: break;
+  }
+}
+
+}  // namespace
+
+void append_children(Context* context, NodeId id, std::vector<NodeId>* out) {
+  ChildCollector(context, out).collect(id);
+}
+
+}  // namespace ast
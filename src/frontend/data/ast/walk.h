@@ -0,0 +1,44 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_DATA_AST_WALK_H_
+#define FRONTEND_DATA_AST_WALK_H_
+
+#include <vector>
+
+#include "frontend/data/ast/base/ast_export.h"
+#include "frontend/data/ast/base/node_id.h"
+#include "frontend/data/ast/context.h"
+
+namespace ast {
+
+// appends the direct child nodes of `id` to `out` in source order, including
+// the ones reached through payloads such as blocks, if branches, match arms
+// and array type sizes
+AST_EXPORT void append_children(Context* context,
+                                NodeId id,
+                                std::vector<NodeId>* out);
+
+// calls f(id) for every node reachable from the roots of `context`, each node
+// before its children and siblings in source order. nodes no root reaches,
+// e.g. the ones of items a Document parsed again, are skipped.
+template <typename F>
+void for_each_reachable_node(Context* context, F&& f) {
+  const std::vector<NodeId>& roots = context->roots();
+  std::vector<NodeId> stack(roots.rbegin(), roots.rend());
+  std::vector<NodeId> children;
+  while (!stack.empty()) {
+    const NodeId id = stack.back();
+    stack.pop_back();
+    f(id);
+
+    children.clear();
+    append_children(context, id, &children);
+    stack.insert(stack.end(), children.rbegin(), children.rend());
+  }
+}
+
+}  // namespace ast
+
+#endif  // FRONTEND_DATA_AST_WALK_H_
@@ -0,0 +1,82 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/data/ast/walk.h"
+
+#include <memory>
+#include <vector>
+
+#include "frontend/base/keyword/type.h"
+#include "frontend/base/operator/binary_operator.h"
+#include "frontend/data/ast/base/node.h"
+#include "frontend/data/ast/context.h"
+#include "frontend/data/ast/payload/data.h"
+#include "frontend/data/ast/payload/expression.h"
+#include "frontend/data/ast/payload/statement.h"
+#include "gtest/gtest.h"
+
+namespace ast {
+
+namespace {
+
+NodeId alloc_literal(Context* context) {
+  return context->alloc_node(NodeKind::kLiteralExpression,
+                             LiteralExpressionPayload{});
+}
+
+std::vector<NodeId> reachable_nodes(Context* context) {
+  std::vector<NodeId> ids;
+  for_each_reachable_node(context, [&](NodeId id) { ids.push_back(id); });
+  return ids;
+}
+
+}  // namespace
+
+TEST(WalkTest, VisitsReachableNodesInSourceOrder) {
+  auto context = Context::create();
+  // left behind, e.g. by an item that was parsed again
+  alloc_literal(context.get());
+
+  // loop { a + b } c
+  const NodeId a = alloc_literal(context.get());
+  const NodeId b = alloc_literal(context.get());
+  const NodeId sum = context->alloc_node(
+      NodeKind::kBinaryExpression,
+      BinaryExpressionPayload{.op = base::BinaryOperator::kAdd,
+                              .lhs = a,
+                              .rhs = b});
+  const NodeId body[] = {sum};
+  const auto block = context->alloc_payload(BlockExpressionPayload{
+      .body_nodes_range = context->alloc_children(body)});
+  const NodeId loop = context->alloc_node(NodeKind::kLoopExpression,
+                                          LoopExpressionPayload{.body = block});
+  const NodeId c = alloc_literal(context.get());
+  context->add_root(loop);
+  context->add_root(c);
+
+  EXPECT_EQ(reachable_nodes(context.get()),
+            (std::vector<NodeId>{loop, sum, a, b, c}));
+}
+
+TEST(WalkTest, ReachesArraySizesOfParameterTypes) {
+  auto context = Context::create();
+  // fn f(p: [i32; size])
+  const NodeId size = alloc_literal(context.get());
+  const auto element =
+      context->alloc_payload(TypeReferencePayload(base::PrimitiveType::kI32));
+  const auto array = context->alloc_payload(
+      ArrayTypePayload{.type = element, .array_size_expr = size});
+  const auto type = context->alloc_payload(TypeReferencePayload(array));
+  const auto parameter = context->alloc_payload(ParameterPayload{.type = type});
+  const NodeId function = context->alloc_node(
+      NodeKind::kFunctionDeclaration,
+      FunctionDeclarationPayload{
+          .parameters_range = {.begin = parameter, .size = 1}});
+  context->add_root(function);
+
+  EXPECT_EQ(reachable_nodes(context.get()),
+            (std::vector<NodeId>{function, size}));
+}
+
+}  // namespace ast
@@ -5,12 +5,15 @@
 #ifndef FRONTEND_DATA_HIR_CONTEXT_H_
 #define FRONTEND_DATA_HIR_CONTEXT_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string_view>
 #include <utility>
 
 #include "frontend/base/data/arena.h"
+#include "frontend/base/data/arena_profile.h"
+#include "frontend/base/data/region.h"
 #include "frontend/data/hir/base/hir_export.h"
 #include "frontend/data/hir/base/node.h"
 #include "frontend/data/hir/base/node_id.h"
@@ -30,8 +33,10 @@ class HIR_EXPORT Context {
   Context(const Context&) = delete;
   Context& operator=(const Context&) = delete;
 
+  // move assignment would free the region before the arenas that still
+  // point into it, contexts are handed around by unique_ptr instead
   Context(Context&&) noexcept = default;
-  Context& operator=(Context&&) noexcept = default;
+  Context& operator=(Context&&) = delete;
 
   template <typename T>
   inline constexpr base::Arena<T>& arena();
@@ -60,8 +65,89 @@ class HIR_EXPORT Context {
     return arena<T>()[id];
   }
 
+  // calls f(name, arena) for every arena, in a fixed order. names are the
+  // profile and serialization keys.
+  template <typename F>
+  inline void for_each_arena(F&& f) {
+    visit_arenas(*this, f);
+  }
+  template <typename F>
+  inline void for_each_arena(F&& f) const {
+    visit_arenas(*this, f);
+  }
+
+  // reserves every arena for an input of `units` ast nodes, from the
+  // average usage of earlier runs
+  inline void reserve_from(const base::ArenaProfile& profile,
+                           std::size_t units) {
+    for_each_arena([&](std::string_view name, auto& arena) {
+      arena.reserve(profile.estimate(name, units));
+    });
+  }
+
+  inline void record_usage(base::ArenaProfile* profile, std::size_t units) {
+    for_each_arena([&](std::string_view name, auto& arena) {
+      profile->record(name, arena.size(), units);
+    });
+  }
+
  private:
-  Context() = default;
+  // every arena allocates from one region, so a context costs a few chunk
+  // allocations and a single teardown however many arenas it has
+  Context() : region_(std::make_unique<base::Region>()) {
+    for_each_arena([this](std::string_view, auto& arena) {
+      if constexpr (requires { arena.use_region(region_.get()); }) {
+        arena.use_region(region_.get());
+      }
+    });
+  }
+
+  template <typename Self, typename F>
+  static void visit_arenas(Self& self, F& f) {
+    f("hir.nodes", self.nodes_);
+    f("hir.literal_expression_payloads", self.literal_expression_payloads_);
+    f("hir.resolved_path_expression_payloads",
+      self.resolved_path_expression_payloads_);
+    f("hir.unary_expression_payloads", self.unary_expression_payloads_);
+    f("hir.binary_expression_payloads", self.binary_expression_payloads_);
+    f("hir.array_expression_payloads", self.array_expression_payloads_);
+    f("hir.tuple_expression_payloads", self.tuple_expression_payloads_);
+    f("hir.index_expression_payloads", self.index_expression_payloads_);
+    f("hir.construct_expression_payloads", self.construct_expression_payloads_);
+    f("hir.call_expression_payloads", self.call_expression_payloads_);
+    f("hir.field_access_expression_payloads",
+      self.field_access_expression_payloads_);
+    f("hir.await_expression_payloads", self.await_expression_payloads_);
+    f("hir.continue_expression_payloads", self.continue_expression_payloads_);
+    f("hir.break_expression_payloads", self.break_expression_payloads_);
+    f("hir.range_expression_payloads", self.range_expression_payloads_);
+    f("hir.return_expression_payloads", self.return_expression_payloads_);
+    f("hir.block_expression_payloads", self.block_expression_payloads_);
+    f("hir.if_expression_payloads", self.if_expression_payloads_);
+    f("hir.while_expression_payloads", self.while_expression_payloads_);
+    f("hir.match_expression_payloads", self.match_expression_payloads_);
+    f("hir.closure_expression_payloads", self.closure_expression_payloads_);
+    f("hir.assign_statement_payloads", self.assign_statement_payloads_);
+    f("hir.attribute_statement_payloads", self.attribute_statement_payloads_);
+    f("hir.function_declaration_payloads", self.function_declaration_payloads_);
+    f("hir.struct_declaration_payloads", self.struct_declaration_payloads_);
+    f("hir.enumeration_declaration_payloads",
+      self.enumeration_declaration_payloads_);
+    f("hir.trait_declaration_payloads", self.trait_declaration_payloads_);
+    f("hir.union_declaration_payloads", self.union_declaration_payloads_);
+    f("hir.module_declaration_payloads", self.module_declaration_payloads_);
+    f("hir.attribute_use_payloads", self.attribute_use_payloads_);
+    f("hir.capture_payloads", self.capture_payloads_);
+    f("hir.field_payloads", self.field_payloads_);
+    f("hir.parameter_payloads", self.parameter_payloads_);
+    f("hir.enum_variant_payloads", self.enum_variant_payloads_);
+    f("hir.if_branch_payloads", self.if_branch_payloads_);
+    f("hir.match_arm_payloads", self.match_arm_payloads_);
+  }
+
+
+  // declared first so it outlives the arenas
+  std::unique_ptr<base::Region> region_;
 
   base::Arena<Node> nodes_;
 
@@ -15,7 +15,10 @@ enum class DiagnosticOutputFormat : uint8_t {
   kUnknown = 0,
   kClassic = 1,
   kShort = 2,
+  // one json object per line, see DiagnosticEngine::emit_json()
   kJson = 3,
+  // see engine/record.h
+  kBinary = 4,
 };
 
 struct DIAGNOSTIC_EXPORT DiagnosticOptions {
@@ -25,6 +28,12 @@ struct DIAGNOSTIC_EXPORT DiagnosticOptions {
   bool show_help : 1 = true;
   bool show_source_snippet : 1 = true;
   bool use_unicode : 1 = true;
+  // DiagnosticEngine::push() drops diagnostics beyond these, 0 is no limit
+  uint32_t max_entries = 1000;
+  uint32_t max_entries_per_file = 200;
+  // threads rendering a batch, 0 uses every hardware thread. the output does
+  // not depend on it.
+  uint32_t jobs = 1;
 };
 
 }  // namespace diagnostic
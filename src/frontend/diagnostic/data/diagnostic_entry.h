@@ -7,6 +7,7 @@
 
 #include <vector>
 
+#include "core/base/source_location.h"
 #include "frontend/diagnostic/base/diagnostic_export.h"
 #include "frontend/diagnostic/data/header.h"
 #include "frontend/diagnostic/data/label.h"
@@ -30,11 +31,26 @@ class DIAGNOSTIC_EXPORT DiagnosticEntry {
   inline const Header& header() const { return header_; }
   inline const Labels& labels() const { return labels_; }
 
+  // where the reporter resumed after this error, if it skipped input to
+  // recover. diagnostics starting between the first label and this point are
+  // treated as its follow-up errors, see DiagnosticEngine::push().
+  inline bool has_recovery_region() const {
+    return recovery_end_.line() != 0;
+  }
+  inline const core::SourceLocation& recovery_end() const {
+    return recovery_end_;
+  }
+  inline void set_recovery_end(const core::SourceLocation& end) {
+    recovery_end_ = end;
+  }
+
   Labels& sort_labels();
 
  private:
   Header header_;
   Labels labels_;
+  // line 0 if there is none
+  core::SourceLocation recovery_end_{0, 0};
 };
 
 }  // namespace diagnostic
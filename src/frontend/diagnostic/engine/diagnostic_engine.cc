@@ -5,18 +5,29 @@
 #include "frontend/diagnostic/engine/diagnostic_engine.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "core/base/file_manager.h"
 #include "core/base/logger.h"
-#include "core/cli/ansi/style_builder.h"
+#include "core/base/source_location.h"
+#include "core/base/source_range.h"
 #include "core/cli/ansi/style_util.h"
+#include "core/cli/console.h"
+#include "frontend/diagnostic/base/diagnostic_options.h"
 #include "frontend/diagnostic/data/annotation.h"
 #include "frontend/diagnostic/data/diagnostic_id.h"
 #include "frontend/diagnostic/data/label.h"
 #include "frontend/diagnostic/data/severity.h"
+#include "frontend/diagnostic/engine/sink.h"
+#include "frontend/diagnostic/engine/writer.h"
 #include "i18n/base/data/translation_key.h"
 #include "i18n/base/translator.h"
 
@@ -54,55 +65,284 @@ DiagnosticEngine::DiagnosticEngine(unicode::Utf8FileManager* file_manager,
   DCHECK(translator_);
 }
 
-std::string DiagnosticEngine::pop_and_format() {
+namespace {
+
+inline bool before(const core::SourceLocation& a,
+                   const core::SourceLocation& b) {
+  return a.line() < b.line() ||
+         (a.line() == b.line() && a.column() < b.column());
+}
+
+}  // namespace
+
+void DiagnosticEngine::clear() {
+  entries_.clear();
+  reported_.clear();
+  files_.clear();
+  accepted_ = 0;
+  suppressed_ = {};
+}
+
+std::size_t DiagnosticEngine::EntryKeyHash::operator()(
+    const EntryKey& key) const {
+  uint64_t h = static_cast<uint64_t>(key.diag_id) |
+               (static_cast<uint64_t>(key.file_id) << 8);
+  h = (h ^ key.line) * 0x9e3779b97f4a7c15ull;
+  h = (h ^ key.column) * 0x9e3779b97f4a7c15ull;
+  h = (h ^ key.length) * 0x9e3779b97f4a7c15ull;
+  return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+bool DiagnosticEngine::accept(const DiagnosticEntry& entry) {
+  const bool has_label = !entry.labels().empty();
+  const unicode::Utf8FileId file_id =
+      has_label ? entry.labels()[0].file_id() : unicode::kInvalidFileId;
+  const core::SourceRange range =
+      has_label ? entry.labels()[0].range() : core::SourceRange(0, 0, 0);
+  FileState* file = nullptr;
+  if (file_id != unicode::kInvalidFileId) {
+    if (file_id >= files_.size()) {
+      files_.resize(file_id + 1);
+    }
+    file = &files_[file_id];
+  }
+
+  if (file) {
+    for (const RecoveryRegion& region : file->recovery_regions) {
+      if (!before(range.start(), region.begin) &&
+          before(range.start(), region.end)) {
+        ++suppressed_.cascaded;
+        return false;
+      }
+    }
+  }
+
+  const EntryKey key = {
+      .diag_id = entry.header().diag_id(),
+      .file_id = file_id,
+      .line = range.start().line(),
+      .column = range.start().column(),
+      .length = range.length(),
+  };
+  if (reported_.contains(key)) {
+    ++suppressed_.duplicates;
+    return false;
+  }
+
+  if ((options_.max_entries != 0 && accepted_ >= options_.max_entries) ||
+      (file && options_.max_entries_per_file != 0 &&
+       file->entries >= options_.max_entries_per_file)) {
+    ++suppressed_.over_limit;
+    return false;
+  }
+
+  reported_.insert(key);
+  ++accepted_;
+  if (file) {
+    ++file->entries;
+    if (entry.has_recovery_region() &&
+        before(range.start(), entry.recovery_end())) {
+      file->recovery_regions.push_back(
+          {.begin = range.start(), .end = entry.recovery_end()});
+    }
+  }
+  return true;
+}
+
+void DiagnosticEngine::pop_and_emit(DiagnosticSink* sink) {
   DCHECK(!entries_.empty());
   DiagnosticEntry entry = std::move(entries_.back());
   entries_.pop_back();
 
-  std::string result;
-  result.reserve(kPredictedFormattedStrSize);
-  format_one(std::move(entry), &result);
-  return result;
+  DiagnosticWriter out(sink, should_colorise());
+  emit_one(std::move(entry), &out);
 }
 
-std::string DiagnosticEngine::format_batch_and_clear() {
+void DiagnosticEngine::emit_batch_and_clear(DiagnosticSink* sink) {
   Entries local;
   entries_.swap(local);
 
+  const bool colorise = should_colorise();
+  const std::size_t workers = worker_count(local.size());
+  if (workers > 1) {
+    emit_parallel(&local, workers, colorise, sink);
+    return;
+  }
+
+  DiagnosticWriter out(sink, colorise);
+  emit_range(&local, 0, local.size(), &out);
+}
+
+std::string DiagnosticEngine::pop_and_format() {
+  std::string result;
+  StringSink sink(&result);
+  pop_and_emit(&sink);
+  return result;
+}
+
+std::string DiagnosticEngine::format_batch_and_clear() {
   std::string result;
-  result.reserve(local.size() * kPredictedFormattedStrSize);
-  format(std::move(local), &result);
+  StringSink sink(&result);
+  emit_batch_and_clear(&sink);
   return result;
 }
 
 void DiagnosticEngine::format_one(DiagnosticEntry&& entry,
-                                  std::string* out_str) const {
-  format_header(entry.header(), out_str);
+                                  DiagnosticWriter* out) const {
+  format_header(entry.header(), out);
 
-  format_labels(std::move(entry.sort_labels()), out_str);
+  format_labels(entry.sort_labels(), out);
 }
 
-void DiagnosticEngine::format(Entries&& entries, std::string* out_str) const {
+void DiagnosticEngine::format(Entries&& entries, DiagnosticWriter* out) const {
   bool first = true;
   for (DiagnosticEntry& e : entries) {
     if (!first) {
-      out_str->append("\n");
+      out->append('\n');
     } else {
       first = false;
     }
-    format_one(std::move(e), out_str);
+    format_one(std::move(e), out);
   }
 }
 
-void DiagnosticEngine::render_source_line(std::string* out_str,
+void DiagnosticEngine::emit_one(DiagnosticEntry&& entry,
+                                DiagnosticWriter* out) const {
+  switch (options_.output_format) {
+    case DiagnosticOutputFormat::kJson: emit_json(entry, out); return;
+    case DiagnosticOutputFormat::kBinary: emit_binary(entry, out); return;
+    default: format_one(std::move(entry), out); return;
+  }
+}
+
+void DiagnosticEngine::emit_range(Entries* entries,
+                                  std::size_t begin,
+                                  std::size_t end,
+                                  DiagnosticWriter* out) const {
+  // classic diagnostics are separated by a blank line, machine readable ones
+  // end with their own delimiter
+  const bool separate =
+      options_.output_format != DiagnosticOutputFormat::kJson &&
+      options_.output_format != DiagnosticOutputFormat::kBinary;
+  for (std::size_t i = begin; i < end; ++i) {
+    if (separate && i != 0) {
+      out->append('\n');
+    }
+    emit_one(std::move((*entries)[i]), out);
+  }
+}
+
+void DiagnosticEngine::emit_parallel(Entries* entries,
+                                     std::size_t workers,
+                                     bool colorise,
+                                     DiagnosticSink* sink) const {
+  // files are loaded on first use, which must not happen on the workers
+  for (const DiagnosticEntry& entry : *entries) {
+    for (const Label& label : entry.labels()) {
+      file_manager_->loaded_file(label.file_id());
+    }
+  }
+
+  // the workers live for the whole batch and take tasks, contiguous slices of
+  // kEntriesPerTask entries, in order. each task renders into slot
+  // `task % slots`, which the calling thread writes to the sink and hands back
+  // once every earlier task is written. memory is bounded by the slots
+  // rather than by the whole batch.
+  const std::size_t tasks =
+      (entries->size() + kEntriesPerTask - 1) / kEntriesPerTask;
+  const std::size_t slots = workers * kTasksPerWorker;
+  std::vector<std::string> buffers(slots);
+  // a char per slot, std::vector<bool> would share bytes between slots
+  std::vector<char> ready(slots, 0);
+
+  std::mutex mutex;
+  std::condition_variable slot_free;
+  std::condition_variable slot_ready;
+  std::size_t next_task = 0;
+  std::size_t written = 0;
+
+  auto work = [&]() {
+    while (true) {
+      std::size_t t;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        slot_free.wait(lock, [&] {
+          return next_task >= tasks || next_task < written + slots;
+        });
+        if (next_task >= tasks) {
+          return;
+        }
+        t = next_task++;
+      }
+
+      const std::size_t begin = t * kEntriesPerTask;
+      const std::size_t end =
+          std::min(entries->size(), begin + kEntriesPerTask);
+      std::string& buffer = buffers[t % slots];
+      buffer.clear();
+      {
+        StringSink task_sink(&buffer);
+        DiagnosticWriter out(&task_sink, colorise);
+        emit_range(entries, begin, end, &out);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready[t % slots] = 1;
+      }
+      slot_ready.notify_one();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers);
+  for (std::size_t w = 0; w < workers; ++w) {
+    threads.emplace_back(work);
+  }
+
+  for (std::size_t t = 0; t < tasks; ++t) {
+    const std::size_t slot = t % slots;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      slot_ready.wait(lock, [&] { return ready[slot] != 0; });
+    }
+    // no worker touches the slot until `written` moves past it
+    sink->write(buffers[slot].data(), buffers[slot].size());
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ready[slot] = 0;
+      ++written;
+    }
+    slot_free.notify_all();
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  sink->flush();
+}
+
+std::size_t DiagnosticEngine::worker_count(std::size_t entry_count) const {
+  std::size_t jobs = options_.jobs;
+  if (jobs == 0) {
+    jobs = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  const std::size_t tasks =
+      (entry_count + kEntriesPerTask - 1) / kEntriesPerTask;
+  return std::max<std::size_t>(std::min(jobs, tasks), 1);
+}
+
+bool DiagnosticEngine::should_colorise() const {
+  return options_.colorise && core::can_use_ansi_escape_sequence();
+}
+
+void DiagnosticEngine::render_source_line(DiagnosticWriter* out,
                                           const Label& label,
                                           std::string_view line,
                                           std::size_t line_number_width) const {
-  // at first, the last line of the `out_str` is like:
+  // at first, the last line of the output is like:
   // "n |" (n is the line number of the source line)
 
-  core::StyleBuilder s;
-
   std::size_t column_start = label.range().start().column();
   std::size_t column_end = label.range().end().column();
 
@@ -117,63 +357,51 @@ void DiagnosticEngine::render_source_line(std::string* out_str,
   const std::size_t marker_end_idx = std::min(column_end - 1, line.length());
   const std::size_t marker_length = marker_end_idx - marker_start_idx;
   const LabelMarkerType marker_type = label.marker_type();
+  const core::Color marker_color = label_marker_type_to_color(marker_type);
 
   // source line:
   // n | **some code()** (<- THIS PART)
   //   |        ~~~~ this code is invalid!
-  const std::string_view src_before_marker = line.substr(0, marker_start_idx);
-  const std::string_view src_on_marker =
-      line.substr(marker_start_idx, marker_length);
-  const std::string_view src_after_marker = line.substr(marker_end_idx);
-
-  out_str->append(src_before_marker);
+  out->append(line.substr(0, marker_start_idx));
 
-  const core::Color marker_color = label_marker_type_to_color(marker_type);
-  s.style(core::Style::kBold).color(marker_color);
-  out_str->append(s.build(src_on_marker));
-  s.reset();
+  out->begin_style(marker_color);
+  out->append(line.substr(marker_start_idx, marker_length));
+  out->end_style();
 
-  out_str->append(src_after_marker);
-  out_str->append("\n");
+  out->append(line.substr(marker_end_idx));
+  out->append('\n');
 
   // marker:
   // n | some code()
   //   |    **~~~~** (<- THIS PART) this code is invalid!
-  out_str->append(line_number_width, ' ');
-  out_str->append(" | ");
-  out_str->append(marker_start_idx, ' ');
-
-  std::string marker_string_buf;
+  out->append(line_number_width, ' ');
+  out->append(" | ");
+  out->append(marker_start_idx, ' ');
 
-  // heuristic
-  marker_string_buf.reserve(marker_length + kFormatBufSize / 4);
-  marker_string_buf.append(marker_length,
-                           label_maker_type_to_char(marker_type));
+  out->begin_style(marker_color);
+  out->append(marker_length, label_maker_type_to_char(marker_type));
 
   // marker message:
   // n | some code()
   //   |      ~~~~ **this code is invalid!** (<- THIS PART)
   const i18n::TranslationKey marker_msg_tr_key = label.message_tr_key();
   if (marker_msg_tr_key != i18n::TranslationKey::kDiagnosticUnknown) {
-    marker_string_buf.append(" ");
+    out->append(' ');
 
     if (label.should_format()) {
-      char format_buf[kFormatBufSize];
-      translator_->translate_fmt_to(marker_msg_tr_key, format_buf,
-                                    label.format_args(), label.args_count());
-      marker_string_buf.append(format_buf);
+      translator_->translate_fmt_each(
+          marker_msg_tr_key, label.format_args(), label.args_count(),
+          [out](std::string_view piece) { out->append(piece); });
     } else {
-      marker_string_buf.append(translator_->translate(marker_msg_tr_key));
+      out->append(translator_->translate(marker_msg_tr_key));
     }
   }
-  s.style(core::Style::kBold).color(marker_color);
-  out_str->append(s.build(std::move(marker_string_buf)));
-  s.reset();
+  out->end_style();
 
-  out_str->append("\n");
+  out->append('\n');
 
-  out_str->append(line_number_width, ' ');
-  out_str->append(" |\n");
+  out->append(line_number_width, ' ');
+  out->append(" |\n");
 }
 
 }  // namespace diagnostic
@@ -5,15 +5,22 @@
 #ifndef FRONTEND_DIAGNOSTIC_ENGINE_DIAGNOSTIC_ENGINE_H_
 #define FRONTEND_DIAGNOSTIC_ENGINE_DIAGNOSTIC_ENGINE_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "core/base/source_location.h"
 #include "frontend/base/token/token.h"
 #include "frontend/diagnostic/base/diagnostic_options.h"
 #include "frontend/diagnostic/data/diagnostic_entry.h"
+#include "frontend/diagnostic/data/diagnostic_id.h"
 #include "frontend/diagnostic/data/label.h"
+#include "frontend/diagnostic/engine/sink.h"
+#include "frontend/diagnostic/engine/writer.h"
 #include "unicode/utf8/file_manager.h"
 
 namespace i18n {
@@ -26,6 +33,20 @@ class DiagnosticEngine {
  public:
   using Entries = std::vector<DiagnosticEntry>;
 
+  // diagnostics push() dropped, by reason
+  struct Suppressed {
+    // same id, file and range as an earlier one
+    std::size_t duplicates = 0;
+    // inside the recovery region of an earlier one
+    std::size_t cascaded = 0;
+    // beyond DiagnosticOptions::max_entries or max_entries_per_file
+    std::size_t over_limit = 0;
+
+    inline std::size_t total() const {
+      return duplicates + cascaded + over_limit;
+    }
+  };
+
   explicit DiagnosticEngine(unicode::Utf8FileManager* file_manager,
                             const i18n::Translator* translator,
                             DiagnosticOptions options);
@@ -40,8 +61,12 @@ class DiagnosticEngine {
 
   inline const Entries& entries() const { return entries_; }
 
+  // drops `entry` if it repeats, follows from or exceeds the limits on what
+  // was pushed before, so suppressed diagnostics are never formatted
   inline void push(DiagnosticEntry&& entry) {
-    entries_.push_back(std::move(entry));
+    if (accept(entry)) {
+      entries_.push_back(std::move(entry));
+    }
   }
 
   inline void push(Entries&& entries) {
@@ -50,14 +75,24 @@ class DiagnosticEngine {
     }
   }
 
-  inline void clear() { entries_.clear(); }
+  inline const Suppressed& suppressed() const { return suppressed_; }
+
+  // drops pending entries and forgets everything pushed so far. emitting
+  // keeps that history, so diagnostics already shown are not shown again.
+  void clear();
+
+  // render into `sink` through a fixed buffer, so memory use does not grow
+  // with the number of diagnostics. the output format follows
+  // DiagnosticOptions::output_format.
+  void pop_and_emit(DiagnosticSink* sink);
+  void emit_batch_and_clear(DiagnosticSink* sink);
 
   std::string pop_and_format();
   std::string format_batch_and_clear();
 
   void format_annotation(const Annotation& annotation,
                          std::size_t line_number_width,
-                         std::string* out_str) const;
+                         DiagnosticWriter* out) const;
 
   void format_label_header(const Label& label,
                            std::size_t line_number_width,
@@ -65,30 +100,94 @@ class DiagnosticEngine {
                            std::size_t line_num_len,
                            const char* col_num_str,
                            std::size_t col_num_len,
-                           std::string* out_str) const;
+                           DiagnosticWriter* out) const;
 
   void format_label_body(const Label& label,
                          std::size_t line_number_width,
                          std::size_t current_line,
-                         std::string* out_str) const;
+                         DiagnosticWriter* out) const;
+
+  void format_labels(const std::vector<Label>& sorted_labels,
+                     DiagnosticWriter* out) const;
 
-  void format_labels(std::vector<Label>&& sorted_labels,
-                     std::string* out_str) const;
+  void format_header(const Header& header, DiagnosticWriter* out) const;
 
-  void format_header(const Header& header, std::string* out_str) const;
+  void format_one(DiagnosticEntry&& entry, DiagnosticWriter* out) const;
 
-  void format_one(DiagnosticEntry&& entry, std::string* out_str) const;
+  void format(Entries&& entries, DiagnosticWriter* out) const;
 
-  void format(Entries&& entries, std::string* out_str) const;
+  // machine readable output. messages are written as translation keys and
+  // arguments, nothing is translated or styled.
+
+  // one line like
+  // {"severity":2,"id":17,"code":"e0017","key":24,"labels":[{"file":"a.ry",
+  // "file_id":0,"line":2,"column":6,"length":1,"marker":4,"key":55,
+  // "args":["expression",":="],"annotations":[{"severity":3,"key":60,
+  // "args":["y := 42"]}]}]}
+  // enums are written as their underlying values.
+  void emit_json(const DiagnosticEntry& entry, DiagnosticWriter* out) const;
+
+  // one record as described in engine/record.h
+  void emit_binary(const DiagnosticEntry& entry, DiagnosticWriter* out) const;
 
  private:
   // renders a specific source line Rith marker
-  void render_source_line(std::string* out_str,
+  void render_source_line(DiagnosticWriter* out,
                           const Label& label,
                           std::string_view line,
                           std::size_t line_number_width) const;
 
-  inline static void indent(std::string* out_str, std::size_t count = 1);
+  inline static void indent(DiagnosticWriter* out, std::size_t count = 1);
+
+  // (id, file, range) of the first label
+  struct EntryKey {
+    DiagnosticId diag_id;
+    unicode::Utf8FileId file_id;
+    std::size_t line;
+    std::size_t column;
+    std::size_t length;
+
+    bool operator==(const EntryKey&) const = default;
+  };
+
+  struct EntryKeyHash {
+    std::size_t operator()(const EntryKey& key) const;
+  };
+
+  struct RecoveryRegion {
+    core::SourceLocation begin;
+    core::SourceLocation end;
+  };
+
+  struct FileState {
+    uint32_t entries = 0;
+    std::vector<RecoveryRegion> recovery_regions;
+  };
+
+  // true if `entry` should be kept, records it if so
+  bool accept(const DiagnosticEntry& entry);
+
+  // renders `entry` in options_.output_format
+  void emit_one(DiagnosticEntry&& entry, DiagnosticWriter* out) const;
+
+  // renders entries [begin, end) of a batch, with the separator the
+  // sequential path puts in front of every entry but the first
+  void emit_range(Entries* entries,
+                  std::size_t begin,
+                  std::size_t end,
+                  DiagnosticWriter* out) const;
+
+  // renders contiguous slices of `entries` on a pool of `workers` threads and
+  // writes them to `sink` in order from the calling thread
+  void emit_parallel(Entries* entries,
+                     std::size_t workers,
+                     bool colorise,
+                     DiagnosticSink* sink) const;
+
+  std::size_t worker_count(std::size_t entry_count) const;
+
+  // options_.colorise, if the terminal understands ansi escapes
+  bool should_colorise() const;
 
   template <typename T>
   inline static std::size_t itoa_to_buffer(T value,
@@ -100,14 +199,25 @@ class DiagnosticEngine {
   const i18n::Translator* translator_ = nullptr;
   DiagnosticOptions options_;
 
-  static constexpr const std::size_t kPredictedFormattedStrSize = 512;
-  static constexpr const std::size_t kFormatBufSize = 256;
+  // what push() accepted so far
+  std::unordered_set<EntryKey, EntryKeyHash> reported_;
+  // indexed by file id
+  std::vector<FileState> files_;
+  std::size_t accepted_ = 0;
+  Suppressed suppressed_;
+
+  // entries rendered per task by emit_parallel(), and rendered tasks it
+  // buffers per worker
+  static constexpr const std::size_t kEntriesPerTask = 32;
+  static constexpr const std::size_t kTasksPerWorker = 4;
+
   static constexpr const std::size_t kItoaBufSize = 16;
 };
 
 // static
-inline void DiagnosticEngine::indent(std::string* out_str, std::size_t count) {
-  out_str->append(count * 2, ' ');
+inline void DiagnosticEngine::indent(DiagnosticWriter* out,
+                                     std::size_t count) {
+  out->append(count * 2, ' ');
 }
 
 // static
@@ -4,6 +4,10 @@
 
 #include "frontend/diagnostic/engine/diagnostic_engine.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -18,6 +22,9 @@
 #include "frontend/diagnostic/data/entry_builder.h"
 #include "frontend/diagnostic/data/label.h"
 #include "frontend/diagnostic/data/severity.h"
+#include "frontend/diagnostic/engine/record.h"
+#include "frontend/diagnostic/engine/sink.h"
+#include "frontend/diagnostic/engine/writer.h"
 #include "gtest/gtest.h"
 #include "i18n/base/data/translation_key.h"
 #include "i18n/base/translator.h"
@@ -26,6 +33,66 @@ namespace diagnostic {
 
 static unicode::Utf8FileManager file_manager;
 
+namespace {
+
+// records how the writer hands its output over
+class ChunkSink : public DiagnosticSink {
+ public:
+  void write(const char* data, std::size_t size) override {
+    out.append(data, size);
+    max_chunk = std::max(max_chunk, size);
+    ++chunks;
+  }
+
+  std::string out;
+  std::size_t max_chunk = 0;
+  std::size_t chunks = 0;
+};
+
+DiagnosticEntry move_entry(unicode::Utf8FileId fid, std::size_t line) {
+  return std::move(
+             EntryBuilder(Severity::kError,
+                          DiagnosticId::kMovedVariableThatWasStillBorrowed)
+                 .label(fid, line, 6, 1,
+                        i18n::TranslationKey::kDiagnosticLabelMoveOccursHere,
+                        LabelMarkerType::kEmphasis))
+      .build();
+}
+
+// a label with a quoted, multi-line argument and an annotation
+DiagnosticEntry borrow_entry(unicode::Utf8FileId fid, std::size_t line = 2) {
+  static constexpr std::string_view kArg = "say \"hi\"\n";
+  return std::move(
+             EntryBuilder(Severity::kError,
+                          DiagnosticId::kMovedVariableThatWasStillBorrowed)
+                 .label(fid, line, 3, 4,
+                        i18n::TranslationKey::kDiagnosticLabelExpectedAfter,
+                        LabelMarkerType::kEmphasis, {kArg, "x"})
+                 .annotation(
+                     AnnotationSeverity::kHelp,
+                     i18n::TranslationKey::kDiagnosticAnnotationTryCloningData,
+                     {"data"}))
+      .build();
+}
+
+template <typename T>
+T read_record(std::string_view data, std::size_t* offset) {
+  T value;
+  EXPECT_LE(*offset + sizeof(T), data.size());
+  std::memcpy(&value, data.data() + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return value;
+}
+
+std::string_view read_string(std::string_view data, std::size_t* offset) {
+  const uint32_t size = read_record<uint32_t>(data, offset);
+  const std::string_view str = data.substr(*offset, size);
+  *offset += size;
+  return str;
+}
+
+}  // namespace
+
 TEST(DiagnosticEngineTest, FormatSingle) {
   std::u8string source = u8"x := 42;\ny := ;\n";
   unicode::Utf8FileId fid =
@@ -188,4 +255,355 @@ TEST(DiagnosticEngineTest, FormatVeryLargeLineNumber) {
   EXPECT_NE(formatted3.find("expected expression after `:=`"), np);
 }
 
+TEST(DiagnosticEngineTest, StreamsIntoSinkThroughFixedBuffer) {
+  std::u8string source;
+  constexpr std::size_t kLines = 2000;
+  for (std::size_t i = 0; i < kLines; ++i) {
+    source += u8"y := ;\n";
+  }
+  unicode::Utf8FileId fid =
+      file_manager.register_virtual_file(std::move(source));
+  i18n::Translator translator;
+  DiagnosticEngine engine(
+      &file_manager, &translator,
+      DiagnosticOptions{.max_entries = 0, .max_entries_per_file = 0});
+
+  for (std::size_t i = 1; i <= kLines; ++i) {
+    engine.push(move_entry(fid, i));
+  }
+  const std::string formatted = engine.format_batch_and_clear();
+  EXPECT_TRUE(engine.entries().empty());
+
+  // forget them, they would be dropped as duplicates otherwise
+  engine.clear();
+  for (std::size_t i = 1; i <= kLines; ++i) {
+    engine.push(move_entry(fid, i));
+  }
+  ChunkSink sink;
+  engine.emit_batch_and_clear(&sink);
+  EXPECT_TRUE(engine.entries().empty());
+
+  EXPECT_EQ(sink.out, formatted);
+  EXPECT_GT(sink.chunks, 1u);
+  EXPECT_LE(sink.max_chunk, DiagnosticWriter::kBufferSize);
+
+  constexpr const auto np = std::string::npos;
+  EXPECT_NE(formatted.find("2000 | y := "), np);
+  EXPECT_NE(formatted.find("move occurs here"), np);
+}
+
+TEST(DiagnosticEngineTest, WriterStylesOnlyWhenColorised) {
+  std::string plain;
+  std::string colored;
+  {
+    StringSink sink(&plain);
+    DiagnosticWriter out(&sink, false);
+    out.begin_style(core::Color::kRed);
+    out.append("error");
+    out.end_style();
+  }
+  {
+    StringSink sink(&colored);
+    DiagnosticWriter out(&sink, true);
+    out.begin_style(core::Color::kRed);
+    out.append("error");
+    out.end_style();
+    out.begin_style(core::Color::kDefault);
+    out.append(3, '~');
+    out.end_style();
+  }
+  EXPECT_EQ(plain, "error");
+  EXPECT_EQ(colored, "\033[1m\033[31merror\033[0m\033[1m~~~\033[0m");
+
+  // text larger than the buffer goes straight to the sink
+  const std::string large(DiagnosticWriter::kBufferSize * 3 + 5, 'x');
+  ChunkSink sink;
+  {
+    DiagnosticWriter out(&sink, false);
+    out.append('a');
+    out.append(large);
+    out.append(DiagnosticWriter::kBufferSize + 1, 'b');
+  }
+  EXPECT_EQ(sink.out,
+            "a" + large + std::string(DiagnosticWriter::kBufferSize + 1, 'b'));
+}
+
+TEST(DiagnosticEngineTest, HeaderShowsFullDiagnosticCode) {
+  unicode::Utf8FileId fid = file_manager.register_virtual_file(u8"y := ;\n");
+  i18n::Translator translator;
+  DiagnosticEngine engine(&file_manager, &translator,
+                          DiagnosticOptions{.colorise = false});
+  engine.push(move_entry(fid, 1));
+
+  const std::string formatted = engine.pop_and_format();
+  EXPECT_EQ(formatted.find('\0'), std::string::npos);
+  EXPECT_EQ(formatted.find('\033'), std::string::npos);
+  const std::size_t code = formatted.find(": [e");
+  ASSERT_NE(code, std::string::npos);
+  EXPECT_EQ(formatted.substr(code + 8, 3), "] -");
+}
+
+TEST(DiagnosticEngineTest, EmitsJsonLines) {
+  unicode::Utf8FileId fid =
+      file_manager.register_virtual_file(u8"a := 1;\nconsume(data);\n");
+  i18n::Translator translator;
+  DiagnosticEngine engine(
+      &file_manager, &translator,
+      DiagnosticOptions{.output_format = DiagnosticOutputFormat::kJson});
+  engine.push(borrow_entry(fid));
+  engine.push(move_entry(fid, 1));
+
+  const std::string json = engine.format_batch_and_clear();
+  const std::string file_name(file_manager.file(fid).file_name());
+  const auto key = [](auto k) {
+    return std::to_string(static_cast<uint8_t>(k));
+  };
+  constexpr DiagnosticId kId = DiagnosticId::kMovedVariableThatWasStillBorrowed;
+  char code[6];
+  diagnostic_id_to_code(kId, Severity::kError, code);
+
+  const std::size_t first_end = json.find('\n');
+  ASSERT_NE(first_end, std::string::npos);
+  EXPECT_EQ(
+      json.substr(0, first_end),
+      "{\"severity\":2,\"id\":" + key(kId) + ",\"code\":\"" + code +
+          "\",\"key\":" + key(diagnostic_id_to_tr_key(kId)) +
+          ",\"labels\":[{\"file\":\"" + file_name +
+          "\",\"file_id\":" + std::to_string(fid) +
+          ",\"line\":2,\"column\":3,\"length\":4,\"marker\":4,\"key\":" +
+          key(i18n::TranslationKey::kDiagnosticLabelExpectedAfter) +
+          ",\"args\":[\"say \\\"hi\\\"\\n\",\"x\"],"
+          "\"annotations\":[{\"severity\":3,\"key\":" +
+          key(i18n::TranslationKey::kDiagnosticAnnotationTryCloningData) +
+          ",\"args\":[\"data\"]}]}]}");
+
+  // one object per line, nothing translated
+  EXPECT_EQ(json.find('\n', first_end + 1), json.size() - 1);
+  EXPECT_EQ(json.find("moved"), std::string::npos);
+  EXPECT_EQ(json.find('\033'), std::string::npos);
+}
+
+TEST(DiagnosticEngineTest, EmitsBinaryRecords) {
+  unicode::Utf8FileId fid =
+      file_manager.register_virtual_file(u8"a := 1;\nconsume(data);\n");
+  i18n::Translator translator;
+  DiagnosticEngine engine(
+      &file_manager, &translator,
+      DiagnosticOptions{.output_format = DiagnosticOutputFormat::kBinary});
+  engine.push(borrow_entry(fid));
+  engine.push(move_entry(fid, 1));
+
+  const std::string data = engine.format_batch_and_clear();
+  const std::string_view file_name = file_manager.file(fid).file_name();
+
+  std::size_t offset = 0;
+  const auto entry = read_record<BinaryEntryRecord>(data, &offset);
+  EXPECT_EQ(entry.version, kBinaryRecordVersion);
+  EXPECT_EQ(entry.severity, static_cast<uint8_t>(Severity::kError));
+  EXPECT_EQ(entry.diag_id,
+            static_cast<uint8_t>(
+                DiagnosticId::kMovedVariableThatWasStillBorrowed));
+  ASSERT_EQ(entry.label_count, 1u);
+
+  const auto label = read_record<BinaryLabelRecord>(data, &offset);
+  EXPECT_EQ(label.file_id, fid);
+  EXPECT_EQ(label.line, 2u);
+  EXPECT_EQ(label.column, 3u);
+  EXPECT_EQ(label.length, 4u);
+  EXPECT_EQ(label.tr_key,
+            static_cast<uint8_t>(
+                i18n::TranslationKey::kDiagnosticLabelExpectedAfter));
+  ASSERT_EQ(label.arg_count, 2u);
+  ASSERT_EQ(label.annotation_count, 1u);
+  ASSERT_EQ(label.file_name_size, file_name.size());
+  EXPECT_EQ(data.substr(offset, file_name.size()), file_name);
+  offset += file_name.size();
+  EXPECT_EQ(read_string(data, &offset), "say \"hi\"\n");
+  EXPECT_EQ(read_string(data, &offset), "x");
+
+  const auto annotation = read_record<BinaryAnnotationRecord>(data, &offset);
+  EXPECT_EQ(annotation.severity,
+            static_cast<uint8_t>(AnnotationSeverity::kHelp));
+  ASSERT_EQ(annotation.arg_count, 1u);
+  EXPECT_EQ(read_string(data, &offset), "data");
+  EXPECT_EQ(offset, entry.size);
+
+  // the second record can be skipped by its size alone
+  const auto second = read_record<BinaryEntryRecord>(data, &offset);
+  EXPECT_EQ(second.label_count, 1u);
+  EXPECT_EQ(entry.size + second.size, data.size());
+}
+
+TEST(DiagnosticEngineTest, BinaryRecordsCutListsToTheirCount) {
+  unicode::Utf8FileId fid = file_manager.register_virtual_file(u8"a := 1;\n");
+  i18n::Translator translator;
+  DiagnosticEngine engine(
+      &file_manager, &translator,
+      DiagnosticOptions{.output_format = DiagnosticOutputFormat::kBinary});
+
+  // more annotations than the one byte count can hold
+  constexpr std::size_t kAnnotations = 300;
+  EntryBuilder builder(Severity::kError,
+                       DiagnosticId::kMovedVariableThatWasStillBorrowed);
+  builder.label(fid, 1, 1, 1,
+                i18n::TranslationKey::kDiagnosticLabelMoveOccursHere,
+                LabelMarkerType::kEmphasis);
+  for (std::size_t i = 0; i < kAnnotations; ++i) {
+    builder.annotation(
+        AnnotationSeverity::kHelp,
+        i18n::TranslationKey::kDiagnosticAnnotationTryCloningData, {"data"});
+  }
+  engine.push(std::move(builder).build());
+
+  const std::string data = engine.format_batch_and_clear();
+  std::size_t offset = 0;
+  const auto entry = read_record<BinaryEntryRecord>(data, &offset);
+  ASSERT_EQ(entry.label_count, 1u);
+  const auto label = read_record<BinaryLabelRecord>(data, &offset);
+  ASSERT_EQ(label.annotation_count, 255u);
+  offset += label.file_name_size;
+  for (std::size_t i = 0; i < label.annotation_count; ++i) {
+    const auto annotation = read_record<BinaryAnnotationRecord>(data, &offset);
+    ASSERT_EQ(annotation.arg_count, 1u);
+    EXPECT_EQ(read_string(data, &offset), "data");
+  }
+  EXPECT_EQ(offset, entry.size);
+  EXPECT_EQ(offset, data.size());
+}
+
+TEST(DiagnosticEngineTest, DropsDuplicatesAndCascadedErrors) {
+  unicode::Utf8FileId fid =
+      file_manager.register_virtual_file(u8"a\nb\nc\nd\n");
+  i18n::Translator translator;
+  DiagnosticEngine engine(&file_manager, &translator, DiagnosticOptions{});
+
+  engine.push(move_entry(fid, 1));
+  engine.push(move_entry(fid, 1));
+  EXPECT_EQ(engine.entries().size(), 1u);
+  EXPECT_EQ(engine.suppressed().duplicates, 1u);
+
+  // another id at the same place is not a duplicate
+  engine.push(std::move(EntryBuilder(Severity::kError,
+                                     DiagnosticId::kExpectedButFound)
+                            .label(fid, 1, 6, 1,
+                                   i18n::TranslationKey::kDiagnosticUnknown))
+                  .build());
+  EXPECT_EQ(engine.entries().size(), 2u);
+
+  // recovered from line 2, column 6 up to line 3, column 6
+  DiagnosticEntry recovered = move_entry(fid, 2);
+  recovered.set_recovery_end(core::SourceLocation(3, 6));
+  engine.push(std::move(recovered));
+  engine.push(std::move(EntryBuilder(Severity::kError,
+                                     DiagnosticId::kExpectedButFound)
+                            .label(fid, 3, 1, 1,
+                                   i18n::TranslationKey::kDiagnosticUnknown))
+                  .build());
+  EXPECT_EQ(engine.entries().size(), 3u);
+  EXPECT_EQ(engine.suppressed().cascaded, 1u);
+
+  // where parsing resumed is reported again
+  engine.push(move_entry(fid, 3));
+  EXPECT_EQ(engine.entries().size(), 4u);
+
+  // emitting keeps the history
+  engine.format_batch_and_clear();
+  engine.push(move_entry(fid, 3));
+  EXPECT_TRUE(engine.entries().empty());
+  EXPECT_EQ(engine.suppressed().total(), 3u);
+
+  engine.clear();
+  engine.push(move_entry(fid, 3));
+  EXPECT_EQ(engine.entries().size(), 1u);
+  EXPECT_EQ(engine.suppressed().total(), 0u);
+}
+
+TEST(DiagnosticEngineTest, LimitsEntriesPerFileAndInTotal) {
+  unicode::Utf8FileId a = file_manager.register_virtual_file(u8"a\nb\nc\n");
+  unicode::Utf8FileId b = file_manager.register_virtual_file(u8"a\nb\nc\n");
+  i18n::Translator translator;
+  DiagnosticEngine engine(
+      &file_manager, &translator,
+      DiagnosticOptions{.max_entries = 3, .max_entries_per_file = 2});
+
+  for (std::size_t line = 1; line <= 3; ++line) {
+    engine.push(move_entry(a, line));
+  }
+  EXPECT_EQ(engine.entries().size(), 2u);
+
+  for (std::size_t line = 1; line <= 3; ++line) {
+    engine.push(move_entry(b, line));
+  }
+  EXPECT_EQ(engine.entries().size(), 3u);
+  EXPECT_EQ(engine.suppressed().over_limit, 3u);
+  EXPECT_EQ(engine.entries().back().labels()[0].file_id(), b);
+}
+
+TEST(DiagnosticEngineTest, ParallelBatchMatchesSequential) {
+  constexpr std::size_t kLines = 300;
+  std::u8string source;
+  for (std::size_t i = 0; i < kLines; ++i) {
+    source += u8"y := ;\n";
+  }
+  const unicode::Utf8FileId files[] = {
+      file_manager.register_virtual_file(std::u8string(source)),
+      file_manager.register_virtual_file(std::u8string(source)),
+      file_manager.register_virtual_file(std::move(source)),
+  };
+  i18n::Translator translator;
+
+  auto render = [&](DiagnosticOutputFormat format, uint32_t jobs) {
+    DiagnosticEngine engine(&file_manager, &translator,
+                            DiagnosticOptions{.output_format = format,
+                                              .max_entries = 0,
+                                              .max_entries_per_file = 0,
+                                              .jobs = jobs});
+    for (std::size_t line = 1; line <= kLines; ++line) {
+      for (const unicode::Utf8FileId fid : files) {
+        engine.push(line % 7 == 0 ? borrow_entry(fid, line)
+                                  : move_entry(fid, line));
+      }
+    }
+    ChunkSink sink;
+    engine.emit_batch_and_clear(&sink);
+    EXPECT_TRUE(engine.entries().empty());
+    return sink.out;
+  };
+
+  for (const DiagnosticOutputFormat format :
+       {DiagnosticOutputFormat::kClassic, DiagnosticOutputFormat::kJson,
+        DiagnosticOutputFormat::kBinary}) {
+    const std::string sequential = render(format, 1);
+    EXPECT_FALSE(sequential.empty());
+    EXPECT_EQ(render(format, 2), sequential);
+    EXPECT_EQ(render(format, 7), sequential);
+    EXPECT_EQ(render(format, 0), sequential);
+  }
+}
+
+TEST(DiagnosticEngineTest, FormatsLongArgumentsInFull) {
+  unicode::Utf8FileId fid =
+      file_manager.register_virtual_file(u8"a := 1;\nconsume(data);\n");
+  i18n::Translator translator;
+  DiagnosticEngine engine(&file_manager, &translator,
+                          DiagnosticOptions{.colorise = false});
+  const std::string long_arg(1000, 'x');
+  EntryBuilder builder(Severity::kError,
+                       DiagnosticId::kMovedVariableThatWasStillBorrowed);
+  builder
+      .label(fid, 2, 3, 4, i18n::TranslationKey::kDiagnosticLabelExpectedAfter,
+             LabelMarkerType::kEmphasis, {long_arg, "y"})
+      .annotation(AnnotationSeverity::kHelp,
+                  i18n::TranslationKey::kDiagnosticAnnotationTryCloningData,
+                  {long_arg});
+  engine.push(std::move(builder).build());
+
+  const std::string formatted = engine.format_batch_and_clear();
+  EXPECT_NE(formatted.find("~~~~ expected " + long_arg + " after `y`\n"),
+            std::string::npos);
+  EXPECT_NE(formatted.find("help: try cloning `" + long_arg +
+                           "` if you need to use it after moving\n"),
+            std::string::npos);
+}
+
 }  // namespace diagnostic
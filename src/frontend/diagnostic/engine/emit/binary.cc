@@ -0,0 +1,135 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "frontend/diagnostic/data/diagnostic_entry.h"
+#include "frontend/diagnostic/data/diagnostic_id.h"
+#include "frontend/diagnostic/engine/diagnostic_engine.h"
+#include "frontend/diagnostic/engine/record.h"
+#include "frontend/diagnostic/engine/writer.h"
+
+namespace diagnostic {
+
+namespace {
+
+// the record counts are narrow. a longer list is cut to what its count can
+// hold, and only the counted elements are written, so readers stay in sync.
+template <typename Count, typename T>
+inline std::span<const T> counted(const std::vector<T>& elements) {
+  return std::span<const T>(elements).first(std::min<std::size_t>(
+      elements.size(), std::numeric_limits<Count>::max()));
+}
+
+// format args are bounded by the array, which always fits the count
+static_assert(
+    i18n::kMaxFormatArgsCount <=
+    std::numeric_limits<decltype(BinaryLabelRecord::arg_count)>::max());
+static_assert(
+    i18n::kMaxFormatArgsCount <=
+    std::numeric_limits<decltype(BinaryAnnotationRecord::arg_count)>::max());
+
+inline std::size_t arg_count(const i18n::FormatArgs& args,
+                             std::size_t args_count) {
+  return std::min(args_count, args.size());
+}
+
+std::size_t args_size(const i18n::FormatArgs& args, std::size_t args_count) {
+  std::size_t size = 0;
+  for (std::size_t i = 0; i < arg_count(args, args_count); ++i) {
+    size += sizeof(uint32_t) + args[i].size();
+  }
+  return size;
+}
+
+void write_string(std::string_view str, DiagnosticWriter* out) {
+  out->append_bytes(static_cast<uint32_t>(str.size()));
+  out->append(str);
+}
+
+void write_args(const i18n::FormatArgs& args,
+                std::size_t args_count,
+                DiagnosticWriter* out) {
+  for (std::size_t i = 0; i < arg_count(args, args_count); ++i) {
+    write_string(args[i], out);
+  }
+}
+
+}  // namespace
+
+void DiagnosticEngine::emit_binary(const DiagnosticEntry& entry,
+                                   DiagnosticWriter* out) const {
+  using LabelCount = decltype(BinaryEntryRecord::label_count);
+  using AnnotationCount = decltype(BinaryLabelRecord::annotation_count);
+  const Header& header = entry.header();
+  const std::span<const Label> labels = counted<LabelCount>(entry.labels());
+
+  // the size goes first, so add everything up before writing
+  std::size_t size = sizeof(BinaryEntryRecord);
+  for (const Label& label : labels) {
+    size += sizeof(BinaryLabelRecord) +
+            file_manager_->file(label.file_id()).file_name().size() +
+            args_size(label.format_args(), label.args_count());
+    for (const Annotation& annotation :
+         counted<AnnotationCount>(label.annotations())) {
+      size += sizeof(BinaryAnnotationRecord) +
+              args_size(annotation.format_args(), annotation.args_count());
+    }
+  }
+
+  const BinaryEntryRecord entry_record = {
+      .size = static_cast<uint32_t>(size),
+      .version = kBinaryRecordVersion,
+      .severity = static_cast<uint8_t>(header.severity()),
+      .diag_id = static_cast<uint8_t>(header.diag_id()),
+      .tr_key =
+          static_cast<uint8_t>(diagnostic_id_to_tr_key(header.diag_id())),
+      .reserved = 0,
+      .label_count = static_cast<LabelCount>(labels.size()),
+  };
+  out->append_bytes(entry_record);
+
+  for (const Label& label : labels) {
+    const std::span<const Annotation> annotations =
+        counted<AnnotationCount>(label.annotations());
+    const std::string_view file_name =
+        file_manager_->file(label.file_id()).file_name();
+    const core::SourceLocation& loc = label.range().start();
+    const BinaryLabelRecord label_record = {
+        .file_id = label.file_id(),
+        .line = static_cast<uint32_t>(loc.line()),
+        .column = static_cast<uint32_t>(loc.column()),
+        .length = static_cast<uint32_t>(label.range().length()),
+        .file_name_size = static_cast<uint32_t>(file_name.size()),
+        .tr_key = static_cast<uint8_t>(label.message_tr_key()),
+        .marker_type = static_cast<uint8_t>(label.marker_type()),
+        .arg_count = static_cast<uint8_t>(
+            arg_count(label.format_args(), label.args_count())),
+        .annotation_count = static_cast<AnnotationCount>(annotations.size()),
+    };
+    out->append_bytes(label_record);
+    out->append(file_name);
+    write_args(label.format_args(), label.args_count(), out);
+
+    for (const Annotation& annotation : annotations) {
+      const BinaryAnnotationRecord annotation_record = {
+          .severity = static_cast<uint8_t>(annotation.severity()),
+          .tr_key = static_cast<uint8_t>(annotation.message_tr_key()),
+          .arg_count = static_cast<uint8_t>(
+              arg_count(annotation.format_args(), annotation.args_count())),
+          .reserved = 0,
+      };
+      out->append_bytes(annotation_record);
+      write_args(annotation.format_args(), annotation.args_count(), out);
+    }
+  }
+}
+
+}  // namespace diagnostic
@@ -0,0 +1,144 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "frontend/diagnostic/data/diagnostic_entry.h"
+#include "frontend/diagnostic/data/diagnostic_id.h"
+#include "frontend/diagnostic/engine/diagnostic_engine.h"
+#include "frontend/diagnostic/engine/writer.h"
+
+namespace diagnostic {
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// quoted and escaped. bytes above 0x7f are valid utf-8 already and are
+// written as they are.
+void write_json_string(std::string_view str, DiagnosticWriter* out) {
+  out->append('"');
+  std::size_t run_start = 0;
+  for (std::size_t i = 0; i < str.size(); ++i) {
+    const unsigned char c = static_cast<unsigned char>(str[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    out->append(str.substr(run_start, i - run_start));
+    run_start = i + 1;
+    switch (c) {
+      case '"': out->append("\\\""); break;
+      case '\\': out->append("\\\\"); break;
+      case '\n': out->append("\\n"); break;
+      case '\r': out->append("\\r"); break;
+      case '\t': out->append("\\t"); break;
+      default: {
+        const char escaped[] = {'\\', 'u', '0', '0', kHexDigits[c >> 4],
+                                kHexDigits[c & 0xf]};
+        out->append(escaped, sizeof(escaped));
+        break;
+      }
+    }
+  }
+  out->append(str.substr(run_start));
+  out->append('"');
+}
+
+// enums are written as their underlying value, whatever its width
+template <typename T>
+void write_json_field(std::string_view name, T value, DiagnosticWriter* out) {
+  out->append('"');
+  out->append(name);
+  out->append("\":");
+  if constexpr (std::is_enum_v<T>) {
+    out->append_integer(static_cast<std::underlying_type_t<T>>(value));
+  } else {
+    out->append_integer(value);
+  }
+}
+
+void write_json_args(const i18n::FormatArgs& args,
+                     std::size_t args_count,
+                     DiagnosticWriter* out) {
+  out->append(",\"args\":[");
+  const std::size_t count = std::min(args_count, args.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    if (i != 0) {
+      out->append(',');
+    }
+    write_json_string(args[i], out);
+  }
+  out->append(']');
+}
+
+}  // namespace
+
+void DiagnosticEngine::emit_json(const DiagnosticEntry& entry,
+                                 DiagnosticWriter* out) const {
+  const Header& header = entry.header();
+
+  out->append('{');
+  write_json_field("severity", header.severity(), out);
+  out->append(',');
+  write_json_field("id", header.diag_id(), out);
+
+  // "e0017"
+  constexpr std::size_t kDiagCodeLength = 5;
+  char diag_code_buf[kDiagCodeLength + 1];
+  diagnostic_id_to_code(header.diag_id(), header.severity(), diag_code_buf);
+  out->append(",\"code\":\"");
+  out->append(diag_code_buf, kDiagCodeLength);
+  out->append("\",");
+  write_json_field("key", diagnostic_id_to_tr_key(header.diag_id()), out);
+
+  out->append(",\"labels\":[");
+  bool first_label = true;
+  for (const Label& label : entry.labels()) {
+    if (!first_label) {
+      out->append(',');
+    }
+    first_label = false;
+
+    const core::SourceLocation& loc = label.range().start();
+    out->append("{\"file\":");
+    write_json_string(file_manager_->file(label.file_id()).file_name(), out);
+    out->append(',');
+    write_json_field("file_id", label.file_id(), out);
+    out->append(',');
+    write_json_field("line", loc.line(), out);
+    out->append(',');
+    write_json_field("column", loc.column(), out);
+    out->append(',');
+    write_json_field("length", label.range().length(), out);
+    out->append(',');
+    write_json_field("marker", label.marker_type(), out);
+    out->append(',');
+    write_json_field("key", label.message_tr_key(), out);
+    write_json_args(label.format_args(), label.args_count(), out);
+
+    out->append(",\"annotations\":[");
+    bool first_annotation = true;
+    for (const Annotation& annotation : label.annotations()) {
+      if (!first_annotation) {
+        out->append(',');
+      }
+      first_annotation = false;
+
+      out->append('{');
+      write_json_field("severity", annotation.severity(), out);
+      out->append(',');
+      write_json_field("key", annotation.message_tr_key(), out);
+      write_json_args(annotation.format_args(), annotation.args_count(), out);
+      out->append('}');
+    }
+    out->append("]}");
+  }
+  out->append("]}\n");
+}
+
+}  // namespace diagnostic
@@ -3,48 +3,44 @@
 // which can be found in the LICENSE file.
 
 #include <cstddef>
-#include <string>
+#include <string_view>
 
-#include "core/cli/ansi/style_builder.h"
 #include "frontend/diagnostic/engine/diagnostic_engine.h"
+#include "frontend/diagnostic/engine/writer.h"
 #include "i18n/base/translator.h"
 
 namespace diagnostic {
 
 void DiagnosticEngine::format_annotation(const Annotation& annotation,
                                          std::size_t line_number_width,
-                                         std::string* out_str) const {
+                                         DiagnosticWriter* out) const {
   const AnnotationSeverity severity = annotation.severity();
   const core::Color severity_color = annotation_severity_to_color(severity);
   const char* severity_str = annotation_severity_to_string(severity);
 
-  core::StyleBuilder s;
+  out->append(line_number_width, ' ');
+  out->append(" = ");
 
-  out_str->append(line_number_width, ' ');
-  out_str->append(" = ");
+  out->begin_style(severity_color);
+  out->append(severity_str);
+  out->end_style();
 
-  s.style(core::Style::kBold).color(severity_color);
-  out_str->append(s.build(severity_str));
-  s.reset();
+  out->append(": ");
 
-  out_str->append(": ");
-
-  s.style(core::Style::kBold);
   if (annotation.message_tr_key() != i18n::TranslationKey::kUnknown) {
+    out->begin_style(core::Color::kDefault);
     if (annotation.should_format()) {
-      char format_buf[kFormatBufSize];
-      translator_->translate_fmt_to(annotation.message_tr_key(), format_buf,
-                                    annotation.format_args(),
-                                    annotation.args_count());
-      out_str->append(s.build(format_buf));
+      translator_->translate_fmt_each(
+          annotation.message_tr_key(), annotation.format_args(),
+          annotation.args_count(),
+          [out](std::string_view piece) { out->append(piece); });
     } else {
-      out_str->append(
-          s.build(translator_->translate(annotation.message_tr_key())));
+      out->append(translator_->translate(annotation.message_tr_key()));
     }
+    out->end_style();
   }
-  s.reset();
 
-  out_str->append("\n");
+  out->append('\n');
 }
 
 }  // namespace diagnostic
@@ -3,47 +3,44 @@
 // which can be found in the LICENSE file.
 
 #include <cstddef>
-#include <string>
 
-#include "core/cli/ansi/style_builder.h"
 #include "frontend/diagnostic/data/severity.h"
 #include "frontend/diagnostic/engine/diagnostic_engine.h"
+#include "frontend/diagnostic/engine/writer.h"
 #include "i18n/base/translator.h"
 
 namespace diagnostic {
 
 void DiagnosticEngine::format_header(const Header& header,
-                                     std::string* out_str) const {
+                                     DiagnosticWriter* out) const {
   const core::Color severity_color = severity_to_color(header.severity());
 
-  core::StyleBuilder s;
+  out->begin_style(severity_color);
+  out->append(translator_->translate(severity_to_tr_key(header.severity())));
+  out->end_style();
 
-  s.style(core::Style::kBold).color(severity_color);
-  out_str->append(
-      s.build(translator_->translate(severity_to_tr_key(header.severity()))));
-  s.reset();
-
-  out_str->append(": ");
+  out->append(": ");
 
   // diag_code be like "[e0001]" <- fixed length
-  constexpr std::size_t kDiagCodeBufSize = 8;
-  char diag_code_buf[kDiagCodeBufSize];
+  constexpr std::size_t kDiagCodeLength = 7;
+  char diag_code_buf[kDiagCodeLength];
   diag_code_buf[0] = '[';
   diagnostic_id_to_code(header.diag_id(), header.severity(), diag_code_buf + 1);
-  diag_code_buf[kDiagCodeBufSize - 1] = ']';
+  // overwrites the terminator
+  diag_code_buf[kDiagCodeLength - 1] = ']';
 
-  s.style(core::Style::kBold).color(severity_color);
-  out_str->append(s.build(diag_code_buf, 7));
-  s.reset();
+  out->begin_style(severity_color);
+  out->append(diag_code_buf, kDiagCodeLength);
+  out->end_style();
 
-  out_str->append(" - ");
+  out->append(" - ");
 
-  s.style(core::Style::kBold);
-  out_str->append(s.build(
-      translator_->translate(diagnostic_id_to_tr_key(header.diag_id()))));
-  s.reset();
+  out->begin_style(core::Color::kDefault);
+  out->append(
+      translator_->translate(diagnostic_id_to_tr_key(header.diag_id())));
+  out->end_style();
 
-  out_str->append("\n");
+  out->append('\n');
 }
 
 }  // namespace diagnostic
@@ -0,0 +1,97 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_DIAGNOSTIC_ENGINE_RECORD_H_
+#define FRONTEND_DIAGNOSTIC_ENGINE_RECORD_H_
+
+#include <cstdint>
+#include <type_traits>
+
+#include "frontend/diagnostic/data/annotation.h"
+#include "frontend/diagnostic/data/diagnostic_id.h"
+#include "frontend/diagnostic/data/label.h"
+#include "frontend/diagnostic/data/severity.h"
+#include "i18n/base/data/translation_key.h"
+
+namespace diagnostic {
+
+// layout of DiagnosticOutputFormat::kBinary. every diagnostic is one record,
+// records follow each other without padding, in host byte order. read them
+// with memcpy, nothing is aligned.
+//
+// record:
+//   BinaryEntryRecord
+//   label_count x label:
+//     BinaryLabelRecord
+//     file name (file_name_size bytes)
+//     arg_count x string
+//     annotation_count x annotation:
+//       BinaryAnnotationRecord
+//       arg_count x string
+// string:
+//   uint32_t size, then size bytes
+//
+// messages are carried as i18n::TranslationKey values plus their arguments,
+// translating them is left to the reader.
+
+// bump whenever a record layout changes
+inline constexpr uint16_t kBinaryRecordVersion = 1;
+
+struct BinaryEntryRecord {
+  // of the whole record, this header included
+  uint32_t size;
+  uint16_t version;
+  // Severity
+  uint8_t severity;
+  // DiagnosticId
+  uint8_t diag_id;
+  // i18n::TranslationKey of the header message
+  uint8_t tr_key;
+  uint8_t reserved;
+  uint16_t label_count;
+};
+
+struct BinaryLabelRecord {
+  uint32_t file_id;
+  uint32_t line;
+  uint32_t column;
+  uint32_t length;
+  uint32_t file_name_size;
+  uint8_t tr_key;
+  // LabelMarkerType
+  uint8_t marker_type;
+  uint8_t arg_count;
+  uint8_t annotation_count;
+};
+
+struct BinaryAnnotationRecord {
+  // AnnotationSeverity
+  uint8_t severity;
+  uint8_t tr_key;
+  uint8_t arg_count;
+  uint8_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<BinaryEntryRecord>);
+static_assert(std::is_trivially_copyable_v<BinaryLabelRecord>);
+static_assert(std::is_trivially_copyable_v<BinaryAnnotationRecord>);
+// the one byte fields above hold these enums. widen the fields and bump
+// kBinaryRecordVersion before any of them outgrows a byte, e.g. once
+// i18n_gen.py picks uint16_t for TranslationKey.
+static_assert(sizeof(std::underlying_type_t<Severity>) == sizeof(uint8_t));
+static_assert(sizeof(std::underlying_type_t<DiagnosticId>) == sizeof(uint8_t));
+static_assert(sizeof(std::underlying_type_t<i18n::TranslationKey>) ==
+              sizeof(uint8_t));
+static_assert(sizeof(std::underlying_type_t<LabelMarkerType>) ==
+              sizeof(uint8_t));
+static_assert(sizeof(std::underlying_type_t<AnnotationSeverity>) ==
+              sizeof(uint8_t));
+
+static_assert(sizeof(BinaryEntryRecord) == 12);
+static_assert(sizeof(BinaryLabelRecord) == 24);
+static_assert(sizeof(BinaryAnnotationRecord) == 4);
+
+}  // namespace diagnostic
+
+#endif  // FRONTEND_DIAGNOSTIC_ENGINE_RECORD_H_
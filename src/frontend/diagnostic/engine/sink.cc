@@ -0,0 +1,56 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/diagnostic/engine/sink.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <string_view>
+
+#include "build/build_flag.h"
+#include "core/base/logger.h"
+
+#if IS_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace diagnostic {
+
+void FdSink::write(const char* data, std::size_t size) {
+  std::size_t total_written = 0;
+  while (!failed_ && total_written < size) {
+#if IS_WINDOWS
+    const int bytes = _write(fd_, data + total_written,
+                             static_cast<unsigned int>(size - total_written));
+#else
+    const ssize_t bytes = ::write(fd_, data + total_written,
+                                  size - total_written);
+#endif
+    if (bytes < 0 && errno == EINTR) {
+      // interrupted before anything was written, try again
+      continue;
+    }
+    if (bytes <= 0) {
+      failed_ = true;
+      return;
+    }
+    // a short write leaves the rest for the next iteration
+    total_written += static_cast<std::size_t>(bytes);
+  }
+}
+
+void LoggerSink::write(const char* data, std::size_t size) {
+  // the logger may read the argument after this returns, and the writer
+  // reuses `data` for the next chunk
+  logger_->raw_ref<"{}">(std::string_view(data, size));
+  logger_->flush();
+}
+
+void LoggerSink::flush() {
+  logger_->flush();
+}
+
+}  // namespace diagnostic
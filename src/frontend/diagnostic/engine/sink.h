@@ -0,0 +1,78 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_DIAGNOSTIC_ENGINE_SINK_H_
+#define FRONTEND_DIAGNOSTIC_ENGINE_SINK_H_
+
+#include <cstddef>
+#include <string>
+
+#include "core/base/logger.h"
+#include "frontend/diagnostic/base/diagnostic_export.h"
+
+namespace diagnostic {
+
+// where rendered diagnostics go. DiagnosticWriter hands over its buffer in
+// chunks, so a sink never sees more than one chunk at a time and must not keep
+// pointers into it.
+class DIAGNOSTIC_EXPORT DiagnosticSink {
+ public:
+  DiagnosticSink() = default;
+  virtual ~DiagnosticSink() = default;
+
+  DiagnosticSink(const DiagnosticSink&) = delete;
+  DiagnosticSink& operator=(const DiagnosticSink&) = delete;
+
+  virtual void write(const char* data, std::size_t size) = 0;
+  virtual void flush() {}
+};
+
+// writes to a file descriptor, e.g. 2 for stderr. the descriptor is not
+// closed.
+class DIAGNOSTIC_EXPORT FdSink : public DiagnosticSink {
+ public:
+  explicit FdSink(int fd) : fd_(fd) {}
+  ~FdSink() override = default;
+
+  void write(const char* data, std::size_t size) override;
+
+  // true once a write failed, everything after it is dropped
+  inline bool failed() const { return failed_; }
+
+ private:
+  int fd_ = -1;
+  bool failed_ = false;
+};
+
+// writes through a femtolog logger as raw messages
+class DIAGNOSTIC_EXPORT LoggerSink : public DiagnosticSink {
+ public:
+  explicit LoggerSink(femtolog::Logger* logger = &core::glog)
+      : logger_(logger) {}
+  ~LoggerSink() override = default;
+
+  void write(const char* data, std::size_t size) override;
+  void flush() override;
+
+ private:
+  femtolog::Logger* logger_ = nullptr;
+};
+
+// appends to a string, for tests and callers that want the whole output
+class DIAGNOSTIC_EXPORT StringSink : public DiagnosticSink {
+ public:
+  explicit StringSink(std::string* out) : out_(out) {}
+  ~StringSink() override = default;
+
+  inline void write(const char* data, std::size_t size) override {
+    out_->append(data, size);
+  }
+
+ private:
+  std::string* out_ = nullptr;
+};
+
+}  // namespace diagnostic
+
+#endif  // FRONTEND_DIAGNOSTIC_ENGINE_SINK_H_
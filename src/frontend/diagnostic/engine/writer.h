@@ -0,0 +1,141 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_DIAGNOSTIC_ENGINE_WRITER_H_
+#define FRONTEND_DIAGNOSTIC_ENGINE_WRITER_H_
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "core/check.h"
+#include "core/cli/ansi/style_util.h"
+#include "frontend/diagnostic/engine/sink.h"
+
+namespace diagnostic {
+
+// bold, then the color. the same bytes core::StyleBuilder emits for
+// style(kBold).color(c), without building them per span.
+inline constexpr std::string_view kAnsiBold = "\033[1m";
+inline constexpr std::string_view kAnsiReset = "\033[0m";
+inline constexpr std::array<std::string_view, 16> kAnsiBoldColors = {
+    "\033[1m\033[30m", "\033[1m\033[31m", "\033[1m\033[32m",
+    "\033[1m\033[33m", "\033[1m\033[34m", "\033[1m\033[35m",
+    "\033[1m\033[36m", "\033[1m\033[37m", "\033[1m\033[90m",
+    "\033[1m\033[91m", "\033[1m\033[92m", "\033[1m\033[93m",
+    "\033[1m\033[94m", "\033[1m\033[95m", "\033[1m\033[96m",
+    "\033[1m\033[97m",
+};
+
+// buffers rendered output in a fixed buffer and hands it to a sink whenever
+// it fills up, so rendering any number of diagnostics takes the same memory
+class DiagnosticWriter {
+ public:
+  static constexpr std::size_t kBufferSize = 4096;
+
+  DiagnosticWriter(DiagnosticSink* sink, bool colorise)
+      : sink_(sink), colorise_(colorise) {
+    DCHECK(sink_);
+  }
+
+  ~DiagnosticWriter() { flush(); }
+
+  DiagnosticWriter(const DiagnosticWriter&) = delete;
+  DiagnosticWriter& operator=(const DiagnosticWriter&) = delete;
+
+  inline void append(std::string_view text) {
+    if (text.size() > kBufferSize - size_) {
+      flush();
+      if (text.size() >= kBufferSize) {
+        sink_->write(text.data(), text.size());
+        return;
+      }
+    }
+    std::memcpy(buffer_ + size_, text.data(), text.size());
+    size_ += text.size();
+  }
+
+  inline void append(const char* text, std::size_t size) {
+    append(std::string_view(text, size));
+  }
+
+  inline void append(char c) {
+    if (size_ == kBufferSize) {
+      flush();
+    }
+    buffer_[size_++] = c;
+  }
+
+  inline void append(std::size_t count, char c) {
+    while (count > 0) {
+      if (size_ == kBufferSize) {
+        flush();
+      }
+      const std::size_t n = std::min(count, kBufferSize - size_);
+      std::memset(buffer_ + size_, c, n);
+      size_ += n;
+      count -= n;
+    }
+  }
+
+  template <typename T>
+  inline void append_integer(T value) {
+    static_assert(std::is_integral_v<T>, "append_integer needs an integer");
+    char buf[24];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    DCHECK_EQ(ec, std::errc{});
+    append(buf, static_cast<std::size_t>(ptr - buf));
+  }
+
+  // the object representation of `value`, for binary output
+  template <typename T>
+  inline void append_bytes(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  // makes the following text bold and, unless `color` is kDefault, colored
+  // until end_style()
+  inline void begin_style(core::Color color) {
+    if (!colorise_) {
+      return;
+    }
+    if (color == core::Color::kDefault) {
+      append(kAnsiBold);
+    } else {
+      append(kAnsiBoldColors[static_cast<uint8_t>(color)]);
+    }
+  }
+
+  inline void end_style() {
+    if (colorise_) {
+      append(kAnsiReset);
+    }
+  }
+
+  // hands everything buffered to the sink and flushes it
+  inline void flush() {
+    if (size_ > 0) {
+      sink_->write(buffer_, size_);
+      size_ = 0;
+    }
+    sink_->flush();
+  }
+
+  inline bool colorise() const { return colorise_; }
+
+ private:
+  DiagnosticSink* sink_ = nullptr;
+  std::size_t size_ = 0;
+  bool colorise_ = true;
+  char buffer_[kBufferSize];
+};
+
+}  // namespace diagnostic
+
+#endif  // FRONTEND_DIAGNOSTIC_ENGINE_WRITER_H_
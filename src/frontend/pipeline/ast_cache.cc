@@ -0,0 +1,123 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/pipeline/ast_cache.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "build/build_flag.h"
+#include "core/base/file_util.h"
+#include "frontend/base/string/string_hash.h"
+#include "frontend/data/ast/serialization.h"
+
+#if IS_WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace pipeline {
+
+namespace {
+
+// seeds the content hash with the format version, so a format change also
+// changes every key
+constexpr uint64_t kHashSeed = ast::kSerializedFormatVersion;
+
+constexpr std::string_view kEntryExtension = ".ast";
+// an entry name is the hash as 16 hex digits plus the extension
+constexpr std::size_t kEntryNameLength = 16 + kEntryExtension.size();
+
+std::atomic<uint64_t> temp_counter = 0;
+
+inline int process_id() {
+#if IS_WINDOWS
+  return _getpid();
+#else
+  return getpid();
+#endif
+}
+
+}  // namespace
+
+AstCache::AstCache(std::string directory) : directory_(std::move(directory)) {
+  if (!core::dir_exists(directory_.c_str())) {
+    core::create_directories(directory_.c_str());
+  }
+}
+
+uint64_t AstCache::hash_source(std::string_view content) {
+  return base::hash_string(content, kHashSeed);
+}
+
+std::string AstCache::entry_path(uint64_t source_hash) const {
+  return core::join_path(
+      directory_, std::format("{:016x}{}", source_hash, kEntryExtension));
+}
+
+std::size_t AstCache::evict(const std::set<uint64_t>& keep) const {
+  std::size_t removed = 0;
+  for (const std::string& name : core::list_files(directory_)) {
+    // temporaries of a concurrent store() and other files are left alone
+    if (name.size() != kEntryNameLength || !name.ends_with(kEntryExtension)) {
+      continue;
+    }
+    uint64_t source_hash = 0;
+    const char* end = name.data() + 16;
+    const auto [ptr, ec] = std::from_chars(name.data(), end, source_hash, 16);
+    if (ec != std::errc() || ptr != end || keep.contains(source_hash)) {
+      continue;
+    }
+    if (core::remove_file(core::join_path(directory_, name).c_str()) == 0) {
+      ++removed;
+    }
+  }
+  return removed;
+}
+
+std::unique_ptr<ast::Context> AstCache::load(
+    uint64_t source_hash,
+    base::StringInterner* interner) const {
+  const std::string path = entry_path(source_hash);
+  core::MappedFile file(path.c_str());
+  if (!file.valid()) {
+    return nullptr;
+  }
+  return ast::deserialize(std::string_view(file.data(), file.size()),
+                          source_hash, interner);
+}
+
+bool AstCache::store(uint64_t source_hash,
+                     const ast::Context& context,
+                     const base::StringInterner& interner) const {
+  const std::string path = entry_path(source_hash);
+  // the pid keeps concurrent runs apart and the counter keeps workers of one
+  // run apart. the temporary is created exclusively, so even a clashing name
+  // fails here rather than truncating a file someone else is writing.
+  const std::string temp =
+      std::format("{}.{}.{}.tmp", path, process_id(),
+                  temp_counter.fetch_add(1, std::memory_order_relaxed));
+
+  // renamed only once it is completely written and closed
+  if (core::write_new_file(
+          temp.c_str(), ast::serialize(context, interner, source_hash)) != 0) {
+    return false;
+  }
+  if (core::rename_file(temp.c_str(), path.c_str()) != 0) {
+    core::remove_file(temp.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace pipeline
@@ -0,0 +1,67 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_PIPELINE_AST_CACHE_H_
+#define FRONTEND_PIPELINE_AST_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "frontend/data/ast/context.h"
+#include "frontend/pipeline/base/pipeline_export.h"
+
+namespace base {
+class StringInterner;
+}  // namespace base
+
+namespace pipeline {
+
+// directory of serialized asts keyed by the content hash of their source, so
+// a file that did not change since the last run skips lexing and parsing.
+// stateless apart from the directory, so workers may share one instance.
+class PIPELINE_EXPORT AstCache {
+ public:
+  explicit AstCache(std::string directory);
+  ~AstCache() = default;
+
+  AstCache(const AstCache&) = delete;
+  AstCache& operator=(const AstCache&) = delete;
+
+  AstCache(AstCache&&) noexcept = default;
+  AstCache& operator=(AstCache&&) noexcept = default;
+
+  static uint64_t hash_source(std::string_view content);
+
+  // nullptr on a miss or an unreadable entry
+  std::unique_ptr<ast::Context> load(uint64_t source_hash,
+                                     base::StringInterner* interner) const;
+
+  // writes a temporary file unique to this process and call, then renames it
+  // over the entry once it is complete. readers therefore only ever map whole
+  // entries, and an entry mapped by another run is replaced rather than
+  // truncated under it. returns false if the entry could not be written.
+  bool store(uint64_t source_hash,
+             const ast::Context& context,
+             const base::StringInterner& interner) const;
+
+  // removes every entry whose hash is not in `keep`, the sources of a whole
+  // project, so entries of deleted files and of earlier contents of changed
+  // ones do not pile up. returns the number of entries removed.
+  std::size_t evict(const std::set<uint64_t>& keep) const;
+
+  std::string entry_path(uint64_t source_hash) const;
+
+  inline const std::string& directory() const { return directory_; }
+
+ private:
+  std::string directory_;
+};
+
+}  // namespace pipeline
+
+#endif  // FRONTEND_PIPELINE_AST_CACHE_H_
@@ -0,0 +1,16 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_PIPELINE_BASE_PIPELINE_EXPORT_H_
+#define FRONTEND_PIPELINE_BASE_PIPELINE_EXPORT_H_
+
+#include "build/component_export.h"
+
+namespace pipeline {
+
+#define PIPELINE_EXPORT COMPONENT_EXPORT(PIPELINE)
+
+}  // namespace pipeline
+
+#endif  // FRONTEND_PIPELINE_BASE_PIPELINE_EXPORT_H_
@@ -0,0 +1,291 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/pipeline/build_manifest.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "core/base/file_util.h"
+#include "core/check.h"
+#include "frontend/base/string/string_interner.h"
+#include "frontend/data/ast/context.h"
+#include "frontend/data/ast/payload/data.h"
+
+namespace pipeline {
+
+namespace {
+
+constexpr std::string_view kHeader = "# redy build manifest v1";
+
+// first segment of a path expression, empty if it has none
+std::string_view first_segment(ast::Context* context,
+                               const ast::PathExpressionPayload& path,
+                               const base::StringInterner& interner) {
+  if (!path.path_parts_range.valid()) {
+    return "";
+  }
+  const ast::IdentifierPayload& part =
+      context->arena<ast::IdentifierPayload>()[path.path_parts_range.begin.id];
+  return interner.lookup(part.id);
+}
+
+// splits "keyword rest" at the first space
+bool split_line(std::string_view line,
+                std::string_view* keyword,
+                std::string_view* rest) {
+  const std::size_t space = line.find(' ');
+  if (space == std::string_view::npos || space == 0 ||
+      space + 1 == line.size()) {
+    return false;
+  }
+  *keyword = line.substr(0, space);
+  *rest = line.substr(space + 1);
+  return true;
+}
+
+}  // namespace
+
+std::string module_name_of(std::string_view file_name) {
+  return core::file_name_without_extension(std::string(file_name));
+}
+
+ModuleReferences collect_module_references(
+    std::string_view file_name,
+    ast::Context* context,
+    const base::StringInterner& interner) {
+  ModuleReferences references;
+  references.provides.emplace(module_name_of(file_name));
+
+  auto& paths = context->arena<ast::PathExpressionPayload>();
+  auto& modules = context->arena<ast::ModuleDeclarationPayload>();
+  for (std::size_t i = 0; i < modules.size(); ++i) {
+    const ast::PayloadId<ast::PathExpressionPayload> name = modules[i].name;
+    if (!name.valid()) {
+      continue;
+    }
+    const std::string_view module =
+        first_segment(context, paths[name.id], interner);
+    if (!module.empty()) {
+      references.provides.emplace(module);
+    }
+  }
+
+  auto& uses = context->arena<ast::UseStatementPayload>();
+  for (std::size_t i = 0; i < uses.size(); ++i) {
+    const auto& range = uses[i].use_paths_range;
+    if (!range.valid()) {
+      continue;
+    }
+    for (uint32_t id = range.begin.id; id <= range.end(); ++id) {
+      const std::string_view module =
+          first_segment(context, paths[id], interner);
+      if (!module.empty()) {
+        references.uses.emplace(module);
+      }
+    }
+  }
+  return references;
+}
+
+BuildManifest::FileNames BuildManifest::invalidated(
+    const FileRecords& current) const {
+  return invalidate(current, true, nullptr);
+}
+
+BuildManifest::FileNames BuildManifest::invalidated_partial(
+    const FileRecords& current,
+    FileNames* stale) const {
+  DCHECK(stale);
+  return invalidate(current, false, stale);
+}
+
+BuildManifest::FileNames BuildManifest::invalidate(const FileRecords& current,
+                                                   bool complete,
+                                                   FileNames* stale) const {
+  FileNames result;
+  FileNames dirty_modules;
+
+  for (const auto& [name, record] : current) {
+    const FileRecord* previous = find(name);
+    if (previous && previous->content_hash == record.content_hash) {
+      continue;
+    }
+    result.emplace(name);
+    dirty_modules.insert(record.modules.provides.begin(),
+                         record.modules.provides.end());
+    if (previous) {
+      dirty_modules.insert(previous->modules.provides.begin(),
+                           previous->modules.provides.end());
+    }
+  }
+  if (complete) {
+    for (const auto& [name, record] : records_) {
+      if (!current.contains(name)) {
+        dirty_modules.insert(record.modules.provides.begin(),
+                             record.modules.provides.end());
+      }
+    }
+  }
+
+  // marks `name` if it uses a dirty module, which dirties what it provides in
+  // turn
+  auto propagate = [&dirty_modules](const std::string& name,
+                                    const FileRecord& record,
+                                    FileNames* marked) {
+    if (marked->contains(name)) {
+      return false;
+    }
+    for (const std::string& module : record.modules.uses) {
+      if (dirty_modules.contains(module)) {
+        marked->emplace(name);
+        dirty_modules.insert(record.modules.provides.begin(),
+                             record.modules.provides.end());
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // repeat until no unchanged file picks up a dirty dependency. on a partial
+  // run the files left out pass changes on as well.
+  bool grew = !dirty_modules.empty();
+  while (grew) {
+    grew = false;
+    for (const auto& [name, record] : current) {
+      grew |= propagate(name, record, &result);
+    }
+    if (complete) {
+      continue;
+    }
+    for (const auto& [name, record] : records_) {
+      if (!current.contains(name)) {
+        grew |= propagate(name, record, stale);
+      }
+    }
+  }
+  return result;
+}
+
+void BuildManifest::update(std::string_view file_name, FileRecord record) {
+  auto it = records_.find(file_name);
+  if (it == records_.end()) {
+    records_.emplace(std::string(file_name), std::move(record));
+  } else {
+    it->second = std::move(record);
+  }
+}
+
+void BuildManifest::erase(std::string_view file_name) {
+  auto it = records_.find(file_name);
+  if (it != records_.end()) {
+    records_.erase(it);
+  }
+}
+
+void BuildManifest::mark_stale(std::string_view file_name) {
+  auto it = records_.find(file_name);
+  if (it != records_.end()) {
+    it->second.content_hash = 0;
+  }
+}
+
+void BuildManifest::prune(const FileRecords& current) {
+  std::erase_if(records_, [&current](const auto& entry) {
+    return !current.contains(entry.first);
+  });
+}
+
+const BuildManifest::FileRecord* BuildManifest::find(
+    std::string_view file_name) const {
+  auto it = records_.find(file_name);
+  return it == records_.end() ? nullptr : &it->second;
+}
+
+bool BuildManifest::load(const std::string& path) {
+  if (!core::file_exists(path.c_str())) {
+    return false;
+  }
+  const std::string content = core::read_file(path.c_str());
+  std::string_view rest = content;
+
+  FileRecords records;
+  FileRecord* record = nullptr;
+  bool header = true;
+  while (!rest.empty()) {
+    const std::size_t eol = rest.find('\n');
+    std::string_view line = rest.substr(0, eol);
+    rest = eol == std::string_view::npos ? "" : rest.substr(eol + 1);
+
+    if (header) {
+      if (line != kHeader) {
+        return false;
+      }
+      header = false;
+      continue;
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    std::string_view keyword;
+    std::string_view value;
+    if (!split_line(line, &keyword, &value)) {
+      return false;
+    }
+
+    if (keyword == "file") {
+      // file <16 hex digits> <file name>
+      std::string_view hash;
+      std::string_view name;
+      if (!split_line(value, &hash, &name) || hash.size() != 16) {
+        return false;
+      }
+      const std::string digits(hash);
+      char* end = nullptr;
+      const uint64_t content_hash = std::strtoull(digits.c_str(), &end, 16);
+      if (end != digits.c_str() + digits.size()) {
+        return false;
+      }
+      record = &records[std::string(name)];
+      record->content_hash = content_hash;
+    } else if (keyword == "provides" && record) {
+      record->modules.provides.emplace(value);
+    } else if (keyword == "uses" && record) {
+      record->modules.uses.emplace(value);
+    } else {
+      return false;
+    }
+  }
+  if (header) {
+    return false;
+  }
+
+  records_ = std::move(records);
+  return true;
+}
+
+bool BuildManifest::save(const std::string& path) const {
+  std::string content(kHeader);
+  content += '\n';
+  for (const auto& [name, record] : records_) {
+    content += std::format("file {:016x} {}\n", record.content_hash, name);
+    for (const std::string& module : record.modules.provides) {
+      content += std::format("provides {}\n", module);
+    }
+    for (const std::string& module : record.modules.uses) {
+      content += std::format("uses {}\n", module);
+    }
+  }
+  return core::write_file(path.c_str(), content) == 0;
+}
+
+}  // namespace pipeline
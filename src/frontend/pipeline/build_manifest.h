@@ -0,0 +1,114 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_PIPELINE_BUILD_MANIFEST_H_
+#define FRONTEND_PIPELINE_BUILD_MANIFEST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "frontend/pipeline/base/pipeline_export.h"
+
+namespace ast {
+class Context;
+}  // namespace ast
+
+namespace base {
+class StringInterner;
+}  // namespace base
+
+namespace pipeline {
+
+// top-level module names a file provides and refers to. a file always
+// provides its own stem, plus the first segment of every module it declares.
+// `use a::b::c` refers to `a`.
+struct ModuleReferences {
+  std::set<std::string, std::less<>> provides;
+  std::set<std::string, std::less<>> uses;
+};
+
+PIPELINE_EXPORT std::string module_name_of(std::string_view file_name);
+
+PIPELINE_EXPORT ModuleReferences
+collect_module_references(std::string_view file_name,
+                          ast::Context* context,
+                          const base::StringInterner& interner);
+
+// what the previous run saw of every file: its content hash and the modules
+// it provides and uses. comparing it with the current hashes tells which
+// files changed and which unchanged files depend on them, directly or through
+// other files, and so have to be reprocessed.
+class PIPELINE_EXPORT BuildManifest {
+ public:
+  static constexpr std::string_view kFileName = "manifest.txt";
+
+  struct FileRecord {
+    uint64_t content_hash = 0;
+    ModuleReferences modules;
+  };
+
+  BuildManifest() = default;
+  ~BuildManifest() = default;
+
+  BuildManifest(const BuildManifest&) = delete;
+  BuildManifest& operator=(const BuildManifest&) = delete;
+
+  BuildManifest(BuildManifest&&) noexcept = default;
+  BuildManifest& operator=(BuildManifest&&) noexcept = default;
+
+  using FileRecords = std::map<std::string, FileRecord, std::less<>>;
+
+  using FileNames = std::set<std::string, std::less<>>;
+
+  // file names of `current`, the whole project, that are new, changed or
+  // depend on a module provided by a new, changed or removed file. a changed
+  // file dirties the modules it provided before and the ones it provides now,
+  // a file recorded here but missing from `current` (deleted or renamed) the
+  // ones it provided.
+  FileNames invalidated(const FileRecords& current) const;
+
+  // invalidated() for a run over only part of the project. files recorded
+  // here but missing from `current` are not taken as removed, they still
+  // carry changes between the given files. the ones of them that depend on a
+  // dirty module are added to `stale`, see mark_stale().
+  FileNames invalidated_partial(const FileRecords& current,
+                                FileNames* stale) const;
+
+  void update(std::string_view file_name, FileRecord record);
+  void erase(std::string_view file_name);
+
+  // forgets the content hash of a recorded file, so the next run that is
+  // given the file invalidates it even if its content did not change
+  void mark_stale(std::string_view file_name);
+
+  // drops the records of files missing from `current`, the whole project.
+  // call it after invalidated(), which needs them to find the users of
+  // removed files.
+  void prune(const FileRecords& current);
+
+  const FileRecord* find(std::string_view file_name) const;
+
+  // returns false and leaves the manifest untouched if the file is missing
+  // or malformed
+  bool load(const std::string& path);
+  bool save(const std::string& path) const;
+
+  inline std::size_t size() const { return records_.size(); }
+
+ private:
+  FileNames invalidate(const FileRecords& current,
+                       bool complete,
+                       FileNames* stale) const;
+
+  FileRecords records_;
+};
+
+}  // namespace pipeline
+
+#endif  // FRONTEND_PIPELINE_BUILD_MANIFEST_H_
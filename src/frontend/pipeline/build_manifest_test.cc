@@ -0,0 +1,156 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/pipeline/build_manifest.h"
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "core/base/file_util.h"
+#include "gtest/gtest.h"
+
+namespace pipeline {
+
+namespace {
+
+using Names = std::set<std::string, std::less<>>;
+
+constexpr uint64_t kHash = 0xfedcba9876543210;
+
+BuildManifest::FileRecord make_record(uint64_t hash,
+                                      Names provides,
+                                      Names uses) {
+  BuildManifest::FileRecord record{.content_hash = hash};
+  record.modules.provides = std::move(provides);
+  record.modules.uses = std::move(uses);
+  return record;
+}
+
+// app uses util, util uses core, tool uses nothing
+BuildManifest::FileRecords make_records(uint64_t core_hash) {
+  BuildManifest::FileRecords records;
+  records.emplace("src/core.ry", make_record(core_hash, {"core"}, {}));
+  records.emplace("src/util.ry", make_record(2, {"util"}, {"core"}));
+  records.emplace("src/app.ry", make_record(3, {"app"}, {"util"}));
+  records.emplace("src/tool.ry", make_record(4, {"tool"}, {}));
+  return records;
+}
+
+BuildManifest make_manifest(const BuildManifest::FileRecords& records) {
+  BuildManifest manifest;
+  for (const auto& [name, record] : records) {
+    manifest.update(name, record);
+  }
+  return manifest;
+}
+
+}  // namespace
+
+TEST(BuildManifestTest, ModuleNameIsTheFileStem) {
+  EXPECT_EQ(module_name_of("src/util.ry"), "util");
+  EXPECT_EQ(module_name_of("main.ry"), "main");
+}
+
+TEST(BuildManifestTest, EveryFileIsInvalidatedOnTheFirstRun) {
+  const BuildManifest manifest;
+  EXPECT_EQ(manifest.invalidated(make_records(1)).size(), 4u);
+}
+
+TEST(BuildManifestTest, UnchangedFilesAreNotInvalidated) {
+  const BuildManifest manifest = make_manifest(make_records(1));
+  EXPECT_TRUE(manifest.invalidated(make_records(1)).empty());
+}
+
+TEST(BuildManifestTest, ChangesPropagateToTransitiveDependents) {
+  const BuildManifest manifest = make_manifest(make_records(1));
+  const Names expected = {"src/app.ry", "src/core.ry", "src/util.ry"};
+  EXPECT_EQ(manifest.invalidated(make_records(10)), expected);
+}
+
+TEST(BuildManifestTest, LeafChangesStayLocal) {
+  const BuildManifest manifest = make_manifest(make_records(1));
+  BuildManifest::FileRecords current = make_records(1);
+  current.at("src/app.ry").content_hash = 30;
+  EXPECT_EQ(manifest.invalidated(current), Names{"src/app.ry"});
+}
+
+TEST(BuildManifestTest, RemovedFilesInvalidateTheirUsers) {
+  BuildManifest manifest = make_manifest(make_records(1));
+  BuildManifest::FileRecords current = make_records(1);
+  current.erase("src/core.ry");
+
+  const Names expected = {"src/app.ry", "src/util.ry"};
+  EXPECT_EQ(manifest.invalidated(current), expected);
+
+  manifest.prune(current);
+  EXPECT_EQ(manifest.size(), 3u);
+  EXPECT_EQ(manifest.find("src/core.ry"), nullptr);
+  EXPECT_TRUE(manifest.invalidated(current).empty());
+}
+
+TEST(BuildManifestTest, RenamedFilesInvalidateTheirUsers) {
+  BuildManifest manifest = make_manifest(make_records(1));
+  BuildManifest::FileRecords current = make_records(1);
+  current.erase("src/util.ry");
+  current.emplace("src/helpers.ry", make_record(2, {"helpers"}, {"core"}));
+
+  const Names expected = {"src/app.ry", "src/helpers.ry"};
+  EXPECT_EQ(manifest.invalidated(current), expected);
+
+  manifest.prune(current);
+  EXPECT_EQ(manifest.find("src/util.ry"), nullptr);
+}
+
+TEST(BuildManifestTest, PartialRunsKeepFilesLeftOut) {
+  BuildManifest manifest = make_manifest(make_records(1));
+  // only core, changed, and app are given
+  BuildManifest::FileRecords current = make_records(10);
+  current.erase("src/util.ry");
+  current.erase("src/tool.ry");
+
+  // app picks the change up through util, which is not given
+  Names stale;
+  const Names expected = {"src/app.ry", "src/core.ry"};
+  EXPECT_EQ(manifest.invalidated_partial(current, &stale), expected);
+  EXPECT_EQ(stale, Names{"src/util.ry"});
+
+  for (const std::string& name : stale) {
+    manifest.mark_stale(name);
+  }
+  for (const auto& [name, record] : current) {
+    manifest.update(name, record);
+  }
+  EXPECT_EQ(manifest.size(), 4u);
+  const Names next = {"src/app.ry", "src/util.ry"};
+  EXPECT_EQ(manifest.invalidated(make_records(10)), next);
+}
+
+TEST(BuildManifestTest, SavesAndLoads) {
+  core::TempFile file("build_manifest_");
+  ASSERT_TRUE(file.valid());
+
+  const BuildManifest manifest = make_manifest(make_records(kHash));
+  ASSERT_TRUE(manifest.save(file.path()));
+
+  BuildManifest loaded;
+  ASSERT_TRUE(loaded.load(file.path()));
+  EXPECT_EQ(loaded.size(), 4u);
+  ASSERT_NE(loaded.find("src/core.ry"), nullptr);
+  EXPECT_EQ(loaded.find("src/core.ry")->content_hash, kHash);
+  EXPECT_EQ(loaded.find("src/util.ry")->modules.uses, Names{"core"});
+  EXPECT_TRUE(loaded.invalidated(make_records(kHash)).empty());
+}
+
+TEST(BuildManifestTest, RejectsMalformedFiles) {
+  core::TempFile file("build_manifest_", "not a manifest\n");
+  ASSERT_TRUE(file.valid());
+
+  BuildManifest manifest = make_manifest(make_records(1));
+  EXPECT_FALSE(manifest.load(file.path()));
+  EXPECT_EQ(manifest.size(), 4u);
+}
+
+}  // namespace pipeline
@@ -0,0 +1,340 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/pipeline/document.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/check.h"
+#include "frontend/base/token/token.h"
+#include "frontend/base/token/token_kind.h"
+#include "frontend/processor/lexer/lexer.h"
+#include "i18n/base/translator.h"
+
+namespace pipeline {
+
+namespace {
+
+inline bool is_continuation_byte(char8_t c) {
+  return (c & 0xC0) == 0x80;
+}
+
+inline std::size_t shifted(std::size_t pos, std::ptrdiff_t delta) {
+  return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(pos) + delta);
+}
+
+}  // namespace
+
+Document::Document(unicode::Utf8FileManager* file_manager,
+                   unicode::Utf8FileId file_id,
+                   base::StringInterner* interner,
+                   const i18n::Translator* translator)
+    : file_manager_(file_manager),
+      file_id_(file_id),
+      interner_(interner),
+      translator_(translator) {
+  DCHECK(file_manager_);
+  DCHECK(interner_);
+  DCHECK(translator_);
+  rebuild();
+}
+
+Document::~Document() = default;
+
+std::size_t Document::diagnostic_count() const {
+  std::size_t count = 0;
+  for_each_diagnostic([&](const De&) { ++count; });
+  return count;
+}
+
+void Document::apply_edit(const unicode::TextEdit& edit) {
+  last_edit_ = {};
+  const bool valid = keeps_utf8_valid(edit);
+  file_manager_->apply_edit(file_id_, edit);
+
+  std::size_t first = 0;
+  std::size_t old_last = 0;
+  std::ptrdiff_t token_delta = 0;
+  if (!valid || !stream_ || !relex(edit, &first, &old_last, &token_delta)) {
+    rebuild();
+    return;
+  }
+
+  // the item that ends just before the changed tokens may have looked at
+  // them, so parsing starts there
+  const auto it = std::partition_point(
+      items_.begin(), items_.end(), [&](const Item& item) {
+        return item.end + kParserLookahead <= first;
+      });
+  std::size_t next =
+      reparse(static_cast<std::size_t>(it - items_.begin()), old_last,
+              token_delta, edit.delta());
+
+  // diagnostics of failed items behind the edit may point at moved lines
+  while (next < items_.size()) {
+    if (items_[next].errors.empty()) {
+      ++next;
+    } else {
+      next = reparse(next, items_[next].end, 0, 0);
+    }
+  }
+
+  compact_if_needed();
+  update_roots();
+  extend_recovery_regions();
+}
+
+void Document::rebuild() {
+  last_edit_.rebuilt = true;
+  lex_errors_.clear();
+  items_.clear();
+  dead_nodes_ = 0;
+  parser_ = parser::Parser();
+  stream_.reset();
+
+  lexer::Lexer lexer;
+  lexer.set_interner(interner_);
+  lexer::Lexer::InitResult init_result =
+      lexer.init(file_manager_, file_id_, lexer::Lexer::Mode::kCodeAnalysis,
+                 lexer::Lexer::DecodeMode::kOnDemand);
+  if (init_result.is_err()) {
+    lex_errors_.emplace_back(std::move(init_result).unwrap_err());
+    return;
+  }
+
+  lexer::Lexer::Results<base::Token> tokenize_result = lexer.tokenize();
+  if (tokenize_result.is_err()) {
+    for (auto&& e : std::move(tokenize_result).unwrap_err()) {
+      lex_errors_.emplace_back(std::move(e).convert_to_entry());
+    }
+    return;
+  }
+
+  stream_ = std::make_unique<base::TokenStream>(
+      std::move(tokenize_result).unwrap(), file_manager_, file_id_);
+  last_edit_.relexed_tokens = stream_->size();
+  parser_.init(stream_.get(), interner_, *translator_);
+  parse_all_items();
+  update_roots();
+  extend_recovery_regions();
+}
+
+bool Document::keeps_utf8_valid(const unicode::TextEdit& edit) const {
+  // ascii spliced in at codepoint boundaries can not break an encoding
+  const std::u8string_view content = file().content_u8();
+  const std::size_t edit_end = edit.offset + edit.length;
+  if ((edit.offset < content.size() &&
+       is_continuation_byte(content[edit.offset])) ||
+      (edit_end < content.size() && is_continuation_byte(content[edit_end]))) {
+    return false;
+  }
+  return std::all_of(edit.replacement.begin(), edit.replacement.end(),
+                     [](char8_t c) { return c < 0x80; });
+}
+
+bool Document::relex(const unicode::TextEdit& edit,
+                     std::size_t* first,
+                     std::size_t* old_last,
+                     std::ptrdiff_t* token_delta) {
+  const std::ptrdiff_t byte_delta = edit.delta();
+  const std::size_t old_size = stream_->size();
+
+  // tokens ending before the edit are kept, except the last one, which the
+  // lexer may have looked past to end it
+  std::size_t kept = 0;
+  {
+    std::size_t lo = 0;
+    std::size_t hi = old_size;
+    while (lo < hi) {
+      const std::size_t mid = lo + (hi - lo) / 2;
+      if (stream_->at(mid).end_offset() < edit.offset) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    kept = lo > 0 ? lo - 1 : 0;
+  }
+  const std::size_t restart =
+      kept > 0 ? stream_->at(kept - 1).end_offset() : 0;
+
+  // the edited file was checked to stay valid, see keeps_utf8_valid()
+  lexer::Lexer lexer;
+  lexer.set_interner(interner_);
+  if (lexer
+          .init(file_manager_, file_id_, lexer::Lexer::Mode::kCodeAnalysis,
+                lexer::Lexer::DecodeMode::kOnDemand, false)
+          .is_err()) {
+    return false;
+  }
+  lexer.seek(restart);
+
+  // a new token behind the edit that matches an old token moved by the edit
+  // means the rest of the old tokens are still valid
+  const std::size_t edit_end = edit.offset + edit.replacement.size();
+  std::vector<base::Token> tokens;
+  std::size_t old = kept;
+  while (true) {
+    lexer::Lexer::Result<base::Token> result = lexer.tokenize_next();
+    if (result.is_err()) {
+      return false;
+    }
+    base::Token token = std::move(result).unwrap();
+
+    if (token.offset() >= edit_end) {
+      const std::size_t old_offset = shifted(token.offset(), -byte_delta);
+      while (old + 1 < old_size && stream_->at(old).offset() < old_offset) {
+        ++old;
+      }
+      const base::Token& candidate = stream_->at(old);
+      if (candidate.offset() == old_offset &&
+          candidate.kind() == token.kind() &&
+          candidate.length() == token.length()) {
+        break;
+      }
+    }
+    // the old eof token always matches, so a new one is never kept
+    DCHECK_NE(token.kind(), base::TokenKind::kEof);
+    tokens.emplace_back(std::move(token));
+  }
+
+  last_edit_.relexed_tokens = tokens.size();
+  *first = kept;
+  *old_last = old;
+  *token_delta = static_cast<std::ptrdiff_t>(tokens.size()) -
+                 static_cast<std::ptrdiff_t>(old - kept);
+  stream_->splice(kept, old, std::move(tokens), byte_delta);
+  return true;
+}
+
+std::size_t Document::reparse(std::size_t first_item,
+                              std::size_t old_last,
+                              std::ptrdiff_t token_delta,
+                              std::ptrdiff_t byte_delta) {
+  std::size_t pos = 0;
+  if (first_item < items_.size()) {
+    pos = items_[first_item].begin;
+  } else if (!items_.empty()) {
+    pos = items_.back().end;
+  }
+  const std::size_t new_last = shifted(old_last, token_delta);
+
+  std::vector<Item> fresh;
+  std::size_t sync = items_.size();
+  while (!is_eof(pos)) {
+    if (pos >= new_last) {
+      // an old item starting here, behind the changed tokens, would parse
+      // exactly as before
+      const std::size_t old_pos = shifted(pos, -token_delta);
+      const auto it = std::partition_point(
+          items_.begin() + first_item, items_.end(),
+          [&](const Item& item) { return item.begin < old_pos; });
+      if (it != items_.end() && it->begin == old_pos) {
+        sync = static_cast<std::size_t>(it - items_.begin());
+        break;
+      }
+    }
+    Item item = parser_.parse_item(pos);
+    DCHECK_GT(item.end, item.begin);
+    pos = item.end;
+    fresh.emplace_back(std::move(item));
+  }
+
+  for (std::size_t i = first_item; i < sync; ++i) {
+    dead_nodes_ += items_[i].node_count;
+  }
+  for (std::size_t i = sync; i < items_.size(); ++i) {
+    items_[i].begin = shifted(items_[i].begin, token_delta);
+    items_[i].end = shifted(items_[i].end, token_delta);
+    if (byte_delta != 0) {
+      shift_nodes(items_[i], byte_delta);
+    }
+  }
+  items_.erase(items_.begin() + first_item, items_.begin() + sync);
+  items_.insert(items_.begin() + first_item,
+                std::make_move_iterator(fresh.begin()),
+                std::make_move_iterator(fresh.end()));
+
+  last_edit_.reparsed_items += fresh.size();
+  return first_item + fresh.size();
+}
+
+void Document::shift_nodes(const Item& item, std::ptrdiff_t byte_delta) {
+  // literals are the only nodes that keep a byte range of the source
+  ast::Context* context = parser_.context();
+  const base::Arena<ast::Node>& nodes = context->arena<ast::Node>();
+  auto& literals = context->arena<ast::LiteralExpressionPayload>();
+  for (std::size_t i = 0; i < item.node_count; ++i) {
+    const ast::Node& node = nodes[item.first_node + i];
+    if (node.kind == ast::NodeKind::kLiteralExpression) {
+      uint32_t& offset = literals[node.payload_id].lexeme_offset;
+      offset = static_cast<uint32_t>(shifted(offset, byte_delta));
+    }
+  }
+}
+
+void Document::parse_all_items() {
+  std::size_t pos = 0;
+  while (!is_eof(pos)) {
+    Item item = parser_.parse_item(pos);
+    DCHECK_GT(item.end, item.begin);
+    pos = item.end;
+    items_.emplace_back(std::move(item));
+  }
+  last_edit_.reparsed_items = items_.size();
+}
+
+void Document::compact_if_needed() {
+  const std::size_t nodes = parser_.context()->arena<ast::Node>().size();
+  if (dead_nodes_ < kMinDeadNodes || dead_nodes_ * 2 < nodes) {
+    return;
+  }
+  last_edit_.compacted = true;
+  items_.clear();
+  dead_nodes_ = 0;
+  parser_.reset_context();
+  parse_all_items();
+}
+
+void Document::update_roots() {
+  std::vector<ast::NodeId> roots;
+  roots.reserve(items_.size());
+  for (const Item& item : items_) {
+    if (item.root != ast::kInvalidNodeId) {
+      roots.push_back(item.root);
+    }
+  }
+  parser_.context()->set_roots(std::move(roots));
+}
+
+void Document::extend_recovery_regions() {
+  // as in Parser::parse_all(), items failing behind an error are most likely
+  // its follow-ups, so its region stays open until an item parses again
+  De* recovering = nullptr;
+  for (Item& item : items_) {
+    if (!item.errors.empty()) {
+      if (!recovering) {
+        recovering = &item.errors.front();
+      }
+      continue;
+    }
+    if (recovering && item.root != ast::kInvalidNodeId) {
+      recovering->set_recovery_end(
+          stream_->at(item.begin).range(stream_->file()).start());
+      recovering = nullptr;
+    }
+  }
+  if (recovering) {
+    const base::Token& eof = stream_->at(stream_->size() - 1);
+    recovering->set_recovery_end(eof.range(stream_->file()).start());
+  }
+}
+
+}  // namespace pipeline
@@ -0,0 +1,162 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_PIPELINE_DOCUMENT_H_
+#define FRONTEND_PIPELINE_DOCUMENT_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "frontend/base/token/token_stream.h"
+#include "frontend/data/ast/context.h"
+#include "frontend/diagnostic/data/diagnostic_entry.h"
+#include "frontend/pipeline/base/pipeline_export.h"
+#include "frontend/processor/parser/parser.h"
+#include "unicode/utf8/file.h"
+#include "unicode/utf8/file_manager.h"
+
+namespace base {
+class StringInterner;
+}  // namespace base
+
+namespace i18n {
+class Translator;
+}  // namespace i18n
+
+namespace pipeline {
+
+// a source file kept lexed and parsed across edits, for editor integration.
+//
+// an edit is re-lexed from the last token that ends before it until the new
+// tokens line up with the old ones again, and the new tokens are spliced into
+// the token stream. only the top-level items that cover changed tokens are
+// parsed again, every other item keeps its nodes and node ids.
+//
+// items with parse errors are parsed again after every edit, since their
+// diagnostics hold resolved lines and columns. a lexer error makes the next
+// edit lex and parse the whole file again.
+//
+// replaced items leave dead nodes behind in the context, so walk it from
+// roots(). once dead nodes outnumber live ones the file is parsed again (not
+// lexed) into a fresh context.
+class PIPELINE_EXPORT Document {
+ public:
+  using De = diagnostic::DiagnosticEntry;
+
+  // what the last edit did
+  struct EditStats {
+    std::size_t relexed_tokens = 0;
+    std::size_t reparsed_items = 0;
+    // the file was lexed and parsed from scratch
+    bool rebuilt = false;
+    // dead nodes were dropped by parsing every item into a fresh context
+    bool compacted = false;
+  };
+
+  // lexes and parses the file. every pointer must outlive the document.
+  Document(unicode::Utf8FileManager* file_manager,
+           unicode::Utf8FileId file_id,
+           base::StringInterner* interner,
+           const i18n::Translator* translator);
+  ~Document();
+
+  // the parser points at the token stream
+  Document(const Document&) = delete;
+  Document& operator=(const Document&) = delete;
+
+  Document(Document&&) = delete;
+  Document& operator=(Document&&) = delete;
+
+  // applies `edit` to the file and brings tokens, ast and diagnostics up to
+  // date
+  void apply_edit(const unicode::TextEdit& edit);
+
+  // null if the file could not be lexed
+  inline ast::Context* context() const { return parser_.context(); }
+
+  // calls f(const De&) for the lexer errors, then the parse errors in source
+  // order
+  template <typename F>
+  void for_each_diagnostic(F&& f) const {
+    for (const De& e : lex_errors_) {
+      f(e);
+    }
+    for (const parser::Parser::Item& item : items_) {
+      for (const De& e : item.errors) {
+        f(e);
+      }
+    }
+  }
+
+  std::size_t diagnostic_count() const;
+
+  inline const unicode::Utf8File& file() const {
+    return file_manager_->file(file_id_);
+  }
+  inline const EditStats& last_edit() const { return last_edit_; }
+
+ private:
+  using Item = parser::Parser::Item;
+
+  // dead nodes tolerated before a compaction is considered
+  static constexpr std::size_t kMinDeadNodes = 4096;
+
+  // tokens past the end of an item the parser may have looked at to end it
+  static constexpr std::size_t kParserLookahead = 2;
+
+  void rebuild();
+
+  // true if `edit` keeps already validated content valid utf-8 without
+  // validating it again
+  bool keeps_utf8_valid(const unicode::TextEdit& edit) const;
+
+  // re-lexes around `edit`, which is already applied to the file, and splices
+  // the result into the token stream. returns false on a lexer error.
+  bool relex(const unicode::TextEdit& edit,
+             std::size_t* first,
+             std::size_t* old_last,
+             std::ptrdiff_t* token_delta);
+
+  // parses from items_[first_item] until the item boundaries line up with
+  // the old items behind old token position `old_last` again. old items
+  // behind that are shifted by `token_delta` tokens and `byte_delta` bytes.
+  // returns the index after the new items.
+  std::size_t reparse(std::size_t first_item,
+                      std::size_t old_last,
+                      std::ptrdiff_t token_delta,
+                      std::ptrdiff_t byte_delta);
+
+  // moves the source positions stored in the nodes of `item` by `byte_delta`
+  void shift_nodes(const Item& item, std::ptrdiff_t byte_delta);
+
+  void parse_all_items();
+  void compact_if_needed();
+  void update_roots();
+  // extends the recovery region of the first error in a run of failed items
+  // up to the next item that parses
+  void extend_recovery_regions();
+
+  inline bool is_eof(std::size_t pos) const {
+    return stream_->at(pos).kind() == base::TokenKind::kEof;
+  }
+
+  unicode::Utf8FileManager* file_manager_ = nullptr;
+  unicode::Utf8FileId file_id_ = unicode::kInvalidFileId;
+  base::StringInterner* interner_ = nullptr;
+  const i18n::Translator* translator_ = nullptr;
+
+  // null if the file could not be lexed
+  std::unique_ptr<base::TokenStream> stream_;
+  parser::Parser parser_;
+  // cover every token but eof, in order
+  std::vector<Item> items_;
+  std::vector<De> lex_errors_;
+  std::size_t dead_nodes_ = 0;
+  EditStats last_edit_;
+};
+
+}  // namespace pipeline
+
+#endif  // FRONTEND_PIPELINE_DOCUMENT_H_
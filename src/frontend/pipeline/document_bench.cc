@@ -0,0 +1,76 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include <cstddef>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "frontend/base/string/string_interner.h"
+#include "frontend/pipeline/document.h"
+#include "i18n/base/translator.h"
+#include "unicode/utf8/file_manager.h"
+
+namespace pipeline {
+
+namespace {
+
+constexpr std::size_t kStatements = 16384;
+
+// returns the source and the offset of a literal digit in its middle
+std::u8string generate_file(std::size_t* edit_offset) {
+  std::u8string source;
+  for (std::size_t i = 0; i < kStatements; ++i) {
+    const std::string m = std::to_string(i % 64);
+    if (i == kStatements / 2) {
+      // the "1" in front of m
+      *edit_offset = source.size() + 10 + m.size();
+    }
+    const std::string line = "value_" + m + " := 1" + m + " * 2; ";
+    source.append(line.begin(), line.end());
+  }
+  return source;
+}
+
+// latency of a single keystroke in the middle of a large file
+void document_apply_edit(benchmark::State& state) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+  base::StringInterner interner;
+  std::size_t offset = 0;
+  const unicode::Utf8FileId id =
+      manager.register_virtual_file(generate_file(&offset));
+  Document document(&manager, id, &interner, &translator);
+
+  bool flip = false;
+  for (auto _ : state) {
+    flip = !flip;
+    document.apply_edit(
+        {.offset = offset, .length = 1, .replacement = flip ? u8"7" : u8"1"});
+    benchmark::DoNotOptimize(document.context());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(document_apply_edit)->Unit(benchmark::kMicrosecond);
+
+// what every keystroke would cost without incremental re-parsing
+void document_rebuild(benchmark::State& state) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+  base::StringInterner interner;
+  std::size_t offset = 0;
+  const unicode::Utf8FileId id =
+      manager.register_virtual_file(generate_file(&offset));
+
+  for (auto _ : state) {
+    Document document(&manager, id, &interner, &translator);
+    benchmark::DoNotOptimize(document.context());
+  }
+  state.SetBytesProcessed(manager.file(id).content_u8().size() *
+                          state.iterations());
+}
+BENCHMARK(document_rebuild)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+}  // namespace pipeline
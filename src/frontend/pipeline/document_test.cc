@@ -0,0 +1,333 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/pipeline/document.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "frontend/base/string/string_interner.h"
+#include "frontend/data/ast/payload/data.h"
+#include "gtest/gtest.h"
+#include "i18n/base/translator.h"
+#include "unicode/utf8/file_manager.h"
+
+namespace pipeline {
+
+namespace {
+
+std::u8string to_u8(const std::string& s) {
+  return std::u8string(s.begin(), s.end());
+}
+
+// one entry per root: its kind, and the target name of assignments
+std::vector<std::string> describe_roots(ast::Context* context,
+                                        const base::StringInterner& interner) {
+  std::vector<std::string> roots;
+  for (const ast::NodeId id : context->roots()) {
+    const ast::Node& node = context->arena<ast::Node>()[id];
+    std::string& root =
+        roots.emplace_back(std::to_string(static_cast<int>(node.kind)));
+    if (node.kind != ast::NodeKind::kAssignStatement) {
+      continue;
+    }
+    const auto& assign =
+        context->arena<ast::AssignStatementPayload>()[node.payload_id];
+    const auto& path =
+        context->arena<ast::PathExpressionPayload>()[assign.target_variable.id];
+    if (path.path_parts_range.valid()) {
+      const auto& part = context->arena<ast::IdentifierPayload>()
+                             [path.path_parts_range.begin.id];
+      root += ":" + std::string(interner.lookup(part.id));
+    }
+  }
+  return roots;
+}
+
+// "<offset>:<lexeme>" for the literals under an expression
+void collect_literals(ast::Context& context,
+                      ast::NodeId id,
+                      std::u8string_view source,
+                      std::vector<std::string>* literals) {
+  if (id == ast::kInvalidNodeId) {
+    return;
+  }
+  const ast::Node& node = context.arena<ast::Node>()[id];
+  const uint32_t payload = node.payload_id;
+  switch (node.kind) {
+    case ast::NodeKind::kLiteralExpression: {
+      const auto& literal =
+          context.arena<ast::LiteralExpressionPayload>()[payload];
+      const std::u8string_view lexeme =
+          source.substr(literal.lexeme_offset, literal.lexeme_length);
+      literals->push_back(std::to_string(literal.lexeme_offset) + ":" +
+                          std::string(lexeme.begin(), lexeme.end()));
+      break;
+    }
+    case ast::NodeKind::kUnaryExpression:
+      collect_literals(context,
+                       context.arena<ast::UnaryExpressionPayload>()[payload]
+                           .operand,
+                       source, literals);
+      break;
+    case ast::NodeKind::kBinaryExpression: {
+      const auto& binary =
+          context.arena<ast::BinaryExpressionPayload>()[payload];
+      collect_literals(context, binary.lhs, source, literals);
+      collect_literals(context, binary.rhs, source, literals);
+      break;
+    }
+    case ast::NodeKind::kGroupedExpression:
+      collect_literals(context,
+                       context.arena<ast::GroupedExpressionPayload>()[payload]
+                           .expression,
+                       source, literals);
+      break;
+    case ast::NodeKind::kTupleExpression:
+      for (const ast::NodeId element : context.children(
+               context.arena<ast::TupleExpressionPayload>()[payload]
+                   .tuple_elements_range)) {
+        collect_literals(context, element, source, literals);
+      }
+      break;
+    case ast::NodeKind::kArrayExpression:
+      for (const ast::NodeId element : context.children(
+               context.arena<ast::ArrayExpressionPayload>()[payload]
+                   .array_elements_range)) {
+        collect_literals(context, element, source, literals);
+      }
+      break;
+    default: break;
+  }
+}
+
+// the literals assigned by the roots, with their source positions
+std::vector<std::string> describe_literals(const Document& document) {
+  ast::Context& context = *document.context();
+  std::vector<std::string> literals;
+  for (const ast::NodeId id : context.roots()) {
+    const ast::Node& node = context.arena<ast::Node>()[id];
+    if (node.kind == ast::NodeKind::kAssignStatement) {
+      collect_literals(
+          context,
+          context.arena<ast::AssignStatementPayload>()[node.payload_id]
+              .value_expression,
+          document.file().content_u8(), &literals);
+    }
+  }
+  return literals;
+}
+
+std::vector<std::size_t> diagnostic_lines(const Document& document) {
+  std::vector<std::size_t> lines;
+  document.for_each_diagnostic([&](const Document::De& e) {
+    for (const auto& label : e.labels()) {
+      lines.push_back(label.range().start().line());
+    }
+  });
+  return lines;
+}
+
+// where the recovery region of every diagnostic that has one ends
+std::vector<std::pair<std::size_t, std::size_t>> recovery_ends(
+    const Document& document) {
+  std::vector<std::pair<std::size_t, std::size_t>> ends;
+  document.for_each_diagnostic([&](const Document::De& e) {
+    if (e.has_recovery_region()) {
+      ends.emplace_back(e.recovery_end().line(), e.recovery_end().column());
+    }
+  });
+  return ends;
+}
+
+class DocumentTest : public testing::Test {
+ protected:
+  // parses the current content of `document` from scratch and compares
+  void expect_matches_full_parse(const Document& document) {
+    const Document fresh(
+        &manager_,
+        manager_.register_virtual_file(std::u8string(
+            document.file().content_u8())),
+        &interner_, &translator_);
+
+    ASSERT_EQ(document.context() == nullptr, fresh.context() == nullptr);
+    if (fresh.context()) {
+      EXPECT_EQ(describe_roots(document.context(), interner_),
+                describe_roots(fresh.context(), interner_));
+      EXPECT_EQ(describe_literals(document), describe_literals(fresh));
+    }
+    EXPECT_EQ(diagnostic_lines(document), diagnostic_lines(fresh));
+    EXPECT_EQ(recovery_ends(document), recovery_ends(fresh));
+    EXPECT_EQ(document.diagnostic_count(), fresh.diagnostic_count());
+  }
+
+  unicode::Utf8FileManager manager_;
+  base::StringInterner interner_;
+  const i18n::Translator translator_;
+};
+
+}  // namespace
+
+TEST_F(DocumentTest, EditsMatchAFullParse) {
+  const unicode::Utf8FileId id = manager_.register_virtual_file(
+      u8"a := 1;\nb := 1 + 2;\nc: i32 = 2 * 3;\nd := (1, 2);\n");
+  Document document(&manager_, id, &interner_, &translator_);
+  ASSERT_NE(document.context(), nullptr);
+  expect_matches_full_parse(document);
+
+  const std::vector<unicode::TextEdit> edits = {
+      // change a literal
+      {.offset = 5, .length = 1, .replacement = u8"42"},
+      // rename a target
+      {.offset = 9, .length = 1, .replacement = u8"renamed"},
+      // insert a statement between two others
+      {.offset = 9, .length = 0, .replacement = u8"x := 7;\n"},
+      // drop a separator, which breaks the first statement
+      {.offset = 7, .length = 2, .replacement = u8" "},
+      // delete the broken line
+      {.offset = 0, .length = 16, .replacement = u8""},
+  };
+  for (const unicode::TextEdit& edit : edits) {
+    document.apply_edit(edit);
+    EXPECT_FALSE(document.last_edit().rebuilt);
+    expect_matches_full_parse(document);
+  }
+
+  // append at the end
+  document.apply_edit({.offset = document.file().content_u8().size(),
+                       .length = 0,
+                       .replacement = u8"e := 4;"});
+  EXPECT_FALSE(document.last_edit().rebuilt);
+  expect_matches_full_parse(document);
+}
+
+TEST_F(DocumentTest, KeepsNodesOutsideTheEdit) {
+  constexpr std::size_t kLines = 100;
+  std::string source;
+  std::size_t edit_offset = 0;
+  for (std::size_t i = 0; i < kLines; ++i) {
+    if (i == kLines / 2) {
+      // the "0" of "value_0 := 10;"
+      edit_offset = source.size() + 12;
+    }
+    source += "value_" + std::to_string(i % 10) + " := 1" +
+              std::to_string(i % 10) + "; ";
+  }
+  Document document(&manager_, manager_.register_virtual_file(to_u8(source)),
+                    &interner_, &translator_);
+  ASSERT_NE(document.context(), nullptr);
+  const std::vector<ast::NodeId> before = document.context()->roots();
+  ASSERT_EQ(before.size(), kLines);
+
+  // "value_0 := 10;" -> "value_0 := 1234;"
+  document.apply_edit(
+      {.offset = edit_offset, .length = 1, .replacement = u8"234"});
+  expect_matches_full_parse(document);
+  EXPECT_FALSE(document.last_edit().rebuilt);
+  EXPECT_LT(document.last_edit().relexed_tokens, 8u);
+  EXPECT_LT(document.last_edit().reparsed_items, 8u);
+
+  const std::vector<ast::NodeId>& after = document.context()->roots();
+  ASSERT_EQ(after.size(), kLines);
+  std::size_t changed = 0;
+  for (std::size_t i = 0; i < kLines; ++i) {
+    changed += before[i] != after[i] ? 1 : 0;
+  }
+  EXPECT_GE(changed, 1u);
+  EXPECT_LE(changed, 2u);
+}
+
+TEST_F(DocumentTest, ParseErrorsFollowEdits) {
+  Document document(&manager_,
+                    manager_.register_virtual_file(u8"a := 1; b := ; c := 2;"),
+                    &interner_, &translator_);
+  ASSERT_NE(document.context(), nullptr);
+  ASSERT_GT(document.diagnostic_count(), 0u);
+  const std::vector<std::size_t> lines = diagnostic_lines(document);
+
+  // move the broken statement down a line without touching it
+  document.apply_edit({.offset = 0, .length = 0, .replacement = u8"/*\n*/ "});
+  expect_matches_full_parse(document);
+  const std::vector<std::size_t> moved = diagnostic_lines(document);
+  ASSERT_EQ(moved.size(), lines.size());
+  for (std::size_t i = 0; i < lines.size(); ++i) {
+    EXPECT_EQ(moved[i], lines[i] + 1);
+  }
+
+  // fix it
+  document.apply_edit({.offset = 19, .length = 0, .replacement = u8"2"});
+  expect_matches_full_parse(document);
+  EXPECT_EQ(document.diagnostic_count(), 0u);
+}
+
+TEST_F(DocumentTest, FollowUpErrorsShareOneRecoveryRegion) {
+  // the stray } fails after the broken parameter list, the region of the
+  // first error runs up to b := 2;, the next item that parses
+  Document document(
+      &manager_,
+      manager_.register_virtual_file(u8"fn f( { a := 1; } ; b := 2;"),
+      &interner_, &translator_);
+  ASSERT_NE(document.context(), nullptr);
+  using Ends = std::vector<std::pair<std::size_t, std::size_t>>;
+  EXPECT_EQ(recovery_ends(document), (Ends{{1, 21}, {1, 21}}));
+
+  // breaking b := 2; leaves nothing that parses, so the region runs to the end
+  document.apply_edit({.offset = 25, .length = 1, .replacement = u8""});
+  expect_matches_full_parse(document);
+  EXPECT_EQ(recovery_ends(document), (Ends{{1, 27}, {1, 21}, {1, 27}}));
+
+  document.apply_edit({.offset = 25, .length = 0, .replacement = u8"2"});
+  expect_matches_full_parse(document);
+  EXPECT_EQ(recovery_ends(document), (Ends{{1, 21}, {1, 21}}));
+}
+
+TEST_F(DocumentTest, LexerErrorsAndNonAsciiEditsRebuild) {
+  Document document(&manager_, manager_.register_virtual_file(u8"a := 1;"),
+                    &interner_, &translator_);
+  ASSERT_NE(document.context(), nullptr);
+  EXPECT_TRUE(document.last_edit().rebuilt);
+
+  document.apply_edit({.offset = 7, .length = 0, .replacement = u8"b := \""});
+  EXPECT_TRUE(document.last_edit().rebuilt);
+  EXPECT_GT(document.diagnostic_count(), 0u);
+  expect_matches_full_parse(document);
+
+  document.apply_edit({.offset = 13, .length = 0, .replacement = u8"\";"});
+  EXPECT_TRUE(document.last_edit().rebuilt);
+  EXPECT_EQ(document.diagnostic_count(), 0u);
+  expect_matches_full_parse(document);
+
+  document.apply_edit({.offset = 13, .length = 0, .replacement = u8"あ"});
+  EXPECT_TRUE(document.last_edit().rebuilt);
+  expect_matches_full_parse(document);
+
+  // ascii edits next to multibyte content stay incremental
+  document.apply_edit({.offset = 0, .length = 1, .replacement = u8"z"});
+  EXPECT_FALSE(document.last_edit().rebuilt);
+  expect_matches_full_parse(document);
+}
+
+TEST_F(DocumentTest, CompactsDeadNodes) {
+  std::string source;
+  for (std::size_t i = 0; i < 64; ++i) {
+    source += "v := (1, 2, 3, 4, 5, 6, 7, 8); ";
+  }
+  Document document(&manager_, manager_.register_virtual_file(to_u8(source)),
+                    &interner_, &translator_);
+  ASSERT_NE(document.context(), nullptr);
+
+  bool compacted = false;
+  for (std::size_t i = 0; i < 1024 && !compacted; ++i) {
+    document.apply_edit({.offset = 6, .length = 1, .replacement = u8"9"});
+    compacted = document.last_edit().compacted;
+  }
+  EXPECT_TRUE(compacted);
+  expect_matches_full_parse(document);
+}
+
+}  // namespace pipeline
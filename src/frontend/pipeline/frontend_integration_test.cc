@@ -2,6 +2,8 @@
 // This source code is licensed under the Apache License, Version 2.0
 // which can be found in the LICENSE file.
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
@@ -81,6 +83,46 @@ TEST(FrontendTest, SimpleCodePipeline) {
   verify_compile_pipeline(u8"x := 42; y: i32 = 57;");
 }
 
+TEST(FrontendTest, FollowUpParseErrorsAreSuppressed) {
+  // the broken parameter list makes the stray } fail as well, c := ; is an
+  // error of its own after b := 2; parsed again
+  unicode::Utf8FileManager manager;
+  const unicode::Utf8FileId id = manager.register_virtual_file(
+      u8"fn f( { a := 1; } ; b := 2; c := ; d := 4;");
+  base::StringInterner interner;
+  i18n::Translator translator;
+
+  lexer::Lexer lexer;
+  ASSERT_TRUE(lexer.init(&manager, id).is_ok());
+  lexer::Lexer::Results<base::Token> tokenize_result = lexer.tokenize();
+  ASSERT_TRUE(tokenize_result.is_ok());
+  base::TokenStream stream(std::move(tokenize_result).unwrap(), &manager, id);
+
+  parser::Parser parser;
+  parser.init(&stream, &interner, translator);
+  auto result = parser.parse_all(false);
+  ASSERT_TRUE(result.is_err());
+  std::vector<diagnostic::DiagnosticEntry> errors =
+      std::move(result).unwrap_err();
+  ASSERT_EQ(errors.size(), 3u);
+
+  diagnostic::DiagnosticEngine engine(&manager, &translator,
+                                      diagnostic::DiagnosticOptions{});
+  for (auto& e : errors) {
+    engine.push(std::move(e));
+  }
+  EXPECT_EQ(engine.suppressed().cascaded, 1u);
+  ASSERT_EQ(engine.entries().size(), 2u);
+
+  std::vector<std::size_t> columns;
+  for (const diagnostic::DiagnosticEntry& entry : engine.entries()) {
+    ASSERT_FALSE(entry.labels().empty());
+    columns.push_back(entry.labels()[0].range().start().column());
+  }
+  std::sort(columns.begin(), columns.end());
+  EXPECT_EQ(columns, (std::vector<std::size_t>{7, 34}));
+}
+
 // TEST(FrontendTest, HelloWorldFunctionPipeline) {
 //   unicode::Utf8FileManager manager;
 //   std::string source = R"(
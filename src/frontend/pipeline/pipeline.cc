@@ -2,4 +2,330 @@
 // This source code is licensed under the Apache License, Version 2.0
 // which can be found in the LICENSE file.
 
-namespace pipeline {}  // namespace pipeline
+#include "frontend/pipeline/pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/base/file_util.h"
+#include "core/check.h"
+#include "frontend/base/data/arena_profile.h"
+#include "frontend/base/string/string_interner.h"
+#include "frontend/base/token/token_stream.h"
+#include "frontend/data/ast/payload/data.h"
+#include "frontend/processor/lexer/lexer.h"
+#include "frontend/processor/parser/parser.h"
+#include "frontend/processor/resolver/resolver.h"
+#include "i18n/base/translator.h"
+
+namespace pipeline {
+
+namespace {
+
+// lexes and parses one file. the lexer, token stream and parser live only for
+// the duration of the call, so nothing is shared between workers except the
+// (per-file disjoint) file manager entries and the read-only translator.
+Pipeline::FileResult parse_file(unicode::Utf8FileManager* file_manager,
+                                const i18n::Translator& translator,
+                                unicode::Utf8FileId file_id,
+                                base::StringInterner* interner,
+                                const base::ArenaProfile* arena_profile,
+                                const AstCache* cache,
+                                bool strict) {
+  Pipeline::FileResult result;
+  result.file_id = file_id;
+
+  uint64_t source_hash = 0;
+  if (cache) {
+    const unicode::Utf8File& file = file_manager->loaded_file(file_id);
+    if (file.loaded()) {
+      source_hash = AstCache::hash_source(file.content());
+      result.source_hash = source_hash;
+      result.context = cache->load(source_hash, interner);
+      if (result.context) {
+        result.reused = true;
+        return result;
+      }
+    }
+  }
+
+  lexer::Lexer lexer;
+  lexer.set_interner(interner);
+  lexer::Lexer::InitResult init_result = lexer.init(file_manager, file_id);
+  if (init_result.is_err()) {
+    result.errors.emplace_back(std::move(init_result).unwrap_err());
+    return result;
+  }
+
+  lexer::Lexer::Results<base::Token> tokenize_result = lexer.tokenize(strict);
+  if (tokenize_result.is_err()) {
+    for (auto&& e : std::move(tokenize_result).unwrap_err()) {
+      result.errors.emplace_back(std::move(e).convert_to_entry());
+    }
+    return result;
+  }
+
+  base::TokenStream stream(std::move(tokenize_result).unwrap(), file_manager,
+                           file_id);
+  parser::Parser parser;
+  parser.init(&stream, interner, translator, arena_profile);
+  parser::Parser::ParseResult parse_result = parser.parse_all(strict);
+  if (parse_result.is_err()) {
+    result.errors = std::move(parse_result).unwrap_err();
+    return result;
+  }
+
+  result.context = std::move(parse_result).unwrap();
+  if (cache) {
+    cache->store(source_hash, *result.context, *interner);
+  }
+  return result;
+}
+
+// rewrites the identifiers of `context` from a worker-local interner to the
+// shared one. runs on the calling thread in file order, so the ids handed out
+// by `global` do not depend on how files were scheduled.
+void remap_identifiers(ast::Context* context,
+                       const base::StringInterner& local,
+                       base::StringInterner* global) {
+  auto& identifiers = context->arena<ast::IdentifierPayload>();
+  for (std::size_t i = 0; i < identifiers.size(); ++i) {
+    identifiers[i].id = global->intern(local.lookup(identifiers[i].id));
+  }
+}
+
+}  // namespace
+
+Pipeline::Pipeline(unicode::Utf8FileManager* file_manager,
+                   const i18n::Translator* translator,
+                   Options options)
+    : file_manager_(file_manager),
+      translator_(translator),
+      options_(std::move(options)) {
+  DCHECK(file_manager_);
+  DCHECK(translator_);
+  if (!options_.cache_dir.empty()) {
+    cache_ = std::make_unique<AstCache>(options_.cache_dir);
+    manifest_.load(manifest_path());
+  }
+}
+
+std::size_t Pipeline::worker_count(std::size_t file_count) const {
+  std::size_t jobs = options_.jobs;
+  if (jobs == 0) {
+    jobs = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  return std::max<std::size_t>(std::min(jobs, file_count), 1);
+}
+
+std::vector<Pipeline::FileResult> Pipeline::parse_files(
+    std::span<const unicode::Utf8FileId> files,
+    base::StringInterner* interner,
+    Scope scope) {
+  DCHECK(interner);
+
+  std::vector<FileResult> results(files.size());
+  const std::size_t workers = worker_count(files.size());
+
+  if (workers == 1) {
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      results[i] = parse_file(file_manager_, *translator_, files[i], interner,
+                              options_.arena_profile, cache_.get(),
+                              options_.strict);
+    }
+    record_ast_usage(results);
+    update_manifest(&results, *interner, scope);
+    return results;
+  }
+
+  // each file is parsed against the interner of the worker that claimed it,
+  // remembered here for the remap below
+  std::vector<base::StringInterner> local_interners(workers);
+  std::vector<std::size_t> owners(files.size());
+  std::atomic<std::size_t> next_file = 0;
+
+  auto work = [&](std::size_t worker) {
+    base::StringInterner* local = &local_interners[worker];
+    for (std::size_t i = next_file.fetch_add(1, std::memory_order_relaxed);
+         i < files.size();
+         i = next_file.fetch_add(1, std::memory_order_relaxed)) {
+      results[i] = parse_file(file_manager_, *translator_, files[i], local,
+                              options_.arena_profile, cache_.get(),
+                              options_.strict);
+      owners[i] = worker;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (std::size_t w = 1; w < workers; ++w) {
+    threads.emplace_back(work, w);
+  }
+  work(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    if (results[i].context) {
+      remap_identifiers(results[i].context.get(), local_interners[owners[i]],
+                        interner);
+    }
+  }
+  record_ast_usage(results);
+  update_manifest(&results, *interner, scope);
+  return results;
+}
+
+void Pipeline::record_ast_usage(const std::vector<FileResult>& results) {
+  if (!options_.arena_profile) {
+    return;
+  }
+  for (const auto& result : results) {
+    if (result.context) {
+      result.context->record_usage(
+          options_.arena_profile,
+          file_manager_->file(result.file_id).line_count());
+    }
+  }
+}
+
+void Pipeline::update_manifest(std::vector<FileResult>* results,
+                               const base::StringInterner& interner,
+                               Scope scope) {
+  if (!cache_) {
+    return;
+  }
+
+  auto file_name = [this](const FileResult& result) {
+    return file_manager_->file(result.file_id).file_name();
+  };
+
+  // a file that failed to parse takes part with only its stem, so the files
+  // using it are invalidated, and is dropped from the manifest afterwards so
+  // it counts as changed again next time
+  BuildManifest::FileRecords current;
+  for (auto& result : *results) {
+    const std::string_view name = file_name(result);
+    BuildManifest::FileRecord record{.content_hash = result.source_hash};
+    if (result.context) {
+      record.modules =
+          collect_module_references(name, result.context.get(), interner);
+    } else {
+      record.modules.provides.emplace(module_name_of(name));
+    }
+    current.insert_or_assign(std::string(name), std::move(record));
+  }
+
+  // on a project run, files recorded last time but not given now were
+  // deleted or renamed. they only dirty their users, then their records go.
+  // a partial run leaves them alone but remembers which of them now depend
+  // on a changed module.
+  BuildManifest::FileNames invalidated;
+  if (scope == Scope::kProject) {
+    invalidated = manifest_.invalidated(current);
+    manifest_.prune(current);
+  } else {
+    BuildManifest::FileNames stale;
+    invalidated = manifest_.invalidated_partial(current, &stale);
+    for (const std::string& name : stale) {
+      manifest_.mark_stale(name);
+    }
+  }
+  for (auto& result : *results) {
+    const std::string_view name = file_name(result);
+    if (result.context) {
+      result.invalidated = invalidated.contains(name);
+      continue;
+    }
+    manifest_.erase(name);
+    if (auto it = current.find(name); it != current.end()) {
+      current.erase(it);
+    }
+  }
+  // a project run knows every source, entries of any other content are dead
+  std::set<uint64_t> live_hashes;
+  for (auto& [name, record] : current) {
+    live_hashes.insert(record.content_hash);
+    manifest_.update(name, std::move(record));
+  }
+  manifest_.save(manifest_path());
+  if (scope == Scope::kProject) {
+    cache_->evict(live_hashes);
+  }
+}
+
+std::string Pipeline::manifest_path() const {
+  return core::join_path(options_.cache_dir,
+                         std::string(BuildManifest::kFileName));
+}
+
+std::vector<Pipeline::De> Pipeline::run(
+    std::span<const unicode::Utf8FileId> files,
+    base::StringInterner* interner,
+    Scope scope) {
+  std::vector<FileResult> results = parse_files(files, interner, scope);
+
+  std::vector<De> errors;
+  std::vector<std::unique_ptr<ast::Context>> contexts;
+  // files of `contexts` that are lowered
+  std::vector<unicode::Utf8FileId> lowered;
+  std::vector<std::size_t> skipped;
+  contexts.reserve(results.size());
+  for (auto& result : results) {
+    for (auto& e : result.errors) {
+      errors.emplace_back(std::move(e));
+    }
+    if (!result.context) {
+      continue;
+    }
+    if (result.invalidated) {
+      lowered.push_back(result.file_id);
+    } else {
+      skipped.push_back(contexts.size());
+    }
+    contexts.emplace_back(std::move(result.context));
+  }
+
+  // nothing changed since the last run, which already reported everything
+  if (lowered.empty()) {
+    return errors;
+  }
+
+  resolver::Resolver resolver;
+  resolver.init(interner, std::move(contexts));
+  for (std::size_t index : skipped) {
+    resolver.skip_lowering(index);
+  }
+  if (options_.arena_profile) {
+    resolver.reserve_hir(*options_.arena_profile);
+  }
+  resolver.analyze();
+  if (options_.arena_profile) {
+    resolver.record_hir_usage(options_.arena_profile);
+  }
+  std::vector<De> resolve_errors = resolver.take_errors();
+  if (cache_ && !resolve_errors.empty()) {
+    // lower these files again next time so their errors are reported again
+    for (unicode::Utf8FileId file_id : lowered) {
+      manifest_.mark_stale(file_manager_->file(file_id).file_name());
+    }
+    manifest_.save(manifest_path());
+  }
+  for (auto& e : resolve_errors) {
+    errors.emplace_back(std::move(e));
+  }
+  return errors;
+}
+
+}  // namespace pipeline
@@ -0,0 +1,130 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_PIPELINE_PIPELINE_H_
+#define FRONTEND_PIPELINE_PIPELINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "frontend/data/ast/context.h"
+#include "frontend/diagnostic/data/diagnostic_entry.h"
+#include "frontend/pipeline/ast_cache.h"
+#include "frontend/pipeline/base/pipeline_export.h"
+#include "frontend/pipeline/build_manifest.h"
+#include "unicode/utf8/file_manager.h"
+
+namespace base {
+class ArenaProfile;
+class StringInterner;
+}  // namespace base
+
+namespace i18n {
+class Translator;
+}  // namespace i18n
+
+namespace pipeline {
+
+// drives the frontend over many source files. lexing and parsing run on a
+// pool of worker threads, one file at a time per worker, and the per-file
+// asts are handed to a single resolver afterwards.
+class PIPELINE_EXPORT Pipeline {
+ public:
+  using De = diagnostic::DiagnosticEntry;
+
+  struct Options {
+    // number of worker threads. 0 uses every hardware thread.
+    std::size_t jobs = 0;
+    // stop lexing / parsing a file at its first error
+    bool strict = false;
+    // if set, ast and hir arenas are pre-sized from it and the usage of this
+    // run is recorded back into it. workers only read it, records happen on
+    // the calling thread.
+    base::ArenaProfile* arena_profile = nullptr;
+    // directory of the ast cache, empty disables it. files whose content is
+    // unchanged since an earlier run are loaded from there instead of parsed,
+    // and a build manifest kept next to the entries tracks which files have
+    // to be reprocessed because a module they use changed. a project run
+    // evicts the entries no file of the project has the content of.
+    std::string cache_dir;
+  };
+
+  // what the files given to parse_files() and run() stand for. only matters
+  // with a cache, for the build manifest.
+  enum class Scope : uint8_t {
+    // some files of the project. the records of the other files are kept,
+    // and the ones depending on a changed module are invalidated the next
+    // time they are given.
+    kPartial = 0,
+    // the whole project. files recorded by an earlier run but not given now
+    // were deleted or renamed, their users are invalidated and their records
+    // dropped.
+    kProject = 1,
+  };
+
+  // frontend output of a single source file
+  struct FileResult {
+    unicode::Utf8FileId file_id = unicode::kInvalidFileId;
+    // null if the file could not be lexed or parsed
+    std::unique_ptr<ast::Context> context;
+    std::vector<De> errors;
+    // content hash of the source, 0 without a cache
+    uint64_t source_hash = 0;
+    // the ast was loaded from the cache instead of parsed
+    bool reused = false;
+    // the file, or a module it uses directly or indirectly, changed since the
+    // last run. always true without a cache. run() only lowers invalidated
+    // files, the others just contribute their declarations.
+    bool invalidated = true;
+  };
+
+  Pipeline(unicode::Utf8FileManager* file_manager,
+           const i18n::Translator* translator,
+           Options options);
+  ~Pipeline() = default;
+
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+
+  Pipeline(Pipeline&&) noexcept = default;
+  Pipeline& operator=(Pipeline&&) noexcept = default;
+
+  // lexes and parses `files` in parallel. results are in the order of `files`
+  // and their identifiers are interned into `interner`, which is only touched
+  // by the calling thread.
+  std::vector<FileResult> parse_files(
+      std::span<const unicode::Utf8FileId> files,
+      base::StringInterner* interner,
+      Scope scope = Scope::kPartial);
+
+  // parse_files() followed by name resolution over every file that parsed.
+  // returns all diagnostics in file order.
+  std::vector<De> run(std::span<const unicode::Utf8FileId> files,
+                      base::StringInterner* interner,
+                      Scope scope = Scope::kPartial);
+
+  // worker count actually used for `file_count` files
+  std::size_t worker_count(std::size_t file_count) const;
+
+ private:
+  void record_ast_usage(const std::vector<FileResult>& results);
+  void update_manifest(std::vector<FileResult>* results,
+                       const base::StringInterner& interner,
+                       Scope scope);
+  std::string manifest_path() const;
+
+  unicode::Utf8FileManager* file_manager_ = nullptr;
+  const i18n::Translator* translator_ = nullptr;
+  Options options_;
+  std::unique_ptr<AstCache> cache_;
+  BuildManifest manifest_;
+};
+
+}  // namespace pipeline
+
+#endif  // FRONTEND_PIPELINE_PIPELINE_H_
@@ -0,0 +1,70 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "frontend/base/string/string_interner.h"
+#include "frontend/pipeline/pipeline.h"
+#include "i18n/base/translator.h"
+#include "unicode/utf8/file_manager.h"
+
+namespace pipeline {
+
+namespace {
+
+constexpr std::size_t kFileCount = 256;
+constexpr std::size_t kStatementsPerFile = 2048;
+
+std::u8string generate_file(std::size_t index) {
+  std::u8string source;
+  const std::string n = std::to_string(index);
+  for (std::size_t i = 0; i < kStatementsPerFile; ++i) {
+    const std::string m = std::to_string(i % 64);
+    const std::string line = "value_" + m + " := " + n + "; total_" + n +
+                             ": i32 = value_" + m + " + " + m + ";\n";
+    source.append(line.begin(), line.end());
+  }
+  return source;
+}
+
+// parses kFileCount files with state.range(0) worker threads. compare the
+// items_per_second across job counts for the scaling curve.
+void pipeline_parse_files(benchmark::State& state) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+
+  std::vector<unicode::Utf8FileId> files;
+  std::size_t total_size = 0;
+  for (std::size_t i = 0; i < kFileCount; ++i) {
+    std::u8string source = generate_file(i);
+    total_size += source.size();
+    files.push_back(manager.register_virtual_file(std::move(source)));
+  }
+
+  Pipeline pipeline(&manager, &translator,
+                    {.jobs = static_cast<std::size_t>(state.range(0))});
+  for (auto _ : state) {
+    base::StringInterner interner;
+    auto results = pipeline.parse_files(files, &interner);
+    benchmark::DoNotOptimize(results.data());
+  }
+  state.SetBytesProcessed(total_size * state.iterations());
+  state.SetItemsProcessed(kFileCount * state.iterations());
+  state.counters["jobs"] =
+      static_cast<double>(pipeline.worker_count(kFileCount));
+}
+BENCHMARK(pipeline_parse_files)
+    ->RangeMultiplier(2)
+    ->Range(1, std::max<int>(std::thread::hardware_concurrency(), 1))
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace pipeline
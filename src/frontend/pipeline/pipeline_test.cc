@@ -0,0 +1,403 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "frontend/pipeline/pipeline.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/base/file_util.h"
+#include "frontend/base/data/arena_profile.h"
+#include "frontend/base/string/string_interner.h"
+#include "frontend/data/ast/payload/data.h"
+#include "frontend/pipeline/build_manifest.h"
+#include "gtest/gtest.h"
+#include "i18n/base/translator.h"
+#include "unicode/utf8/file_manager.h"
+
+namespace pipeline {
+
+namespace {
+
+constexpr std::size_t kFileCount = 16;
+
+std::u8string make_source(std::size_t index) {
+  const std::string n = std::to_string(index);
+  const std::string src =
+      "shared := " + n + "; local_" + n + ": i32 = " + n + "; shared_" +
+      std::to_string(index % 3) + " := 1;";
+  return std::u8string(src.begin(), src.end());
+}
+
+std::vector<unicode::Utf8FileId> register_files(
+    unicode::Utf8FileManager* manager) {
+  std::vector<unicode::Utf8FileId> ids;
+  for (std::size_t i = 0; i < kFileCount; ++i) {
+    ids.push_back(manager->register_virtual_file(make_source(i)));
+  }
+  return ids;
+}
+
+// identifier strings of every file, resolved through `interner`
+std::vector<std::vector<std::string>> identifier_names(
+    std::vector<Pipeline::FileResult>* results,
+    const base::StringInterner& interner) {
+  std::vector<std::vector<std::string>> names;
+  for (auto& result : *results) {
+    std::vector<std::string>& file_names = names.emplace_back();
+    auto& identifiers = result.context->arena<ast::IdentifierPayload>();
+    for (std::size_t i = 0; i < identifiers.size(); ++i) {
+      file_names.emplace_back(interner.lookup(identifiers[i].id));
+    }
+  }
+  return names;
+}
+
+std::vector<std::vector<base::StringId>> identifier_ids(
+    std::vector<Pipeline::FileResult>* results) {
+  std::vector<std::vector<base::StringId>> ids;
+  for (auto& result : *results) {
+    std::vector<base::StringId>& file_ids = ids.emplace_back();
+    auto& identifiers = result.context->arena<ast::IdentifierPayload>();
+    for (std::size_t i = 0; i < identifiers.size(); ++i) {
+      file_ids.push_back(identifiers[i].id);
+    }
+  }
+  return ids;
+}
+
+}  // namespace
+
+TEST(PipelineTest, ParsesFilesInInputOrder) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+  const std::vector<unicode::Utf8FileId> files = register_files(&manager);
+
+  base::StringInterner interner;
+  Pipeline pipeline(&manager, &translator, {.jobs = 4});
+  std::vector<Pipeline::FileResult> results =
+      pipeline.parse_files(files, &interner);
+
+  ASSERT_EQ(results.size(), files.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].file_id, files[i]);
+    EXPECT_TRUE(results[i].errors.empty());
+    ASSERT_NE(results[i].context, nullptr);
+  }
+}
+
+TEST(PipelineTest, SingleAndMultiThreadedResultsMatch) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+  const std::vector<unicode::Utf8FileId> files = register_files(&manager);
+
+  base::StringInterner serial_interner;
+  Pipeline serial(&manager, &translator, {.jobs = 1});
+  std::vector<Pipeline::FileResult> serial_results =
+      serial.parse_files(files, &serial_interner);
+
+  base::StringInterner parallel_interner;
+  Pipeline parallel(&manager, &translator, {.jobs = 4});
+  std::vector<Pipeline::FileResult> parallel_results =
+      parallel.parse_files(files, &parallel_interner);
+
+  ASSERT_EQ(serial_results.size(), parallel_results.size());
+  for (std::size_t i = 0; i < serial_results.size(); ++i) {
+    ASSERT_NE(serial_results[i].context, nullptr);
+    ASSERT_NE(parallel_results[i].context, nullptr);
+    EXPECT_EQ(serial_results[i].context->arena<ast::Node>().size(),
+              parallel_results[i].context->arena<ast::Node>().size());
+  }
+
+  // identifiers are remapped into the shared interner in file order, so the
+  // ids match the single threaded run exactly
+  EXPECT_EQ(identifier_names(&serial_results, serial_interner),
+            identifier_names(&parallel_results, parallel_interner));
+  EXPECT_EQ(identifier_ids(&serial_results),
+            identifier_ids(&parallel_results));
+  EXPECT_EQ(serial_interner.size(), parallel_interner.size());
+}
+
+TEST(PipelineTest, SharedIdentifiersGetOneId) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+  const std::vector<unicode::Utf8FileId> files = register_files(&manager);
+
+  base::StringInterner interner;
+  Pipeline pipeline(&manager, &translator, {.jobs = 4});
+  std::vector<Pipeline::FileResult> results =
+      pipeline.parse_files(files, &interner);
+
+  const base::StringId shared = interner.lookup(std::string_view("shared"));
+  ASSERT_NE(shared, base::kInvalidStringId);
+
+  std::size_t files_with_shared = 0;
+  for (auto& result : results) {
+    auto& identifiers = result.context->arena<ast::IdentifierPayload>();
+    for (std::size_t i = 0; i < identifiers.size(); ++i) {
+      if (identifiers[i].id == shared) {
+        ++files_with_shared;
+        break;
+      }
+    }
+  }
+  EXPECT_EQ(files_with_shared, files.size());
+}
+
+TEST(PipelineTest, ReportsErrorsPerFile) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+  std::vector<unicode::Utf8FileId> files = register_files(&manager);
+  files.push_back(manager.register_virtual_file(u8"x := \"unterminated"));
+
+  base::StringInterner interner;
+  Pipeline pipeline(&manager, &translator, {.jobs = 4});
+  std::vector<Pipeline::FileResult> results =
+      pipeline.parse_files(files, &interner);
+
+  ASSERT_EQ(results.size(), files.size());
+  EXPECT_EQ(results.back().context, nullptr);
+  EXPECT_FALSE(results.back().errors.empty());
+  for (std::size_t i = 0; i + 1 < results.size(); ++i) {
+    EXPECT_NE(results[i].context, nullptr);
+  }
+
+  EXPECT_FALSE(pipeline.run(files, &interner).empty());
+}
+
+TEST(PipelineTest, RecordsArenaProfile) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+  const std::vector<unicode::Utf8FileId> files = register_files(&manager);
+
+  base::ArenaProfile profile;
+  base::StringInterner interner;
+  Pipeline pipeline(&manager, &translator,
+                    {.jobs = 4, .arena_profile = &profile});
+  EXPECT_TRUE(pipeline.run(files, &interner).empty());
+
+  // every source is a single line with at least three identifiers
+  EXPECT_GE(profile.estimate("ast.identifier_payloads", 1), 3u);
+  EXPECT_GT(profile.estimate("ast.nodes", 1), 0u);
+  EXPECT_EQ(profile.estimate("ast.nodes", 0), 0u);
+
+  // a second run is pre-sized from the profile and records the same marks
+  base::ArenaProfile before = profile;
+  base::StringInterner second_interner;
+  EXPECT_TRUE(pipeline.run(files, &second_interner).empty());
+  EXPECT_EQ(profile.estimate("ast.nodes", 1000),
+            before.estimate("ast.nodes", 1000));
+}
+
+TEST(PipelineTest, LoadsUnchangedFilesFromTheAstCache) {
+  core::TempDir dir("ast_cache_");
+  ASSERT_TRUE(dir.valid());
+  const Pipeline::Options options = {.jobs = 4, .cache_dir = dir.path()};
+
+  std::vector<std::vector<std::string>> cold_names;
+  {
+    unicode::Utf8FileManager manager;
+    const i18n::Translator translator;
+    const std::vector<unicode::Utf8FileId> files = register_files(&manager);
+    base::StringInterner interner;
+    std::vector<Pipeline::FileResult> results =
+        Pipeline(&manager, &translator, options).parse_files(files, &interner);
+    cold_names = identifier_names(&results, interner);
+  }
+  // one entry per file plus the build manifest
+  const core::Files entries = core::list_files(dir.path());
+  EXPECT_EQ(entries.size(), kFileCount + 1);
+
+  // a fresh run sees the same sources and is served from the cache
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+  const std::vector<unicode::Utf8FileId> files = register_files(&manager);
+  base::StringInterner interner;
+  Pipeline pipeline(&manager, &translator, options);
+  std::vector<Pipeline::FileResult> results =
+      pipeline.parse_files(files, &interner);
+  EXPECT_EQ(identifier_names(&results, interner), cold_names);
+  EXPECT_TRUE(pipeline.run(files, &interner).empty());
+
+  const std::string manifest_path =
+      core::join_path(dir.path(), std::string(BuildManifest::kFileName));
+  BuildManifest before;
+  ASSERT_TRUE(before.load(manifest_path));
+
+  // a changed source misses and adds an entry. it is parsed on its own,
+  // which keeps the records of the other files.
+  std::vector<unicode::Utf8FileId> changed = {
+      manager.register_virtual_file(u8"changed := 1;")};
+  pipeline.parse_files(changed, &interner);
+  EXPECT_EQ(core::list_files(dir.path()).size(), kFileCount + 2);
+  BuildManifest after;
+  ASSERT_TRUE(after.load(manifest_path));
+  EXPECT_EQ(after.size(), before.size() + 1);
+
+  for (const std::string& entry : core::list_files(dir.path())) {
+    core::remove_file(core::join_path(dir.path(), entry).c_str());
+  }
+}
+
+TEST(PipelineTest, InvalidatesDependentsOfChangedModules) {
+  core::TempDir dir("build_manifest_");
+  ASSERT_TRUE(dir.valid());
+  const Pipeline::Options options = {.jobs = 2, .cache_dir = dir.path()};
+
+  // app uses util, util uses core, tool uses nothing
+  auto parse = [&](std::u8string core_source) {
+    unicode::Utf8FileManager manager;
+    const i18n::Translator translator;
+    const std::vector<unicode::Utf8FileId> files = {
+        manager.register_file_loaded(u8"core.ry", std::move(core_source)),
+        manager.register_file_loaded(u8"util.ry",
+                                     u8"use core::base; helper := 2;"),
+        manager.register_file_loaded(u8"app.ry",
+                                     u8"use util::helper; main := 3;"),
+        manager.register_file_loaded(u8"tool.ry", u8"tool := 4;"),
+    };
+    base::StringInterner interner;
+    std::vector<Pipeline::FileResult> results =
+        Pipeline(&manager, &translator, options).parse_files(files, &interner);
+
+    std::vector<std::pair<bool, bool>> flags;
+    for (const auto& result : results) {
+      EXPECT_NE(result.context, nullptr);
+      flags.emplace_back(result.reused, result.invalidated);
+    }
+    return flags;
+  };
+
+  // {reused, invalidated}
+  using Flags = std::vector<std::pair<bool, bool>>;
+  const std::pair<bool, bool> parsed = {false, true};
+  const std::pair<bool, bool> reused = {true, false};
+  const std::pair<bool, bool> stale = {true, true};
+
+  EXPECT_EQ(parse(u8"base := 1;"), (Flags{parsed, parsed, parsed, parsed}));
+  EXPECT_EQ(parse(u8"base := 1;"), (Flags{reused, reused, reused, reused}));
+  EXPECT_EQ(parse(u8"base := 10;"), (Flags{parsed, stale, stale, reused}));
+  EXPECT_EQ(parse(u8"base := 10;"), (Flags{reused, reused, reused, reused}));
+
+  for (const std::string& entry : core::list_files(dir.path())) {
+    core::remove_file(core::join_path(dir.path(), entry).c_str());
+  }
+}
+
+TEST(PipelineTest, InvalidatesDependentsOfRemovedFiles) {
+  core::TempDir dir("build_manifest_");
+  ASSERT_TRUE(dir.valid());
+  const Pipeline::Options options = {.jobs = 2, .cache_dir = dir.path()};
+
+  // {reused, invalidated} of every file, util and app only with `with_util`
+  auto parse = [&](bool with_util) {
+    unicode::Utf8FileManager manager;
+    const i18n::Translator translator;
+    std::vector<unicode::Utf8FileId> files;
+    if (with_util) {
+      files.push_back(
+          manager.register_file_loaded(u8"util.ry", u8"helper := 2;"));
+    }
+    files.push_back(manager.register_file_loaded(
+        u8"app.ry", u8"use util::helper; main := 3;"));
+    base::StringInterner interner;
+    std::vector<Pipeline::FileResult> results =
+        Pipeline(&manager, &translator, options)
+            .parse_files(files, &interner, Pipeline::Scope::kProject);
+
+    std::vector<std::pair<bool, bool>> flags;
+    for (const auto& result : results) {
+      flags.emplace_back(result.reused, result.invalidated);
+    }
+    return flags;
+  };
+
+  using Flags = std::vector<std::pair<bool, bool>>;
+  const std::pair<bool, bool> parsed = {false, true};
+  const std::pair<bool, bool> reused = {true, false};
+  const std::pair<bool, bool> stale = {true, true};
+
+  EXPECT_EQ(parse(true), (Flags{parsed, parsed}));
+  // deleting util dirties app, and util is pruned from the manifest
+  EXPECT_EQ(parse(false), (Flags{stale}));
+  EXPECT_EQ(parse(false), (Flags{reused}));
+
+  BuildManifest manifest;
+  ASSERT_TRUE(manifest.load(
+      core::join_path(dir.path(), std::string(BuildManifest::kFileName))));
+  EXPECT_EQ(manifest.size(), 1u);
+  EXPECT_EQ(manifest.find("util.ry"), nullptr);
+  // the entry of util is evicted, app's and the manifest remain
+  EXPECT_EQ(core::list_files(dir.path()).size(), 2u);
+
+  for (const std::string& entry : core::list_files(dir.path())) {
+    core::remove_file(core::join_path(dir.path(), entry).c_str());
+  }
+}
+
+TEST(PipelineTest, PartialRunsInvalidateDependentsLater) {
+  core::TempDir dir("build_manifest_");
+  ASSERT_TRUE(dir.valid());
+  const Pipeline::Options options = {.jobs = 2, .cache_dir = dir.path()};
+
+  // {reused, invalidated} of the given files. app uses util, util uses core.
+  auto parse = [&](std::u8string core_source, bool all) {
+    unicode::Utf8FileManager manager;
+    const i18n::Translator translator;
+    std::vector<unicode::Utf8FileId> files = {
+        manager.register_file_loaded(u8"core.ry", std::move(core_source))};
+    if (all) {
+      files.push_back(manager.register_file_loaded(
+          u8"util.ry", u8"use core::base; helper := 2;"));
+      files.push_back(manager.register_file_loaded(
+          u8"app.ry", u8"use util::helper; main := 3;"));
+    }
+    base::StringInterner interner;
+    std::vector<Pipeline::FileResult> results =
+        Pipeline(&manager, &translator, options)
+            .parse_files(files, &interner,
+                         all ? Pipeline::Scope::kProject
+                             : Pipeline::Scope::kPartial);
+
+    std::vector<std::pair<bool, bool>> flags;
+    for (const auto& result : results) {
+      flags.emplace_back(result.reused, result.invalidated);
+    }
+    return flags;
+  };
+
+  using Flags = std::vector<std::pair<bool, bool>>;
+  const std::pair<bool, bool> parsed = {false, true};
+  const std::pair<bool, bool> reused = {true, false};
+  const std::pair<bool, bool> stale = {true, true};
+
+  EXPECT_EQ(parse(u8"base := 1;", true), (Flags{parsed, parsed, parsed}));
+  // core changes on its own, util and app keep their records
+  EXPECT_EQ(parse(u8"base := 10;", false), (Flags{parsed}));
+  // both contents of core are cached next to the manifest
+  EXPECT_EQ(core::list_files(dir.path()).size(), 5u);
+  EXPECT_EQ(parse(u8"base := 10;", true), (Flags{reused, stale, stale}));
+  // the project run evicts the old content of core
+  EXPECT_EQ(core::list_files(dir.path()).size(), 4u);
+  EXPECT_EQ(parse(u8"base := 10;", true), (Flags{reused, reused, reused}));
+
+  for (const std::string& entry : core::list_files(dir.path())) {
+    core::remove_file(core::join_path(dir.path(), entry).c_str());
+  }
+}
+
+TEST(PipelineTest, WorkerCountIsBoundedByFiles) {
+  unicode::Utf8FileManager manager;
+  const i18n::Translator translator;
+
+  EXPECT_EQ(Pipeline(&manager, &translator, {.jobs = 8}).worker_count(3), 3u);
+  EXPECT_EQ(Pipeline(&manager, &translator, {.jobs = 2}).worker_count(3), 2u);
+  EXPECT_EQ(Pipeline(&manager, &translator, {.jobs = 4}).worker_count(0), 1u);
+  EXPECT_GE(Pipeline(&manager, &translator, {}).worker_count(64), 1u);
+}
+
+}  // namespace pipeline
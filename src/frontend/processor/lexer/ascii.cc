@@ -2,52 +2,59 @@
 // This source code is licensed under the Apache License, Version 2.0
 // which can be found in the LICENSE file.
 
+#include "frontend/processor/lexer/encoding.h"
 #include "frontend/processor/lexer/lexer.h"
 #include "unicode/base/unicode_util.h"
 
 namespace lexer {
 
+template <typename Enc>
 Lexer::Result<base::Token> Lexer::ascii_token(char current_char,
-                                              std::size_t start,
-                                              std::size_t line,
-                                              std::size_t col) {
-  if (unicode::is_xid_start(current_char)) {
-    return identifier_or_keyword();
+                                              std::size_t start) {
+  if (Enc::is_id_start(current_char)) {
+    return identifier_or_keyword<Enc>();
   }
 
-  if (unicode::is_decimal_number(current_char)) {
-    return literal_numeric();
+  if (Enc::is_decimal_number(current_char)) {
+    return literal_numeric<Enc>();
   }
 
   // string literals
   if (current_char == '"') {
-    return literal_str();
+    return literal_str<Enc>();
   }
 
   // character literals
   if (current_char == '\'') {
-    return literal_char();
+    return literal_char<Enc>();
   }
 
   if (current_char == '\\' && !stream_.eof()) {
-    const char32_t next_codepoint = stream_.peek_at(1);
-    if (unicode::is_ascii(next_codepoint)) {
+    const char32_t next_codepoint = peek_at<Enc>(1);
+    if (Enc::kAsciiOnly || unicode::is_ascii(next_codepoint)) {
       const char next_char = static_cast<char>(next_codepoint);
       if (!core::is_valid_escape_sequence(current_char, next_char)) {
         status_ = Status::kErrorOccured;
-        return err<Token>(Error::create(
-            start, line, col, diagnostic::DiagId::kInvalidCharacterEscape));
+        return err<Token>(
+            error_at(start, 1, diagnostic::DiagId::kInvalidCharacterEscape));
       }
     }
   }
 
   // consume the current character
-  const char32_t next_codepoint = stream_.next();
-  const char next_char = unicode::is_ascii(next_codepoint)
+  const char32_t next_codepoint = next<Enc>();
+  const char next_char = Enc::kAsciiOnly || unicode::is_ascii(next_codepoint)
                              ? static_cast<char>(next_codepoint)
                              : '\0';
 
-  return other_token(current_char, next_char, start, line, col);
+  return other_token<Enc>(current_char, next_char, start);
 }
 
+template Lexer::Result<base::Token> Lexer::ascii_token<AsciiEncoding>(
+    char,
+    std::size_t);
+template Lexer::Result<base::Token> Lexer::ascii_token<Utf8Encoding>(
+    char,
+    std::size_t);
+
 }  // namespace lexer
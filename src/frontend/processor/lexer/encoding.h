@@ -0,0 +1,86 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef FRONTEND_PROCESSOR_LEXER_ENCODING_H_
+#define FRONTEND_PROCESSOR_LEXER_ENCODING_H_
+
+#include <cstddef>
+
+#include "unicode/base/unicode_util.h"
+#include "unicode/utf8/stream.h"
+
+namespace lexer {
+
+// encoding classes the lexer core is instantiated for. one of them is picked
+// per file from what the stream found while validating it, see
+// Lexer::tokenize().
+
+// any valid utf-8
+struct Utf8Encoding {
+  static constexpr bool kAsciiOnly = false;
+
+  static inline char32_t peek(const unicode::Utf8Stream& stream) {
+    return stream.peek();
+  }
+  static inline char32_t peek_at(const unicode::Utf8Stream& stream,
+                                 std::size_t offset) {
+    return stream.peek_at(offset);
+  }
+  static inline char32_t next(unicode::Utf8Stream& stream) {
+    return stream.next();
+  }
+
+  static inline bool is_id_start(char32_t c) {
+    return unicode::is_xid_start(c);
+  }
+  static inline bool is_id_continue(char32_t c) {
+    return unicode::is_xid_continue(c);
+  }
+  static inline bool is_decimal_number(char32_t c) {
+    return unicode::is_decimal_number(c);
+  }
+  static inline bool is_whitespace(char32_t c) {
+    return unicode::is_unicode_whitespace(c);
+  }
+  static inline bool is_newline(char32_t c) {
+    return unicode::is_unicode_newline(c);
+  }
+};
+
+// content without a byte above 0x7f (unicode::Utf8Stream::is_ascii()). bytes
+// are read directly, nothing is decoded and no unicode table is looked up.
+struct AsciiEncoding {
+  static constexpr bool kAsciiOnly = true;
+
+  static inline char32_t peek(const unicode::Utf8Stream& stream) {
+    return stream.peek_ascii();
+  }
+  static inline char32_t peek_at(const unicode::Utf8Stream& stream,
+                                 std::size_t offset) {
+    return stream.peek_ascii_at(offset);
+  }
+  static inline char32_t next(unicode::Utf8Stream& stream) {
+    return stream.next_ascii();
+  }
+
+  static inline bool is_id_start(char32_t c) {
+    return unicode::detail::kAsciiIdStartBitmap[c];
+  }
+  static inline bool is_id_continue(char32_t c) {
+    return unicode::detail::kAsciiIdContinueBitmap[c];
+  }
+  static inline bool is_decimal_number(char32_t c) {
+    return c - U'0' < 10u;
+  }
+  static inline bool is_whitespace(char32_t c) {
+    return unicode::is_ascii_whitespace(c);
+  }
+  static inline bool is_newline(char32_t c) {
+    return unicode::is_ascii_newline(c);
+  }
+};
+
+}  // namespace lexer
+
+#endif  // FRONTEND_PROCESSOR_LEXER_ENCODING_H_
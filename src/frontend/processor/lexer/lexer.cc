@@ -6,12 +6,17 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "core/base/string_util.h"
 #include "frontend/base/keyword/keyword.h"
+#include "frontend/base/string/string_interner.h"
 #include "frontend/base/token/token.h"
 #include "frontend/base/token/token_kind.h"
+#include "frontend/base/token/token_stream.h"
+#include "frontend/processor/lexer/encoding.h"
 #include "frontend/diagnostic/data/annotation.h"
 #include "frontend/diagnostic/data/diagnostic_entry.h"
 #include "frontend/diagnostic/data/diagnostic_id.h"
@@ -28,13 +33,23 @@ Lexer::Lexer() = default;
 
 Lexer::InitResult Lexer::init(unicode::Utf8FileManager* file_manager,
                               unicode::Utf8FileId file_id,
-                              Mode mode) {
+                              Mode mode,
+                              DecodeMode decode_mode,
+                              bool validate_utf8) {
   DCHECK_EQ(status_, Status::kNotInitialized);
   mode_ = mode;
+  return init_result(
+      stream_.init(file_manager, file_id, decode_mode, validate_utf8));
+}
 
-  unicode::Utf8Stream::ErrorCode error_code =
-      stream_.init(file_manager, file_id);
+Lexer::InitResult Lexer::init(unicode::Utf8Window* window, Mode mode) {
+  DCHECK_EQ(status_, Status::kNotInitialized);
+  mode_ = mode;
+  return init_result(stream_.init(window));
+}
 
+Lexer::InitResult Lexer::init_result(
+    unicode::Utf8Stream::ErrorCode error_code) {
   using Ec = unicode::Utf8Stream::ErrorCode;
   switch (error_code) {
     case Ec::kSuccess:
@@ -60,13 +75,40 @@ Lexer::InitResult Lexer::init(unicode::Utf8FileManager* file_manager,
 
 Lexer::Results<base::Token> Lexer::tokenize(bool strict) {
   DCHECK_EQ(status_, Status::kReadyToTokenize);
+  DCHECK(!stream_.windowed()) << "windowed input is read by token_source()";
+  if (stream_.is_ascii()) {
+    return tokenize_all<AsciiEncoding>(strict);
+  }
+  return tokenize_all<Utf8Encoding>(strict);
+}
+
+Lexer::Result<base::Token> Lexer::tokenize_next() {
+  if (stream_.is_ascii()) {
+    return tokenize_next_impl<AsciiEncoding>();
+  }
+  return tokenize_next_impl<Utf8Encoding>();
+}
+
+base::TokenStream::TokenSource Lexer::token_source(
+    std::vector<Error>* errors) {
+  DCHECK_EQ(status_, Status::kReadyToTokenize);
+  DCHECK(errors);
+  if (stream_.is_ascii()) {
+    return token_source_impl<AsciiEncoding>(errors);
+  }
+  return token_source_impl<Utf8Encoding>(errors);
+}
+
+template <typename Enc>
+Lexer::Results<base::Token> Lexer::tokenize_all(bool strict) {
   std::vector<Token> tokens;
   std::vector<Error> errors;
 
-  tokens.reserve(stream_.file().line_count() * kPredictedTokensCountPerLine);
+  tokens.reserve(stream_.file().content_u8().size() / kPredictedBytesPerToken +
+                 1);
 
   while (true) {
-    Result<Token> result = tokenize_next();
+    Result<Token> result = tokenize_next_impl<Enc>();
     if (result.is_ok()) [[likely]] {
       Token token = std::move(result).unwrap();
       const bool is_eof = token.kind() == base::TokenKind::kEof;
@@ -90,10 +132,62 @@ Lexer::Results<base::Token> Lexer::tokenize(bool strict) {
   }
 }
 
-Lexer::Result<base::Token> Lexer::tokenize_next() {
+template <typename Enc>
+base::TokenStream::TokenSource Lexer::token_source_impl(
+    std::vector<Error>* errors) {
+  return [this, errors]() {
+    while (true) {
+      // trivia is skipped up front, so `start` is where the token begins and
+      // an error that consumed nothing is told apart from the trivia before it
+      const std::size_t trivia_start = stream_.byte_position();
+      Result<void> trivia = skip_trivia<Enc>();
+      if (near_window_end()) [[unlikely]] {
+        slide_window(trivia_start);
+        continue;
+      }
+      if (trivia.is_err()) [[unlikely]] {
+        // an unterminated comment, which runs to the end of the file
+        errors->push_back(std::move(trivia).unwrap_err());
+        continue;
+      }
+      const std::size_t start = stream_.byte_position();
+      Result<Token> result = tokenize_next_impl<Enc>();
+      if (near_window_end()) [[unlikely]] {
+        // the token may continue past the window, lex it again
+        slide_window(start);
+        continue;
+      }
+      if (result.is_ok()) [[likely]] {
+        Token token = std::move(result).unwrap();
+        if (token.kind() == TokenKind::kEof && stream_.windowed() &&
+            stream_.window().status() != unicode::Utf8Window::Status::kValid)
+            [[unlikely]] {
+          // the window stopped reading in front of an invalid sequence or
+          // a read error, and the file ends here for the lexer
+          const bool invalid = stream_.window().status() ==
+                               unicode::Utf8Window::Status::kInvalidUtf8;
+          errors->push_back(
+              error_at(stream_.window().end(), 0,
+                       invalid ? diagnostic::DiagnosticId::kInvalidUtfSequence
+                               : diagnostic::DiagnosticId::kFileNotFound));
+        }
+        return token;
+      }
+      errors->push_back(std::move(result).unwrap_err());
+      if (stream_.byte_position() == start && !stream_.eof()) [[unlikely]] {
+        // the offending character was not consumed (e.g. an unrecognized
+        // one), skip it or the next call would fail the same way
+        next<Enc>();
+      }
+    }
+  };
+}
+
+template <typename Enc>
+Lexer::Result<base::Token> Lexer::tokenize_next_impl() {
   DCHECK_NE(status_, Status::kNotInitialized);
   DCHECK_NE(status_, Status::kTokenizeCompleted);
-  auto r = skip_trivia();
+  auto r = skip_trivia<Enc>();
   if (r.is_err()) [[unlikely]] {
     status_ = Status::kErrorOccured;
     return Result<base::Token>(
@@ -103,40 +197,46 @@ Lexer::Result<base::Token> Lexer::tokenize_next() {
   if (stream_.eof()) [[unlikely]] {
     status_ = Status::kTokenizeCompleted;
     return Result<Token>(diagnostic::create_ok(
-        Token(TokenKind::kEof, stream_.line(), stream_.column(), 0)));
+        Token(TokenKind::kEof, stream_.byte_position(), 0)));
   }
 
-  const char32_t current_codepoint = stream_.peek();
-  const std::size_t line = stream_.line();
-  const std::size_t col = stream_.column();
-  const std::size_t start = stream_.position();
+  const char32_t current_codepoint = peek<Enc>();
+  const std::size_t start = stream_.byte_position();
 
   if (unicode::is_eof(current_codepoint)) [[unlikely]] {
     status_ = Status::kErrorOccured;
-    return err<Token>(Error::create(
-        line, col, 0, diagnostic::DiagnosticId::kUnexpectedEndOfFile));
+    return err<Token>(
+        error_at(start, 0, diagnostic::DiagnosticId::kUnexpectedEndOfFile));
   }
 
   // for ascii characters (most common case)
-  if (unicode::is_ascii(current_codepoint)) [[likely]] {
-    return ascii_token(static_cast<char>(current_codepoint), start, line, col);
+  if (Enc::kAsciiOnly || unicode::is_ascii(current_codepoint)) [[likely]] {
+    return ascii_token<Enc>(static_cast<char>(current_codepoint), start);
   }
 
   // unicode-specific handling
-  return unicode_token(current_codepoint, start, line, col);
+  return unicode_token(current_codepoint, start);
 }
 
+template <typename Enc>
 void Lexer::skip_whitespace() {
-  while (!stream_.eof() && !unicode::is_unicode_newline(stream_.peek()) &&
-         unicode::is_unicode_whitespace(stream_.peek())) {
-    stream_.next();
+  while (true) {
+    // jump over runs of spaces and tabs, then handle the rest one by one
+    stream_.skip_ascii_blanks();
+    const char32_t current = peek<Enc>();
+    if (stream_.eof() || Enc::is_newline(current) ||
+        !Enc::is_whitespace(current)) {
+      break;
+    }
+    next<Enc>();
   }
 }
 
+template <typename Enc>
 Lexer::Result<void> Lexer::skip_comments() {
   while (!stream_.eof()) {
-    if (stream_.peek() == '/' && stream_.peek_at(1) == '/') {
-      const char32_t third_cp = stream_.peek_at(2);
+    if (peek<Enc>() == '/' && peek_at<Enc>(1) == '/') {
+      const char32_t third_cp = peek_at<Enc>(2);
       if (third_cp == '@') {
         if (should_include_documentation_comments()) {
           break;
@@ -147,41 +247,47 @@ Lexer::Result<void> Lexer::skip_comments() {
         }
       }
       // skip inline comment
-      stream_.next();
-      stream_.next();  // skip //
-      while (!stream_.eof() && !unicode::is_unicode_newline(stream_.peek())) {
-        stream_.next();
+      next<Enc>();
+      next<Enc>();  // skip //
+      while (true) {
+        stream_.skip_to_line_end();
+        if (stream_.eof() || Enc::is_newline(peek<Enc>())) {
+          break;
+        }
+        // the scan stopped at a non-newline lead byte
+        next<Enc>();
       }
       continue;
     }
 
-    if (stream_.peek() == '/' && stream_.peek_at(1) == '*') {
+    if (peek<Enc>() == '/' && peek_at<Enc>(1) == '*') {
       if (should_include_normal_comments()) {
         break;
       }
       // skip block comment
 
       // remember start position for error reporting
-      const std::size_t error_line = stream_.line();
-      const std::size_t error_col = stream_.column();
+      const std::size_t error_offset = stream_.byte_position();
 
-      stream_.next();
-      stream_.next();  // skip /*
+      next<Enc>();
+      next<Enc>();  // skip /*
 
+      bool terminated = false;
       while (!stream_.eof()) {
-        if (stream_.peek() == '*' && stream_.peek_at(1) == '/') {
-          stream_.next();
-          stream_.next();
+        stream_.skip_to_star();
+        if (peek<Enc>() == '*' && peek_at<Enc>(1) == '/') {
+          next<Enc>();
+          next<Enc>();
+          terminated = true;
           break;
         }
-        stream_.next();
+        next<Enc>();
       }
 
       // check if we reached eof without finding closing */
-      if (stream_.eof() &&
-          !(stream_.peek() == '*' && stream_.peek_at(1) == '/')) {
-        return Result<void>(diagnostic::create_err(Error::create(
-            error_line, error_col, 2,
+      if (!terminated) {
+        return Result<void>(diagnostic::create_err(error_at(
+            error_offset, 2,
             diagnostic::DiagnosticId::kUnterminatedBlockComment)));
       }
 
@@ -194,17 +300,18 @@ Lexer::Result<void> Lexer::skip_comments() {
   return Result<void>(diagnostic::create_ok());
 }
 
+template <typename Enc>
 Lexer::Result<void> Lexer::skip_trivia() {
   while (!stream_.eof()) {
     const std::size_t old_position = stream_.position();
 
     if (!should_include_whitespace()) {
-      skip_whitespace();
+      skip_whitespace<Enc>();
     }
 
     if (!should_include_normal_comments() ||
         !should_include_documentation_comments()) {
-      const auto result = skip_comments();
+      const auto result = skip_comments<Enc>();
       if (result.is_err()) {
         // propagate error
         return result;
@@ -219,18 +326,33 @@ Lexer::Result<void> Lexer::skip_trivia() {
   return Result<void>(diagnostic::create_ok());
 }
 
+template <typename Enc>
 Lexer::Result<base::Token> Lexer::identifier_or_keyword() {
-  const std::size_t start = stream_.position();
-  const std::size_t line = stream_.line();
-  const std::size_t col = stream_.column();
+  const std::size_t start = stream_.byte_position();
 
-  while (unicode::is_xid_continue(stream_.peek())) {
-    stream_.next();
+  stream_.skip_ascii_id_continue();
+  if constexpr (!Enc::kAsciiOnly) {
+    while (unicode::is_xid_continue(stream_.peek())) {
+      stream_.next();
+      stream_.skip_ascii_id_continue();
+    }
+  }
+
+  const std::size_t length = stream_.byte_position() - start;
+  const std::u8string_view lexeme = stream_.slice(start, length);
+  TokenKind kind = base::lookup_id_or_keyword(lexeme);
+  if (kind != TokenKind::kIdentifier || !interner_) {
+    return create_token(kind, start);
   }
 
-  TokenKind kind = base::lookup_id_or_keyword(
-      stream_.file().content_u8(), start, stream_.position() - start);
-  return create_token(kind, start, line, col);
+  Token token(kind, start, length);
+  token.set_symbol(interner_->intern(core::to_string_view(lexeme)));
+  return Result<Token>(diagnostic::create_ok(std::move(token)));
 }
 
+template Lexer::Result<base::Token>
+Lexer::identifier_or_keyword<AsciiEncoding>();
+template Lexer::Result<base::Token>
+Lexer::identifier_or_keyword<Utf8Encoding>();
+
 }  // namespace lexer
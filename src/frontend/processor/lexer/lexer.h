@@ -9,11 +9,16 @@
 #include <vector>
 
 #include "frontend/base/token/token.h"
+#include "frontend/base/token/token_stream.h"
 #include "frontend/diagnostic/data/error/source_error.h"
 #include "frontend/diagnostic/data/result.h"
 #include "frontend/processor/lexer/base/lexer_export.h"
 #include "unicode/utf8/stream.h"
 
+namespace base {
+class StringInterner;
+}  // namespace base
+
 namespace lexer {
 
 class LEXER_EXPORT Lexer {
@@ -60,16 +65,56 @@ class LEXER_EXPORT Lexer {
   Lexer(Lexer&&) noexcept = default;
   Lexer& operator=(Lexer&&) noexcept = default;
 
+  using DecodeMode = unicode::Utf8Stream::DecodeMode;
+
+  // kOnDemand scans the utf-8 bytes of the file directly instead of expanding
+  // it into a char32_t buffer first. `validate_utf8` = false is for content
+  // already known to be valid (see unicode::Utf8Stream::init).
   [[nodiscard]] InitResult init(unicode::Utf8FileManager* file_manager,
                                 unicode::Utf8FileId file_id,
+                                Mode mode = Mode::kCodeAnalysis,
+                                DecodeMode decode_mode = DecodeMode::kPreDecode,
+                                bool validate_utf8 = true);
+
+  // lexes a file through a window of it instead of loading it as a whole (see
+  // unicode::Utf8Window), read with token_source() only
+  [[nodiscard]] InitResult init(unicode::Utf8Window* window,
                                 Mode mode = Mode::kCodeAnalysis);
 
+  // lexes with the core specialized for ascii content when the file is pure
+  // ascii (see unicode::Utf8Stream::is_ascii()), the general one otherwise
   [[nodiscard]] Results<Token> tokenize(bool strict = false);
 
+  // picks the lexer core on every call, prefer tokenize() or token_source()
   [[nodiscard]] Result<Token> tokenize_next();
 
+  // pull-based alternative to tokenize() for base::TokenStream's streaming
+  // mode, so the token vector is never materialized. errors are appended to
+  // `errors` and lexing continues past them as in tokenize(false). a file
+  // lexer still reads the whole file. a windowed one slides its window along,
+  // lexing a token again if it ran into the end of the resident content, so
+  // memory stays within the window unless a single lexeme outgrows it.
+  // the lexer and `errors` must outlive the returned source.
+  [[nodiscard]] base::TokenStream::TokenSource token_source(
+      std::vector<Error>* errors);
+
   inline const unicode::Utf8Stream& stream() const { return stream_; }
 
+  // interns identifiers as they are lexed and stores their ids in the tokens
+  // (see base::Token::symbol), so the parser does not read their lexemes
+  // again. must be the interner the tokens are parsed with. null disables it.
+  inline void set_interner(base::StringInterner* interner) {
+    interner_ = interner;
+  }
+
+  // restarts lexing at a byte offset where a token may begin (the end of an
+  // earlier token). kOnDemand decode mode only.
+  inline void seek(std::size_t byte_offset) {
+    DCHECK_NE(status_, Status::kNotInitialized);
+    stream_.seek(byte_offset);
+    status_ = Status::kReadyToTokenize;
+  }
+
   inline void reset() {
     DCHECK_NE(status_, Status::kNotInitialized);
     stream_.reset();
@@ -77,40 +122,88 @@ class LEXER_EXPORT Lexer {
   }
 
  private:
+  // the lexer core below is instantiated for both encoding classes of
+  // encoding.h, in the translation unit that defines each member
+  template <typename Enc>
+  Results<Token> tokenize_all(bool strict);
+  template <typename Enc>
+  Result<Token> tokenize_next_impl();
+  template <typename Enc>
+  base::TokenStream::TokenSource token_source_impl(std::vector<Error>* errors);
+
+  InitResult init_result(unicode::Utf8Stream::ErrorCode error_code);
+
+  // windowed input only. a token is decided at most a few codepoints past
+  // its end (see peek_at()), so lexing this close to the end of the resident
+  // content may have been cut short by it.
+  inline bool near_window_end() const {
+    return stream_.more_input() && stream_.eof_at(kWindowLookahead);
+  }
+
+  // lexes on from `keep_from` with the window slid forward to it
+  inline void slide_window(std::size_t keep_from) {
+    stream_.slide(keep_from);
+    stream_.seek(keep_from);
+    status_ = Status::kReadyToTokenize;
+  }
+
+  template <typename Enc>
   void skip_whitespace();
+  template <typename Enc>
   Result<void> skip_comments();
+  template <typename Enc>
   Result<void> skip_trivia();
 
+  template <typename Enc>
   Result<Token> identifier_or_keyword();
+  template <typename Enc>
   Result<Token> literal_numeric();
+  template <typename Enc>
   Result<Token> literal_str();
+  template <typename Enc>
   Result<Token> literal_char();
 
+  template <typename Enc>
   Result<Token> ascii_token(char current_char,
-                            std::size_t start,
-                            std::size_t line,
-                            std::size_t col);
+                            std::size_t start);
 
+  // utf-8 only
   Result<Token> unicode_token(char32_t current_codepoint,
-                              std::size_t start,
-                              std::size_t line,
-                              std::size_t col);
+                              std::size_t start);
 
   // operator or delimiter
+  template <typename Enc>
   Result<Token> other_token(char current,
                             char next,
-                            std::size_t start,
-                            std::size_t line,
-                            std::size_t col);
-
-  inline Result<Token> create_token(TokenKind kind,
-                                    std::size_t start_pos,
-                                    std::size_t line,
-                                    std::size_t column) {
-    const std::size_t end_pos = stream_.position();
-    const std::size_t length = end_pos - start_pos;
+                            std::size_t start);
+
+  template <typename Enc>
+  inline char32_t peek() const {
+    return Enc::peek(stream_);
+  }
+  template <typename Enc>
+  inline char32_t peek_at(std::size_t offset) const {
+    return Enc::peek_at(stream_, offset);
+  }
+  template <typename Enc>
+  inline char32_t next() {
+    return Enc::next(stream_);
+  }
+
+  // start_offset is a byte offset from stream_.byte_position()
+  inline Result<Token> create_token(TokenKind kind, std::size_t start_offset) {
+    const std::size_t length = stream_.byte_position() - start_offset;
     return Result<Token>(
-        diagnostic::create_ok(Token(kind, line, column, length)));
+        diagnostic::create_ok(Token(kind, start_offset, length)));
+  }
+
+  // line and column are only resolved once an error is reported, the stream
+  // tracks byte offsets alone
+  inline Error error_at(std::size_t offset,
+                        std::size_t length,
+                        diagnostic::DiagnosticId diag_id) const {
+    const core::SourceLocation location = stream_.location_at(offset);
+    return Error::create(location.line(), location.column(), length, diag_id);
   }
 
   template <typename T>
@@ -132,11 +225,14 @@ class LEXER_EXPORT Lexer {
   }
 
   unicode::Utf8Stream stream_;
+  base::StringInterner* interner_ = nullptr;
   Mode mode_ = Mode::kCodeAnalysis;
   Status status_ = Status::kNotInitialized;
 
   // heuristic
-  static constexpr const std::size_t kPredictedTokensCountPerLine = 12;
+  static constexpr const std::size_t kPredictedBytesPerToken = 5;
+  // bytes of 4 codepoints
+  static constexpr const std::size_t kWindowLookahead = 16;
 };
 
 }  // namespace lexer
@@ -3,16 +3,206 @@
 // which can be found in the LICENSE file.
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdio>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "benchmark/benchmark.h"
+#include "build/build_flag.h"
+#include "core/base/file_util.h"
+#include "frontend/base/token/token_stream.h"
 #include "frontend/processor/lexer/lexer.h"
+#include "unicode/utf8/window.h"
+
+#if IS_UNIX
+#include <sys/resource.h>
+#endif
 
 namespace lexer {
 
 namespace {
 
+constexpr const std::size_t kLargeSourceSize = 4 * 1024 * 1024;
+constexpr const std::size_t kHugeSourceSize = 128 * 1024 * 1024;
+
+// mixed code, comments and non-ascii identifiers of at least `target_size`
+// bytes
+std::u8string generate_large_source(std::size_t target_size) {
+  constexpr const std::u8string_view kSnippet =
+      u8"//@ computes the answer\n"
+      u8"fn compute(x: i32, y: i32) -> i32 {\n"
+      u8"  /* accumulate */ total := 0\n"
+      u8"  for i: 0..<100 { total = total + x * i - y }  // hot loop\n"
+      u8"  名前 := \"ワールド\"\n"
+      u8"  ret total\n"
+      u8"}\n";
+  std::u8string source;
+  source.reserve(target_size + kSnippet.size());
+  while (source.size() < target_size) {
+    source.append(kSnippet);
+  }
+  return source;
+}
+
+// process-wide high-water mark. run each decode mode in its own process
+// (--benchmark_filter) to compare them.
+double peak_rss_kib() {
+#if IS_UNIX
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return static_cast<double>(usage.ru_maxrss);
+  }
+#endif
+  return 0.0;
+}
+
+void lexer_tokenize_large(benchmark::State& state,
+                          Lexer::DecodeMode decode_mode) {
+  std::u8string code = generate_large_source(kLargeSourceSize);
+  std::size_t code_size = code.size();
+
+  unicode::Utf8FileManager manager;
+  unicode::Utf8FileId id = manager.register_virtual_file(std::move(code));
+
+  for (auto _ : state) {
+    // init is included since that is where the pre-decoded buffer is built
+    Lexer lexer;
+    auto init_result =
+        lexer.init(&manager, id, Lexer::Mode::kCodeAnalysis, decode_mode);
+    auto result = lexer.tokenize();
+    benchmark::DoNotOptimize(std::move(result).unwrap().size());
+  }
+  state.SetBytesProcessed(code_size * state.iterations());
+  state.counters["peak_rss_kib"] = peak_rss_kib();
+}
+BENCHMARK_CAPTURE(lexer_tokenize_large,
+                  pre_decode,
+                  Lexer::DecodeMode::kPreDecode);
+BENCHMARK_CAPTURE(lexer_tokenize_large,
+                  on_demand,
+                  Lexer::DecodeMode::kOnDemand);
+
+// pure ascii counterpart of generate_large_source()
+std::u8string generate_large_ascii_source(std::size_t target_size) {
+  constexpr const std::u8string_view kSnippet =
+      u8"//@ computes the answer\n"
+      u8"fn compute(x: i32, y: i32) -> i32 {\n"
+      u8"  /* accumulate */ total := 0\n"
+      u8"  for i: 0..<100 { total = total + x * i - y }  // hot loop\n"
+      u8"  name := \"world\"\n"
+      u8"  ret total\n"
+      u8"}\n";
+  std::u8string source;
+  source.reserve(target_size + kSnippet.size());
+  while (source.size() < target_size) {
+    source.append(kSnippet);
+  }
+  return source;
+}
+
+// the same ascii file through the ascii lexer core, and through the general
+// one by skipping the validation that tells the lexer the file is ascii. only
+// the ascii core pays for validating.
+void lexer_tokenize_ascii(benchmark::State& state, bool ascii_core) {
+  std::u8string code = generate_large_ascii_source(kLargeSourceSize);
+  std::size_t code_size = code.size();
+
+  unicode::Utf8FileManager manager;
+  unicode::Utf8FileId id = manager.register_virtual_file(std::move(code));
+
+  for (auto _ : state) {
+    Lexer lexer;
+    auto init_result =
+        lexer.init(&manager, id, Lexer::Mode::kCodeAnalysis,
+                   Lexer::DecodeMode::kOnDemand, ascii_core);
+    auto result = lexer.tokenize();
+    benchmark::DoNotOptimize(std::move(result).unwrap().size());
+  }
+  state.SetBytesProcessed(code_size * state.iterations());
+}
+BENCHMARK_CAPTURE(lexer_tokenize_ascii, ascii_core, true);
+BENCHMARK_CAPTURE(lexer_tokenize_ascii, utf8_core, false);
+
+// lexes and walks a huge file through a TokenStream. with `streaming` the
+// tokens go through the bounded ring buffer instead of a materialized vector,
+// the source itself is resident in both. run each variant in its own process
+// to compare peak_rss_kib.
+void lexer_tokenize_huge(benchmark::State& state, bool streaming) {
+  std::u8string code = generate_large_source(kHugeSourceSize);
+  std::size_t code_size = code.size();
+
+  unicode::Utf8FileManager manager;
+  unicode::Utf8FileId id = manager.register_virtual_file(std::move(code));
+
+  for (auto _ : state) {
+    Lexer lexer;
+    auto init_result = lexer.init(&manager, id, Lexer::Mode::kCodeAnalysis,
+                                  Lexer::DecodeMode::kOnDemand);
+    std::vector<Lexer::Error> errors;
+    base::TokenStream stream =
+        streaming
+            ? base::TokenStream(lexer.token_source(&errors), &manager, id)
+            : base::TokenStream(lexer.tokenize().unwrap(), &manager, id);
+
+    std::size_t count = 0;
+    while (!stream.eof()) {
+      stream.next();
+      ++count;
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetBytesProcessed(code_size * state.iterations());
+  state.counters["peak_rss_kib"] = peak_rss_kib();
+}
+BENCHMARK_CAPTURE(lexer_tokenize_huge, materialized, false)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+BENCHMARK_CAPTURE(lexer_tokenize_huge, streaming, true)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+
+// the streaming variant over a unicode::Utf8Window, so only the window of the
+// source is resident. the file is written in large-source sized chunks to
+// keep the generator out of the peak.
+void lexer_tokenize_huge_windowed(benchmark::State& state) {
+  core::TempFile temp("lexer_bench_huge_");
+  const std::u8string chunk = generate_large_source(kLargeSourceSize);
+  std::size_t code_size = 0;
+  std::FILE* file = std::fopen(temp.path().c_str(), "ab");
+  if (!file) {
+    state.SkipWithError("failed to write the source");
+    return;
+  }
+  while (code_size < kHugeSourceSize) {
+    code_size += std::fwrite(chunk.data(), 1, chunk.size(), file);
+  }
+  std::fclose(file);
+
+  for (auto _ : state) {
+    unicode::Utf8Window window;
+    window.open(temp.path().c_str());
+    Lexer lexer;
+    auto init_result = lexer.init(&window);
+    std::vector<Lexer::Error> errors;
+    base::TokenStream stream(lexer.token_source(&errors));
+
+    std::size_t count = 0;
+    while (!stream.eof()) {
+      stream.next();
+      ++count;
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetBytesProcessed(code_size * state.iterations());
+  state.counters["peak_rss_kib"] = peak_rss_kib();
+}
+BENCHMARK(lexer_tokenize_huge_windowed)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3);
+
 void lexer_init(benchmark::State& state) {
   std::u8string code =
       u8"x := 42 while x < 100 { x = x + 1 } for i: 0..<100 { ++i } ret 0";
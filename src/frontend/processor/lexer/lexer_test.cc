@@ -5,13 +5,19 @@
 #include "frontend/processor/lexer/lexer.h"
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "core/base/file_util.h"
+#include "core/base/string_util.h"
+#include "frontend/base/string/string_interner.h"
 #include "frontend/base/token/token_kind.h"
+#include "frontend/base/token/token_stream.h"
 #include "frontend/diagnostic/data/diagnostic_id.h"
 #include "gtest/gtest.h"
 #include "unicode/utf8/file_manager.h"
+#include "unicode/utf8/window.h"
 
 namespace lexer {
 
@@ -21,10 +27,12 @@ struct TestLexer {
   unicode::Utf8FileManager manager;
   Lexer lexer;
 
-  explicit TestLexer(std::u8string&& source,
-                     Lexer::Mode mode = Lexer::Mode::kCodeAnalysis) {
+  explicit TestLexer(
+      std::u8string&& source,
+      Lexer::Mode mode = Lexer::Mode::kCodeAnalysis,
+      Lexer::DecodeMode decode_mode = Lexer::DecodeMode::kPreDecode) {
     id_ = manager.register_virtual_file(std::move(source));
-    const auto _ = lexer.init(&manager, id_, mode);
+    const auto _ = lexer.init(&manager, id_, mode, decode_mode);
   }
 
   base::Token next() {
@@ -57,6 +65,8 @@ struct TestLexer {
     }
   }
 
+  unicode::Utf8FileId id() const { return id_; }
+
  private:
   unicode::Utf8FileId id_;
 };
@@ -103,8 +113,8 @@ void validate_token_properties(std::u8string&& source,
     const base::Token token = test_lexer.next();
 
     EXPECT_FALSE(std::string(token_kind_to_string(token.kind())).empty());
-    EXPECT_GT(token.start().line(), 0);
-    EXPECT_GT(token.start().column(), 0);
+    EXPECT_GT(token.start(file).line(), 0);
+    EXPECT_GT(token.start(file).column(), 0);
     EXPECT_NE(token.kind(), base::TokenKind::kUnknown);
 
     if (token.kind() == base::TokenKind::kEof) {
@@ -154,6 +164,154 @@ TEST(LexerTest, UnicodeCharacter) {
   expect_repeated_token(u8"α 中　", base::TokenKind::kIdentifier, 2);
 }
 
+TEST(LexerTest, OnDemandDecodeMatchesPreDecode) {
+  const std::u8string source =
+      u8"fn メイン() -> i32 {\n  α := \"ワールド\"; // コメント\n  ret 0;\n}\n";
+  TestLexer pre_decoded(std::u8string(source), Lexer::Mode::kCodeAnalysis,
+                        Lexer::DecodeMode::kPreDecode);
+  TestLexer on_demand(std::u8string(source), Lexer::Mode::kCodeAnalysis,
+                      Lexer::DecodeMode::kOnDemand);
+
+  while (true) {
+    const base::Token expected = pre_decoded.next();
+    const base::Token actual = on_demand.next();
+
+    EXPECT_EQ(actual.kind(), expected.kind());
+    EXPECT_EQ(actual.offset(), expected.offset());
+    EXPECT_EQ(actual.length(), expected.length());
+    if (expected.kind() == base::TokenKind::kEof) {
+      break;
+    }
+  }
+}
+
+TEST(LexerTest, AsciiCoreMatchesUtf8Core) {
+  const std::vector<std::u8string> sources = {
+      u8"//@ doc\nfn main(x: i32) -> i32 {\n\t/* block\n */ y := 0x1F + 2.5e3"
+      u8" * x;\n  s := \"a\\n\\x41\"; c := 'z' // tail\r\n  ret y >>= 1\n}",
+      u8"x := 0b102; y := \"open",
+  };
+  for (const std::u8string& source : sources) {
+    for (const auto decode_mode :
+         {Lexer::DecodeMode::kPreDecode, Lexer::DecodeMode::kOnDemand}) {
+      unicode::Utf8FileManager manager;
+      const unicode::Utf8FileId id =
+          manager.register_virtual_file(std::u8string(source));
+
+      Lexer ascii;
+      ASSERT_TRUE(
+          ascii.init(&manager, id, Lexer::Mode::kCodeAnalysis, decode_mode)
+              .is_ok());
+      EXPECT_TRUE(ascii.stream().is_ascii());
+
+      // skipping the validation leaves the content class unknown
+      Lexer general;
+      ASSERT_TRUE(general
+                      .init(&manager, id, Lexer::Mode::kCodeAnalysis,
+                            decode_mode, false)
+                      .is_ok());
+      EXPECT_FALSE(general.stream().is_ascii());
+
+      auto expected = general.tokenize();
+      auto actual = ascii.tokenize();
+      ASSERT_EQ(actual.is_ok(), expected.is_ok());
+      if (expected.is_err()) {
+        const auto expected_errors = std::move(expected).unwrap_err();
+        const auto actual_errors = std::move(actual).unwrap_err();
+        ASSERT_EQ(actual_errors.size(), expected_errors.size());
+        for (std::size_t i = 0; i < expected_errors.size(); ++i) {
+          EXPECT_EQ(actual_errors[i].diag_id, expected_errors[i].diag_id);
+        }
+        continue;
+      }
+
+      const auto expected_tokens = std::move(expected).unwrap();
+      const auto actual_tokens = std::move(actual).unwrap();
+      ASSERT_EQ(actual_tokens.size(), expected_tokens.size());
+      for (std::size_t i = 0; i < expected_tokens.size(); ++i) {
+        EXPECT_EQ(actual_tokens[i].kind(), expected_tokens[i].kind());
+        EXPECT_EQ(actual_tokens[i].offset(), expected_tokens[i].offset());
+        EXPECT_EQ(actual_tokens[i].length(), expected_tokens[i].length());
+      }
+      EXPECT_EQ(ascii.stream().line(), general.stream().line());
+      EXPECT_EQ(ascii.stream().column(), general.stream().column());
+    }
+  }
+}
+
+TEST(LexerTest, LongRunsAcrossSimdBlocks) {
+  // runs longer than a 32-byte block, with non-ascii text inside comments
+  std::u8string source = u8"\t" + std::u8string(70, ' ') + u8"// ";
+  for (int i = 0; i < 20; ++i) {
+    source += u8"コメント ";
+  }
+  source += u8"\n/* ";
+  for (int i = 0; i < 20; ++i) {
+    source += u8"ブロック\n * ";
+  }
+  source += u8"*/ " + std::u8string(40, 'a') + u8"_9 x";
+
+  TestLexer test_lexer(std::move(source), Lexer::Mode::kCodeAnalysis,
+                       Lexer::DecodeMode::kOnDemand);
+  EXPECT_EQ(test_lexer.next().kind(), base::TokenKind::kNewline);
+
+  const base::Token ident = test_lexer.next();
+  EXPECT_EQ(ident.kind(), base::TokenKind::kIdentifier);
+  EXPECT_EQ(ident.length(), 42);
+  EXPECT_EQ(test_lexer.lexer.stream().line(), 22);
+
+  EXPECT_EQ(test_lexer.next().kind(), base::TokenKind::kIdentifier);
+  EXPECT_EQ(test_lexer.next().kind(), base::TokenKind::kEof);
+}
+
+TEST(LexerTest, TokenOffsetsInBytes) {
+  for (const auto decode_mode :
+       {Lexer::DecodeMode::kPreDecode, Lexer::DecodeMode::kOnDemand}) {
+    TestLexer test_lexer(u8"メイン x", Lexer::Mode::kCodeAnalysis,
+                         decode_mode);
+    const std::size_t ident_size = std::u8string_view(u8"メイン").size();
+
+    const base::Token ident = test_lexer.next();
+    EXPECT_EQ(ident.kind(), base::TokenKind::kIdentifier);
+    EXPECT_EQ(ident.offset(), 0);
+    EXPECT_EQ(ident.length(), ident_size);
+
+    const base::Token x = test_lexer.next();
+    EXPECT_EQ(x.kind(), base::TokenKind::kIdentifier);
+    EXPECT_EQ(x.offset(), ident_size + 1);
+    EXPECT_EQ(x.length(), 1);
+
+    EXPECT_EQ(test_lexer.next().kind(), base::TokenKind::kEof);
+  }
+}
+
+TEST(LexerTest, InternsIdentifiers) {
+  base::StringInterner interner;
+  TestLexer test_lexer(u8"foo fn bar foo");
+  test_lexer.lexer.set_interner(&interner);
+
+  const base::Token foo = test_lexer.next();
+  ASSERT_TRUE(foo.has_symbol());
+  EXPECT_EQ(interner.lookup(foo.symbol()), "foo");
+
+  // keywords are not interned
+  const base::Token fn = test_lexer.next();
+  EXPECT_EQ(fn.kind(), base::TokenKind::kFunction);
+  EXPECT_FALSE(fn.has_symbol());
+
+  const base::Token bar = test_lexer.next();
+  ASSERT_TRUE(bar.has_symbol());
+  EXPECT_EQ(interner.lookup(bar.symbol()), "bar");
+
+  const base::Token foo_again = test_lexer.next();
+  ASSERT_TRUE(foo_again.has_symbol());
+  EXPECT_EQ(foo_again.symbol(), foo.symbol());
+
+  // without an interner the ids are left to the parser
+  TestLexer plain(u8"foo");
+  EXPECT_FALSE(plain.next().has_symbol());
+}
+
 // lexer mode tests
 TEST(LexerModeTest, InlineCommentIgnore) {
   // ignore inline comment in code analysis mode
@@ -176,6 +334,11 @@ TEST(LexerModeTest, BlockCommentIgnore) {
                 Lexer::Mode::kCodeAnalysis);
 }
 
+TEST(LexerModeTest, BlockCommentAtEndOfFile) {
+  expect_tokens(u8"x /* comment */", {base::TokenKind::kIdentifier},
+                Lexer::Mode::kCodeAnalysis);
+}
+
 TEST(LexerModeTest, BlockCommentStore) {
   // store block comment in format mode
   expect_tokens(u8"/* comment */ x",
@@ -263,4 +426,162 @@ TEST(LexerTest, NumericLiteralEdgeCases) {
                         5);
 }
 
+TEST(LexerTest, TokenSourceMatchesTokenize) {
+  std::u8string source;
+  for (int i = 0; i < 200; ++i) {
+    source.append(u8"fn f(x: i32) -> i32 { /* c */ ret x * 2 }  // 名前\n");
+  }
+
+  TestLexer bulk{std::u8string(source)};
+  std::vector<base::Token> expected = bulk.lexer.tokenize().unwrap();
+
+  TestLexer streaming{std::move(source), Lexer::Mode::kCodeAnalysis,
+                      Lexer::DecodeMode::kOnDemand};
+  std::vector<Lexer::Error> errors;
+  base::TokenStream stream(streaming.lexer.token_source(&errors),
+                           &streaming.manager, streaming.id(), 64);
+
+  // the ring buffer wraps around many times over
+  for (const base::Token& token : expected) {
+    EXPECT_EQ(stream.peek().kind(), token.kind());
+    EXPECT_EQ(stream.peek().offset(), token.offset());
+    EXPECT_EQ(stream.peek().length(), token.length());
+    if (!stream.eof()) {
+      stream.next();
+    }
+  }
+  EXPECT_TRUE(stream.eof());
+  EXPECT_TRUE(errors.empty());
+}
+
+TEST(LexerErrorTest, ErrorLocationsAreResolvedFromOffsets) {
+  // the stream only tracks offsets, lines and columns come from the file
+  for (const auto decode_mode :
+       {Lexer::DecodeMode::kPreDecode, Lexer::DecodeMode::kOnDemand}) {
+    for (const std::u8string_view source :
+         {u8"x\n\ty := 1\n  z := \"open", u8"x\n\tあ := 1\n  z := \"open"}) {
+      TestLexer test_lexer(std::u8string(source), Lexer::Mode::kCodeAnalysis,
+                           decode_mode);
+      for (int i = 0; i < 8; ++i) {
+        test_lexer.next();
+      }
+      auto result = test_lexer.lexer.tokenize_next();
+      ASSERT_TRUE(result.is_err());
+      const Lexer::Error error = std::move(result).unwrap_err();
+      EXPECT_EQ(error.diag_id,
+                diagnostic::DiagnosticId::kUnterminatedStringLiteral);
+      EXPECT_EQ(error.range.start().line(), 3);
+      EXPECT_EQ(error.range.start().column(), 8);
+    }
+  }
+}
+
+TEST(LexerErrorTest, TokenSourceCollectsErrors) {
+  // errors that do not consume the offending character must not stall
+  std::u8string source = u8"x ¿ y ";
+  source.push_back('\0');
+  TestLexer lexer{std::move(source)};
+  std::vector<Lexer::Error> errors;
+  base::TokenStream stream(lexer.lexer.token_source(&errors), &lexer.manager,
+                           lexer.id());
+
+  EXPECT_EQ(stream.peek().kind(), base::TokenKind::kIdentifier);
+  EXPECT_EQ(stream.next().kind(), base::TokenKind::kIdentifier);
+  EXPECT_EQ(stream.next().kind(), base::TokenKind::kEof);
+  ASSERT_EQ(errors.size(), 2u);
+  EXPECT_EQ(errors[0].diag_id,
+            diagnostic::DiagnosticId::kUnrecognizedCharacter);
+  EXPECT_EQ(errors[1].diag_id, diagnostic::DiagnosticId::kUnexpectedEndOfFile);
+}
+
+TEST(LexerTest, WindowedTokenSourceMatchesFileLexing) {
+  std::u8string source;
+  for (int i = 0; i < 40; ++i) {
+    source.append(
+        u8"fn 名前(x: i32) -> f64 { /* a\n comment */ ret x ..< 1.5e3 }\n"
+        u8"s := \"a string literal that is longer than the small windows\"\n"
+        u8"c := '\\n' ¿ // trailing comment 😊\n");
+  }
+  source.append(u8"z := \"open");
+  core::TempFile temp("lexer_window_test_",
+                      std::string(core::to_string_view(source)));
+
+  base::StringInterner interner;
+  TestLexer file_lexer{std::move(source), Lexer::Mode::kCodeAnalysis,
+                       Lexer::DecodeMode::kOnDemand};
+  file_lexer.lexer.set_interner(&interner);
+  std::vector<Lexer::Error> expected_errors;
+  base::TokenStream::TokenSource expected =
+      file_lexer.lexer.token_source(&expected_errors);
+  std::vector<base::Token> expected_tokens;
+  do {
+    expected_tokens.push_back(expected());
+  } while (expected_tokens.back().kind() != base::TokenKind::kEof);
+
+  // windows smaller than a token, and larger than a line
+  for (const std::size_t capacity : {8u, 37u, 256u}) {
+    unicode::Utf8Window window;
+    ASSERT_EQ(window.open(temp.path().c_str(), capacity),
+              unicode::Utf8Window::Status::kValid);
+    Lexer lexer;
+    ASSERT_TRUE(lexer.init(&window).is_ok());
+    lexer.set_interner(&interner);
+    std::vector<Lexer::Error> errors;
+    base::TokenStream stream(lexer.token_source(&errors), 64);
+
+    for (const base::Token& token : expected_tokens) {
+      EXPECT_EQ(stream.peek().kind(), token.kind());
+      EXPECT_EQ(stream.peek().offset(), token.offset());
+      EXPECT_EQ(stream.peek().length(), token.length());
+      EXPECT_EQ(stream.peek().has_symbol(), token.has_symbol());
+      if (token.has_symbol()) {
+        EXPECT_EQ(stream.peek().symbol(), token.symbol());
+      }
+      if (!stream.eof()) {
+        stream.next();
+      }
+    }
+    EXPECT_TRUE(stream.eof());
+
+    // line and column of each error come from the window
+    ASSERT_EQ(errors.size(), expected_errors.size());
+    for (std::size_t i = 0; i < errors.size(); ++i) {
+      EXPECT_EQ(errors[i].diag_id, expected_errors[i].diag_id);
+      EXPECT_EQ(errors[i].range.start().line(),
+                expected_errors[i].range.start().line());
+      EXPECT_EQ(errors[i].range.start().column(),
+                expected_errors[i].range.start().column());
+    }
+  }
+}
+
+TEST(LexerErrorTest, WindowedTokenSourceReportsInvalidUtf8) {
+  std::string source = "x := 1\ny";
+  source.push_back(static_cast<char>(0xFF));
+  source.append(" z");
+  core::TempFile temp("lexer_window_test_", source);
+
+  unicode::Utf8Window window;
+  ASSERT_EQ(window.open(temp.path().c_str(), 4),
+            unicode::Utf8Window::Status::kValid);
+  Lexer lexer;
+  ASSERT_TRUE(lexer.init(&window).is_ok());
+  std::vector<Lexer::Error> errors;
+  base::TokenStream stream(lexer.token_source(&errors));
+
+  // the file ends in front of the invalid byte for the lexer
+  for (const base::TokenKind kind :
+       {base::TokenKind::kIdentifier, base::TokenKind::kColonEqual,
+        base::TokenKind::kDecimal, base::TokenKind::kNewline,
+        base::TokenKind::kIdentifier}) {
+    EXPECT_EQ(stream.peek().kind(), kind);
+    stream.next();
+  }
+  EXPECT_TRUE(stream.eof());
+  ASSERT_EQ(errors.size(), 1u);
+  EXPECT_EQ(errors[0].diag_id, diagnostic::DiagnosticId::kInvalidUtfSequence);
+  EXPECT_EQ(errors[0].range.start().line(), 2);
+  EXPECT_EQ(errors[0].range.start().column(), 2);
+}
+
 }  // namespace lexer
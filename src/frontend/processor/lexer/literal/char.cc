@@ -5,49 +5,49 @@
 #include <string>
 
 #include "core/base/string_util.h"
+#include "frontend/processor/lexer/encoding.h"
 #include "frontend/processor/lexer/lexer.h"
 #include "unicode/base/unicode_util.h"
 
 namespace lexer {
 
+template <typename Enc>
 Lexer::Result<base::Token> Lexer::literal_char() {
-  const std::size_t start = stream_.position();
-  const std::size_t line = stream_.line();
-  const std::size_t col = stream_.column();
+  const std::size_t start = stream_.byte_position();
 
   // consume the opening '\''
-  stream_.next();
+  next<Enc>();
 
   if (stream_.eof()) {
-    return err<Token>(Error::create(
-        start, line, col, diagnostic::DiagId::kUnterminatedCharacterLiteral));
+    return err<Token>(
+        error_at(start, 1, diagnostic::DiagId::kUnterminatedCharacterLiteral));
   }
 
-  if (stream_.peek() == '\\') {
+  if (peek<Enc>() == '\\') {
     // consume '\'
-    stream_.next();
+    next<Enc>();
 
     if (stream_.eof()) {
-      return err<Token>(Error::create(
-          start, line, col, diagnostic::DiagId::kUnterminatedCharacterLiteral));
+      return err<Token>(error_at(
+          start, 1, diagnostic::DiagId::kUnterminatedCharacterLiteral));
     }
 
-    const char32_t esc = stream_.peek();
+    const char32_t esc = peek<Enc>();
     if (unicode::is_ascii(esc) && core::is_valid_escape_sequence('\\', esc)) {
       // consume escape
-      stream_.next();
+      next<Enc>();
     } else if (esc == 'x') {
       // hex escape
       // consume 'x'
-      stream_.next();
+      next<Enc>();
       std::string buf;
-      while (core::is_ascii_hex_digit(stream_.peek())) {
-        buf += static_cast<char>(stream_.peek());
-        stream_.next();
+      while (core::is_ascii_hex_digit(peek<Enc>())) {
+        buf += static_cast<char>(peek<Enc>());
+        next<Enc>();
       }
       if (!core::is_valid_hex_escape("x" + buf)) {
-        return err<Token>(Error::create(start, line, col,
-                                        diagnostic::DiagId::kInvalidHexEscape));
+        return err<Token>(
+            error_at(start, 1, diagnostic::DiagId::kInvalidHexEscape));
       }
     } else if (esc == 'u' || esc == 'U') {
       // unicode escape
@@ -55,55 +55,58 @@ Lexer::Result<base::Token> Lexer::literal_char() {
       std::string buf;
       buf += static_cast<char>(esc);
       // consume 'u'
-      stream_.next();
+      next<Enc>();
 
       for (int i = 0; i < expected_digits; ++i) {
-        if (!core::is_ascii_hex_digit(stream_.peek())) {
+        if (!core::is_ascii_hex_digit(peek<Enc>())) {
           break;
         }
-        buf += static_cast<char>(stream_.peek());
-        stream_.next();
+        buf += static_cast<char>(peek<Enc>());
+        next<Enc>();
       }
 
       if (buf.size() != (1 + expected_digits) ||
           !core::is_valid_unicode_escape(buf)) {
-        return err<Token>(Error::create(
-            start, line, col, diagnostic::DiagId::kInvalidUnicodeEscape));
+        return err<Token>(
+            error_at(start, 1, diagnostic::DiagId::kInvalidUnicodeEscape));
       }
 
     } else if (core::is_ascii_octal_digit(esc)) {
       // octal escape (up to 3 digits)
       std::string buf;
-      for (int i = 0; i < 3 && (core::is_ascii_octal_digit(stream_.peek()));
+      for (int i = 0; i < 3 && (core::is_ascii_octal_digit(peek<Enc>()));
            ++i) {
-        buf += static_cast<char>(stream_.peek());
-        stream_.next();
+        buf += static_cast<char>(peek<Enc>());
+        next<Enc>();
       }
       if (!core::is_valid_octal_escape(buf)) {
-        return err<Token>(Error::create(
-            start, line, col, diagnostic::DiagId::kInvalidOctalEscape));
+        return err<Token>(
+            error_at(start, 1, diagnostic::DiagId::kInvalidOctalEscape));
       }
 
     } else {
       // unknown escape
-      return err<Token>(Error::create(
-          start, line, col, diagnostic::DiagId::kInvalidCharacterEscape));
+      return err<Token>(
+          error_at(start, 1, diagnostic::DiagId::kInvalidCharacterEscape));
     }
 
   } else {
     // consume literal character
-    stream_.next();
+    next<Enc>();
   }
 
-  if (stream_.eof() || stream_.peek() != '\'') {
-    return err<Token>(Error::create(
-        start, line, col, diagnostic::DiagId::kUnterminatedCharacterLiteral));
+  if (stream_.eof() || peek<Enc>() != '\'') {
+    return err<Token>(
+        error_at(start, 1, diagnostic::DiagId::kUnterminatedCharacterLiteral));
   }
 
   // consume the closing '\''
-  stream_.next();
+  next<Enc>();
 
-  return create_token(TokenKind::kCharacter, start, line, col);
+  return create_token(TokenKind::kCharacter, start);
 }
 
+template Lexer::Result<base::Token> Lexer::literal_char<AsciiEncoding>();
+template Lexer::Result<base::Token> Lexer::literal_char<Utf8Encoding>();
+
 }  // namespace lexer
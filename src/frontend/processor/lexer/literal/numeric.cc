@@ -6,6 +6,7 @@
 #include <string>
 
 #include "core/base/string_util.h"
+#include "frontend/processor/lexer/encoding.h"
 #include "frontend/processor/lexer/lexer.h"
 
 namespace lexer {
@@ -21,16 +22,15 @@ struct NumericMeta {
 
 }  // namespace
 
+template <typename Enc>
 Lexer::Result<base::Token> Lexer::literal_numeric() {
-  const std::size_t start = stream_.position();
-  const std::size_t line = stream_.line();
-  const std::size_t col = stream_.column();
+  const std::size_t start = stream_.byte_position();
   TokenKind kind = TokenKind::kUnknown;
 
   NumericMeta meta;
 
-  const char32_t ch0 = stream_.peek();
-  const char32_t ch1 = stream_.peek_at(1);
+  const char32_t ch0 = peek<Enc>();
+  const char32_t ch1 = peek_at<Enc>(1);
 
   // base prefixes (0x, 0b, 0o)
   if (ch0 == '0') {
@@ -38,65 +38,63 @@ Lexer::Result<base::Token> Lexer::literal_numeric() {
       // hex
       meta.is_base_prefixed = true;
       kind = TokenKind::kHexadecimal;
-      stream_.next();  // consume '0'
-      stream_.next();  // consume 'x'
+      next<Enc>();  // consume '0'
+      next<Enc>();  // consume 'x'
 
       // consume hex digits
-      while (core::is_ascii_hex_digit(stream_.peek())) {
+      while (core::is_ascii_hex_digit(peek<Enc>())) {
         meta.has_digit = true;
-        stream_.next();
+        next<Enc>();
       }
 
     } else if (ch1 == 'b' || ch1 == 'B') {
       // binary
       meta.is_base_prefixed = true;
       kind = TokenKind::kBinary;
-      stream_.next();  // consume '0'
-      stream_.next();  // consume 'b'
+      next<Enc>();  // consume '0'
+      next<Enc>();  // consume 'b'
 
       // consume binary digits
       while (true) {
-        const char32_t c = stream_.peek();
+        const char32_t c = peek<Enc>();
         if (core::is_ascii_binary_digit(c)) {
           meta.has_digit = true;
-          stream_.next();
+          next<Enc>();
         } else {
           break;
         }
       }
 
       // check for invalid binary digits (2-9)
-      if (core::is_ascii_digit(stream_.peek()) &&
-          !core::is_ascii_binary_digit(stream_.peek())) {
-        return err<Token>(
-            Error::create(start, line, col,
-                          diagnostic::DiagnosticId::kInvalidNumericLiteral));
+      if (core::is_ascii_digit(peek<Enc>()) &&
+          !core::is_ascii_binary_digit(peek<Enc>())) {
+        return err<Token>(error_at(
+            start, 1, diagnostic::DiagnosticId::kInvalidNumericLiteral));
       }
 
     } else if (ch1 == 'o' || ch1 == 'O') {
       // octal
       meta.is_base_prefixed = true;
       kind = TokenKind::kOctal;
-      stream_.next();  // consume '0'
-      stream_.next();  // consume 'o'
+      next<Enc>();  // consume '0'
+      next<Enc>();  // consume 'o'
 
       // consume octal digits
       while (true) {
-        const char32_t c = stream_.peek();
+        const char32_t c = peek<Enc>();
         if (core::is_ascii_octal_digit(c)) {
           meta.has_digit = true;
-          stream_.next();
+          next<Enc>();
         } else {
           break;
         }
       }
 
       // check for invalid octal digits (8-9)
-      if (core::is_ascii_digit(stream_.peek()) &&
-          !core::is_ascii_octal_digit(stream_.peek())) {
-        return err<Token>(
-            Error::create(start, line, col,
-                          diagnostic::DiagnosticId::kInvalidNumericLiteral));
+      if (core::is_ascii_digit(peek<Enc>()) &&
+          !core::is_ascii_octal_digit(peek<Enc>())) {
+        return err<Token>(error_at(
+            start, 1, diagnostic::DiagnosticId::kInvalidNumericLiteral));
       }
     }
   }
@@ -105,67 +103,69 @@ Lexer::Result<base::Token> Lexer::literal_numeric() {
   if (!meta.is_base_prefixed) {
     kind = TokenKind::kDecimal;
     // consume initial digits
-    while (core::is_ascii_digit(stream_.peek())) {
+    while (core::is_ascii_digit(peek<Enc>())) {
       meta.has_digit = true;
-      stream_.next();
+      next<Enc>();
     }
 
     // handle decimal point
-    if (stream_.peek() == '.' && core::is_ascii_digit(stream_.peek_at(1))) {
+    if (peek<Enc>() == '.' && core::is_ascii_digit(peek_at<Enc>(1))) {
       meta.seen_dot = true;
-      stream_.next();  // consume '.'
+      next<Enc>();  // consume '.'
 
       // consume fractional digits
-      while (core::is_ascii_digit(stream_.peek())) {
+      while (core::is_ascii_digit(peek<Enc>())) {
         meta.has_digit = true;
-        stream_.next();
+        next<Enc>();
       }
     }
 
     // handle scientific notation
-    if ((stream_.peek() == 'e' || stream_.peek() == 'E') && meta.has_digit) {
+    if ((peek<Enc>() == 'e' || peek<Enc>() == 'E') && meta.has_digit) {
       meta.seen_exponent = true;
-      stream_.next();  // consume 'e'
+      next<Enc>();  // consume 'e'
 
       // optional sign
-      if (stream_.peek() == '+' || stream_.peek() == '-') {
-        stream_.next();
+      if (peek<Enc>() == '+' || peek<Enc>() == '-') {
+        next<Enc>();
       }
 
       // must have digits after exponent
       bool has_exp_digits = false;
-      while (core::is_ascii_digit(stream_.peek())) {
+      while (core::is_ascii_digit(peek<Enc>())) {
         has_exp_digits = true;
-        stream_.next();
+        next<Enc>();
       }
 
       if (!has_exp_digits) {
-        return err<Token>(
-            Error::create(start, line, col,
-                          diagnostic::DiagnosticId::kInvalidNumericLiteral));
+        return err<Token>(error_at(
+            start, 1, diagnostic::DiagnosticId::kInvalidNumericLiteral));
       }
     }
   }
 
   // check if we actually found any valid digits
   if (!meta.has_digit) {
-    return err<Token>(Error::create(
-        start, line, col, diagnostic::DiagnosticId::kInvalidNumericLiteral));
+    return err<Token>(
+        error_at(start, 1, diagnostic::DiagnosticId::kInvalidNumericLiteral));
   }
 
   // handle optional suffix
-  if (core::is_ascii_alphabet(stream_.peek())) {
-    const char32_t suffix = stream_.peek();
+  if (core::is_ascii_alphabet(peek<Enc>())) {
+    const char32_t suffix = peek<Enc>();
     if (suffix == 'f' || suffix == 'd' || suffix == 'L') {
-      stream_.next();
+      next<Enc>();
     } else {
       // invalid suffix
-      return err<Token>(Error::create(
-          start, line, col, diagnostic::DiagnosticId::kInvalidNumericLiteral));
+      return err<Token>(
+          error_at(start, 1, diagnostic::DiagnosticId::kInvalidNumericLiteral));
     }
   }
 
-  return create_token(kind, start, line, col);
+  return create_token(kind, start);
 }
 
+template Lexer::Result<base::Token> Lexer::literal_numeric<AsciiEncoding>();
+template Lexer::Result<base::Token> Lexer::literal_numeric<Utf8Encoding>();
+
 }  // namespace lexer
@@ -5,97 +5,97 @@
 #include <string>
 
 #include "core/base/string_util.h"
+#include "frontend/processor/lexer/encoding.h"
 #include "frontend/processor/lexer/lexer.h"
 
 namespace lexer {
 
+template <typename Enc>
 Lexer::Result<base::Token> Lexer::literal_str() {
-  const std::size_t start = stream_.position();
-  const std::size_t line = stream_.line();
-  const std::size_t col = stream_.column();
+  const std::size_t start = stream_.byte_position();
 
-  stream_.next();  // consume the opening '"'
+  next<Enc>();  // consume the opening '"'
 
   // consume characters until closing '"' or eof
   while (!stream_.eof()) {
-    const char current = stream_.peek();
+    const char current = peek<Enc>();
     if (current == '"') {
       break;
     }
 
     if (current == '\\') {
       // consume '\'
-      stream_.next();
+      next<Enc>();
 
       if (stream_.eof()) {
         break;
       }
 
-      const char esc = stream_.peek();
+      const char esc = peek<Enc>();
       if (core::is_ascii_char(esc) &&
           core::is_valid_escape_sequence('\\', esc)) {
-        stream_.next();
+        next<Enc>();
       } else if (esc == 'x') {
         // \xHH: must be followed by at least 1 hex digit
         std::string buf;
         buf += esc;
         // consume 'x'
-        stream_.next();
-        while (core::is_ascii_hex_digit(stream_.peek())) {
-          buf += static_cast<char>(stream_.peek());
-          stream_.next();
+        next<Enc>();
+        while (core::is_ascii_hex_digit(peek<Enc>())) {
+          buf += static_cast<char>(peek<Enc>());
+          next<Enc>();
         }
         if (!core::is_valid_hex_escape(buf)) {
-          return err<Token>(Error::create(
-              start, line, col, diagnostic::DiagnosticId::kInvalidHexEscape));
+          return err<Token>(
+              error_at(start, 1, diagnostic::DiagnosticId::kInvalidHexEscape));
         }
       } else if (esc == 'u' || esc == 'U') {
         std::string buf;
         buf += esc;
         // consume 'u' or 'U'
-        stream_.next();
+        next<Enc>();
         const uint8_t count = (esc == 'u' ? 4 : 8);
         for (uint8_t i = 0;
-             i < count && core::is_ascii_hex_digit(stream_.peek()); ++i) {
-          buf += static_cast<char>(stream_.peek());
-          stream_.next();
+             i < count && core::is_ascii_hex_digit(peek<Enc>()); ++i) {
+          buf += static_cast<char>(peek<Enc>());
+          next<Enc>();
         }
         if (!core::is_valid_unicode_escape(buf)) {
-          return err<Token>(
-              Error::create(start, line, col,
-                            diagnostic::DiagnosticId::kInvalidUnicodeEscape));
+          return err<Token>(error_at(
+              start, 1, diagnostic::DiagnosticId::kInvalidUnicodeEscape));
         }
-      } else if (core::is_ascii_octal_digit(stream_.peek())) {
+      } else if (core::is_ascii_octal_digit(peek<Enc>())) {
         std::string buf;
-        const char c = stream_.peek();
+        const char c = peek<Enc>();
         for (uint8_t i = 0; i < 3 && '0' <= c && c <= '7'; ++i) {
           buf += c;
-          stream_.next();
+          next<Enc>();
         }
         if (!core::is_valid_octal_escape(buf)) {
-          return err<Token>(Error::create(
-              start, line, col, diagnostic::DiagnosticId::kInvalidOctalEscape));
+          return err<Token>(error_at(
+              start, 1, diagnostic::DiagnosticId::kInvalidOctalEscape));
         }
       } else {
-        return err<Token>(
-            Error::create(start, line, col,
-                          diagnostic::DiagnosticId::kInvalidCharacterEscape));
+        return err<Token>(error_at(
+            start, 1, diagnostic::DiagnosticId::kInvalidCharacterEscape));
       }
     } else {
-      stream_.next();
+      next<Enc>();
     }
   }
 
   if (stream_.eof()) {
-    return err<Token>(
-        Error::create(start, line, col,
-                      diagnostic::DiagnosticId::kUnterminatedStringLiteral));
+    return err<Token>(error_at(
+        start, 1, diagnostic::DiagnosticId::kUnterminatedStringLiteral));
   }
 
   // consume the closing '"'
-  stream_.next();
+  next<Enc>();
 
-  return create_token(TokenKind::kString, start, line, col);
+  return create_token(TokenKind::kString, start);
 }
 
+template Lexer::Result<base::Token> Lexer::literal_str<AsciiEncoding>();
+template Lexer::Result<base::Token> Lexer::literal_str<Utf8Encoding>();
+
 }  // namespace lexer
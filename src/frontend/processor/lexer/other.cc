@@ -2,104 +2,104 @@
 // This source code is licensed under the Apache License, Version 2.0
 // which can be found in the LICENSE file.
 
+#include "frontend/processor/lexer/encoding.h"
 #include "frontend/processor/lexer/lexer.h"
 #include "unicode/base/unicode_util.h"
 
 namespace lexer {
 
+template <typename Enc>
 Lexer::Result<base::Token> Lexer::other_token(char current_char,
                                               char next_char,
-                                              std::size_t start,
-                                              std::size_t line,
-                                              std::size_t col) {
+                                              std::size_t start) {
   switch (current_char) {
     // single character tokens
-    case ';': return create_token(TokenKind::kSemicolon, start, line, col);
-    case ',': return create_token(TokenKind::kComma, start, line, col);
-    case '(': return create_token(TokenKind::kLeftParen, start, line, col);
-    case ')': return create_token(TokenKind::kRightParen, start, line, col);
-    case '{': return create_token(TokenKind::kLeftBrace, start, line, col);
-    case '}': return create_token(TokenKind::kRightBrace, start, line, col);
-    case '[': return create_token(TokenKind::kLeftBracket, start, line, col);
-    case ']': return create_token(TokenKind::kRightBracket, start, line, col);
-    case '@': return create_token(TokenKind::kAt, start, line, col);
-    case '#': return create_token(TokenKind::kHash, start, line, col);
-    case '$': return create_token(TokenKind::kDollar, start, line, col);
-    case '?': return create_token(TokenKind::kQuestion, start, line, col);
-    case '~': return create_token(TokenKind::kTilde, start, line, col);
-    case '\n': return create_token(TokenKind::kNewline, start, line, col);
+    case ';': return create_token(TokenKind::kSemicolon, start);
+    case ',': return create_token(TokenKind::kComma, start);
+    case '(': return create_token(TokenKind::kLeftParen, start);
+    case ')': return create_token(TokenKind::kRightParen, start);
+    case '{': return create_token(TokenKind::kLeftBrace, start);
+    case '}': return create_token(TokenKind::kRightBrace, start);
+    case '[': return create_token(TokenKind::kLeftBracket, start);
+    case ']': return create_token(TokenKind::kRightBracket, start);
+    case '@': return create_token(TokenKind::kAt, start);
+    case '#': return create_token(TokenKind::kHash, start);
+    case '$': return create_token(TokenKind::kDollar, start);
+    case '?': return create_token(TokenKind::kQuestion, start);
+    case '~': return create_token(TokenKind::kTilde, start);
+    case '\n': return create_token(TokenKind::kNewline, start);
     case '%':  // % or %=
       if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kPercentEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kPercentEq, start);
       } else {
-        return create_token(TokenKind::kPercent, start, line, col);
+        return create_token(TokenKind::kPercent, start);
       }
     case '&':  // & or && or &=
       if (next_char == '&') {
-        stream_.next();
-        return create_token(TokenKind::kAndAnd, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kAndAnd, start);
       } else if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kAndEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kAndEq, start);
       } else {
-        return create_token(TokenKind::kAnd, start, line, col);
+        return create_token(TokenKind::kAnd, start);
       }
     case '|':  // | or || or |=
       if (next_char == '|') {
-        stream_.next();
-        return create_token(TokenKind::kPipePipe, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kPipePipe, start);
       } else if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kPipeEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kPipeEq, start);
       } else {
-        return create_token(TokenKind::kPipe, start, line, col);
+        return create_token(TokenKind::kPipe, start);
       }
     case '^':  // ^ or ^=
       if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kCaretEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kCaretEq, start);
       } else {
-        return create_token(TokenKind::kCaret, start, line, col);
+        return create_token(TokenKind::kCaret, start);
       }
 
     // multi-character token handling (longest match first)
     case '+':  // +, +=, ++
       if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kPlusEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kPlusEq, start);
       } else if (next_char == '+') {
-        stream_.next();
-        return create_token(TokenKind::kPlusPlus, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kPlusPlus, start);
       } else {
-        return create_token(TokenKind::kPlus, start, line, col);
+        return create_token(TokenKind::kPlus, start);
       }
     case '-':  // -, ->, --, -=
       if (next_char == '>') {
-        stream_.next();
-        return create_token(TokenKind::kArrow, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kArrow, start);
       } else if (next_char == '-') {
-        stream_.next();
-        return create_token(TokenKind::kMinusMinus, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kMinusMinus, start);
       } else if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kMinusEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kMinusEq, start);
       } else {
-        return create_token(TokenKind::kMinus, start, line, col);
+        return create_token(TokenKind::kMinus, start);
       }
     case '*':  // *, ** or *=
       if (next_char == '*') {
-        stream_.next();
-        return create_token(TokenKind::kStarStar, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kStarStar, start);
       } else if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kStarEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kStarEq, start);
       } else {
-        return create_token(TokenKind::kStar, start, line, col);
+        return create_token(TokenKind::kStar, start);
       }
     case '/':  // /, //, /*, /=
       if (next_char == '/') {
-        const char third_cp = stream_.next();  // consume second '/'
+        const char third_cp = next<Enc>();  // consume second '/'
         TokenKind comment_kind;
         if (third_cp == '@') {
           // doc comment
@@ -109,108 +109,121 @@ Lexer::Result<base::Token> Lexer::other_token(char current_char,
           comment_kind = TokenKind::kInlineComment;
         }
         // read until end of file or line
-        while (!stream_.eof() && !unicode::is_unicode_newline(stream_.peek())) {
-          stream_.next();
+        while (true) {
+          stream_.skip_to_line_end();
+          if (stream_.eof() || Enc::is_newline(peek<Enc>())) {
+            break;
+          }
+          next<Enc>();
         }
-        return create_token(comment_kind, start, line, col);
+        return create_token(comment_kind, start);
       } else if (next_char == '*') {
-        stream_.next();  // consume '*'
+        next<Enc>();  // consume '*'
         while (!stream_.eof()) {
-          if (stream_.peek() == '*' && stream_.peek_at(1) == '/') {
-            stream_.next();  // consume '*'
-            stream_.next();  // consume '/'
-            return create_token(TokenKind::kBlockComment, start, line, col);
+          stream_.skip_to_star();
+          if (peek<Enc>() == '*' && peek_at<Enc>(1) == '/') {
+            next<Enc>();  // consume '*'
+            next<Enc>();  // consume '/'
+            return create_token(TokenKind::kBlockComment, start);
           }
-          stream_.next();
+          next<Enc>();
         }
         // reached eof before finding '*/'
-        return err<Token>(
-            Error::create(start, line, col,
-                          diagnostic::DiagnosticId::kUnterminatedBlockComment));
+        return err<Token>(error_at(
+            start, 1, diagnostic::DiagnosticId::kUnterminatedBlockComment));
       } else if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kSlashEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kSlashEq, start);
       } else {
-        return create_token(TokenKind::kSlash, start, line, col);
+        return create_token(TokenKind::kSlash, start);
       }
     case '=':  // =, ==
       if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kEqEq, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kEqEq, start);
       } else {
-        return create_token(TokenKind::kEqual, start, line, col);
+        return create_token(TokenKind::kEqual, start);
       }
     case '!':  // !, !=
       if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kNotEqual, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kNotEqual, start);
       } else {
-        return create_token(TokenKind::kBang, start, line, col);
+        return create_token(TokenKind::kBang, start);
       }
     case '<':  // <, <=, <<, <<=
       if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kLe, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kLe, start);
       } else if (next_char == '<') {
-        stream_.next();
+        next<Enc>();
         if (next_char == '=') {  // <<=
-          stream_.next();
-          return create_token(TokenKind::kLtLtEq, start, line, col);
+          next<Enc>();
+          return create_token(TokenKind::kLtLtEq, start);
         }
-        return create_token(TokenKind::kLtLt, start, line, col);
+        return create_token(TokenKind::kLtLt, start);
       } else {
-        return create_token(TokenKind::kLt, start, line, col);
+        return create_token(TokenKind::kLt, start);
       }
     case '>':  // >, >=, >>, >>=
       if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kGe, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kGe, start);
       } else if (next_char == '>') {
-        stream_.next();
+        next<Enc>();
         if (next_char == '=') {  // >>=
-          stream_.next();
-          return create_token(TokenKind::kGtGtEq, start, line, col);
+          next<Enc>();
+          return create_token(TokenKind::kGtGtEq, start);
         }
-        return create_token(TokenKind::kGtGt, start, line, col);
+        return create_token(TokenKind::kGtGt, start);
       } else {
-        return create_token(TokenKind::kGt, start, line, col);
+        return create_token(TokenKind::kGt, start);
       }
     case ':':  // :, ::, :=
       if (next_char == ':') {
-        stream_.next();
-        return create_token(TokenKind::kColonColon, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kColonColon, start);
       } else if (next_char == '=') {
-        stream_.next();
-        return create_token(TokenKind::kColonEqual, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kColonEqual, start);
       } else {
-        return create_token(TokenKind::kColon, start, line, col);
+        return create_token(TokenKind::kColon, start);
       }
     case '.':  // ., ..
       if (next_char == '.') {
-        stream_.next();
-        return create_token(TokenKind::kDotDot, start, line, col);
+        next<Enc>();
+        return create_token(TokenKind::kDotDot, start);
       } else {
-        return create_token(TokenKind::kDot, start, line, col);
+        return create_token(TokenKind::kDot, start);
       }
     case '\r':  // \r\n
       if (next_char == '\n') {
-        stream_.next();
+        next<Enc>();
       }
-      return create_token(TokenKind::kNewline, start, line, col);
+      return create_token(TokenKind::kNewline, start);
     case ' ':
       // consume a block of whitespace that begins with an ascii space
       // note that the second and subsequent characters may not necessarily be
       // ascii spaces
-      while (!stream_.eof() && unicode::is_unicode_whitespace(stream_.peek()) &&
-             !unicode::is_unicode_newline(stream_.peek())) {
-        stream_.next();
+      while (!stream_.eof() && Enc::is_whitespace(peek<Enc>()) &&
+             !Enc::is_newline(peek<Enc>())) {
+        next<Enc>();
       }
-      return create_token(TokenKind::kWhitespace, start, line, col);
+      return create_token(TokenKind::kWhitespace, start);
 
     default:
-      return err<Token>(Error::create(
-          start, line, col, diagnostic::DiagnosticId::kUnrecognizedCharacter));
+      return err<Token>(
+          error_at(start, 1, diagnostic::DiagnosticId::kUnrecognizedCharacter));
   }
 }
 
+template Lexer::Result<base::Token> Lexer::other_token<AsciiEncoding>(
+    char,
+    char,
+    std::size_t);
+template Lexer::Result<base::Token> Lexer::other_token<Utf8Encoding>(
+    char,
+    char,
+    std::size_t);
+
 }  // namespace lexer
@@ -47,17 +47,14 @@ Parser::Result<R> Parser::parse_attribute_use_one() {
 }
 
 Parser::Result<RR> Parser::parse_attribute_use_list() {
-  R first_id;
-  uint32_t attr_count = 0;
+  ScratchScope attributes(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBracket)) {
     auto r = parse_attribute_use_one();
     if (r.is_err()) {
       return err<RR>(std::move(r));
-    } else if (attr_count == 0) {
-      first_id = std::move(r).unwrap();
     }
-    ++attr_count;
+    attributes.push(std::move(r).unwrap().id);
 
     if (!check(base::TokenKind::kComma)) {
       break;
@@ -67,10 +64,8 @@ Parser::Result<RR> Parser::parse_attribute_use_list() {
   }
 
   // returns ok even if id is invalid and captures count is 0
-  return ok(RR{
-      .begin = first_id,
-      .size = attr_count,
-  });
+  return ok(context_->alloc_payload_range<ast::AttributeUsePayload>(
+      attributes.ids()));
 }
 
 }  // namespace parser
@@ -42,16 +42,13 @@ Parser::Result<R> Parser::parse_capture_one() {
 }
 
 Parser::Result<RR> Parser::parse_capture_list() {
-  R first_id;
-  uint32_t captures_count = 0;
+  ScratchScope captures(&scratch_);
   while (!eof() && !check(base::TokenKind::kRightBracket)) {
     auto r = parse_capture_one();
     if (r.is_err()) {
       return err<RR>(std::move(r));
-    } else if (captures_count == 0) {
-      first_id = std::move(r).unwrap();
     }
-    ++captures_count;
+    captures.push(std::move(r).unwrap().id);
 
     if (!check(base::TokenKind::kComma)) {
       break;
@@ -61,10 +58,7 @@ Parser::Result<RR> Parser::parse_capture_list() {
   }
 
   // returns ok even if id is invalid and captures count is 0
-  return ok(RR{
-      .begin = first_id,
-      .size = captures_count,
-  });
+  return ok(context_->alloc_payload_range<ast::CapturePayload>(captures.ids()));
 }
 
 }  // namespace parser
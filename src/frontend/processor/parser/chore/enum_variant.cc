@@ -63,17 +63,14 @@ Parser::Result<R> Parser::parse_enum_variant() {
       next_non_whitespace();
 
       // type nodes
-      PayloadId<ast::TypeReferencePayload> first_id;
-      uint32_t types_count = 0;
+      ScratchScope types(&scratch_);
 
       while (!eof() && !check(base::TokenKind::kRightParen)) {
         auto r = parse_type_reference();
         if (r.is_err()) {
           return err<R>(std::move(r));
-        } else if (types_count == 0) {
-          first_id = std::move(r).unwrap();
         }
-        ++types_count;
+        types.push(std::move(r).unwrap().id);
 
         if (!check(base::TokenKind::kComma)) {
           break;
@@ -87,19 +84,17 @@ Parser::Result<R> Parser::parse_enum_variant() {
         return err<R>(std::move(right_r));
       }
 
-      return ok(context_->alloc_payload(
-          ast::EnumVariantPayload(std::move(variant_name_r).unwrap(),
-                                  PayloadRange<ast::TypeReferencePayload>{
-                                      .begin = first_id,
-                                      .size = types_count,
-                                  })));
+      const PayloadRange<ast::TypeReferencePayload> types_range =
+          context_->alloc_payload_range<ast::TypeReferencePayload>(types.ids());
+      return ok(context_->alloc_payload(ast::EnumVariantPayload(
+          std::move(variant_name_r).unwrap(), types_range)));
     }
     default:
       return err<R>(
           std::move(
               Eb(diagnostic::Severity::kError,
                  diagnostic::DiagnosticId::kUnexpectedToken)
-                  .label(stream_->file_id(), peek().range(),
+                  .label(stream_->file_id(), range_of(peek()),
                          i18n::TranslationKey::kDiagnosticParserUnexpectedToken,
                          diagnostic::LabelMarkerType::kEmphasis,
                          {translator_->translate(
@@ -12,8 +12,7 @@
 namespace parser {
 
 Parser::Result<ast::NodeRange> Parser::parse_expression_sequence() {
-  NodeId first_id = ast::kInvalidNodeId;
-  uint32_t arg_count = 0;
+  ScratchScope args(&scratch_);
 
   while (!eof()) {
     auto arg_value_r = parse_expression();
@@ -21,10 +20,7 @@ Parser::Result<ast::NodeRange> Parser::parse_expression_sequence() {
       return err<NodeRange>(std::move(arg_value_r));
     }
 
-    if (arg_count == 0) {
-      first_id = std::move(arg_value_r).unwrap();
-    }
-    ++arg_count;
+    args.push(std::move(arg_value_r).unwrap());
 
     if (!check(base::TokenKind::kComma)) {
       break;
@@ -33,10 +29,7 @@ Parser::Result<ast::NodeRange> Parser::parse_expression_sequence() {
     next_non_whitespace();
   }
 
-  return ok(NodeRange{
-      .begin = first_id,
-      .size = arg_count,
-  });
+  return ok(context_->alloc_children(args.ids()));
 }
 
 }  // namespace parser
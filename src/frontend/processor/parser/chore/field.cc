@@ -40,17 +40,14 @@ Parser::Result<R> Parser::parse_field_one() {
 }
 
 Parser::Result<RR> Parser::parse_field_list() {
-  R first_id;
-  uint32_t fields_count = 0;
+  ScratchScope fields(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBrace)) {
     auto r = parse_field_one();
     if (r.is_err()) {
       return err<RR>(std::move(r));
-    } else if (fields_count == 0) {
-      first_id = std::move(r).unwrap();
     }
-    ++fields_count;
+    fields.push(std::move(r).unwrap().id);
 
     if (!check(base::TokenKind::kComma)) {
       break;
@@ -60,10 +57,7 @@ Parser::Result<RR> Parser::parse_field_list() {
   }
 
   // returns ok even if id is invalid and fields count is 0
-  return ok(RR{
-      .begin = first_id,
-      .size = fields_count,
-  });
+  return ok(context_->alloc_payload_range<ast::FieldPayload>(fields.ids()));
 }
 
 }  // namespace parser
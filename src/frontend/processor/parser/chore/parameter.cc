@@ -42,17 +42,14 @@ Parser::Result<R> Parser::parse_parameter_one() {
 }
 
 Parser::Result<RR> Parser::parse_parameter_list() {
-  R first_id;
-  uint32_t parameters_count = 0;
+  ScratchScope parameters(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightParen)) {
     auto r = parse_parameter_one();
     if (r.is_err()) {
       return err<RR>(std::move(r));
-    } else if (parameters_count == 0) {
-      first_id = std::move(r).unwrap();
     }
-    ++parameters_count;
+    parameters.push(std::move(r).unwrap().id);
 
     if (!check(base::TokenKind::kComma)) {
       break;
@@ -62,10 +59,8 @@ Parser::Result<RR> Parser::parse_parameter_list() {
   }
 
   // returns ok even if id is invalid and parameters count is 0
-  return ok(RR{
-      .begin = first_id,
-      .size = parameters_count,
-  });
+  return ok(
+      context_->alloc_payload_range<ast::ParameterPayload>(parameters.ids()));
 }
 
 }  // namespace parser
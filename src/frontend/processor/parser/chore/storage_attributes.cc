@@ -45,8 +45,8 @@ Parser::Result<ast::StorageAttributeData> Parser::parse_storage_attributes() {
   if (attribute.has_any()) {
     DCHECK(attribute_last_token);
     const core::SourceRange attribute_range{
-        first_token.start(),
-        attribute_last_token->end(),
+        first_token.start(stream_->file()),
+        attribute_last_token->end(stream_->file()),
     };
 
     if ((attribute & Sadd::kMutable) && (attribute & Sadd::kConstant)) {
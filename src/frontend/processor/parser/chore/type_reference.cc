@@ -87,7 +87,7 @@ Parser::Result<R> Parser::parse_type_reference() {
                 Eb(diagnostic::Severity::kError,
                    diagnostic::DiagId::kExpectedButFound)
                     .label(
-                        stream_->file_id(), current.range(),
+                        stream_->file_id(), range_of(current),
                         i18n::TranslationKey::kDiagnosticParserExpectedButFound,
                         diagnostic::LabelMarkerType::kEmphasis,
                         {translator_->translate(
@@ -22,19 +22,14 @@ Parser::Result<R> Parser::parse_array_expr() {
     return err<R>(std::move(left_r));
   }
 
-  NodeId first_id;
-  uint32_t elements_count = 0;
+  ScratchScope elements(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBracket)) {
     auto expr_r = parse_unary_expr();
     if (expr_r.is_err()) {
       return err<R>(std::move(expr_r));
     }
-    if (elements_count == 0) {
-      first_id = std::move(expr_r).unwrap();
-    }
-
-    ++elements_count;
+    elements.push(std::move(expr_r).unwrap());
 
     const base::Token& next_token = next_non_whitespace();
     const base::TokenKind kind = next_token.kind();
@@ -45,7 +40,7 @@ Parser::Result<R> Parser::parse_array_expr() {
           std::move(
               Eb(diagnostic::Severity::kError,
                  diagnostic::DiagId::kUnexpectedToken)
-                  .label(stream_->file_id(), next_token.range(),
+                  .label(stream_->file_id(), range_of(next_token),
                          i18n::TranslationKey::kDiagnosticParserUnexpectedToken,
                          diagnostic::LabelMarkerType::kEmphasis,
                          {translator_->translate(
@@ -60,7 +55,7 @@ Parser::Result<R> Parser::parse_array_expr() {
   }
 
   return ok(context_->alloc_payload(ast::ArrayExpressionPayload{
-      .array_elements_range = {.begin = first_id, .size = elements_count},
+      .array_elements_range = context_->alloc_children(elements.ids()),
   }));
 }
 
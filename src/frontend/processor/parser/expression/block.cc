@@ -25,8 +25,7 @@ Parser::Result<R> Parser::parse_block_expr() {
     return err<R>(std::move(left_r));
   }
 
-  NodeId first_id = ast::kInvalidNodeId;
-  uint32_t body_statement_count = 0;
+  ScratchScope body(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBrace)) {
     auto body_statement_r = parse_statement();
@@ -34,10 +33,7 @@ Parser::Result<R> Parser::parse_block_expr() {
       return err<R>(std::move(body_statement_r));
     }
 
-    if (body_statement_count == 0) {
-      first_id = std::move(body_statement_r).unwrap();
-    }
-    ++body_statement_count;
+    body.push(std::move(body_statement_r).unwrap());
   }
 
   auto right_r = consume(base::TokenKind::kRightBrace, true);
@@ -47,7 +43,7 @@ Parser::Result<R> Parser::parse_block_expr() {
 
   return ok(context_->alloc_payload(ast::BlockExpressionPayload{
       .storage_attribute = storage_attribute,
-      .body_nodes_range = {.begin = first_id, .size = body_statement_count},
+      .body_nodes_range = context_->alloc_children(body.ids()),
   }));
 }
 
@@ -20,8 +20,7 @@ Parser::Result<R> Parser::parse_construct_expr(NodeId type_path) {
     return err<R>(std::move(left_r));
   }
 
-  NodeId first_id = ast::kInvalidNodeId;
-  uint32_t arg_count = 0;
+  ScratchScope args(&scratch_);
 
   while (!eof() && check(base::TokenKind::kDot)) {
     // consume dot
@@ -42,10 +41,7 @@ Parser::Result<R> Parser::parse_construct_expr(NodeId type_path) {
       return err<R>(std::move(init_value_r));
     }
 
-    if (arg_count == 0) {
-      first_id = std::move(init_value_r).unwrap();
-    }
-    ++arg_count;
+    args.push(std::move(init_value_r).unwrap());
 
     if (!check(base::TokenKind::kComma)) {
       break;
@@ -61,7 +57,7 @@ Parser::Result<R> Parser::parse_construct_expr(NodeId type_path) {
 
   return ok(context_->alloc_payload(ast::ConstructExpressionPayload{
       .type_path = type_path,
-      .args_range = {.begin = first_id, .size = arg_count},
+      .args_range = context_->alloc_children(args.ids()),
   }));
 }
 
@@ -32,13 +32,16 @@ Parser::Result<R> Parser::parse_if_expr() {
     return err<R>(std::move(block_r));
   }
 
-  const PayloadId<ast::IfBranchPayload> first_id =
-      context_->alloc_payload(ast::IfBranchPayload{
-          .condition = cond_id,
-          .block = std::move(block_r).unwrap(),
-      });
+  // else-if blocks may hold nested ifs, whose branches would otherwise end
+  // up between ours
+  ScratchScope branches(&scratch_);
+  branches.push(context_
+                    ->alloc_payload(ast::IfBranchPayload{
+                        .condition = cond_id,
+                        .block = std::move(block_r).unwrap(),
+                    })
+                    .id);
 
-  uint32_t branches_count = 1;
   while (!eof() && check(base::TokenKind::kElse)) {
     // consume else
     next_non_whitespace();
@@ -66,12 +69,12 @@ Parser::Result<R> Parser::parse_if_expr() {
       return err<R>(std::move(block_r));
     }
 
-    context_->alloc_payload(ast::IfBranchPayload{
-        .condition = cond_id,
-        .block = std::move(block_r).unwrap(),
-    });
-
-    ++branches_count;
+    branches.push(context_
+                      ->alloc_payload(ast::IfBranchPayload{
+                          .condition = cond_id,
+                          .block = std::move(block_r).unwrap(),
+                      })
+                      .id);
 
     if (!is_else_if) {
       // last else
@@ -80,7 +83,8 @@ Parser::Result<R> Parser::parse_if_expr() {
   }
 
   return ok(context_->alloc_payload(ast::IfExpressionPayload{
-      .branches_range = {.begin = first_id, .size = branches_count},
+      .branches_range =
+          context_->alloc_payload_range<ast::IfBranchPayload>(branches.ids()),
   }));
 }
 
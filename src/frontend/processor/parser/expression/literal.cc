@@ -23,7 +23,8 @@ Parser::Result<R> Parser::parse_literal_expr() {
 
   return ok(context_->alloc_payload(ast::LiteralExpressionPayload{
       .kind = literal_kind,
-      .lexeme_range = literal_token.range(),
+      .lexeme_offset = literal_token.offset(),
+      .lexeme_length = literal_token.length(),
   }));
 }
 
@@ -31,8 +31,7 @@ Parser::Result<R> Parser::parse_match_expr() {
     return err<R>(std::move(left_r));
   }
 
-  PayloadId<ast::MatchArmPayload> first_id;
-  uint32_t arms_count = 0;
+  ScratchScope arms(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBrace)) {
     auto pattern_r = parse_expression();
@@ -50,17 +49,12 @@ Parser::Result<R> Parser::parse_match_expr() {
       return err<R>(std::move(expr_r));
     }
 
-    const PayloadId<ast::MatchArmPayload> arm_id =
-        context_->alloc_payload(ast::MatchArmPayload{
-            .pattern = std::move(pattern_r).unwrap(),
-            .expression = std::move(expr_r).unwrap(),
-        });
-
-    if (arms_count == 0) {
-      first_id = arm_id;
-    }
-
-    ++arms_count;
+    arms.push(context_
+                  ->alloc_payload(ast::MatchArmPayload{
+                      .pattern = std::move(pattern_r).unwrap(),
+                      .expression = std::move(expr_r).unwrap(),
+                  })
+                  .id);
   }
 
   auto right_r = consume(base::TokenKind::kRightBrace, true);
@@ -70,7 +64,8 @@ Parser::Result<R> Parser::parse_match_expr() {
 
   return ok(context_->alloc_payload(ast::MatchExpressionPayload{
       .expression = match_expr_id,
-      .arms_range = {.begin = first_id, .size = arms_count},
+      .arms_range =
+          context_->alloc_payload_range<ast::MatchArmPayload>(arms.ids()),
   }));
 }
 
@@ -5,6 +5,7 @@
 #include <utility>
 
 #include "frontend/base/string/string_interner.h"
+#include "frontend/base/token/token.h"
 #include "frontend/base/token/token_kind.h"
 #include "frontend/data/ast/base/node.h"
 #include "frontend/data/ast/base/node_id.h"
@@ -13,6 +14,7 @@
 #include "frontend/processor/parser/parser.h"
 #include "i18n/base/data/translation_key.h"
 #include "i18n/base/translator.h"
+#include "unicode/utf8/file.h"
 
 namespace parser {
 
@@ -26,14 +28,18 @@ Parser::Result<R> Parser::parse_path_expr() {
 
   PayloadId<ast::IdentifierPayload> first_part;
   uint32_t parts_count = 0;
+  const unicode::Utf8File& file = stream_->file();
 
   while (!eof()) {
     auto next_part_r = consume(base::TokenKind::kIdentifier, true);
     if (next_part_r.is_err()) {
       return err<R>(std::move(next_part_r));
     }
-    const base::StringId id = interner_->intern(
-        std::move(next_part_r).unwrap()->lexeme(stream_->file()));
+    // identifiers are usually interned by the lexer already
+    const base::Token& part = *std::move(next_part_r).unwrap();
+    const base::StringId id = part.has_symbol()
+                                  ? part.symbol()
+                                  : interner_->intern(part.lexeme(file));
     const PayloadId<ast::IdentifierPayload> part_id =
         context_->alloc_payload(ast::IdentifierPayload{.id = id});
 
@@ -58,7 +64,7 @@ Parser::Result<R> Parser::parse_path_expr() {
         std::move(
             Eb(diagnostic::Severity::kError,
                diagnostic::DiagId::kExpectedButFound)
-                .label(stream_->file_id(), token.range(),
+                .label(stream_->file_id(), range_of(token),
                        i18n::TranslationKey::kDiagnosticParserExpectedButFound,
                        diagnostic::LabelMarkerType::kEmphasis,
                        {translator_->translate(
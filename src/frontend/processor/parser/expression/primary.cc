@@ -54,7 +54,7 @@ Parser::Result<ast::NodeId> Parser::parse_primary_expr() {
           std::move(
               Eb(diagnostic::Severity::kError,
                  diagnostic::DiagnosticId::kUnexpectedToken)
-                  .label(stream_->file_id(), peek().range(),
+                  .label(stream_->file_id(), range_of(peek()),
                          i18n::TranslationKey::kDiagnosticParserUnexpectedToken,
                          diagnostic::LabelMarkerType::kEmphasis,
                          {translator_->translate(
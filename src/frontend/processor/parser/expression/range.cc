@@ -41,7 +41,7 @@ Parser::Result<ast::NodeId> Parser::parse_range_expr() {
           std::move(
               Eb(diagnostic::Severity::kError,
                  diagnostic::DiagId::kUnexpectedToken)
-                  .label(stream_->file_id(), lt_or_equal.range(),
+                  .label(stream_->file_id(), range_of(lt_or_equal),
                          i18n::TranslationKey::kDiagnosticParserUnexpectedToken,
                          diagnostic::LabelMarkerType::kEmphasis,
                          {translator_->translate(
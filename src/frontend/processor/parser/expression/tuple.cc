@@ -21,19 +21,14 @@ Parser::Result<R> Parser::parse_tuple_expr() {
     return err<R>(std::move(left_r));
   }
 
-  NodeId first_id = ast::kInvalidNodeId;
-  uint32_t elements_count = 0;
+  ScratchScope elements(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightParen)) {
     auto expr_r = parse_expression();
     if (expr_r.is_err()) {
       return err<R>(std::move(expr_r));
     }
-    if (elements_count == 0) {
-      first_id = std::move(expr_r).unwrap();
-    }
-
-    ++elements_count;
+    elements.push(std::move(expr_r).unwrap());
 
     const base::Token& next_token = next_non_whitespace();
     if (next_token.kind() == base::TokenKind::kComma) {
@@ -43,7 +38,7 @@ Parser::Result<R> Parser::parse_tuple_expr() {
           std::move(
               Eb(diagnostic::Severity::kError,
                  diagnostic::DiagId::kUnexpectedToken)
-                  .label(stream_->file_id(), next_token.range(),
+                  .label(stream_->file_id(), range_of(next_token),
                          i18n::TranslationKey::kDiagnosticParserUnexpectedToken,
                          diagnostic::LabelMarkerType::kEmphasis,
                          {translator_->translate(
@@ -58,7 +53,7 @@ Parser::Result<R> Parser::parse_tuple_expr() {
   }
 
   return ok(context_->alloc_payload(ast::TupleExpressionPayload{
-      .tuple_elements_range = {.begin = first_id, .size = elements_count},
+      .tuple_elements_range = context_->alloc_children(elements.ids()),
   }));
 }
 
@@ -3,6 +3,7 @@
 // which can be found in the LICENSE file.
 
 #include <utility>
+#include <vector>
 
 #include "frontend/base/operator/unary_operator.h"
 #include "frontend/base/token/token.h"
@@ -17,11 +18,12 @@
 namespace parser {
 
 Parser::Result<ast::NodeId> Parser::parse_unary_expr() {
-  uint32_t pre_op_count;
-  for (pre_op_count = 0; pre_op_count < stream_->size(); ++pre_op_count) {
-    if (!base::token_kind_is_unary_operator(peek().kind())) {
-      break;
-    }
+  // prefix operators are kept rather than read again after the operand, so
+  // the stream never has to step back over it
+  std::vector<base::UnaryOperator> prefix_ops;
+  while (base::token_kind_is_unary_operator(peek().kind())) {
+    prefix_ops.push_back(base::token_kind_to_unary_op(
+        peek().kind(), base::IncrementPosition::kPrefix));
     next_non_whitespace();
   }
 
@@ -29,22 +31,17 @@ Parser::Result<ast::NodeId> Parser::parse_unary_expr() {
   auto operand_r = parse_primary_expr();
   if (operand_r.is_err()) {
     return operand_r;
-  } else if (pre_op_count == 0) {
+  } else if (prefix_ops.empty()) {
     return operand_r;
   }
   NodeId operand_id = std::move(operand_r).unwrap();
 
-  // rewind to first unary operator position
-  stream_->rewind(stream_->position() - pre_op_count);
-
   // apply prefix operators in reverse order (right-to-left associativity)
   // i.e., `++--x` becomes `++(--x)`
-  for (uint32_t i = pre_op_count; i > 0; --i) {
-    const base::UnaryOperator op = base::token_kind_to_unary_op(
-        peek_at(i).kind(), base::IncrementPosition::kPrefix);
+  for (auto it = prefix_ops.rbegin(); it != prefix_ops.rend(); ++it) {
     operand_id = context_->alloc_node(ast::NodeKind::kUnaryExpression,
                                       ast::UnaryExpressionPayload{
-                                          .op = op,
+                                          .op = *it,
                                           .operand = operand_id,
                                       });
   }
@@ -62,7 +59,7 @@ Parser::Result<ast::NodeId> Parser::parse_unary_expr() {
           std::move(
               Eb(diagnostic::Severity::kError,
                  diagnostic::DiagId::kCannotBePostfixOperator)
-                  .label(stream_->file_id(), postfix_token.range(),
+                  .label(stream_->file_id(), range_of(postfix_token),
                          i18n::TranslationKey::
                              kDiagnosticParserCannotBePostfixOperator,
                          diagnostic::LabelMarkerType::kEmphasis,
@@ -4,9 +4,14 @@
 
 #include "frontend/processor/parser/parser.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <utility>
 
+#include "core/base/source_location.h"
+#include "frontend/base/data/arena_profile.h"
 #include "frontend/base/keyword/attribute_keyword.h"
 #include "frontend/base/keyword/control_flow_keyword.h"
 #include "frontend/base/keyword/declaration_keyword.h"
@@ -26,12 +31,20 @@
 
 namespace parser {
 
+namespace {
+
+constexpr std::size_t kNotRecovering = SIZE_MAX;
+
+}  // namespace
+
 void Parser::init(base::TokenStream* stream,
                   base::StringInterner* interner,
-                  const i18n::Translator& translator) {
+                  const i18n::Translator& translator,
+                  const base::ArenaProfile* arena_profile) {
   DCHECK_EQ(status_, Status::kNotInitialized);
   stream_ = stream;
   DCHECK(stream_);
+  DCHECK(stream_->has_file());
 
   interner_ = interner;
   DCHECK(interner_);
@@ -39,6 +52,7 @@ void Parser::init(base::TokenStream* stream,
   translator_ = &translator;
   DCHECK(translator_);
 
+  arena_profile_ = arena_profile;
   init_context();
 
   status_ = Status::kReadyToParse;
@@ -50,78 +64,48 @@ void Parser::init_context() {
   context_ = ast::Context::create();
   DCHECK(context_);
 
-  // TODO: hot path heuristic allocations
-  context_->arena<ast::Node>().reserve(512);
-
-  // expressions
-  context_->arena<ast::LiteralExpressionPayload>().reserve(256);
-  context_->arena<ast::PathExpressionPayload>().reserve(256);
-  context_->arena<ast::UnaryExpressionPayload>().reserve(256);
-  context_->arena<ast::BinaryExpressionPayload>().reserve(256);
-  context_->arena<ast::GroupedExpressionPayload>().reserve(32);
-  context_->arena<ast::ArrayExpressionPayload>().reserve(32);
-  context_->arena<ast::TupleExpressionPayload>().reserve(32);
-  context_->arena<ast::IndexExpressionPayload>().reserve(32);
-  context_->arena<ast::ConstructExpressionPayload>().reserve(256);
-  context_->arena<ast::FunctionCallExpressionPayload>().reserve(512);
-  context_->arena<ast::MethodCallExpressionPayload>().reserve(256);
-  context_->arena<ast::FunctionMacroCallExpressionPayload>().reserve(256);
-  context_->arena<ast::MethodMacroCallExpressionPayload>().reserve(256);
-  context_->arena<ast::FieldAccessExpressionPayload>().reserve(256);
-  context_->arena<ast::AwaitExpressionPayload>().reserve(256);
-  context_->arena<ast::ContinueExpressionPayload>().reserve(256);
-  context_->arena<ast::BreakExpressionPayload>().reserve(256);
-  context_->arena<ast::RangeExpressionPayload>().reserve(256);
-  context_->arena<ast::ReturnExpressionPayload>().reserve(512);
-  context_->arena<ast::BlockExpressionPayload>().reserve(256);
-  context_->arena<ast::BlockExpressionPayload>().reserve(256);
-  context_->arena<ast::IfExpressionPayload>().reserve(256);
-  context_->arena<ast::LoopExpressionPayload>().reserve(256);
-  context_->arena<ast::WhileExpressionPayload>().reserve(256);
-  context_->arena<ast::ForExpressionPayload>().reserve(256);
-  context_->arena<ast::MatchExpressionPayload>().reserve(256);
-  context_->arena<ast::ClosureExpressionPayload>().reserve(256);
-
-  // statements
-  context_->arena<ast::AssignStatementPayload>().reserve(512);
-  context_->arena<ast::AttributeStatementPayload>().reserve(32);
-  context_->arena<ast::UseStatementPayload>().reserve(32);
-
-  context_->arena<ast::FunctionDeclarationPayload>().reserve(512);
-  context_->arena<ast::StructDeclarationPayload>().reserve(256);
-  context_->arena<ast::EnumerationDeclarationPayload>().reserve(256);
-  context_->arena<ast::TraitDeclarationPayload>().reserve(256);
-  context_->arena<ast::ImplementationDeclarationPayload>().reserve(256);
-  context_->arena<ast::UnionDeclarationPayload>().reserve(256);
-  context_->arena<ast::ModuleDeclarationPayload>().reserve(32);
-  context_->arena<ast::RedirectDeclarationPayload>().reserve(256);
-
-  // data
-  context_->arena<ast::AttributeUsePayload>().reserve(256);
-  context_->arena<ast::CapturePayload>().reserve(256);
-  context_->arena<ast::FieldPayload>().reserve(256);
-  context_->arena<ast::ParameterPayload>().reserve(256);
-  context_->arena<ast::EnumVariantPayload>().reserve(256);
-  context_->arena<ast::TypeReferencePayload>().reserve(256);
-  context_->arena<ast::ArrayTypePayload>().reserve(256);
-  context_->arena<ast::IdentifierPayload>().reserve(256);
-  context_->arena<ast::IfBranchPayload>().reserve(256);
-  context_->arena<ast::MatchArmPayload>().reserve(256);
+  // without a profile the arenas just grow block by block
+  if (arena_profile_ && !arena_profile_->empty()) {
+    const std::size_t lines = stream_->file().line_count();
+    context_->reserve_from(*arena_profile_, std::max<std::size_t>(lines, 1));
+  }
 }
 
 Parser::ParseResult Parser::parse_all(bool strict) {
   DCHECK_EQ(status_, Status::kReadyToParse);
+  // error whose recovery region is still open. items failing after it are
+  // most likely its follow-ups, so the region only ends where an item parses
+  // again.
+  std::size_t recovering = kNotRecovering;
+  core::SourceLocation item_start(0, 0);
   while (!eof()) {
+    if (recovering != kNotRecovering) [[unlikely]] {
+      item_start = range_of(peek()).start();
+    }
     auto result = parse_next();
     if (result.is_err()) [[unlikely]] {
       errors_.emplace_back(std::move(result).unwrap_err());
       if (strict) {
         break;
       } else {
-        synchronize();
+        skip_to_sync_point();
+        if (recovering == kNotRecovering) {
+          recovering = errors_.size() - 1;
+        }
         continue;
       }
     }
+    const NodeId root = std::move(result).unwrap();
+    if (root != ast::kInvalidNodeId) {
+      if (recovering != kNotRecovering) [[unlikely]] {
+        errors_[recovering].set_recovery_end(item_start);
+        recovering = kNotRecovering;
+      }
+      context_->add_root(root);
+    }
+  }
+  if (recovering != kNotRecovering) {
+    errors_[recovering].set_recovery_end(range_of(peek()).start());
   }
 
   if (errors_.empty()) [[likely]] {
@@ -133,27 +117,51 @@ Parser::ParseResult Parser::parse_all(bool strict) {
   }
 }
 
-Parser::Result<void> Parser::parse_next() {
+Parser::Item Parser::parse_item(std::size_t begin) {
+  DCHECK_EQ(status_, Status::kReadyToParse);
+  DCHECK(!stream_->is_streaming()) << "items are re-parsed from all tokens";
+  stream_->rewind(begin);
+  DCHECK(!eof());
+
+  Item item{.begin = begin};
+  const std::size_t nodes_before = context_->arena<Node>().size();
+  auto result = parse_next();
+  if (result.is_err()) [[unlikely]] {
+    item.errors.emplace_back(std::move(result).unwrap_err());
+    synchronize(&item.errors.back());
+  } else {
+    item.root = std::move(result).unwrap();
+  }
+  item.end = stream_->position();
+  item.first_node = static_cast<NodeId>(nodes_before);
+  item.node_count = context_->arena<Node>().size() - nodes_before;
+  return item;
+}
+
+void Parser::reset_context() {
+  DCHECK_EQ(status_, Status::kReadyToParse);
+  status_ = Status::kNotInitialized;
+  init_context();
+  status_ = Status::kReadyToParse;
+}
+
+Parser::Result<ast::NodeId> Parser::parse_next() {
   const base::TokenKind current_kind = peek().kind();
 
   // parses declaration or statement
   if (eof() || current_kind == base::TokenKind::kEof) {
-    return ok<void>();
+    return ok<NodeId>(ast::kInvalidNodeId);
   } else if (current_kind == base::TokenKind::kBlockComment ||
              current_kind == base::TokenKind::kInlineComment) {
     // TODO: support document gen mode
     next();
-    return ok<void>();
+    return ok<NodeId>(ast::kInvalidNodeId);
   } else if (current_kind == base::TokenKind::kSemicolon) {
     // consume ;
     next();
-    return ok<void>();
+    return ok<NodeId>(ast::kInvalidNodeId);
   } else {
-    auto result = parse_statement();
-    if (result.is_err()) {
-      return err<void>(std::move(result));
-    }
-    return ok<void>();
+    return parse_statement();
   }
 }
 
@@ -177,7 +185,7 @@ Parser::Result<const base::Token*> Parser::consume(base::TokenKind expected,
         std::move(
             Eb(diagnostic::Severity::kError,
                diagnostic::DiagId::kExpectedButFound)
-                .label(stream_->file_id(), token.range(),
+                .label(stream_->file_id(), range_of(token),
                        i18n::TranslationKey::kDiagnosticParserExpectedButFound,
                        diagnostic::LabelMarkerType::kEmphasis,
                        {translator_->translate(
@@ -188,7 +196,7 @@ Parser::Result<const base::Token*> Parser::consume(base::TokenKind expected,
   }
 }
 
-void Parser::synchronize() {
+void Parser::skip_to_sync_point() {
   if (eof()) [[unlikely]] {
     return;
   }
@@ -213,6 +221,13 @@ void Parser::synchronize() {
   }
 }
 
+void Parser::synchronize(De* error) {
+  skip_to_sync_point();
+  // everything up to here was skipped, errors reported inside it are most
+  // likely caused by this one
+  error->set_recovery_end(range_of(peek()).start());
+}
+
 // static
 bool Parser::is_sync_point(base::TokenKind kind) {
   return base::token_kind_is_control_flow_keyword(kind) ||
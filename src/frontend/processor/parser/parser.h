@@ -6,6 +6,7 @@
 #define FRONTEND_PROCESSOR_PARSER_PARSER_H_
 
 #include <memory>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -22,6 +23,7 @@
 #include "unicode/utf8/file_manager.h"
 
 namespace base {
+class ArenaProfile;
 class TokenStream;
 class StringInterner;
 };  // namespace base
@@ -63,12 +65,43 @@ class Parser {
   PARSER_EXPORT Parser(Parser&&) noexcept = default;
   PARSER_EXPORT Parser& operator=(Parser&&) noexcept = default;
 
+  // `arena_profile`, if given, pre-sizes the ast arenas for the input's line
+  // count. it must outlive the parser. the stream must have a file, nodes
+  // keep source ranges and literals keep offsets into it.
   PARSER_EXPORT void init(base::TokenStream* stream,
                           base::StringInterner* interner,
-                          const i18n::Translator& translater);
+                          const i18n::Translator& translater,
+                          const base::ArenaProfile* arena_profile = nullptr);
 
   PARSER_EXPORT ParseResult parse_all(bool strict = false);
 
+  // what one top-level parse step consumed and produced
+  struct Item {
+    // token positions [begin, end)
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    // kInvalidNodeId for separators, comments and items that failed
+    ast::NodeId root = ast::kInvalidNodeId;
+    // nodes allocated for the item, [first_node, first_node + node_count).
+    // they stay in the context as dead nodes once the item is parsed again.
+    ast::NodeId first_node = ast::kInvalidNodeId;
+    std::size_t node_count = 0;
+    std::vector<De> errors;
+  };
+
+  // incremental alternative to parse_all() that parses the single top-level
+  // item starting at token `begin` into the parser's own context. an item
+  // only depends on its own tokens, so callers can re-parse the items an
+  // edit touched and keep the rest. `begin` must not be the eof token.
+  // needs a stream holding all tokens, a streaming one can not step back
+  // to an item it already passed.
+  PARSER_EXPORT Item parse_item(std::size_t begin);
+
+  // drops every node parsed so far and starts over on a fresh context
+  PARSER_EXPORT void reset_context();
+
+  inline ast::Context* context() const { return context_.get(); }
+
   inline void reset() {
     DCHECK_NE(status_, Status::kNotInitialized);
     status_ = Status::kNotInitialized;
@@ -88,7 +121,35 @@ class Parser {
   template <typename T>
   using PayloadRange = ast::PayloadRange<T>;
 
-  Result<void> parse_next();
+  // collects the ids of one list (children or payloads) while it is parsed.
+  // lists nest, so scopes form a stack over the shared scratch_ vector and
+  // each one only sees the ids pushed since it was opened. the ids are then
+  // committed in bulk, which keeps every list contiguous in the context.
+  class ScratchScope {
+   public:
+    explicit ScratchScope(std::vector<uint32_t>* stack)
+        : stack_(stack), mark_(stack->size()) {}
+    ~ScratchScope() { stack_->resize(mark_); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    inline void push(uint32_t id) { stack_->push_back(id); }
+    inline uint32_t size() const {
+      return static_cast<uint32_t>(stack_->size() - mark_);
+    }
+    // invalidated by the next push
+    inline std::span<const uint32_t> ids() const {
+      return std::span<const uint32_t>(*stack_).subspan(mark_);
+    }
+
+   private:
+    std::vector<uint32_t>* stack_;
+    std::size_t mark_;
+  };
+
+  // kInvalidNodeId for tokens that do not produce a node
+  Result<NodeId> parse_next();
 
   // expression wo block
   Result<NodeId> parse_expression();
@@ -187,7 +248,11 @@ class Parser {
   void append_errors(std::vector<De>&& new_errors);
   Result<const base::Token*> consume(base::TokenKind expected,
                                      bool skip_whitespaces);
-  void synchronize();
+  void skip_to_sync_point();
+  // skips to the next sync point and records where parsing resumes as the end
+  // of the recovery region of `error`. parse_all() extends the region further,
+  // up to the next item that parses.
+  void synchronize(De* error);
 
   inline bool eof() const { return stream_->eof(); }
 
@@ -210,6 +275,11 @@ class Parser {
     return peek();
   }
 
+  // tokens only store byte offsets, line and column are resolved on demand
+  inline core::SourceRange range_of(const base::Token& token) const {
+    return token.range(stream_->file());
+  }
+
   template <typename T>
   inline static Result<T> ok(T ok_value) {
     return Result<T>(diagnostic::create_ok(std::move(ok_value)));
@@ -248,7 +318,9 @@ class Parser {
   base::StringInterner* interner_ = nullptr;
   std::unique_ptr<ast::Context> context_ = nullptr;
   const i18n::Translator* translator_ = nullptr;
+  const base::ArenaProfile* arena_profile_ = nullptr;
   std::vector<De> errors_;
+  std::vector<uint32_t> scratch_;
   Status status_ = Status::kNotInitialized;
 };
 
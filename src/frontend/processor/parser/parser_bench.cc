@@ -25,7 +25,7 @@ base::TokenStream tkstr(std::vector<base::TokenKind>&& kinds) {
   tokens.reserve(kinds.size());
 
   for (auto kind : kinds) {
-    base::Token token(kind, 1, 1, 0);
+    base::Token token(kind, 0, 0);
     tokens.emplace_back(std::move(token));
   }
 
@@ -6,13 +6,16 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "frontend/base/string/string_interner.h"
 #include "frontend/base/token/token_kind.h"
 #include "frontend/base/token/token_stream.h"
+#include "frontend/data/ast/context.h"
 #include "frontend/diagnostic/data/diagnostic_entry.h"
 #include "frontend/diagnostic/data/diagnostic_id.h"
 #include "frontend/diagnostic/engine/diagnostic_engine.h"
@@ -33,7 +36,7 @@ base::TokenStream tkstr(std::vector<base::TokenKind>&& kinds) {
   tokens.reserve(kinds.size());
 
   for (auto kind : kinds) {
-    base::Token token(kind, 1, 1, 0);
+    base::Token token(kind, 0, 0);
     tokens.emplace_back(std::move(token));
   }
   const unicode::Utf8FileId id = file_manager.register_virtual_file(u8"");
@@ -54,6 +57,16 @@ struct TestParser {
 
   ~TestParser() = default;
 
+  std::unique_ptr<ast::Context> parse_ok() {
+    auto result = parser.parse_all(false);
+    EXPECT_TRUE(result.is_ok());
+    if (result.is_err()) {
+      describe_errors(std::move(result).unwrap_err());
+      return nullptr;
+    }
+    return std::move(result).unwrap();
+  }
+
   void expect_ok(bool strict = false) {
     auto result = parser.parse_all(strict);
 
@@ -108,6 +121,83 @@ struct TestParser {
   base::TokenStream stream_;
 };
 
+// tokens of a source whose tokens are all separated by single spaces, with
+// real offsets so literal payloads can be read back
+base::TokenStream tokens_of(std::u8string_view source) {
+  std::vector<base::Token> tokens;
+  std::size_t offset = 0;
+  while (offset < source.size()) {
+    std::size_t end = source.find(u8' ', offset);
+    if (end == std::u8string_view::npos) {
+      end = source.size();
+    }
+    const std::u8string_view word = source.substr(offset, end - offset);
+    base::TokenKind kind = base::TokenKind::kIdentifier;
+    if (word == u8"if") {
+      kind = base::TokenKind::kIf;
+    } else if (word == u8"else") {
+      kind = base::TokenKind::kElse;
+    } else if (word == u8"match") {
+      kind = base::TokenKind::kMatch;
+    } else if (word == u8"{") {
+      kind = base::TokenKind::kLeftBrace;
+    } else if (word == u8"}") {
+      kind = base::TokenKind::kRightBrace;
+    } else if (word == u8"->") {
+      kind = base::TokenKind::kArrow;
+    } else if (word == u8":=") {
+      kind = base::TokenKind::kColonEqual;
+    } else if (word == u8";") {
+      kind = base::TokenKind::kSemicolon;
+    } else if (u8'0' <= word[0] && word[0] <= u8'9') {
+      kind = base::TokenKind::kDecimal;
+    }
+    tokens.emplace_back(kind, offset, word.size());
+    offset = end + 1;
+  }
+  tokens.emplace_back(base::TokenKind::kEof, source.size(), 0);
+
+  const unicode::Utf8FileId id =
+      file_manager.register_virtual_file(std::u8string(source));
+  return base::TokenStream(std::move(tokens), &file_manager, id);
+}
+
+// reads payloads of a parsed context back as text
+struct PayloadReader {
+  ast::Context& context;
+  std::u8string_view source;
+
+  std::u8string_view literal(ast::NodeId id) const {
+    const ast::Node& node = context.arena<ast::Node>()[id];
+    EXPECT_EQ(node.kind, ast::NodeKind::kLiteralExpression);
+    if (node.kind != ast::NodeKind::kLiteralExpression) {
+      return {};
+    }
+    const auto& payload =
+        context.arena<ast::LiteralExpressionPayload>()[node.payload_id];
+    return source.substr(payload.lexeme_offset, payload.lexeme_length);
+  }
+
+  // the only node of a block, e.g. `{ 2 }`
+  ast::NodeId block_value(
+      ast::PayloadId<ast::BlockExpressionPayload> block) const {
+    const auto& payload =
+        context.arena<ast::BlockExpressionPayload>()[block.id];
+    const auto body = context.children(payload.body_nodes_range);
+    EXPECT_EQ(body.size(), 1u);
+    return body.empty() ? ast::kInvalidNodeId : body[0];
+  }
+
+  template <typename T>
+  std::vector<T> range(ast::PayloadRange<T> range) const {
+    std::vector<T> payloads;
+    for (uint32_t i = 0; i < range.size; ++i) {
+      payloads.push_back(context.arena<T>()[range.begin.id + i]);
+    }
+    return payloads;
+  }
+};
+
 }  // namespace
 
 TEST(ParserTest, GlobalAssignWithTypeAnnotation) {
@@ -338,6 +428,124 @@ TEST(ParserTest, ParseEmptyModule) {
   parser.expect_ok();
 }
 
+TEST(ParserTest, NestedChildrenAreContiguous) {
+  TestParser parser({
+      base::TokenKind::kModule,     base::TokenKind::kIdentifier,
+      base::TokenKind::kLeftBrace,  base::TokenKind::kModule,
+      base::TokenKind::kIdentifier, base::TokenKind::kLeftBrace,
+      base::TokenKind::kModule,     base::TokenKind::kIdentifier,
+      base::TokenKind::kLeftBrace,  base::TokenKind::kRightBrace,
+      base::TokenKind::kRightBrace, base::TokenKind::kModule,
+      base::TokenKind::kIdentifier, base::TokenKind::kLeftBrace,
+      base::TokenKind::kModule,     base::TokenKind::kIdentifier,
+      base::TokenKind::kLeftBrace,  base::TokenKind::kRightBrace,
+      base::TokenKind::kRightBrace, base::TokenKind::kRightBrace,
+      base::TokenKind::kEof,
+  });
+  // mod outer { mod a { mod c {} } mod b { mod d {} } }
+  // nodes are allocated c, a, d, b, so a and b are not adjacent in the node
+  // arena but still form one contiguous child range
+  std::unique_ptr<ast::Context> context = parser.parse_ok();
+  ASSERT_NE(context, nullptr);
+
+  auto module_children = [&](const ast::Node& node) {
+    EXPECT_EQ(node.kind, ast::NodeKind::kModuleDeclaration);
+    const auto& payload =
+        context->arena<ast::ModuleDeclarationPayload>()[node.payload_id];
+    return context->children(payload.module_nodes_range);
+  };
+
+  const auto& nodes = context->arena<ast::Node>();
+  const ast::Node* outer = nullptr;
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].kind == ast::NodeKind::kModuleDeclaration &&
+        module_children(nodes[i]).size() == 2) {
+      outer = &nodes[i];
+    }
+  }
+  ASSERT_NE(outer, nullptr);
+
+  const auto children = module_children(*outer);
+  ASSERT_EQ(children.size(), 2u);
+  for (const ast::NodeId child : children) {
+    const auto grandchildren = module_children(nodes[child]);
+    ASSERT_EQ(grandchildren.size(), 1u);
+    EXPECT_TRUE(module_children(nodes[grandchildren[0]]).empty());
+  }
+  EXPECT_NE(children[1], children[0] + 1);
+}
+
+TEST(ParserTest, NestedIfBranchesKeepTheirOrder) {
+  // the inner if allocates its branches while the outer one is between its
+  // second and third branch, so the outer range has to be copied together
+  constexpr std::u8string_view kSource =
+      u8"v := if 1 { 2 } else if 3 { if 4 { 5 } else if 6 { 7 } else { 8 } }"
+      u8" else { 9 }";
+  TestParser parser(tokens_of(kSource));
+  std::unique_ptr<ast::Context> context = parser.parse_ok();
+  ASSERT_NE(context, nullptr);
+  const PayloadReader reader{*context, kSource};
+
+  // 6 branches plus the 3 copied ones of the outer if
+  EXPECT_EQ(context->arena<ast::IfBranchPayload>().size(), 9u);
+  const auto& ifs = context->arena<ast::IfExpressionPayload>();
+  ASSERT_EQ(ifs.size(), 2u);
+  // the inner if is finished first
+  const auto inner = reader.range(ifs[0].branches_range);
+  const auto outer = reader.range(ifs[1].branches_range);
+
+  ASSERT_EQ(outer.size(), 3u);
+  EXPECT_EQ(reader.literal(outer[0].condition), u8"1");
+  EXPECT_EQ(reader.literal(reader.block_value(outer[0].block)), u8"2");
+  EXPECT_EQ(reader.literal(outer[1].condition), u8"3");
+  const ast::NodeId nested = reader.block_value(outer[1].block);
+  EXPECT_EQ(context->arena<ast::Node>()[nested].kind,
+            ast::NodeKind::kIfExpression);
+  EXPECT_EQ(outer[2].condition, ast::kInvalidNodeId);
+  EXPECT_EQ(reader.literal(reader.block_value(outer[2].block)), u8"9");
+
+  ASSERT_EQ(inner.size(), 3u);
+  EXPECT_EQ(reader.literal(inner[0].condition), u8"4");
+  EXPECT_EQ(reader.literal(reader.block_value(inner[0].block)), u8"5");
+  EXPECT_EQ(reader.literal(inner[1].condition), u8"6");
+  EXPECT_EQ(reader.literal(reader.block_value(inner[1].block)), u8"7");
+  EXPECT_EQ(inner[2].condition, ast::kInvalidNodeId);
+  EXPECT_EQ(reader.literal(reader.block_value(inner[2].block)), u8"8");
+}
+
+TEST(ParserTest, NestedMatchArmsKeepTheirOrder) {
+  constexpr std::u8string_view kSource =
+      u8"v := match 0 { 1 -> 2 3 -> match 4 { 5 -> 6 7 -> 8 } 9 -> 10 }";
+  TestParser parser(tokens_of(kSource));
+  std::unique_ptr<ast::Context> context = parser.parse_ok();
+  ASSERT_NE(context, nullptr);
+  const PayloadReader reader{*context, kSource};
+
+  // 5 arms plus the 3 copied ones of the outer match
+  EXPECT_EQ(context->arena<ast::MatchArmPayload>().size(), 8u);
+  const auto& matches = context->arena<ast::MatchExpressionPayload>();
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(reader.literal(matches[0].expression), u8"4");
+  EXPECT_EQ(reader.literal(matches[1].expression), u8"0");
+  const auto inner = reader.range(matches[0].arms_range);
+  const auto outer = reader.range(matches[1].arms_range);
+
+  ASSERT_EQ(outer.size(), 3u);
+  EXPECT_EQ(reader.literal(outer[0].pattern), u8"1");
+  EXPECT_EQ(reader.literal(outer[0].expression), u8"2");
+  EXPECT_EQ(reader.literal(outer[1].pattern), u8"3");
+  EXPECT_EQ(context->arena<ast::Node>()[outer[1].expression].kind,
+            ast::NodeKind::kMatchExpression);
+  EXPECT_EQ(reader.literal(outer[2].pattern), u8"9");
+  EXPECT_EQ(reader.literal(outer[2].expression), u8"10");
+
+  ASSERT_EQ(inner.size(), 2u);
+  EXPECT_EQ(reader.literal(inner[0].pattern), u8"5");
+  EXPECT_EQ(reader.literal(inner[0].expression), u8"6");
+  EXPECT_EQ(reader.literal(inner[1].pattern), u8"7");
+  EXPECT_EQ(reader.literal(inner[1].expression), u8"8");
+}
+
 TEST(ParserTest, ParseConstantDeclaration) {
   TestParser parser({
       base::TokenKind::kConstant,
@@ -352,6 +560,76 @@ TEST(ParserTest, ParseConstantDeclaration) {
   parser.expect_ok();
 }
 
+TEST(ParserTest, UsesLexerSymbolsAndLiteralOffsets) {
+  // xyz := 42
+  const unicode::Utf8FileId id =
+      file_manager.register_virtual_file(u8"xyz := 42");
+  std::vector<base::Token> tokens;
+  tokens.emplace_back(base::TokenKind::kIdentifier, 0, 3);
+  tokens.emplace_back(base::TokenKind::kColonEqual, 4, 2);
+  tokens.emplace_back(base::TokenKind::kDecimal, 7, 2);
+  tokens.emplace_back(base::TokenKind::kEof, 9, 0);
+
+  // the parser must take the interned id instead of reading the lexeme
+  const base::StringId symbol = interner.intern("not_xyz");
+  ASSERT_TRUE(tokens[0].set_symbol(symbol));
+
+  TestParser parser(base::TokenStream(std::move(tokens), &file_manager, id));
+  std::unique_ptr<ast::Context> context = parser.parse_ok();
+  ASSERT_NE(context, nullptr);
+
+  ASSERT_EQ(context->arena<ast::IdentifierPayload>().size(), 1u);
+  EXPECT_EQ(context->arena<ast::IdentifierPayload>()[0].id, symbol);
+
+  ASSERT_EQ(context->arena<ast::LiteralExpressionPayload>().size(), 1u);
+  const auto& literal = context->arena<ast::LiteralExpressionPayload>()[0];
+  EXPECT_EQ(file_manager.file(id).content_u8().substr(literal.lexeme_offset,
+                                                      literal.lexeme_length),
+            u8"42");
+}
+
+TEST(ParserTest, ParsesStreamingInput) {
+  constexpr std::size_t kStatements = 200;
+  std::u8string source;
+  for (std::size_t i = 0; i < kStatements; ++i) {
+    const std::string statement = "v := " + std::to_string(i) + " ; ";
+    source.append(statement.begin(), statement.end());
+  }
+  source.pop_back();
+
+  // the same tokens pulled through a ring buffer far smaller than the input
+  const base::TokenStream all = tokens_of(source);
+  std::size_t pulled = 0;
+  base::TokenStream streaming(
+      [&all, &pulled]() {
+        const base::Token& token = all.at(pulled++);
+        return base::Token(token.kind(), token.offset(), token.length());
+      },
+      &file_manager, all.file_id(), 64);
+  ASSERT_TRUE(streaming.is_streaming());
+
+  TestParser expected(tokens_of(source));
+  TestParser streamed(std::move(streaming));
+  std::unique_ptr<ast::Context> expected_context = expected.parse_ok();
+  std::unique_ptr<ast::Context> streamed_context = streamed.parse_ok();
+  ASSERT_NE(expected_context, nullptr);
+  ASSERT_NE(streamed_context, nullptr);
+  EXPECT_EQ(pulled, all.size());
+
+  ASSERT_EQ(streamed_context->roots().size(), kStatements);
+  EXPECT_EQ(streamed_context->roots(), expected_context->roots());
+  const PayloadReader expected_reader{*expected_context, source};
+  const PayloadReader streamed_reader{*streamed_context, source};
+  for (std::size_t i = 0; i < kStatements; ++i) {
+    const auto& expected_assign =
+        expected_context->arena<ast::AssignStatementPayload>()[i];
+    const auto& streamed_assign =
+        streamed_context->arena<ast::AssignStatementPayload>()[i];
+    EXPECT_EQ(streamed_reader.literal(streamed_assign.value_expression),
+              expected_reader.literal(expected_assign.value_expression));
+  }
+}
+
 TEST(ParserErrorTest, MissingFunctionBody) {
   TestParser parser({
       base::TokenKind::kFunction,
@@ -513,6 +791,34 @@ TEST(ParserErrorTest, MissingFieldType) {
   });
 }
 
+TEST(ParserErrorTest, ErrorsRecordTheirRecoveryRegion) {
+  // a := ; b := 1;
+  const unicode::Utf8FileId id =
+      file_manager.register_virtual_file(u8"a := ; b := 1;");
+  std::vector<base::Token> tokens;
+  tokens.emplace_back(base::TokenKind::kIdentifier, 0, 1);
+  tokens.emplace_back(base::TokenKind::kColonEqual, 2, 2);
+  tokens.emplace_back(base::TokenKind::kSemicolon, 5, 1);
+  tokens.emplace_back(base::TokenKind::kIdentifier, 7, 1);
+  tokens.emplace_back(base::TokenKind::kColonEqual, 9, 2);
+  tokens.emplace_back(base::TokenKind::kDecimal, 12, 1);
+  tokens.emplace_back(base::TokenKind::kSemicolon, 13, 1);
+  tokens.emplace_back(base::TokenKind::kEof, 14, 0);
+
+  TestParser parser(base::TokenStream(std::move(tokens), &file_manager, id));
+  auto result = parser.parser.parse_all(false);
+  ASSERT_TRUE(result.is_err());
+  const auto errors = std::move(result).unwrap_err();
+  ASSERT_FALSE(errors.empty());
+
+  const diagnostic::DiagnosticEntry& first = errors[0];
+  ASSERT_TRUE(first.has_recovery_region());
+  ASSERT_FALSE(first.labels().empty());
+  const core::SourceLocation& start = first.labels()[0].range().start();
+  EXPECT_EQ(first.recovery_end().line(), 1u);
+  EXPECT_GT(first.recovery_end().column(), start.column());
+}
+
 TEST(ParserErrorTest, MultipleErrors) {
   TestParser parser({
       base::TokenKind::kStatic,
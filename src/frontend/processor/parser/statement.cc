@@ -51,7 +51,7 @@ Parser::Result<ast::NodeId> Parser::parse_statement() {
               std::move(
                   Eb(diagnostic::Severity::kError,
                      diagnostic::DiagnosticId::kUnexpectedToken)
-                      .label(stream_->file_id(), peek().range(),
+                      .label(stream_->file_id(), range_of(peek()),
                              i18n::TranslationKey::
                                  kDiagnosticParserUnexpectedToken,
                              diagnostic::LabelMarkerType::kEmphasis,
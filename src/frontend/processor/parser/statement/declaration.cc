@@ -84,7 +84,7 @@ Parser::Result<ast::NodeId> Parser::parse_decl_stmt() {
               Eb(diagnostic::Severity::kError,
                  diagnostic::DiagnosticId::kExpectedButFound)
                   .label(
-                      stream_->file_id(), token.range(),
+                      stream_->file_id(), range_of(token),
                       i18n::TranslationKey::kDiagnosticParserExpectedButFound,
                       diagnostic::LabelMarkerType::kEmphasis,
                       {translator_->translate(
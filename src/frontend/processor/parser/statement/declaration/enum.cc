@@ -30,8 +30,7 @@ Parser::Result<R> Parser::parse_enumeration_decl_stmt(Sad attribute) {
     return err<R>(std::move(left_r));
   }
 
-  PayloadId<ast::EnumVariantPayload> first_variant;
-  uint32_t variants_count = 0;
+  ScratchScope variants(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBrace)) {
     auto enum_variant_r = parse_enum_variant();
@@ -39,10 +38,7 @@ Parser::Result<R> Parser::parse_enumeration_decl_stmt(Sad attribute) {
       return err<R>(std::move(enum_variant_r));
     }
 
-    if (variants_count == 0) {
-      first_variant = std::move(enum_variant_r).unwrap();
-    }
-    ++variants_count;
+    variants.push(std::move(enum_variant_r).unwrap().id);
 
     if (!check(base::TokenKind::kComma)) {
       break;
@@ -58,7 +54,8 @@ Parser::Result<R> Parser::parse_enumeration_decl_stmt(Sad attribute) {
 
   return ok(context_->alloc_payload(ast::EnumerationDeclarationPayload{
       .name = std::move(enumeration_name_r).unwrap(),
-      .variants_range = {.begin = first_variant, .size = variants_count},
+      .variants_range = context_->alloc_payload_range<ast::EnumVariantPayload>(
+          variants.ids()),
       .storage_attribute = attribute,
   }));
 }
@@ -44,8 +44,7 @@ Parser::Result<R> Parser::parse_impl_decl_stmt(Sad attribute) {
     return err<R>(std::move(left_r));
   }
 
-  NodeId first_fn = ast::kInvalidNodeId;
-  uint32_t func_count = 0;
+  ScratchScope functions(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBrace)) {
     auto fn_decl_r = parse_decl_stmt();
@@ -53,10 +52,7 @@ Parser::Result<R> Parser::parse_impl_decl_stmt(Sad attribute) {
       return err<R>(std::move(fn_decl_r));
     }
 
-    if (func_count == 0) {
-      first_fn = std::move(fn_decl_r).unwrap();
-    }
-    ++func_count;
+    functions.push(std::move(fn_decl_r).unwrap());
   }
 
   auto right_r = consume(base::TokenKind::kRightBrace, true);
@@ -67,7 +63,7 @@ Parser::Result<R> Parser::parse_impl_decl_stmt(Sad attribute) {
   return ok(context_->alloc_payload(ast::ImplementationDeclarationPayload{
       .target_name = target_name,
       .trait_name = trait_name,
-      .function_definition_range = {.begin = first_fn, .size = func_count},
+      .function_definition_range = context_->alloc_children(functions.ids()),
       .storage_attribute = attribute,
   }));
 }
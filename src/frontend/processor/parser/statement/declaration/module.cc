@@ -27,8 +27,7 @@ Parser::Result<R> Parser::parse_module_decl_stmt(Sad attribute) {
     return err<R>(std::move(left_r));
   }
 
-  NodeId first_node = ast::kInvalidNodeId;
-  uint32_t nodes_count = 0;
+  ScratchScope nodes(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBrace)) {
     auto stmt_r = parse_statement();
@@ -36,10 +35,7 @@ Parser::Result<R> Parser::parse_module_decl_stmt(Sad attribute) {
       return err<R>(std::move(stmt_r));
     }
 
-    if (nodes_count == 0) {
-      first_node = std::move(stmt_r).unwrap();
-    }
-    ++nodes_count;
+    nodes.push(std::move(stmt_r).unwrap());
   }
 
   auto right_r = consume(base::TokenKind::kRightBrace, true);
@@ -49,7 +45,7 @@ Parser::Result<R> Parser::parse_module_decl_stmt(Sad attribute) {
 
   return ok(context_->alloc_payload(ast::ModuleDeclarationPayload{
       .name = std::move(module_name_r).unwrap(),
-      .module_nodes_range = {.begin = first_node, .size = nodes_count},
+      .module_nodes_range = context_->alloc_children(nodes.ids()),
       .storage_attribute = attribute,
   }));
 }
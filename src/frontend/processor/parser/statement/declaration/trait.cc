@@ -28,8 +28,7 @@ Parser::Result<R> Parser::parse_trait_decl_stmt(Sad attribute) {
     return err<R>(std::move(left_r));
   }
 
-  NodeId first_fn = ast::kInvalidNodeId;
-  uint32_t func_count = 0;
+  ScratchScope functions(&scratch_);
 
   while (!eof() && !check(base::TokenKind::kRightBrace)) {
     auto fn_decl_r = parse_decl_stmt();
@@ -37,10 +36,7 @@ Parser::Result<R> Parser::parse_trait_decl_stmt(Sad attribute) {
       return err<R>(std::move(fn_decl_r));
     }
 
-    if (func_count == 0) {
-      first_fn = std::move(fn_decl_r).unwrap();
-    }
-    ++func_count;
+    functions.push(std::move(fn_decl_r).unwrap());
   }
 
   auto right_r = consume(base::TokenKind::kRightBrace, true);
@@ -50,7 +46,7 @@ Parser::Result<R> Parser::parse_trait_decl_stmt(Sad attribute) {
 
   return ok(context_->alloc_payload(ast::TraitDeclarationPayload{
       .name = std::move(trait_name_r).unwrap(),
-      .function_declare_range = {.begin = first_fn, .size = func_count},
+      .function_declare_range = context_->alloc_children(functions.ids()),
       .storage_attribute = attribute,
   }));
 }
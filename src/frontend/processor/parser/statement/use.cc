@@ -20,19 +20,15 @@ Parser::Result<R> Parser::parse_use_stmt() {
   next_non_whitespace();
 
   // TODO: support more path specification pattern like rust
-  PayloadId<ast::PathExpressionPayload> first_id;
-  uint32_t paths_count;
+  ScratchScope paths(&scratch_);
   if (check(base::TokenKind::kLeftBrace)) {
     // use { some_path::some_func, some_path2::some_func2 }
-    paths_count = 0;
     while (!eof() && !check(base::TokenKind::kRightBrace)) {
       auto path_r = parse_path_expr();
       if (path_r.is_err()) {
         return err<R>(std::move(path_r));
-      } else if (paths_count == 0) {
-        first_id = std::move(path_r).unwrap();
       }
-      ++paths_count;
+      paths.push(std::move(path_r).unwrap().id);
 
       if (!check(base::TokenKind::kComma)) {
         break;
@@ -42,16 +38,17 @@ Parser::Result<R> Parser::parse_use_stmt() {
     }
   } else {
     // use std::some_func
-    paths_count = 1;
     auto path_r = parse_path_expr();
     if (path_r.is_err()) {
       return err<R>(std::move(path_r));
     }
-    first_id = std::move(path_r).unwrap();
+    paths.push(std::move(path_r).unwrap().id);
   }
 
   return ok(context_->alloc_payload(ast::UseStatementPayload{
-      .use_paths_range = {.begin = first_id, .size = paths_count}}));
+      .use_paths_range =
+          context_->alloc_payload_range<ast::PathExpressionPayload>(
+              paths.ids())}));
 }
 
 }  // namespace parser
@@ -4,14 +4,17 @@
 
 #include "frontend/processor/resolver/resolver.h"
 
+#include <cstddef>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "core/check.h"
+#include "frontend/base/data/arena_profile.h"
 #include "frontend/base/string/string_interner.h"
 #include "frontend/data/ast/base/node.h"
 #include "frontend/data/ast/payload/statement.h"
+#include "frontend/data/ast/walk.h"
 #include "frontend/data/hir/payload/common.h"
 #include "frontend/processor/resolver/symbol/symbol_table.h"
 #include "unicode/utf8/file_manager.h"
@@ -20,17 +23,28 @@ namespace resolver {
 
 void Resolver::init(base::StringInterner* interner,
                     std::unique_ptr<ast::Context> ast_context) {
+  std::vector<std::unique_ptr<ast::Context>> ast_contexts;
+  ast_contexts.emplace_back(std::move(ast_context));
+  init(interner, std::move(ast_contexts));
+}
+
+void Resolver::init(base::StringInterner* interner,
+                    std::vector<std::unique_ptr<ast::Context>>&& ast_contexts) {
   DCHECK_EQ(status_, Status::kNotInitialized);
 
   interner_ = interner;
-  ast_ctx_ = std::move(ast_context);
+  ast_contexts_ = std::move(ast_contexts);
+  lowered_.assign(ast_contexts_.size(), true);
   hir_ctx_ = hir::Context::create();
   value_table_ = std::make_unique<SymbolTable>(interner_);
   type_table_ = std::make_unique<SymbolTable>(interner_);
   module_table_ = std::make_unique<SymbolTable>(interner_);
 
   DCHECK(interner_);
-  DCHECK(ast_ctx_);
+  DCHECK(!ast_contexts_.empty());
+  for (const auto& ast_context : ast_contexts_) {
+    DCHECK(ast_context);
+  }
   DCHECK(hir_ctx_);
   DCHECK(value_table_);
   DCHECK(type_table_);
@@ -42,14 +56,49 @@ void Resolver::init(base::StringInterner* interner,
 void Resolver::analyze() {
   DCHECK_EQ(status_, Status::kReadyToAnalyze);
 
-  register_root_declarations();
+  // declarations of every file are visible before any body is lowered
+  for (const auto& ast_context : ast_contexts_) {
+    ast_ctx_ = ast_context.get();
+    register_root_declarations();
+  }
+
+  for (std::size_t i = 0; i < ast_contexts_.size(); ++i) {
+    if (!lowered_[i]) {
+      continue;
+    }
+    ast_ctx_ = ast_contexts_[i].get();
+    lower_all();
+  }
+  ast_ctx_ = nullptr;
+}
+
+void Resolver::skip_lowering(std::size_t index) {
+  DCHECK_EQ(status_, Status::kReadyToAnalyze);
+  DCHECK_LT(index, lowered_.size());
+  lowered_[index] = false;
+}
+
+void Resolver::reserve_hir(const base::ArenaProfile& profile) {
+  DCHECK_EQ(status_, Status::kReadyToAnalyze);
+  hir_ctx_->reserve_from(profile, ast_node_count());
+}
+
+void Resolver::record_hir_usage(base::ArenaProfile* profile) {
+  DCHECK(profile);
+  hir_ctx_->record_usage(profile, ast_node_count());
+}
 
-  lower_all();
+std::size_t Resolver::ast_node_count() const {
+  std::size_t count = 0;
+  for (const auto& ast_context : ast_contexts_) {
+    count += ast_context->arena<ast::Node>().size();
+  }
+  return count;
 }
 
 void Resolver::register_root_declarations() {
   const auto& n = nodes();
-  for (ast::NodeId i = 0; i < n.size(); ++i) {
+  ast::for_each_reachable_node(ast_ctx_, [&](ast::NodeId i) {
     const ast::Node& node = n[i];
 
     switch (node.kind) {
@@ -65,12 +114,12 @@ void Resolver::register_root_declarations() {
 
       default: break;
     }
-  }
+  });
 }
 
 void Resolver::lower_all() {
   const auto& n = nodes();
-  for (ast::NodeId i = 0; i < n.size(); ++i) {  // NOLINT
+  ast::for_each_reachable_node(ast_ctx_, [&](ast::NodeId i) {  // NOLINT
     const ast::Node& node = n[i];
 
     switch (node.kind) {
@@ -115,7 +164,7 @@ void Resolver::lower_all() {
 
       default: break;
     }
-  }
+  });
 }
 
 void Resolver::register_function(const ast::Node& node, ast::NodeId /* id */) {
@@ -5,9 +5,12 @@
 #ifndef FRONTEND_PROCESSOR_RESOLVER_RESOLVER_H_
 #define FRONTEND_PROCESSOR_RESOLVER_RESOLVER_H_
 
+#include <cstddef>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "frontend/base/data/arena.h"
 #include "frontend/data/ast/context.h"
 #include "frontend/data/hir/context.h"
 #include "frontend/diagnostic/data/diagnostic_entry.h"
@@ -16,6 +19,7 @@
 #include "unicode/utf8/file_manager.h"
 
 namespace base {
+class ArenaProfile;
 class StringInterner;
 }
 
@@ -42,10 +46,32 @@ class RESOLVER_EXPORT Resolver {
   void init(base::StringInterner* interner,
             std::unique_ptr<ast::Context> ast_context);
 
+  // resolves several files as one program. every context must have its
+  // identifiers interned into `interner`.
+  void init(base::StringInterner* interner,
+            std::vector<std::unique_ptr<ast::Context>>&& ast_contexts);
+
+  // the context at `index` only contributes its declarations, its bodies
+  // are not lowered. for files unchanged since a run that already checked
+  // them. call between init() and analyze().
+  void skip_lowering(std::size_t index);
+
   void analyze();
 
+  // pre-sizes the hir arenas for the total ast node count. call between
+  // init() and analyze().
+  void reserve_hir(const base::ArenaProfile& profile);
+  void record_hir_usage(base::ArenaProfile* profile);
+
+  inline std::vector<diagnostic::DiagnosticEntry> take_errors() {
+    return std::move(errors_);
+  }
+
  private:
+  // both walk the current context from its roots, so nodes left behind by
+  // re-parsed items are neither declared nor lowered
   void lower_all();
+  std::size_t ast_node_count() const;
 
   void register_root_declarations();
   void register_function(const ast::Node& node, ast::NodeId id);
@@ -57,11 +83,15 @@ class RESOLVER_EXPORT Resolver {
   void register_module(const ast::Node& node, ast::NodeId id);
   void register_redirect(const ast::Node& node, ast::NodeId id);
 
-  inline const std::vector<ast::Node>& nodes() {
-    return ast_ctx_->arena<ast::Node>().buffer();
+  inline const base::Arena<ast::Node>& nodes() {
+    return ast_ctx_->arena<ast::Node>();
   }
 
-  std::unique_ptr<ast::Context> ast_ctx_ = nullptr;
+  std::vector<std::unique_ptr<ast::Context>> ast_contexts_;
+  // per context, whether lower_all() runs over it
+  std::vector<bool> lowered_;
+  // the context currently being visited
+  ast::Context* ast_ctx_ = nullptr;
   std::unique_ptr<hir::Context> hir_ctx_ = nullptr;
   std::unique_ptr<SymbolTable> value_table_ = nullptr;
   std::unique_ptr<SymbolTable> type_table_ = nullptr;
@@ -6,6 +6,7 @@
 #define I18N_BASE_TRANSLATION_UTIL_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <string_view>
 
 namespace i18n {
@@ -57,6 +58,16 @@ enum class TranslationKey : uint8_t;
 
 using FormatArgs = std::array<std::string_view, kMaxFormatArgsCount>;
 
+// marks the last segment of a message, which has no placeholder after it
+constexpr const uint8_t kNoFormatArg = 0xff;
+
+// a piece of a message as split by //src/build/scripts/i18n_gen.py: literal
+// text, then the placeholder for argument `arg` unless it is kNoFormatArg
+struct FormatSegment {
+  std::string_view text;
+  uint8_t arg;
+};
+
 }  // namespace i18n
 
 #endif  // I18N_BASE_TRANSLATION_UTIL_H_
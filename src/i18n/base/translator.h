@@ -8,10 +8,11 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
-#include <format>
+#include <cstdint>
+#include <cstring>
 #include <span>
 #include <string>
-#include <utility>
+#include <string_view>
 
 #include "core/check.h"
 #include "i18n/base/data/language_id.h"
@@ -22,6 +23,9 @@
 
 namespace i18n {
 
+static_assert(kFormatArgSlotCount <= kMaxFormatArgsCount,
+              "a message has more placeholders than kMaxFormatArgsCount");
+
 struct TranslatorConfig {
   LanguageId primary_language = LanguageId::kDefault;
 
@@ -111,23 +115,63 @@ class I18N_EXPORT Translator {
     return translate_with_fallback(key_index);
   }
 
-  inline void translate_fmt_to(TranslationKey key,
-                               char* buf,
-                               const FormatArgs& args,
-                               uint8_t args_count) const {
-    const char* raw = translate(key);
-    const std::string_view fmt = raw;
-    switch (args_count) {
-      case 0: vformat_to_helper<0>(buf, fmt, args); return;
-      case 1: vformat_to_helper<1>(buf, fmt, args); return;
-      case 2: vformat_to_helper<2>(buf, fmt, args); return;
-      case 3: vformat_to_helper<3>(buf, fmt, args); return;
-      case 4: vformat_to_helper<4>(buf, fmt, args); return;
-      case 5: vformat_to_helper<5>(buf, fmt, args); return;
-      default: return;
+  // calls `append(std::string_view)` with each piece of the translation of
+  // `key` in order, its placeholders replaced by `args`. placeholders past
+  // `args_count` expand to nothing.
+  template <typename Append>
+  inline void translate_fmt_each(TranslationKey key,
+                                 const FormatArgs& args,
+                                 uint8_t args_count,
+                                 Append&& append) const {
+    const std::size_t key_index = static_cast<std::size_t>(key);
+    DCHECK_LT(key_index, kTranslationKeyCount);
+    const std::size_t string_index = string_index_with_fallback(key_index);
+    if (string_index == kNoStringIndex) {
+      append(std::string_view(kMissingString));
+      return;
+    }
+
+    const std::size_t arg_count =
+        std::min<std::size_t>(args_count, kMaxFormatArgsCount);
+    const std::size_t end = kFormatSegmentOffsets[string_index + 1];
+    for (std::size_t i = kFormatSegmentOffsets[string_index]; i < end; ++i) {
+      const FormatSegment& segment = kFormatSegments[i];
+      append(segment.text);
+      if (segment.arg < arg_count) {
+        append(args[segment.arg]);
+      }
     }
   }
 
+  // formats into `buf`, cutting the result at `buf_size - 1` bytes on a utf-8
+  // boundary. the result is always nul terminated, returns its size.
+  inline std::size_t translate_fmt_to(TranslationKey key,
+                                      char* buf,
+                                      std::size_t buf_size,
+                                      const FormatArgs& args,
+                                      uint8_t args_count) const {
+    DCHECK_GT(buf_size, 0u);
+    std::size_t size = 0;
+    bool truncated = false;
+    translate_fmt_each(key, args, args_count, [&](std::string_view piece) {
+      if (truncated) {
+        return;
+      }
+      std::size_t n = piece.size();
+      if (n > buf_size - 1 - size) {
+        n = buf_size - 1 - size;
+        while (n > 0 && (static_cast<uint8_t>(piece[n]) & 0xc0) == 0x80) {
+          --n;
+        }
+        truncated = true;
+      }
+      std::memcpy(buf + size, piece.data(), n);
+      size += n;
+    });
+    buf[size] = '\0';
+    return size;
+  }
+
   // convenience factory functions
   static inline Translator create(LanguageId primary_lang) {
     return Translator(TranslatorConfig::create_default(primary_lang));
@@ -148,32 +192,45 @@ class I18N_EXPORT Translator {
  private:
   // main fallback translation logic
   constexpr const char* translate_with_fallback(std::size_t key_index) const {
+    const std::size_t string_index = string_index_with_fallback(key_index);
+    if (string_index == kNoStringIndex) {
+      return kMissingString;
+    }
+    return kStringTable[string_index];
+  }
+
+  // index into kStringTable of the translation to use
+  constexpr std::size_t string_index_with_fallback(
+      std::size_t key_index) const {
     // 1. try primary language
-    const char* result = translate_by_lang(config_.primary_language, key_index);
-    if (result && !is_string_empty(result, config_.skip_empty_strings)) {
+    std::size_t result =
+        string_index_by_lang(config_.primary_language, key_index);
+    if (result != kNoStringIndex &&
+        !is_string_empty(kStringTable[result], config_.skip_empty_strings)) {
       return result;
     }
 
     // 2. try fallback languages in priority order
     for (std::size_t i = 0; i < config_.fallback_count; ++i) {
       const LanguageId fallback_lang = config_.fallback_languages[i];
-      result = translate_by_lang(fallback_lang, key_index);
-      if (result && !is_string_empty(result, config_.skip_empty_strings)) {
+      result = string_index_by_lang(fallback_lang, key_index);
+      if (result != kNoStringIndex &&
+          !is_string_empty(kStringTable[result], config_.skip_empty_strings)) {
         return result;
       }
     }
 
     // 3. final fallback to default language
-    result = translate_by_lang(LanguageId::kDefault, key_index);
-    if (result) {
+    result = string_index_by_lang(LanguageId::kDefault, key_index);
+    if (result != kNoStringIndex) {
       return result;
     }
 
     DCHECK(false);
 
-    // 4. final fallback - return key name as string for debugging
+    // 4. final fallback - kMissingString for debugging
     // this should never happen in properly configured translations
-    return "<?>";
+    return kNoStringIndex;
   }
 
   // check if a string is considered "empty" based on config
@@ -181,38 +238,24 @@ class I18N_EXPORT Translator {
     return skip_empty && (str == nullptr || str[0] == '\0');
   }
 
-  // get translation from specific language table
-  static constexpr const char* translate_by_lang(LanguageId lang_id,
-                                                 std::size_t key_index) {
+  // get the kStringTable index of a translation from specific language table
+  static constexpr std::size_t string_index_by_lang(LanguageId lang_id,
+                                                    std::size_t key_index) {
     const std::size_t lang_index = static_cast<std::size_t>(lang_id);
 
     if (lang_index >= kTranslationTables.size()) {
-      return nullptr;
+      return kNoStringIndex;
     }
 
     if (key_index >= kTranslationKeyCount) {
-      return nullptr;
+      return kNoStringIndex;
     }
 
-    const std::size_t string_index = kTranslationTables[lang_index][key_index];
-    return kStringTable[string_index];
+    return kTranslationTables[lang_index][key_index];
   }
 
-  template <std::size_t N, typename... Args>
-  void vformat_to_helper(char* out_buf,
-                         std::string_view fmt,
-                         const FormatArgs& args,
-                         Args&&... current_args) const {
-    if constexpr (N > 0) {
-      vformat_to_helper<N - 1>(out_buf, fmt, args,
-                               std::forward<Args>(current_args)...,
-                               args[sizeof...(Args)]);
-    } else {
-      std::vformat_to(
-          out_buf, fmt,
-          std::make_format_args((std::forward<Args>(current_args))...));
-    }
-  }
+  static constexpr const std::size_t kNoStringIndex = SIZE_MAX;
+  static constexpr const char* kMissingString = "<?>";
 
   TranslatorConfig config_;
 };
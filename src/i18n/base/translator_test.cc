@@ -4,6 +4,10 @@
 
 #include "i18n/base/translator.h"
 
+#include <cstddef>
+#include <string>
+#include <string_view>
+
 #include "gtest/gtest.h"
 #include "i18n/base/data/language_id.h"
 
@@ -30,4 +34,52 @@ TEST(TranslatorTest, KeyAsString) {
   EXPECT_EQ((tr.translate<"compilation.success">()), "compilation successful");
 }
 
+TEST(TranslatorTest, FormatReplacesPlaceholders) {
+  Translator tr(TranslatorConfig::create_default(LanguageId::kEnUs));
+  const FormatArgs args = {"`i32`", "`;`"};
+  char buf[64];
+  const std::size_t size = tr.translate_fmt_to(
+      TranslationKey::kDiagnosticParserExpectedButFound, buf, sizeof(buf),
+      args, 2);
+  EXPECT_EQ(std::string_view(buf, size), "expected `i32`, but found `;`");
+  EXPECT_EQ(buf[size], '\0');
+
+  tr.set_language(LanguageId::kJaJp);
+  std::string out;
+  tr.translate_fmt_each(TranslationKey::kDiagnosticParserExpectedButFound,
+                        args, 2,
+                        [&out](std::string_view piece) { out += piece; });
+  EXPECT_EQ(out, "`i32`を予期しましたが、`;`が見つかりました");
+}
+
+TEST(TranslatorTest, FormatWithoutArgsLeavesPlaceholdersEmpty) {
+  Translator tr(TranslatorConfig::create_default(LanguageId::kEnUs));
+  char buf[64];
+  const std::size_t size = tr.translate_fmt_to(
+      TranslationKey::kDiagnosticParserConflictingStorageSpecifiers, buf,
+      sizeof(buf), {"`mut`"}, 1);
+  EXPECT_EQ(std::string_view(buf, size), "cannot specify `mut` and  together");
+}
+
+TEST(TranslatorTest, FormatTruncatesToBuffer) {
+  Translator tr(TranslatorConfig::create_default(LanguageId::kEnUs));
+  const std::string long_arg(300, 'x');
+  const FormatArgs args = {long_arg, long_arg};
+  char buf[16];
+  const std::size_t size = tr.translate_fmt_to(
+      TranslationKey::kDiagnosticParserExpectedButFound, buf, sizeof(buf),
+      args, 2);
+  EXPECT_EQ(size, sizeof(buf) - 1);
+  EXPECT_EQ(std::string_view(buf, size), "expected xxxxxx");
+  EXPECT_EQ(buf[size], '\0');
+
+  // a multi-byte character that does not fit is dropped whole
+  tr.set_language(LanguageId::kJaJp);
+  const FormatArgs short_args = {"ab", "cd"};
+  const std::size_t ja_size = tr.translate_fmt_to(
+      TranslationKey::kDiagnosticParserExpectedButFound, buf, sizeof(buf),
+      short_args, 2);
+  EXPECT_EQ(std::string_view(buf, ja_size), "abを予期し");
+}
+
 }  // namespace i18n
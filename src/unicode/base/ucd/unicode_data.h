@@ -25,6 +25,24 @@ extern const std::size_t kXIDContinueCount;
 extern const UnicodeRange kWhiteSpace[];
 extern const std::size_t kWhiteSpaceCount;
 
+// two-stage bitmaps for the properties queried on every lexed codepoint.
+// (codepoint >> kUnicodeBitmapBlockBits) indexes a table of deduplicated
+// 256-bit blocks, so a lookup is two loads and a bit test.
+constexpr const uint32_t kUnicodeBitmapBlockBits = 8;
+constexpr const std::size_t kUnicodeBitmapIndexSize =
+    0x110000 >> kUnicodeBitmapBlockBits;
+
+struct UnicodeBitmapBlock {
+  uint64_t words[(1u << kUnicodeBitmapBlockBits) / 64];
+};
+
+extern const uint8_t kXIDStartIndex[kUnicodeBitmapIndexSize];
+extern const UnicodeBitmapBlock kXIDStartBlocks[];
+extern const uint8_t kXIDContinueIndex[kUnicodeBitmapIndexSize];
+extern const UnicodeBitmapBlock kXIDContinueBlocks[];
+extern const uint8_t kWhiteSpaceIndex[kUnicodeBitmapIndexSize];
+extern const UnicodeBitmapBlock kWhiteSpaceBlocks[];
+
 // General categories
 extern const UnicodeRange kDecimalNumber[];  // Nd
 extern const std::size_t kDecimalNumberCount;
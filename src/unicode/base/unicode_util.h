@@ -57,6 +57,19 @@ inline constexpr bool is_in_ranges(const UnicodeRange* ranges,
   return false;
 }
 
+// o(1) lookup into the two-stage bitmaps generated by ucd_gen.py
+inline constexpr bool is_in_bitmap(const uint8_t* index,
+                                   const UnicodeBitmapBlock* blocks,
+                                   char32_t codepoint) {
+  if (codepoint > kFourBytesMax) [[unlikely]] {
+    return false;
+  }
+  const UnicodeBitmapBlock& block =
+      blocks[index[codepoint >> kUnicodeBitmapBlockBits]];
+  const uint32_t bit = codepoint & ((1u << kUnicodeBitmapBlockBits) - 1);
+  return (block.words[bit >> 6] >> (bit & 63)) & 1u;
+}
+
 inline constexpr bool is_ascii(char32_t codepoint) {
   return codepoint <= kAsciiMax;
 }
@@ -173,11 +186,29 @@ inline constexpr bool generate_id_continue(int i) {
   return generate_alnum(i) || i == '_';
 }
 
+// same as AsciiTable but packed into two words, so the whole table fits in
+// 16 bytes
+template <bool (*Generator)(int)>
+struct AsciiBitmap {
+  uint64_t bits[2] = {};
+  constexpr AsciiBitmap() {
+    for (int i = 0; i < 128; ++i) {
+      bits[i >> 6] |= static_cast<uint64_t>(Generator(i)) << (i & 63);
+    }
+  }
+
+  constexpr bool operator[](char32_t c) const {
+    return c < 128 && ((bits[c >> 6] >> (c & 63)) & 1u);
+  }
+};
+
 constexpr auto kAsciiLetterTable = AsciiTable<generate_letter>{};
 constexpr auto kAsciiDigitTable = AsciiTable<generate_digit>{};
 constexpr auto kAsciiAlnumTable = AsciiTable<generate_alnum>{};
 constexpr auto kAsciiIdStartTable = AsciiTable<generate_id_start>{};
 constexpr auto kAsciiIdContinueTable = AsciiTable<generate_id_continue>{};
+constexpr auto kAsciiIdStartBitmap = AsciiBitmap<generate_id_start>{};
+constexpr auto kAsciiIdContinueBitmap = AsciiBitmap<generate_id_continue>{};
 
 #if ENABLE_AVX2
 bool is_ascii_letters_bulk_avx2(const char32_t* codepoints,
@@ -223,10 +254,10 @@ inline constexpr bool is_xid_start(char32_t codepoint) {
 #if ENABLE_X86_ASM
     return detail::is_ascii_letter_x86(codepoint) || codepoint == '_';
 #else
-    return detail::kAsciiIdStartTable[codepoint];
+    return detail::kAsciiIdStartBitmap[codepoint];
 #endif
   }
-  return is_in_ranges(kXIDStart, kXIDStartCount, codepoint);
+  return is_in_bitmap(kXIDStartIndex, kXIDStartBlocks, codepoint);
 }
 
 inline constexpr bool is_xid_continue(char32_t codepoint) {
@@ -234,32 +265,41 @@ inline constexpr bool is_xid_continue(char32_t codepoint) {
 #if ENABLE_X86_ASM
     return detail::is_ascii_alnum_x86(codepoint) || codepoint == '_';
 #else
-    return detail::kAsciiIdContinueTable[codepoint];
+    return detail::kAsciiIdContinueBitmap[codepoint];
 #endif
   }
-  return is_in_ranges(kXIDContinue, kXIDContinueCount, codepoint);
+  return is_in_bitmap(kXIDContinueIndex, kXIDContinueBlocks, codepoint);
+}
+
+// {' ', '\t', '\n', '\r', '\f', '\v'}, for ascii codepoints only
+inline constexpr bool is_ascii_whitespace(char32_t codepoint) {
+  // bitwise whitespace detection:
+  // = {0x20, 0x09, 0x0A, 0x0D, 0x0C, 0x0B}
+  constexpr const uint64_t whitespace_mask = (1ull << 0x20) | (1ull << 0x09) |
+                                             (1ull << 0x0A) | (1ull << 0x0D) |
+                                             (1ull << 0x0C) | (1ull << 0x0B);
+  return codepoint <= 0x20 && ((whitespace_mask >> codepoint) & 1u);
+}
+
+// LF, VT, FF and CR, for ascii codepoints only
+inline constexpr bool is_ascii_newline(char32_t codepoint) {
+  // bitwise newline detection:
+  // LF: 0x0A, VT: 0x0B, FF: 0x0C, CR: 0x0D
+  constexpr const uint64_t ascii_newline_mask =
+      (1ull << 0x0A) | (1ull << 0x0B) | (1ull << 0x0C) | (1ull << 0x0D);
+  return codepoint <= 0x0D && (ascii_newline_mask & (1ull << codepoint));
 }
 
 inline constexpr bool is_unicode_whitespace(char32_t codepoint) {
   if (is_ascii(codepoint)) [[likely]] {
-    // bitwise whitespace detection:
-    // {' ', '\t', '\n', '\r', '\f', '\v'}
-    // = {0x20, 0x09, 0x0A, 0x0D, 0x0C, 0x0B}
-    constexpr const uint64_t whitespace_mask = (1ull << 0x20) | (1ull << 0x09) |
-                                               (1ull << 0x0A) | (1ull << 0x0D) |
-                                               (1ull << 0x0C) | (1ull << 0x0B);
-    return codepoint <= 0x20 && ((whitespace_mask >> codepoint) & 1u);
+    return is_ascii_whitespace(codepoint);
   }
-  return is_in_ranges(kWhiteSpace, kWhiteSpaceCount, codepoint);
+  return is_in_bitmap(kWhiteSpaceIndex, kWhiteSpaceBlocks, codepoint);
 }
 
 inline constexpr bool is_unicode_newline(char32_t codepoint) {
   if (is_ascii(codepoint)) [[likely]] {
-    // bitwise newline detection:
-    // LF: 0x0A, VT: 0x0B, FF: 0x0C, CR: 0x0D
-    constexpr const uint64_t ascii_newline_mask =
-        (1ull << 0x0A) | (1ull << 0x0B) | (1ull << 0x0C) | (1ull << 0x0D);
-    return codepoint <= 0x0D && (ascii_newline_mask & (1ull << codepoint));
+    return is_ascii_newline(codepoint);
   }
 
   // unicode newlines
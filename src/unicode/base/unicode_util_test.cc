@@ -0,0 +1,68 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "unicode/base/unicode_util.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "unicode/base/ucd/unicode_data.h"
+
+namespace unicode {
+
+namespace {
+
+// the bitmaps and the range tables are both generated by ucd_gen.py from the
+// same data, so they must agree on every codepoint
+void expect_bitmap_matches_ranges(const uint8_t* index,
+                                  const UnicodeBitmapBlock* blocks,
+                                  const UnicodeRange* ranges,
+                                  std::size_t count) {
+  std::size_t mismatches = 0;
+  for (char32_t c = 0; c <= kFourBytesMax; ++c) {
+    if (is_in_bitmap(index, blocks, c) != is_in_ranges(ranges, count, c)) {
+      // report the first few only, a broken table would flood the output
+      ADD_FAILURE_AT(__FILE__, __LINE__)
+          << "mismatch at U+" << std::hex << static_cast<uint32_t>(c);
+      if (++mismatches == 8) {
+        return;
+      }
+    }
+  }
+  EXPECT_FALSE(is_in_bitmap(index, blocks, kFourBytesMax + 1));
+}
+
+}  // namespace
+
+TEST(UnicodeUtilTest, XidStartBitmapMatchesRanges) {
+  expect_bitmap_matches_ranges(kXIDStartIndex, kXIDStartBlocks, kXIDStart,
+                               kXIDStartCount);
+}
+
+TEST(UnicodeUtilTest, XidContinueBitmapMatchesRanges) {
+  expect_bitmap_matches_ranges(kXIDContinueIndex, kXIDContinueBlocks,
+                               kXIDContinue, kXIDContinueCount);
+}
+
+TEST(UnicodeUtilTest, WhiteSpaceBitmapMatchesRanges) {
+  expect_bitmap_matches_ranges(kWhiteSpaceIndex, kWhiteSpaceBlocks,
+                               kWhiteSpace, kWhiteSpaceCount);
+}
+
+TEST(UnicodeUtilTest, NonAsciiClassifiersMatchRanges) {
+  // beyond ascii, whose paths accept '_' as an identifier start on purpose
+  for (char32_t c = kAsciiMax + 1; c <= kFourBytesMax; ++c) {
+    ASSERT_EQ(is_xid_start(c), is_in_ranges(kXIDStart, kXIDStartCount, c))
+        << std::hex << static_cast<uint32_t>(c);
+    ASSERT_EQ(is_xid_continue(c),
+              is_in_ranges(kXIDContinue, kXIDContinueCount, c))
+        << std::hex << static_cast<uint32_t>(c);
+    ASSERT_EQ(is_unicode_whitespace(c),
+              is_in_ranges(kWhiteSpace, kWhiteSpaceCount, c))
+        << std::hex << static_cast<uint32_t>(c);
+  }
+}
+
+}  // namespace unicode
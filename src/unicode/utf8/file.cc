@@ -4,6 +4,7 @@
 
 #include "unicode/utf8/file.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -14,6 +15,32 @@
 
 namespace unicode {
 
+Utf8File::Utf8File(Utf8File&& other) noexcept {
+  *this = std::move(other);
+}
+
+Utf8File& Utf8File::operator=(Utf8File&& other) noexcept {
+  if (this != &other) {
+    file_name_ = std::move(other.file_name_);
+    mapping_ = std::move(other.mapping_);
+    owned_content_ = std::move(other.owned_content_);
+    line_ends_ = std::move(other.line_ends_);
+    status_ = other.status_;
+    rebind_content();
+    other.rebind_content();
+  }
+  return *this;
+}
+
+void Utf8File::rebind_content() {
+  if (mapping_.valid()) {
+    content_ = std::u8string_view(
+        reinterpret_cast<const char8_t*>(mapping_.data()), mapping_.size());
+  } else {
+    content_ = owned_content_;
+  }
+}
+
 void Utf8File::init(std::u8string_view file_name) {
   DCHECK_EQ(status_, Status::kNotInitialized);
   file_name_ = file_name;
@@ -24,23 +51,101 @@ void Utf8File::init_and_load(std::u8string_view file_name,
                              std::u8string&& content) {
   DCHECK_EQ(status_, Status::kNotInitialized);
   init(file_name);
-  content_ = std::move(content);
+  owned_content_ = std::move(content);
+  rebind_content();
   line_ends_ = core::index_newlines(core::to_string_view(content_));
   status_ = Status::kLoaded;
 }
 
 void Utf8File::load() {
   DCHECK_EQ(status_, Status::kNotLoaded);
-  content_ = core::read_file_utf8(file_name_.c_str());
+  const char* path = reinterpret_cast<const char*>(file_name_.c_str());
+  mapping_ = core::MappedFile(path);
+  if (!mapping_.valid()) {
+    owned_content_ = core::read_file_utf8(file_name_.c_str());
+  }
+  rebind_content();
   line_ends_ = core::index_newlines(core::to_string_view(content_));
   status_ = Status::kLoaded;
 }
 
 void Utf8File::unload() {
   DCHECK_EQ(status_, Status::kLoaded);
-  content_ = std::u8string();
+  mapping_ = core::MappedFile();
+  owned_content_ = std::u8string();
+  rebind_content();
   line_ends_ = std::vector<std::size_t>();
   status_ = Status::kNotLoaded;
 }
 
+void Utf8File::apply_edit(const TextEdit& edit) {
+  DCHECK_EQ(status_, Status::kLoaded);
+  DCHECK_LE(edit.offset + edit.length, content_.size());
+
+  if (mapping_.valid()) {
+    owned_content_ = std::u8string(content_);
+    mapping_ = core::MappedFile();
+  }
+  const std::size_t old_size = owned_content_.size();
+  owned_content_.replace(edit.offset, edit.length, edit.replacement);
+  rebind_content();
+
+  // newlines before the edit stay, the ones in the replacement are added and
+  // the ones behind it move. the trailing end-of-content entry (see
+  // core::index_newlines) is recomputed.
+  const std::size_t edit_end = edit.offset + edit.length;
+  auto first_changed =
+      std::lower_bound(line_ends_.begin(), line_ends_.end(), edit.offset);
+  auto first_kept = std::lower_bound(first_changed, line_ends_.end(), edit_end);
+
+  std::vector<std::size_t> tail;
+  for (std::size_t i = 0; i < edit.replacement.size(); ++i) {
+    if (edit.replacement[i] == '\n') {
+      tail.push_back(edit.offset + i);
+    }
+  }
+  for (auto it = first_kept; it != line_ends_.end(); ++it) {
+    if (*it != old_size) {
+      tail.push_back(static_cast<std::size_t>(
+          static_cast<std::ptrdiff_t>(*it) + edit.delta()));
+    }
+  }
+
+  line_ends_.erase(first_changed, line_ends_.end());
+  line_ends_.insert(line_ends_.end(), tail.begin(), tail.end());
+  if (line_ends_.empty() || line_ends_.back() != content_.size() - 1) {
+    line_ends_.push_back(content_.size());
+  }
+}
+
+std::size_t Utf8File::line_of(std::size_t offset) const {
+  DCHECK_EQ(status_, Status::kLoaded);
+  // first line whose end is at or after the offset
+  const auto it =
+      std::lower_bound(line_ends_.begin(), line_ends_.end(), offset);
+  return static_cast<std::size_t>(it - line_ends_.begin()) + 1;
+}
+
+core::SourceLocation Utf8File::location(std::size_t offset) const {
+  DCHECK_EQ(status_, Status::kLoaded);
+  DCHECK_LE(offset, content_.size());
+  const std::size_t line_no = line_of(offset);
+  const std::size_t line_start =
+      (line_no == 1) ? 0 : line_ends_[line_no - 2] + 1;
+  return core::SourceLocation(
+      line_no, codepoint_count(line_start, offset - line_start) + 1);
+}
+
+std::size_t Utf8File::codepoint_count(std::size_t offset,
+                                      std::size_t len) const {
+  DCHECK_EQ(status_, Status::kLoaded);
+  DCHECK_LE(offset + len, content_.size());
+  std::size_t count = 0;
+  for (std::size_t i = offset; i < offset + len; ++i) {
+    // skip continuation bytes
+    count += (content_[i] & 0xC0) != 0x80;
+  }
+  return count;
+}
+
 }  // namespace unicode
@@ -5,16 +5,32 @@
 #ifndef UNICODE_UTF8_FILE_H_
 #define UNICODE_UTF8_FILE_H_
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "core/base/file_util.h"
+#include "core/base/source_location.h"
 #include "core/check.h"
 #include "frontend/diagnostic/data/diagnostic_id.h"
 #include "unicode/base/unicode_export.h"
 
 namespace unicode {
 
+// replaces `length` bytes at byte `offset` with `replacement`
+struct TextEdit {
+  std::size_t offset = 0;
+  std::size_t length = 0;
+  std::u8string replacement;
+
+  // byte count change of the content
+  inline std::ptrdiff_t delta() const {
+    return static_cast<std::ptrdiff_t>(replacement.size()) -
+           static_cast<std::ptrdiff_t>(length);
+  }
+};
+
 class UNICODE_EXPORT Utf8File {
  public:
   enum class Status : uint8_t {
@@ -30,17 +46,27 @@ class UNICODE_EXPORT Utf8File {
   Utf8File(const Utf8File&) = delete;
   Utf8File& operator=(const Utf8File&) = delete;
 
-  Utf8File(Utf8File&&) noexcept = default;
-  Utf8File& operator=(Utf8File&&) noexcept = default;
+  // content_ may view the owned string's inline buffer, so it is rebound
+  Utf8File(Utf8File&& other) noexcept;
+  Utf8File& operator=(Utf8File&& other) noexcept;
 
   void init(std::u8string_view file_name);
   void init_and_load(std::u8string_view file_name, std::u8string&& content);
 
+  // maps regular files read-only and reads everything else (pipes, character
+  // devices, empty files) into an owned buffer
   void load();
   void unload();
 
+  // applies `edit` to the loaded content. a mapped file is copied into an
+  // owned buffer first. only the line index behind the edit is rebuilt.
+  void apply_edit(const TextEdit& edit);
+
   inline bool loaded() const { return status_ == Status::kLoaded; }
 
+  // true if the content is a view into a memory mapping of the file
+  inline bool mapped() const { return mapping_.valid(); }
+
   inline std::u8string_view file_name_u8() const {
     DCHECK_EQ(status_, Status::kLoaded);
     return file_name_;
@@ -85,14 +111,29 @@ class UNICODE_EXPORT Utf8File {
     return line_ends_.size();
   }
 
+  // 1 indexed line containing the byte offset
+  std::size_t line_of(std::size_t offset) const;
+
+  // 1 indexed line and column (in codepoints) of the byte offset.
+  // offsets are only resolved lazily, e.g. when rendering diagnostics.
+  core::SourceLocation location(std::size_t offset) const;
+
+  // number of codepoints in [offset, offset + len)
+  std::size_t codepoint_count(std::size_t offset, std::size_t len) const;
+
   inline std::string_view slice(std::size_t pos, std::size_t len) const {
     DCHECK_EQ(status_, Status::kLoaded);
     return std::string_view(reinterpret_cast<const char*>(&content_[pos]), len);
   }
 
  private:
+  void rebind_content();
+
   std::u8string file_name_ = u8"";
-  std::u8string content_ = u8"";
+  // backing storage of content_, either the mapping or the owned buffer
+  core::MappedFile mapping_;
+  std::u8string owned_content_ = u8"";
+  std::u8string_view content_;
   std::vector<std::size_t> line_ends_;
 
   Status status_ = Status::kNotInitialized;
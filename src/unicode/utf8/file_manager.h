@@ -6,9 +6,9 @@
 #define UNICODE_UTF8_FILE_MANAGER_H_
 
 #include <cstdint>
+#include <deque>
 #include <limits>
 #include <string>
-#include <vector>
 
 #include "unicode/base/unicode_export.h"
 #include "unicode/utf8/file.h"
@@ -38,6 +38,9 @@ class UNICODE_EXPORT Utf8FileManager {
 
   inline void load(Utf8FileId id) { file_mutable(id).load(); }
   inline void unload(Utf8FileId id) { file_mutable(id).unload(); }
+  inline void apply_edit(Utf8FileId id, const TextEdit& edit) {
+    file_mutable(id).apply_edit(edit);
+  }
 
   inline const Utf8File& file(Utf8FileId id) const {
     DCHECK_GE(id, 0);
@@ -62,7 +65,9 @@ class UNICODE_EXPORT Utf8FileManager {
     return files_.at(id);
   }
 
-  std::vector<Utf8File> files_;
+  // deque keeps registered files (and their content) at a stable address so
+  // streams can hold views into them while more files are registered.
+  std::deque<Utf8File> files_;
 };
 
 }  // namespace unicode
@@ -0,0 +1,82 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "unicode/utf8/file.h"
+
+#include <string>
+#include <utility>
+
+#include "core/base/source_location.h"
+#include "gtest/gtest.h"
+#include "unicode/utf8/file_manager.h"
+
+namespace unicode {
+
+namespace {
+
+// checks the incrementally updated line index against a fresh one
+void expect_same_lines(const Utf8File& edited, std::u8string content) {
+  Utf8FileManager manager;
+  const Utf8File& fresh =
+      manager.file(manager.register_virtual_file(std::move(content)));
+
+  ASSERT_EQ(edited.content_u8(), fresh.content_u8());
+  ASSERT_EQ(edited.line_count(), fresh.line_count());
+  for (std::size_t i = 1; i <= fresh.line_count(); ++i) {
+    EXPECT_EQ(edited.line_u8(i), fresh.line_u8(i)) << "line " << i;
+  }
+  for (std::size_t offset = 0; offset <= fresh.content_u8().size(); ++offset) {
+    const core::SourceLocation expected = fresh.location(offset);
+    const core::SourceLocation actual = edited.location(offset);
+    EXPECT_EQ(actual.line(), expected.line()) << "offset " << offset;
+    EXPECT_EQ(actual.column(), expected.column()) << "offset " << offset;
+  }
+}
+
+}  // namespace
+
+TEST(Utf8FileTest, ApplyEditReplacesContent) {
+  Utf8FileManager manager;
+  const Utf8FileId id = manager.register_virtual_file(u8"abc\ndef\nghi");
+
+  manager.apply_edit(id, {.offset = 4, .length = 3, .replacement = u8"xy"});
+  expect_same_lines(manager.file(id), u8"abc\nxy\nghi");
+}
+
+TEST(Utf8FileTest, ApplyEditUpdatesLineIndex) {
+  Utf8FileManager manager;
+  const Utf8FileId id = manager.register_virtual_file(u8"a\nb\nc\nd\n");
+
+  // split a line
+  manager.apply_edit(id, {.offset = 2, .length = 0, .replacement = u8"x\ny"});
+  expect_same_lines(manager.file(id), u8"a\nx\nyb\nc\nd\n");
+
+  // join lines
+  manager.apply_edit(id, {.offset = 1, .length = 4, .replacement = u8""});
+  expect_same_lines(manager.file(id), u8"ab\nc\nd\n");
+
+  // drop the trailing newline
+  manager.apply_edit(id, {.offset = 6, .length = 1, .replacement = u8""});
+  expect_same_lines(manager.file(id), u8"ab\nc\nd");
+
+  // and add it back
+  manager.apply_edit(id, {.offset = 6, .length = 0, .replacement = u8"\n"});
+  expect_same_lines(manager.file(id), u8"ab\nc\nd\n");
+}
+
+TEST(Utf8FileTest, ApplyEditOnEmptyAndMultibyteContent) {
+  Utf8FileManager manager;
+  const Utf8FileId id = manager.register_virtual_file(u8"");
+
+  manager.apply_edit(id, {.offset = 0, .length = 0, .replacement = u8"あ\n😊"});
+  expect_same_lines(manager.file(id), u8"あ\n😊");
+
+  manager.apply_edit(id, {.offset = 0, .length = 4, .replacement = u8""});
+  expect_same_lines(manager.file(id), u8"😊");
+
+  manager.apply_edit(id, {.offset = 0, .length = 4, .replacement = u8""});
+  expect_same_lines(manager.file(id), u8"");
+}
+
+}  // namespace unicode
@@ -0,0 +1,208 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "unicode/utf8/scan.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if ENABLE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace unicode {
+
+namespace {
+
+inline bool is_ascii_blank(char8_t b) {
+  return b == ' ' || b == '\t';
+}
+
+inline bool is_ascii_id_continue(char8_t b) {
+  const char8_t lower = b | 0x20;
+  return ('0' <= b && b <= '9') || ('a' <= lower && lower <= 'z') || b == '_';
+}
+
+// 0x0A-0x0D, or the lead byte of NEL (C2 85) / LS, PS (E2 80 A8, E2 80 A9)
+inline bool may_start_newline(char8_t b) {
+  return (0x0A <= b && b <= 0x0D) || b == 0xC2 || b == 0xE2;
+}
+
+template <typename IsStop>
+inline std::size_t scan_until_scalar(const char8_t* input,
+                                     std::size_t size,
+                                     IsStop is_stop) {
+  std::size_t i = 0;
+  while (i < size && !is_stop(input[i])) {
+    ++i;
+  }
+  return i;
+}
+
+#if ENABLE_AVX2
+
+inline __m256i load(const char8_t* ptr) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+
+// signed compare: lo < chunk < hi. bytes >= 0x80 are negative and never match
+// a range within ascii.
+inline __m256i in_range(__m256i chunk, char lo, char hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(lo - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), chunk));
+}
+
+inline uint32_t to_mask(__m256i cmp) {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(cmp));
+}
+
+template <typename StopMask, typename IsStop>
+inline std::size_t scan_until_avx2(const char8_t* input,
+                                   std::size_t size,
+                                   StopMask stop_mask,
+                                   IsStop is_stop) {
+  std::size_t pos = 0;
+  while (pos + 32 <= size) {
+    const uint32_t stop = stop_mask(load(input + pos));
+    if (stop != 0) {
+      return pos + static_cast<std::size_t>(std::countr_zero(stop));
+    }
+    pos += 32;
+  }
+  return pos + scan_until_scalar(input + pos, size - pos, is_stop);
+}
+
+#endif  // ENABLE_AVX2
+
+}  // namespace
+
+std::size_t scan_ascii_blanks(const char8_t* input, std::size_t size) {
+#if ENABLE_AVX2
+  return detail::scan_ascii_blanks_avx2(input, size);
+#else
+  return detail::scan_ascii_blanks_scalar(input, size);
+#endif
+}
+
+std::size_t scan_ascii_id_continue(const char8_t* input, std::size_t size) {
+#if ENABLE_AVX2
+  return detail::scan_ascii_id_continue_avx2(input, size);
+#else
+  return detail::scan_ascii_id_continue_scalar(input, size);
+#endif
+}
+
+std::size_t scan_to_line_end(const char8_t* input, std::size_t size) {
+#if ENABLE_AVX2
+  return detail::scan_to_line_end_avx2(input, size);
+#else
+  return detail::scan_to_line_end_scalar(input, size);
+#endif
+}
+
+std::size_t scan_to_star(const char8_t* input, std::size_t size) {
+#if ENABLE_AVX2
+  return detail::scan_to_star_avx2(input, size);
+#else
+  return detail::scan_to_star_scalar(input, size);
+#endif
+}
+
+namespace detail {
+
+std::size_t scan_ascii_blanks_scalar(const char8_t* input, std::size_t size) {
+  std::size_t i = 0;
+  while (i < size && is_ascii_blank(input[i])) {
+    ++i;
+  }
+  return i;
+}
+
+std::size_t scan_ascii_id_continue_scalar(const char8_t* input,
+                                          std::size_t size) {
+  std::size_t i = 0;
+  while (i < size && is_ascii_id_continue(input[i])) {
+    ++i;
+  }
+  return i;
+}
+
+std::size_t scan_to_line_end_scalar(const char8_t* input, std::size_t size) {
+  return scan_until_scalar(input, size, may_start_newline);
+}
+
+std::size_t scan_to_star_scalar(const char8_t* input, std::size_t size) {
+  return scan_until_scalar(input, size, [](char8_t b) { return b == '*'; });
+}
+
+#if ENABLE_AVX2
+
+std::size_t scan_ascii_blanks_avx2(const char8_t* input, std::size_t size) {
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+
+  std::size_t pos = 0;
+  while (pos + 32 <= size) {
+    const __m256i chunk = load(input + pos);
+    const uint32_t blank = to_mask(_mm256_or_si256(
+        _mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)));
+    if (blank != 0xFFFFFFFFu) {
+      return pos + static_cast<std::size_t>(std::countr_one(blank));
+    }
+    pos += 32;
+  }
+  return pos + scan_ascii_blanks_scalar(input + pos, size - pos);
+}
+
+std::size_t scan_ascii_id_continue_avx2(const char8_t* input,
+                                        std::size_t size) {
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  const __m256i underscore = _mm256_set1_epi8('_');
+
+  std::size_t pos = 0;
+  while (pos + 32 <= size) {
+    const __m256i chunk = load(input + pos);
+    const __m256i lower = _mm256_or_si256(chunk, case_bit);
+    const __m256i id_continue = _mm256_or_si256(
+        _mm256_or_si256(in_range(chunk, '0', '9'), in_range(lower, 'a', 'z')),
+        _mm256_cmpeq_epi8(chunk, underscore));
+    const uint32_t mask = to_mask(id_continue);
+    if (mask != 0xFFFFFFFFu) {
+      return pos + static_cast<std::size_t>(std::countr_one(mask));
+    }
+    pos += 32;
+  }
+  return pos + scan_ascii_id_continue_scalar(input + pos, size - pos);
+}
+
+std::size_t scan_to_line_end_avx2(const char8_t* input, std::size_t size) {
+  const __m256i nel_lead = _mm256_set1_epi8(static_cast<char>(0xC2));
+  const __m256i ls_ps_lead = _mm256_set1_epi8(static_cast<char>(0xE2));
+
+  return scan_until_avx2(
+      input, size,
+      [&](__m256i chunk) {
+        return to_mask(_mm256_or_si256(
+            in_range(chunk, 0x0A, 0x0D),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, nel_lead),
+                            _mm256_cmpeq_epi8(chunk, ls_ps_lead))));
+      },
+      may_start_newline);
+}
+
+std::size_t scan_to_star_avx2(const char8_t* input, std::size_t size) {
+  const __m256i star = _mm256_set1_epi8('*');
+
+  return scan_until_avx2(
+      input, size,
+      [&](__m256i chunk) { return to_mask(_mm256_cmpeq_epi8(chunk, star)); },
+      [](char8_t b) { return b == '*'; });
+}
+
+#endif  // ENABLE_AVX2
+
+}  // namespace detail
+
+}  // namespace unicode
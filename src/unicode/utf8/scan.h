@@ -0,0 +1,57 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef UNICODE_UTF8_SCAN_H_
+#define UNICODE_UTF8_SCAN_H_
+
+#include <cstddef>
+
+#include "unicode/base/unicode_export.h"
+
+namespace unicode {
+
+// bulk scanners over validated utf-8 bytes used to skip whole runs at once.
+// they always stop on a codepoint boundary.
+
+// length of the leading run of ascii ' ' and '\t'
+UNICODE_EXPORT std::size_t scan_ascii_blanks(const char8_t* input,
+                                             std::size_t size);
+
+// length of the leading run of ascii identifier continue characters
+// ([0-9A-Za-z_])
+UNICODE_EXPORT std::size_t scan_ascii_id_continue(const char8_t* input,
+                                                  std::size_t size);
+
+// skips up to the first byte that may start a newline. that is 0x0A-0x0D or
+// the lead byte of NEL (U+0085), LS (U+2028) and PS (U+2029), so the caller
+// must check the codepoint it stopped at.
+UNICODE_EXPORT std::size_t scan_to_line_end(const char8_t* input,
+                                            std::size_t size);
+
+// skips up to the first '*'. block comments are scanned with it across
+// lines, which are resolved from the file's line index when needed.
+UNICODE_EXPORT std::size_t scan_to_star(const char8_t* input,
+                                              std::size_t size);
+
+namespace detail {
+
+std::size_t scan_ascii_blanks_scalar(const char8_t* input, std::size_t size);
+std::size_t scan_ascii_id_continue_scalar(const char8_t* input,
+                                          std::size_t size);
+std::size_t scan_to_line_end_scalar(const char8_t* input, std::size_t size);
+std::size_t scan_to_star_scalar(const char8_t* input, std::size_t size);
+
+#if ENABLE_AVX2
+std::size_t scan_ascii_blanks_avx2(const char8_t* input, std::size_t size);
+std::size_t scan_ascii_id_continue_avx2(const char8_t* input,
+                                        std::size_t size);
+std::size_t scan_to_line_end_avx2(const char8_t* input, std::size_t size);
+std::size_t scan_to_star_avx2(const char8_t* input, std::size_t size);
+#endif  // ENABLE_AVX2
+
+}  // namespace detail
+
+}  // namespace unicode
+
+#endif  // UNICODE_UTF8_SCAN_H_
@@ -0,0 +1,83 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "unicode/utf8/scan.h"
+
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace unicode {
+
+namespace {
+
+std::u8string repeat(std::u8string_view piece, int count) {
+  std::u8string result;
+  for (int i = 0; i < count; ++i) {
+    result += piece;
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(Utf8ScanTest, AsciiBlanks) {
+  const std::u8string input = repeat(u8" \t", 40) + u8"x  ";
+  EXPECT_EQ(scan_ascii_blanks(input.data(), input.size()), 80);
+  EXPECT_EQ(scan_ascii_blanks(input.data(), 0), 0);
+  EXPECT_EQ(scan_ascii_blanks(input.data() + 80, 3), 0);
+}
+
+TEST(Utf8ScanTest, AsciiIdContinue) {
+  const std::u8string input = repeat(u8"aZ_09", 10) + u8"あ";
+  EXPECT_EQ(scan_ascii_id_continue(input.data(), input.size()), 50);
+
+  const std::u8string short_input = u8"abc-d";
+  EXPECT_EQ(scan_ascii_id_continue(short_input.data(), short_input.size()), 3);
+}
+
+TEST(Utf8ScanTest, ToLineEnd) {
+  // 3-byte codepoints straddle the 32-byte block boundaries
+  const std::u8string input = repeat(u8"コメント ", 12) + u8"\r\n";
+  EXPECT_EQ(scan_to_line_end(input.data(), input.size()), input.size() - 2);
+
+  // stops at the lead byte of LINE SEPARATOR
+  const std::u8string ls = repeat(u8"x", 40) + u8"\u2028";
+  EXPECT_EQ(scan_to_line_end(ls.data(), ls.size()), 40);
+}
+
+TEST(Utf8ScanTest, ToStar) {
+  const std::u8string input = repeat(u8"ブロック ", 10) + u8"*/";
+  EXPECT_EQ(scan_to_star(input.data(), input.size()), input.size() - 2);
+
+  // block comments are scanned across lines in one go
+  const std::u8string lines = repeat(u8"line\n", 20) + u8"*";
+  EXPECT_EQ(scan_to_star(lines.data(), lines.size()), lines.size() - 1);
+}
+
+TEST(Utf8ScanTest, MatchesScalar) {
+  const std::u8string input =
+      repeat(u8"  id_1 あ\t/* é */ x ", 8) + u8"\n tail";
+  for (std::size_t start = 0; start < input.size(); ++start) {
+    // only start on codepoint boundaries
+    if ((input[start] & 0xC0) == 0x80) {
+      continue;
+    }
+    const char8_t* ptr = input.data() + start;
+    const std::size_t size = input.size() - start;
+
+    EXPECT_EQ(scan_ascii_blanks(ptr, size),
+              detail::scan_ascii_blanks_scalar(ptr, size));
+    EXPECT_EQ(scan_ascii_id_continue(ptr, size),
+              detail::scan_ascii_id_continue_scalar(ptr, size));
+
+    EXPECT_EQ(scan_to_line_end(ptr, size),
+              detail::scan_to_line_end_scalar(ptr, size));
+    EXPECT_EQ(scan_to_star(ptr, size),
+              detail::scan_to_star_scalar(ptr, size));
+  }
+}
+
+}  // namespace unicode
@@ -4,9 +4,11 @@
 
 #include "unicode/utf8/stream.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "unicode/base/unicode_util.h"
+#include "unicode/utf8/scan.h"
 
 #if ENABLE_AVX2
 #include <immintrin.h>
@@ -14,39 +16,168 @@
 
 namespace unicode {
 
+namespace {
+
+// scalar counterpart of the byte scanners for the pre-decoded buffer
+template <typename IsStop>
+Utf8Stream::CodepointRun scan_codepoints_until(const char32_t* input,
+                                               std::size_t size,
+                                               IsStop is_stop) {
+  Utf8Stream::CodepointRun run;
+  for (; run.codepoints < size && !is_stop(input[run.codepoints]);
+       ++run.codepoints) {
+    run.bytes += utf8_codepoint_length(input[run.codepoints]);
+  }
+  return run;
+}
+
+}  // namespace
+
 Utf8Stream::ErrorCode Utf8Stream::init(Utf8FileManager* file_manager,
-                                       Utf8FileId file_id) {
+                                       Utf8FileId file_id,
+                                       DecodeMode decode_mode,
+                                       bool validate) {
   file_manager_ = file_manager;
   file_id_ = file_id;
+  decode_mode_ = decode_mode;
 
   DCHECK(file_manager_);
   DCHECK_NE(file_id_, kInvalidFileId);
 
   position_ = 0;
-  line_ = 1;
-  column_ = 1;
+  byte_position_ = 0;
+  base_ = 0;
+  window_ = nullptr;
+  ascii_ = false;
   status_ = Status::kInitialized;
 
   if (!file_manager_->has(file_id_)) [[unlikely]] {
     return ErrorCode::kFileNotFound;
   }
 
-  const std::size_t invalid_pos = validate_utf8();
-  if (invalid_pos != 0) [[unlikely]] {
+  if (validate && validate_utf8(&ascii_) != kValidUtf8) [[unlikely]] {
     status_ = Status::kInvalid;
     return ErrorCode::kInvalidUtf8;
   }
 
-  const std::size_t decode_error = decode_content();
-  if (decode_error != 0) [[unlikely]] {
-    status_ = Status::kInvalid;
-    return ErrorCode::kInvalidUtf8;
+  content_ = file().content_u8();
+  codepoints_.clear();
+
+  // codepoint indices are byte offsets, there is nothing to decode
+  if (ascii_) {
+    decode_mode_ = DecodeMode::kOnDemand;
+  }
+
+  if (decode_mode_ == DecodeMode::kPreDecode) {
+    const std::size_t decode_error = decode_content();
+    if (decode_error != 0) [[unlikely]] {
+      status_ = Status::kInvalid;
+      return ErrorCode::kInvalidUtf8;
+    }
+    size_ = codepoints_.size();
+  } else {
+    size_ = content_.size();
   }
 
   status_ = Status::kValid;
   return ErrorCode::kSuccess;
 }
 
+Utf8Stream::ErrorCode Utf8Stream::init(Utf8Window* window) {
+  DCHECK(window);
+  window_ = window;
+  file_manager_ = nullptr;
+  file_id_ = kInvalidFileId;
+  decode_mode_ = DecodeMode::kOnDemand;
+  position_ = 0;
+  byte_position_ = 0;
+  ascii_ = false;
+  codepoints_.clear();
+
+  // the window validates what it reads, an invalid sequence ends its content
+  // and is reported once the stream gets there
+  if (window_->status() == Utf8Window::Status::kNotInitialized ||
+      window_->status() == Utf8Window::Status::kFileNotFound) [[unlikely]] {
+    status_ = Status::kInvalid;
+    return ErrorCode::kFileNotFound;
+  }
+  content_ = window_->content();
+  base_ = window_->begin();
+  size_ = content_.size();
+  status_ = Status::kValid;
+  return ErrorCode::kSuccess;
+}
+
+void Utf8Stream::seek(std::size_t byte_offset) {
+  DCHECK_EQ(status_, Status::kValid);
+  DCHECK_EQ(decode_mode_, DecodeMode::kOnDemand);
+  DCHECK_GE(byte_offset, base_);
+  DCHECK_LE(byte_offset - base_, size_);
+  restore_position({.pos = byte_offset - base_, .byte_pos = byte_offset});
+}
+
+Utf8Window::Status Utf8Stream::slide(std::size_t keep_from) {
+  DCHECK_EQ(status_, Status::kValid);
+  DCHECK(window_);
+  DCHECK_LE(keep_from, byte_position());
+  const std::size_t position = byte_position();
+  const Utf8Window::Status status = window_->slide(keep_from);
+  content_ = window_->content();
+  base_ = window_->begin();
+  size_ = content_.size();
+  position_ = position - base_;
+  return status;
+}
+
+void Utf8Stream::skip_ascii_blanks() {
+  DCHECK_EQ(status_, Status::kValid);
+  if (decode_mode_ == DecodeMode::kOnDemand) {
+    const std::size_t n =
+        scan_ascii_blanks(content_.data() + position_, size_ - position_);
+    position_ += n;
+    return;
+  }
+  advance(scan_codepoints_until(
+      codepoints_.data() + position_, size_ - position_,
+      [](char32_t c) { return c != ' ' && c != '\t'; }));
+}
+
+void Utf8Stream::skip_ascii_id_continue() {
+  DCHECK_EQ(status_, Status::kValid);
+  if (decode_mode_ == DecodeMode::kOnDemand) {
+    const std::size_t n =
+        scan_ascii_id_continue(content_.data() + position_, size_ - position_);
+    position_ += n;
+    return;
+  }
+  advance(scan_codepoints_until(
+      codepoints_.data() + position_, size_ - position_,
+      [](char32_t c) { return !detail::kAsciiIdContinueTable[c]; }));
+}
+
+void Utf8Stream::skip_to_line_end() {
+  DCHECK_EQ(status_, Status::kValid);
+  if (decode_mode_ == DecodeMode::kOnDemand) {
+    position_ +=
+        scan_to_line_end(content_.data() + position_, size_ - position_);
+    return;
+  }
+  advance(scan_codepoints_until(codepoints_.data() + position_,
+                                size_ - position_, is_unicode_newline));
+}
+
+void Utf8Stream::skip_to_star() {
+  DCHECK_EQ(status_, Status::kValid);
+  if (decode_mode_ == DecodeMode::kOnDemand) {
+    position_ +=
+        scan_to_star(content_.data() + position_, size_ - position_);
+    return;
+  }
+  advance(scan_codepoints_until(
+      codepoints_.data() + position_, size_ - position_,
+      [](char32_t c) { return c == '*'; }));
+}
+
 std::size_t Utf8Stream::decode_content() {
   const std::u8string_view content = file().content_u8();
   if (content.empty()) {
@@ -75,27 +206,24 @@ std::size_t Utf8Stream::decode_content() {
   return 0;
 }
 
-// returns 0 if valid or byte index of the invalid byte
-std::size_t Utf8Stream::validate_utf8() const {
+std::size_t Utf8Stream::validate_utf8(bool* ascii) const {
   DCHECK(file_manager_);
   DCHECK_NE(file_id_, kInvalidFileId);
   DCHECK_EQ(status_, Status::kInitialized);
+  DCHECK(ascii);
 
 #if ENABLE_AVX2
-  return validate_utf8_avx2();
+  return validate_utf8_avx2(ascii);
 #else
-  return validate_utf8_scalar(0);
+  return validate_utf8_scalar(0, ascii);
 #endif
 }
 
 #if ENABLE_AVX2
 
-std::size_t Utf8Stream::validate_utf8_avx2() const {
+std::size_t Utf8Stream::validate_utf8_avx2(bool* ascii) const {
   const std::u8string_view content = file().content_u8();
   const std::size_t total_size = content.size();
-  if (total_size == 0) {
-    return 0;  // empty file is valid
-  }
 
   const char8_t* const begin = content.data();
   const char8_t* ptr = begin;
@@ -105,20 +233,16 @@ std::size_t Utf8Stream::validate_utf8_avx2() const {
   const std::size_t simd_bytes = total_size & ~(kBlock - 1);
   const char8_t* simd_end = begin + simd_bytes;
 
-  const __m256i ascii_mask = _mm256_set1_epi8(static_cast<char>(kAsciiMax));
-
   while (ptr < simd_end) {
     const __m256i chunk1 =
         _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
     const __m256i chunk2 =
         _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 32));
 
-    // any byte > 0x7F?
-    const __m256i cmp1 = _mm256_cmpgt_epi8(chunk1, ascii_mask);
-    const __m256i cmp2 = _mm256_cmpgt_epi8(chunk2, ascii_mask);
-    const __m256i combined = _mm256_or_si256(cmp1, cmp2);
-
-    if (_mm256_testz_si256(combined, combined)) {
+    // any byte > 0x7F? those are exactly the bytes with the sign bit set,
+    // which a signed compare against 0x7F would never report
+    const __m256i combined = _mm256_or_si256(chunk1, chunk2);
+    if (_mm256_movemask_epi8(combined) == 0) {
       ptr += kBlock;
       continue;  // all ascii
     }
@@ -127,35 +251,34 @@ std::size_t Utf8Stream::validate_utf8_avx2() const {
     break;
   }
 
-  // if we scanned all full simd blocks and there's no remainder
-  if (ptr == begin + total_size) {
-    return 0;  // all ascii
-  }
-
   // scalar validate remainder (including the block with first non-ascii)
-  return validate_utf8_scalar(static_cast<std::size_t>(ptr - begin));
+  return validate_utf8_scalar(static_cast<std::size_t>(ptr - begin), ascii);
 }
 
 #else
 
-std::size_t Utf8Stream::validate_utf8_avx2() const {
-  return validate_utf8_scalar(0);
+std::size_t Utf8Stream::validate_utf8_avx2(bool* ascii) const {
+  return validate_utf8_scalar(0, ascii);
 }
 
 #endif
 
-std::size_t Utf8Stream::validate_utf8_scalar(std::size_t start_pos) const {
+std::size_t Utf8Stream::validate_utf8_scalar(std::size_t start_pos,
+                                             bool* ascii) const {
   const std::u8string_view content = file().content_u8();
-  const std::size_t total_size = content.size();
-  if (total_size == 0 || start_pos >= total_size) {
-    return 0;  // empty or nothing to validate
-  }
+  *ascii = true;
 
   const char8_t* const begin = content.data();
   const char8_t* const end = begin + content.size();
-  const char8_t* ptr = begin + start_pos;
+  const char8_t* ptr = begin + std::min(start_pos, content.size());
 
   while (ptr < end) {
+    if (*ptr < 0x80) [[likely]] {
+      ++ptr;
+      continue;
+    }
+    *ascii = false;
+
     const std::size_t remaining = static_cast<std::size_t>(end - ptr);
     const auto [codepoint, bytes] = decoder_.decode(ptr, remaining);
 
@@ -166,7 +289,7 @@ std::size_t Utf8Stream::validate_utf8_scalar(std::size_t start_pos) const {
     ptr += bytes;
   }
 
-  return 0;
+  return kValidUtf8;
 }
 
 }  // namespace unicode
@@ -7,12 +7,18 @@
 
 #include <cstddef>
 #include <memory>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "core/base/source_location.h"
 #include "unicode/base/unicode_export.h"
+#include "unicode/base/unicode_util.h"
 #include "unicode/utf8/decoder.h"
 #include "unicode/utf8/file.h"
 #include "unicode/utf8/file_manager.h"
+#include "unicode/utf8/scan.h"
+#include "unicode/utf8/window.h"
 
 namespace unicode {
 
@@ -31,6 +37,17 @@ class UNICODE_EXPORT Utf8Stream {
     kInvalid = 3,
   };
 
+  enum class DecodeMode : uint8_t {
+    // decode the entire content into a char32_t buffer on init.
+    // position() is a codepoint index. ascii content has nothing to decode
+    // and is always walked as in kOnDemand mode, see is_ascii().
+    kPreDecode = 0,
+
+    // walk the utf-8 bytes of the file directly and decode only non-ascii
+    // lead bytes on demand. position() is a byte offset.
+    kOnDemand = 1,
+  };
+
   explicit Utf8Stream() = default;
   ~Utf8Stream() = default;
 
@@ -40,15 +57,29 @@ class UNICODE_EXPORT Utf8Stream {
   Utf8Stream(Utf8Stream&&) noexcept = default;
   Utf8Stream& operator=(Utf8Stream&&) noexcept = default;
 
-  // validates and decodes entire content
-  ErrorCode init(Utf8FileManager* file_manager, Utf8FileId file_id);
+  // validates the entire content, and decodes it up front in kPreDecode mode.
+  // `validate` = false skips the validation for content the caller already
+  // knows to be valid utf-8, e.g. a file after an ascii-only edit. is_ascii()
+  // is then false.
+  ErrorCode init(Utf8FileManager* file_manager,
+                 Utf8FileId file_id,
+                 DecodeMode decode_mode = DecodeMode::kPreDecode,
+                 bool validate = true);
+
+  // kOnDemand over a Utf8Window, for input that is not loaded as a whole.
+  // only the resident part of the file is addressable, see slide(). file()
+  // is not available and locations are resolved by the window.
+  ErrorCode init(Utf8Window* window);
 
   inline char32_t peek() const {
     DCHECK_EQ(status_, Status::kValid);
     if (eof()) [[unlikely]] {
       return 0;
     }
-    return codepoints_[position_];
+    if (decode_mode_ == DecodeMode::kPreDecode) {
+      return codepoints_[position_];
+    }
+    return decode_at(position_).first;
   }
 
   inline char32_t peek_at(std::size_t offset) const {
@@ -56,8 +87,19 @@ class UNICODE_EXPORT Utf8Stream {
     if (eof_at(offset)) [[unlikely]] {
       return 0;
     }
-    const std::size_t target_pos = position_ + offset;
-    return codepoints_[target_pos];
+    if (decode_mode_ == DecodeMode::kPreDecode) {
+      return codepoints_[position_ + offset];
+    }
+
+    // offset is in codepoints, skip the preceding ones byte-wise
+    std::size_t target_pos = position_;
+    for (std::size_t i = 0; i < offset; ++i) {
+      target_pos += decode_at(target_pos).second;
+      if (target_pos >= size_) [[unlikely]] {
+        return 0;
+      }
+    }
+    return decode_at(target_pos).first;
   }
 
   inline char32_t next() {
@@ -66,20 +108,38 @@ class UNICODE_EXPORT Utf8Stream {
       return 0;
     }
 
-    const char32_t old = codepoints_[position_];
-
-    // update position tracking
-    ++position_;
-    if (old == '\n') [[unlikely]] {
-      ++line_;
-      column_ = 1;
+    if (decode_mode_ == DecodeMode::kPreDecode) {
+      byte_position_ += utf8_codepoint_length(codepoints_[position_]);
+      ++position_;
     } else {
-      ++column_;
+      // content is validated, the lead byte alone gives the length
+      const char8_t lead = content_[position_];
+      position_ += lead < 0x80 ? 1 : utf8_sequence_length(lead);
     }
-
     return peek();
   }
 
+  // byte-indexed counterparts of peek(), peek_at() and next() for is_ascii()
+  // content, where every byte is a codepoint
+  inline char32_t peek_ascii() const {
+    DCHECK(ascii_);
+    return eof() ? 0 : content_[position_];
+  }
+
+  inline char32_t peek_ascii_at(std::size_t offset) const {
+    DCHECK(ascii_);
+    return eof_at(offset) ? 0 : content_[position_ + offset];
+  }
+
+  inline char32_t next_ascii() {
+    DCHECK(ascii_);
+    if (eof()) [[unlikely]] {
+      return 0;
+    }
+    ++position_;
+    return peek_ascii();
+  }
+
   inline bool consume(char32_t expected) {
     DCHECK_EQ(status_, Status::kValid);
     if (peek() == expected) [[likely]] {
@@ -89,85 +149,192 @@ class UNICODE_EXPORT Utf8Stream {
     return false;
   }
 
-  // bulk consumption for pattern matching
+  // bulk consumption for pattern matching. `length` is in codepoints.
   inline bool consume_sequence(const char32_t* sequence, std::size_t length) {
     DCHECK_EQ(status_, Status::kValid);
-    if (position_ + length > codepoints_.size()) {
-      return false;
-    }
-
-    for (std::size_t i = 0; i < length; ++i) {
-      if (codepoints_[position_ + i] != sequence[i]) {
+    if (decode_mode_ == DecodeMode::kPreDecode) {
+      if (position_ + length > size_) {
         return false;
       }
+      std::size_t bytes = 0;
+      for (std::size_t i = 0; i < length; ++i) {
+        const char32_t c = codepoints_[position_ + i];
+        if (c != sequence[i]) {
+          return false;
+        }
+        bytes += utf8_codepoint_length(c);
+      }
+      advance({.codepoints = length, .bytes = bytes});
+      return true;
     }
 
-    // consume all characters
+    // walk a byte cursor once, rather than decoding from the current
+    // position again for every codepoint
+    std::size_t cursor = position_;
     for (std::size_t i = 0; i < length; ++i) {
-      next();
+      if (cursor >= size_) {
+        return false;
+      }
+      const auto [c, bytes] = decode_at(cursor);
+      if (c != sequence[i]) {
+        return false;
+      }
+      cursor += bytes;
     }
+    position_ = cursor;
     return true;
   }
 
+  // bulk skipping fast paths (see unicode/utf8/scan.h). all but
+  // skip_to_star() stop at a newline.
+  void skip_ascii_blanks();
+  void skip_ascii_id_continue();
+  // stops at a codepoint that may be a newline, check it with peek()
+  void skip_to_line_end();
+  // runs across lines up to the next '*', or eof
+  void skip_to_star();
+
   // position management
   inline std::size_t position() const { return position_; }
-  inline std::size_t line() const { return line_; }
-  inline std::size_t column() const { return column_; }
-  inline bool eof() const { return position_ >= codepoints_.size(); }
-  inline bool eof_at(std::size_t n) const {
-    return position_ + n >= codepoints_.size();
+  // byte offset from the beginning of the file in either decode mode
+  inline std::size_t byte_position() const {
+    return decode_mode_ == DecodeMode::kOnDemand ? base_ + position_
+                                                 : byte_position_;
   }
+  // only offsets are tracked while streaming. line and column are resolved
+  // from the file's line index (a binary search) on demand, e.g. for errors.
+  inline core::SourceLocation location() const {
+    return location_at(byte_position());
+  }
+  inline core::SourceLocation location_at(std::size_t byte_offset) const {
+    return window_ ? window_->location(byte_offset)
+                   : file().location(byte_offset);
+  }
+  inline std::size_t line() const {
+    return window_ ? location().line() : file().line_of(byte_position());
+  }
+  inline std::size_t column() const { return location().column(); }
+  inline bool eof() const { return position_ >= size_; }
+  inline bool eof_at(std::size_t n) const { return position_ + n >= size_; }
 
   struct Position {
-    std::size_t pos;
-    std::size_t line;
-    std::size_t column;
+    std::size_t pos = 0;
+    std::size_t byte_pos = 0;
+  };
+
+  // codepoints skipped in pre-decoded mode and the bytes they take
+  struct CodepointRun {
+    std::size_t codepoints = 0;
+    std::size_t bytes = 0;
   };
 
   inline void reset() {
     DCHECK_EQ(status_, Status::kValid);
+    DCHECK(!window_) << "the start of the file is no longer resident";
     restore_position({});
   }
 
+  // moves to a byte offset on a codepoint boundary. kOnDemand mode only.
+  void seek(std::size_t byte_offset);
+
+  // `length` bytes of the file at `byte_offset`
+  inline std::u8string_view slice(std::size_t byte_offset,
+                                  std::size_t length) const {
+    DCHECK_GE(byte_offset, base_);
+    return content_.substr(byte_offset - base_, length);
+  }
+
+  // windowed streams only. moves the window forward to `keep_from`, a byte
+  // offset at or before the current position, reads what follows and keeps
+  // the position. returns the window's status, which is no longer kValid if
+  // reading stopped.
+  Utf8Window::Status slide(std::size_t keep_from);
+
+  // true while the window has not reached the end of the file, i.e. eof()
+  // may only be the end of the resident content
+  inline bool more_input() const { return window_ && !window_->exhausted(); }
+  inline bool windowed() const { return window_ != nullptr; }
+
+  // empty in kOnDemand mode and for ascii content
   inline const std::vector<char32_t>& codepoints() const { return codepoints_; }
   inline Status status() const { return status_; }
+  // kOnDemand for ascii content regardless of the requested mode
+  inline DecodeMode decode_mode() const { return decode_mode_; }
+  // the content was validated and has no byte above 0x7f. lets callers
+  // specialize for it once instead of checking every codepoint.
+  inline bool is_ascii() const { return ascii_; }
+
+  inline const Utf8Window& window() const {
+    DCHECK(window_);
+    return *window_;
+  }
 
   inline const Utf8File& file() const {
+    DCHECK(!window_) << "windowed streams have no file";
     DCHECK(file_manager_);
     DCHECK_NE(file_id_, kInvalidFileId);
     return file_manager_->loaded_file(file_id_);
   }
 
  private:
-  inline Position save_position() const { return {position_, line_, column_}; }
+  inline Position save_position() const {
+    return {position_, byte_position_};
+  }
 
   inline void restore_position(const Position& pos) {
     position_ = pos.pos;
-    line_ = pos.line;
-    column_ = pos.column;
+    byte_position_ = pos.byte_pos;
+  }
+
+  // pre-decoded mode only, on-demand positions are plain byte offsets
+  inline void advance(const CodepointRun& skipped) {
+    DCHECK_EQ(decode_mode_, DecodeMode::kPreDecode);
+    position_ += skipped.codepoints;
+    byte_position_ += skipped.bytes;
+  }
+
+  // returns (codepoint, byte_count) at the given byte offset.
+  // content is already validated so only the non-ascii path hits the decoder.
+  inline std::pair<char32_t, std::size_t> decode_at(std::size_t pos) const {
+    const char8_t lead = content_[pos];
+    if (lead < 0x80) [[likely]] {
+      return {static_cast<char32_t>(lead), 1};
+    }
+    return Utf8Decoder::decode(content_.data() + pos, size_ - pos);
   }
 
   // pre-decode entire utf-8 content into codepoint buffer
   std::size_t decode_content();
 
-  // returns 0 if valid or byte index of the invalid byte
-  std::size_t validate_utf8() const;
+  static constexpr std::size_t kValidUtf8 = static_cast<std::size_t>(-1);
+
+  // returns kValidUtf8 or the byte index of the first invalid byte. `ascii`
+  // is set to whether the content has no byte above 0x7f.
+  std::size_t validate_utf8(bool* ascii) const;
 
   // use avx2 simd if available
-  std::size_t validate_utf8_avx2() const;
+  std::size_t validate_utf8_avx2(bool* ascii) const;
 
   // start_pos is an offset (in bytes) from beginning of file to start
-  // validating.
-  std::size_t validate_utf8_scalar(std::size_t start_pos = 0) const;
+  // validating, everything before it is known to be ascii.
+  std::size_t validate_utf8_scalar(std::size_t start_pos, bool* ascii) const;
 
   std::vector<char32_t> codepoints_;  // pre-decoded codepoints
+  std::u8string_view content_;        // raw utf-8 content of the file
+  // byte offset of content_ in the file, the window's begin() when windowed
+  std::size_t base_ = 0;
+
+  // number of codepoints in kPreDecode mode, bytes in kOnDemand mode
+  std::size_t size_ = 0;
   std::size_t position_ = 0;
-  std::size_t line_ = 1;
-  std::size_t column_ = 1;
+  std::size_t byte_position_ = 0;  // only tracked in kPreDecode mode
 
   Utf8FileManager* file_manager_ = nullptr;
   Utf8FileId file_id_ = kInvalidFileId;
+  Utf8Window* window_ = nullptr;
   Status status_ = Status::kNotInitialized;
+  DecodeMode decode_mode_ = DecodeMode::kPreDecode;
+  bool ascii_ = false;
 
   Utf8Decoder decoder_;
 };
@@ -8,6 +8,7 @@
 #include <string>
 #include <utility>
 
+#include "core/base/file_util.h"
 #include "gtest/gtest.h"
 #include "unicode/utf8/file_manager.h"
 
@@ -17,10 +18,12 @@ namespace {
 
 Utf8FileManager manager;
 
-Utf8Stream make_stream(std::u8string&& input) {
+Utf8Stream make_stream(
+    std::u8string&& input,
+    Utf8Stream::DecodeMode decode_mode = Utf8Stream::DecodeMode::kPreDecode) {
   Utf8FileId id = manager.register_virtual_file(std::move(input));
   Utf8Stream stream;
-  stream.init(&manager, id);
+  stream.init(&manager, id, decode_mode);
   return stream;
 }
 
@@ -99,6 +102,60 @@ TEST(Utf8StreamTest, Utf8PositionTracking) {
   EXPECT_EQ(stream.column(), 2);
 }
 
+TEST(Utf8StreamTest, OnDemandDecodeNextAndPeek) {
+  Utf8Stream stream =
+      make_stream(u8"aあ\n😊b", Utf8Stream::DecodeMode::kOnDemand);
+
+  EXPECT_EQ(stream.status(), Utf8Stream::Status::kValid);
+  EXPECT_TRUE(stream.codepoints().empty());
+
+  EXPECT_EQ(stream.peek(), 'a');
+  EXPECT_EQ(stream.peek_at(1), 0x3042u);
+  EXPECT_EQ(stream.peek_at(2), '\n');
+  EXPECT_EQ(stream.peek_at(3), 0x1F60Au);
+  EXPECT_EQ(stream.peek_at(4), 'b');
+  EXPECT_EQ(stream.peek_at(5), 0u);
+
+  stream.next();  // 'a'
+  EXPECT_EQ(stream.position(), 1);
+  stream.next();  // 'あ' is 3 bytes
+  EXPECT_EQ(stream.position(), 4);
+  EXPECT_EQ(stream.column(), 3);
+  stream.next();  // '\n'
+  EXPECT_EQ(stream.line(), 2);
+  EXPECT_EQ(stream.column(), 1);
+  EXPECT_EQ(stream.peek(), 0x1F60Au);
+  stream.next();  // '😊' is 4 bytes
+  EXPECT_EQ(stream.position(), 9);
+  EXPECT_EQ(stream.column(), 2);
+  EXPECT_EQ(stream.peek(), 'b');
+  stream.next();
+
+  EXPECT_TRUE(stream.eof());
+}
+
+TEST(Utf8StreamTest, ConsumeSequenceInBothModes) {
+  constexpr char32_t kSequence[] = {0x3042, 'b', 0x1F60A};
+  for (const auto mode : {Utf8Stream::DecodeMode::kPreDecode,
+                          Utf8Stream::DecodeMode::kOnDemand}) {
+    Utf8Stream stream = make_stream(u8"aあb😊c", mode);
+    stream.next();
+
+    // a mismatch part way through consumes nothing
+    constexpr char32_t kMismatch[] = {0x3042, 'b', 'c'};
+    EXPECT_FALSE(stream.consume_sequence(kMismatch, 3));
+    EXPECT_EQ(stream.byte_position(), 1u);
+
+    EXPECT_TRUE(stream.consume_sequence(kSequence, 3));
+    EXPECT_EQ(stream.byte_position(), 9u);
+    EXPECT_EQ(stream.peek(), 'c');
+
+    // running past the end fails
+    EXPECT_FALSE(stream.consume_sequence(kSequence, 3));
+    EXPECT_EQ(stream.peek(), 'c');
+  }
+}
+
 TEST(Utf8StreamTest, InvalidUtf8Handling) {
   // invalid utf8: 0xC0 0xAF (overlong encoding)
   std::u8string input = std::u8string(u8"a") + static_cast<char8_t>(0xC0) +
@@ -115,4 +172,61 @@ TEST(Utf8StreamTest, InvalidUtf8Handling) {
   // EXPECT_EQ(stream.peek(), 'b');
 }
 
+TEST(Utf8StreamTest, ReportsAsciiContent) {
+  Utf8Stream ascii = make_stream(u8"fn main() {}\n");
+  EXPECT_TRUE(ascii.is_ascii());
+  // there is nothing to decode
+  EXPECT_EQ(ascii.decode_mode(), Utf8Stream::DecodeMode::kOnDemand);
+  EXPECT_TRUE(ascii.codepoints().empty());
+  EXPECT_EQ(ascii.peek_ascii(), 'f');
+  EXPECT_EQ(ascii.peek_ascii_at(3), 'm');
+
+  // a non-ascii codepoint behind a whole simd block
+  Utf8Stream utf8 = make_stream(std::u8string(100, 'a') + u8"あ");
+  EXPECT_EQ(utf8.status(), Utf8Stream::Status::kValid);
+  EXPECT_FALSE(utf8.is_ascii());
+  EXPECT_EQ(utf8.decode_mode(), Utf8Stream::DecodeMode::kPreDecode);
+}
+
+TEST(Utf8StreamTest, InvalidUtf8AnywhereIsRejected) {
+  // behind a whole simd block
+  std::u8string late(100, 'a');
+  late[70] = static_cast<char8_t>(0xFF);
+  EXPECT_EQ(make_stream(std::move(late)).status(),
+            Utf8Stream::Status::kInvalid);
+
+  // in the very first byte
+  std::u8string first(100, 'a');
+  first[0] = static_cast<char8_t>(0x80);
+  EXPECT_EQ(make_stream(std::move(first)).status(),
+            Utf8Stream::Status::kInvalid);
+}
+
+TEST(Utf8StreamTest, StreamsFromMappedFile) {
+  core::TempFile file("test_mapped_stream_", "fn 名前\nret");
+  ASSERT_TRUE(file.valid());
+
+  Utf8FileManager file_manager;
+  const std::u8string path(file.path().begin(), file.path().end());
+  Utf8FileId id = file_manager.register_file(path);
+  const Utf8File& loaded = file_manager.loaded_file(id);
+  EXPECT_TRUE(loaded.mapped());
+  EXPECT_EQ(loaded.line_u8(2), u8"ret");
+
+  Utf8Stream stream;
+  ASSERT_EQ(stream.init(&file_manager, id, Utf8Stream::DecodeMode::kOnDemand),
+            Utf8Stream::ErrorCode::kSuccess);
+  stream.next();
+  stream.next();
+  stream.next();
+  EXPECT_EQ(stream.peek(), U'名');
+
+  // registering more files keeps the mapped content in place
+  for (int i = 0; i < 64; ++i) {
+    file_manager.register_virtual_file(u8"x");
+  }
+  EXPECT_EQ(file_manager.file(id).content_u8().data(),
+            stream.file().content_u8().data());
+}
+
 }  // namespace unicode
@@ -0,0 +1,140 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "unicode/utf8/window.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "core/check.h"
+#include "unicode/base/unicode_util.h"
+#include "unicode/utf8/decoder.h"
+
+namespace unicode {
+
+Utf8Window::~Utf8Window() {
+  if (file_) {
+    std::fclose(file_);
+  }
+}
+
+Utf8Window::Status Utf8Window::open(const char* path, std::size_t capacity) {
+  DCHECK_EQ(status_, Status::kNotInitialized);
+  DCHECK_GT(capacity, 0);
+  file_ = std::fopen(path, "rb");
+  if (!file_) {
+    status_ = Status::kFileNotFound;
+    return status_;
+  }
+  capacity_ = capacity;
+  buffer_.resize(capacity_);
+  status_ = Status::kValid;
+  fill();
+  return status_;
+}
+
+Utf8Window::Status Utf8Window::slide(std::size_t keep_from) {
+  DCHECK_NE(status_, Status::kNotInitialized);
+  DCHECK_GE(keep_from, begin());
+  DCHECK_LE(keep_from, end());
+  if (exhausted()) {
+    return status_;
+  }
+
+  // carry the line and column of the new begin() over the dropped bytes
+  const auto dropped_end =
+      std::lower_bound(newlines_.begin(), newlines_.end(), keep_from);
+  if (dropped_end != newlines_.begin()) {
+    first_line_ += static_cast<std::size_t>(dropped_end - newlines_.begin());
+    first_column_ = codepoint_count(*(dropped_end - 1) + 1 - begin_,
+                                    keep_from - begin_);
+  } else {
+    first_column_ += codepoint_count(0, keep_from - begin_);
+  }
+  newlines_.erase(newlines_.begin(), dropped_end);
+
+  const std::size_t drop = keep_from - begin_;
+  std::memmove(buffer_.data(), buffer_.data() + drop, filled_ - drop);
+  filled_ -= drop;
+  valid_ -= drop;
+  begin_ = keep_from;
+
+  if (filled_ == capacity_) {
+    capacity_ *= 2;
+    buffer_.resize(capacity_);
+  }
+  fill();
+  return status_;
+}
+
+core::SourceLocation Utf8Window::location(std::size_t offset) const {
+  DCHECK_GE(offset, begin());
+  DCHECK_LE(offset, end());
+  // the newlines before the offset
+  const auto it = std::lower_bound(newlines_.begin(), newlines_.end(), offset);
+  const std::size_t line =
+      first_line_ + static_cast<std::size_t>(it - newlines_.begin());
+  if (it == newlines_.begin()) {
+    return core::SourceLocation(
+        line, first_column_ + codepoint_count(0, offset - begin_) + 1);
+  }
+  return core::SourceLocation(
+      line, codepoint_count(*(it - 1) + 1 - begin_, offset - begin_) + 1);
+}
+
+void Utf8Window::fill() {
+  while (filled_ < capacity_ && !eof_) {
+    const std::size_t wanted = capacity_ - filled_;
+    const std::size_t read =
+        std::fread(buffer_.data() + filled_, 1, wanted, file_);
+    filled_ += read;
+    if (read < wanted) {
+      if (std::ferror(file_)) {
+        status_ = Status::kReadError;
+      }
+      eof_ = true;
+    }
+  }
+
+  // validate the new bytes, holding back a sequence cut off by the end of
+  // the buffer until the rest of it is read
+  std::size_t pos = valid_;
+  while (pos < filled_) {
+    const char8_t lead = buffer_[pos];
+    if (lead < 0x80) [[likely]] {
+      if (lead == '\n') {
+        newlines_.push_back(begin_ + pos);
+      }
+      ++pos;
+      continue;
+    }
+    const std::size_t length = utf8_sequence_length(lead);
+    if (length != 0 && pos + length > filled_ && !eof_) {
+      break;
+    }
+    const auto [codepoint, bytes] =
+        Utf8Decoder::decode(buffer_.data() + pos, filled_ - pos);
+    if (length == 0 || codepoint == Utf8Decoder::kInvalidUnicodePoint ||
+        bytes != length) [[unlikely]] {
+      status_ = Status::kInvalidUtf8;
+      break;
+    }
+    pos += bytes;
+  }
+  valid_ = pos;
+}
+
+std::size_t Utf8Window::codepoint_count(std::size_t from,
+                                        std::size_t to) const {
+  std::size_t count = 0;
+  for (std::size_t i = from; i < to; ++i) {
+    // skip continuation bytes
+    count += (buffer_[i] & 0xC0) != 0x80;
+  }
+  return count;
+}
+
+}  // namespace unicode
@@ -0,0 +1,107 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#ifndef UNICODE_UTF8_WINDOW_H_
+#define UNICODE_UTF8_WINDOW_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/base/source_location.h"
+#include "core/check.h"
+#include "unicode/base/unicode_export.h"
+
+namespace unicode {
+
+// reads a file in chunks and keeps only a window of it resident, for lexing
+// input that should not be loaded as a whole (see Utf8File for that). the
+// window is validated as it is read and only indexes its own lines, lines
+// before it are merely counted.
+class UNICODE_EXPORT Utf8Window {
+ public:
+  enum class Status : uint8_t {
+    kNotInitialized = 0,
+    kValid = 1,
+    kFileNotFound = 2,
+    // reading stopped in front of an invalid sequence, at end()
+    kInvalidUtf8 = 3,
+    // reading stopped at end() because the file could not be read further
+    kReadError = 4,
+  };
+
+  static constexpr const std::size_t kDefaultCapacity = 1024 * 1024;
+
+  Utf8Window() = default;
+  ~Utf8Window();
+
+  // streams keep a pointer to the window
+  Utf8Window(const Utf8Window&) = delete;
+  Utf8Window& operator=(const Utf8Window&) = delete;
+  Utf8Window(Utf8Window&&) = delete;
+  Utf8Window& operator=(Utf8Window&&) = delete;
+
+  // opens the file and reads up to `capacity` bytes of it
+  Status open(const char* path, std::size_t capacity = kDefaultCapacity);
+
+  // drops the bytes before `keep_from` and reads up to the capacity again.
+  // the capacity doubles if nothing could be dropped from a full window, so
+  // a single lexeme longer than the window still fits.
+  Status slide(std::size_t keep_from);
+
+  // the resident bytes [begin(), end()), which end on a codepoint boundary
+  inline std::u8string_view content() const {
+    return std::u8string_view(buffer_.data(), valid_);
+  }
+
+  // byte offsets into the file
+  inline std::size_t begin() const { return begin_; }
+  inline std::size_t end() const { return begin_ + valid_; }
+
+  // nothing can be read past end(), either the file ends there or reading
+  // stopped, see status()
+  inline bool exhausted() const {
+    return status_ != Status::kValid || (eof_ && valid_ == filled_);
+  }
+
+  inline Status status() const { return status_; }
+  inline std::size_t capacity() const { return capacity_; }
+
+  // 1 indexed line and column (in codepoints) of a resident byte offset in
+  // [begin(), end()], as Utf8File::location() would resolve it
+  core::SourceLocation location(std::size_t offset) const;
+
+ private:
+  // reads until the buffer is full or the file ends, then validates and
+  // indexes what was read
+  void fill();
+
+  // number of codepoints in buffer_[from, to)
+  std::size_t codepoint_count(std::size_t from, std::size_t to) const;
+
+  std::FILE* file_ = nullptr;
+  std::u8string buffer_;
+  // bytes read into buffer_. [valid_, filled_) is an incomplete sequence
+  // waiting for the rest of its bytes.
+  std::size_t filled_ = 0;
+  std::size_t valid_ = 0;
+  std::size_t begin_ = 0;
+  std::size_t capacity_ = 0;
+
+  // file offsets of the newlines in content()
+  std::vector<std::size_t> newlines_;
+  // line of begin(), and the codepoints between its line start and begin()
+  std::size_t first_line_ = 1;
+  std::size_t first_column_ = 0;
+
+  bool eof_ = false;
+  Status status_ = Status::kNotInitialized;
+};
+
+}  // namespace unicode
+
+#endif  // UNICODE_UTF8_WINDOW_H_
@@ -0,0 +1,139 @@
+// Copyright 2025 pugur
+// This source code is licensed under the Apache License, Version 2.0
+// which can be found in the LICENSE file.
+
+#include "unicode/utf8/window.h"
+
+#include <string>
+#include <utility>
+
+#include "core/base/file_util.h"
+#include "core/base/source_location.h"
+#include "core/base/string_util.h"
+#include "gtest/gtest.h"
+#include "unicode/utf8/file_manager.h"
+
+namespace unicode {
+
+namespace {
+
+core::TempFile make_file(std::u8string_view content) {
+  return core::TempFile("utf8_window_test_",
+                        std::string(core::to_string_view(content)));
+}
+
+// checks the resident bytes and their locations against a whole file
+void expect_matches_file(const Utf8Window& window, const Utf8File& file) {
+  ASSERT_EQ(window.content(),
+            file.content_u8().substr(window.begin(), window.content().size()));
+  for (std::size_t offset = window.begin(); offset <= window.end(); ++offset) {
+    const core::SourceLocation expected = file.location(offset);
+    const core::SourceLocation actual = window.location(offset);
+    EXPECT_EQ(actual.line(), expected.line()) << "offset " << offset;
+    EXPECT_EQ(actual.column(), expected.column()) << "offset " << offset;
+  }
+}
+
+}  // namespace
+
+TEST(Utf8WindowTest, SlidesAcrossTheFile) {
+  std::u8string content;
+  for (int i = 0; i < 8; ++i) {
+    content.append(u8"ab\nあい😊\n\ncd\r\nxyz 😊😊 w\n");
+  }
+  core::TempFile temp = make_file(content);
+  Utf8FileManager manager;
+  const Utf8File& file = manager.file(manager.register_virtual_file(
+      std::u8string(content)));
+
+  Utf8Window window;
+  ASSERT_EQ(window.open(temp.path().c_str(), 7), Utf8Window::Status::kValid);
+  std::size_t slides = 0;
+  while (true) {
+    expect_matches_file(window, file);
+    if (window.exhausted()) {
+      break;
+    }
+    // alternate between keeping part of the window and dropping all of it
+    const std::size_t keep_from =
+        slides % 2 ? window.end()
+                   : window.begin() + window.content().size() / 2;
+    // a codepoint boundary to keep from
+    std::size_t boundary = keep_from;
+    while ((content[boundary] & 0xC0) == 0x80) {
+      --boundary;
+    }
+    window.slide(boundary);
+    ++slides;
+  }
+  EXPECT_EQ(window.status(), Utf8Window::Status::kValid);
+  EXPECT_EQ(window.end(), content.size());
+  EXPECT_GT(slides, 0u);
+}
+
+TEST(Utf8WindowTest, GrowsWhenNothingCanBeDropped) {
+  const std::u8string content = u8"a long lexeme that outgrows the window";
+  core::TempFile temp = make_file(content);
+
+  Utf8Window window;
+  ASSERT_EQ(window.open(temp.path().c_str(), 4), Utf8Window::Status::kValid);
+  EXPECT_EQ(window.content(), u8"a lo");
+  while (!window.exhausted()) {
+    window.slide(window.begin());
+  }
+  EXPECT_EQ(window.content(), content);
+  EXPECT_EQ(window.capacity(), 64u);
+}
+
+TEST(Utf8WindowTest, HoldsBackCutOffSequences) {
+  // the window ends inside the 4 byte sequence
+  core::TempFile temp = make_file(u8"ab😊c");
+
+  Utf8Window window;
+  ASSERT_EQ(window.open(temp.path().c_str(), 4), Utf8Window::Status::kValid);
+  EXPECT_EQ(window.content(), u8"ab");
+  window.slide(2);
+  EXPECT_EQ(window.content(), u8"😊");
+  window.slide(6);
+  EXPECT_EQ(window.content(), u8"c");
+  EXPECT_TRUE(window.exhausted());
+  EXPECT_EQ(window.location(7).column(), 5u);
+}
+
+TEST(Utf8WindowTest, StopsAtInvalidUtf8) {
+  std::u8string content = u8"abc\ndef";
+  content.push_back(static_cast<char8_t>(0xFF));
+  content.append(u8"ghi");
+  core::TempFile temp = make_file(content);
+
+  Utf8Window window;
+  ASSERT_EQ(window.open(temp.path().c_str(), 3), Utf8Window::Status::kValid);
+  while (!window.exhausted()) {
+    window.slide(window.end());
+  }
+  EXPECT_EQ(window.status(), Utf8Window::Status::kInvalidUtf8);
+  EXPECT_EQ(window.end(), 7u);
+  EXPECT_EQ(window.location(7).line(), 2u);
+  EXPECT_EQ(window.location(7).column(), 4u);
+}
+
+TEST(Utf8WindowTest, RejectsTruncatedSequenceAtEof) {
+  std::u8string content = u8"ab";
+  content.push_back(static_cast<char8_t>(0xE3));
+  content.push_back(static_cast<char8_t>(0x81));
+  core::TempFile temp = make_file(content);
+
+  Utf8Window window;
+  EXPECT_EQ(window.open(temp.path().c_str()),
+            Utf8Window::Status::kInvalidUtf8);
+  EXPECT_TRUE(window.exhausted());
+  EXPECT_EQ(window.content(), u8"ab");
+}
+
+TEST(Utf8WindowTest, MissingFile) {
+  Utf8Window window;
+  EXPECT_EQ(window.open("/nonexistent/utf8_window_test"),
+            Utf8Window::Status::kFileNotFound);
+}
+
+}  // namespace unicode